@@ -1,11 +1,20 @@
 #version 330 core
 layout (location = 0) in vec3 aPos;
 
+layout (std140) uniform CameraBlock
+{
+    mat4 view;
+    mat4 projection;
+    vec4 viewPos;
+};
+
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+
+// 顶点解码参数 (见 vertex_format.h)
+uniform vec3 positionScale;
+uniform vec3 positionOffset;
 
 void main()
 {
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
-}
\ No newline at end of file
+    gl_Position = projection * view * model * vec4(aPos * positionScale + positionOffset, 1.0);
+}
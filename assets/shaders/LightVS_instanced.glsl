@@ -0,0 +1,26 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+
+// 每实例属性 (见 instanced_mesh.h)
+layout (location = 3) in mat4 aInstanceModel;
+layout (location = 7) in vec4 aInstanceColor;
+
+out vec3 LightColor;
+
+layout (std140) uniform CameraBlock
+{
+    mat4 view;
+    mat4 projection;
+    vec4 viewPos;
+};
+
+// 顶点解码参数 (每个网格一组，见 vertex_format.h)
+// 量化位置: 存储值 [0,1] * positionScale + positionOffset；未量化时为 1 和 0
+uniform vec3 positionScale;
+uniform vec3 positionOffset;
+
+void main()
+{
+    gl_Position = projection * view * aInstanceModel * vec4(aPos * positionScale + positionOffset, 1.0);
+    LightColor = aInstanceColor.rgb;
+}
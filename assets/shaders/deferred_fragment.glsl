@@ -0,0 +1,221 @@
+#version 330 core
+out vec4 FragColor;
+
+// 输入来自 deferred_vertex.glsl
+in vec2 TexCoords;
+
+// 延迟渲染的光照阶段 (固定 4 个点光源的版本，对应 main_fragment.glsl)
+// 表面属性从 G-buffer 读取，世界坐标由深度重建，每个像素只计算一次光照
+
+// std140 结构体，与 uniform_blocks.h 一一对应
+struct DirLight {
+    vec4 direction;
+
+    vec4 ambient;
+    vec4 diffuse;
+    vec4 specular;
+};
+
+struct PointLight {
+    vec4 position;
+
+    vec4 ambient;
+    vec4 diffuse;
+    vec4 specular;
+
+    vec4 attenuation; // x = constant, y = linear, z = quadratic
+};
+
+struct SpotLight {
+    vec4 position;
+    vec4 direction;
+
+    vec4 ambient;
+    vec4 diffuse;
+    vec4 specular;
+
+    vec4 attenuation; // x = constant, y = linear, z = quadratic
+    vec4 cone;        // x = 内切角余弦值, y = 外切角余弦值, z = 开关
+};
+// -------------------------
+
+#define NR_POINT_LIGHTS 4
+
+layout (std140) uniform CameraBlock
+{
+    mat4 view;
+    mat4 projection;
+    vec4 viewPos;
+};
+
+layout (std140) uniform LightsBlock
+{
+    DirLight dirLight;
+    PointLight pointLights[NR_POINT_LIGHTS];
+    SpotLight spotLight;
+};
+
+layout (std140) uniform MaterialBlock
+{
+    vec4 materialParams; // x = shininess
+};
+
+// 定向光的级联阴影 (见 shadow_cascades.h)
+#define NR_SHADOW_CASCADES 4
+
+layout (std140) uniform ShadowBlock
+{
+    mat4 lightSpace[NR_SHADOW_CASCADES]; // 世界空间 -> 各级阴影贴图 (xyz 都在 [0, 1])
+    vec4 cascadeSplits;  // 各级覆盖到的最远观察深度
+    vec4 cascadeTexels;  // 各级一个 texel 的世界尺寸
+    vec4 shadowParams;   // x = 级数 (0 = 关闭), y = 深度偏移, z = 法线偏移 (texel), w = 1 / 分辨率
+};
+
+// 每一级是纹理数组的一层，开启了深度比较
+uniform sampler2DArrayShadow shadowMap;
+
+// G-buffer (见 deferred_shading.h)
+uniform sampler2D gAlbedo;  // rgb = 漫反射颜色, a = 镜面强度
+uniform sampler2D gNormal;  // 八面体编码的法线
+uniform sampler2D gDepth;
+
+// 屏幕坐标 + 深度 -> 世界坐标
+uniform mat4 inverseViewProjection;
+
+// 由深度重建的世界坐标 (和前向渲染的 FragPos 含义相同)
+vec3 FragPos;
+
+vec3 decode_octahedral(vec2 e);
+vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir, vec3 diffuseColor, vec3 specularColor);
+float CalcDirShadow(vec3 fragPos, vec3 normal, vec3 lightDir);
+vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir, vec3 diffuseColor, vec3 specularColor);
+vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir, vec3 diffuseColor, vec3 specularColor);
+
+void main()
+{
+    // 背景像素：保留清屏颜色
+    float depth = texture(gDepth, TexCoords).r;
+    if(depth >= 1.0)
+        discard;
+    gl_FragDepth = depth;
+
+    vec4 world = inverseViewProjection * vec4(vec3(TexCoords, depth) * 2.0 - 1.0, 1.0);
+    FragPos = world.xyz / world.w;
+
+    vec4 albedoSpec = texture(gAlbedo, TexCoords);
+    vec3 diffuseColor = albedoSpec.rgb;
+    vec3 specularColor = vec3(albedoSpec.a);
+    vec3 norm = decode_octahedral(texture(gNormal, TexCoords).rg);
+    vec3 viewDir = normalize(viewPos.xyz - FragPos);
+
+    vec3 result = CalcDirLight(dirLight, norm, viewDir, diffuseColor, specularColor);
+
+    for(int i = 0; i < NR_POINT_LIGHTS; i++)
+        result += CalcPointLight(pointLights[i], norm, FragPos, viewDir, diffuseColor, specularColor);
+
+    if(spotLight.cone.z > 0.5)
+    {
+        result += CalcSpotLight(spotLight, norm, FragPos, viewDir, diffuseColor, specularColor);
+    }
+
+    FragColor = vec4(result, 1.0);
+}
+
+vec3 decode_octahedral(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
+
+// 计算定向光
+vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir, vec3 diffuseColor, vec3 specularColor)
+{
+    vec3 lightDir = normalize(-light.direction.xyz);
+    // 漫反射
+    float diff = max(dot(normal, lightDir), 0.0);
+    // 镜面光
+    vec3 reflectDir = reflect(-lightDir, normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), materialParams.x);
+    // 合并结果
+    vec3 ambient = light.ambient.rgb * diffuseColor;
+    vec3 diffuse = light.diffuse.rgb * diff * diffuseColor;
+    vec3 specular = light.specular.rgb * spec * specularColor;
+    // 阴影只遮挡漫反射和镜面光
+    float shadow = CalcDirShadow(FragPos, normal, lightDir);
+    return (ambient + (diffuse + specular) * shadow);
+}
+
+// 定向光的可见度 (0 = 完全在阴影里, 1 = 完全照亮)
+float CalcDirShadow(vec3 fragPos, vec3 normal, vec3 lightDir)
+{
+    int count = int(shadowParams.x);
+    if(count == 0)
+        return 1.0;
+
+    // 按观察深度选择级数，超出最后一级的范围不投阴影
+    float viewDepth = -(view * vec4(fragPos, 1.0)).z;
+    int cascade = 0;
+    while(cascade < count - 1 && viewDepth > cascadeSplits[cascade])
+        cascade++;
+    if(viewDepth > cascadeSplits[count - 1])
+        return 1.0;
+
+    // 法线偏移：沿法线把采样点推出表面，掠射角越大推得越远
+    float slope = 1.0 - max(dot(normal, lightDir), 0.0);
+    vec3 samplePos = fragPos + normal * (shadowParams.z * cascadeTexels[cascade] * slope);
+    vec3 coord = (lightSpace[cascade] * vec4(samplePos, 1.0)).xyz;
+    if(coord.z > 1.0)
+        return 1.0;
+
+    // 3x3 PCF (每次采样硬件再做 2x2 比较的双线性插值)
+    float lit = 0.0;
+    for(int x = -1; x <= 1; x++)
+        for(int y = -1; y <= 1; y++)
+            lit += texture(shadowMap, vec4(coord.xy + vec2(x, y) * shadowParams.w, float(cascade), coord.z - shadowParams.y));
+    return lit / 9.0;
+}
+
+// 计算点光源
+vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir, vec3 diffuseColor, vec3 specularColor)
+{
+    vec3 lightDir = normalize(light.position.xyz - fragPos);
+    // 漫反射
+    float diff = max(dot(normal, lightDir), 0.0);
+    // 镜面光
+    vec3 reflectDir = reflect(-lightDir, normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), materialParams.x);
+    // 衰减
+    float distance = length(light.position.xyz - fragPos);
+    float attenuation = 1.0 / (light.attenuation.x + light.attenuation.y * distance + light.attenuation.z * (distance * distance));
+    // 合并结果
+    vec3 ambient = light.ambient.rgb * diffuseColor;
+    vec3 diffuse = light.diffuse.rgb * diff * diffuseColor;
+    vec3 specular = light.specular.rgb * spec * specularColor;
+    return (ambient + diffuse + specular) * attenuation;
+}
+
+// 计算聚光灯
+vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir, vec3 diffuseColor, vec3 specularColor)
+{
+    vec3 lightDir = normalize(light.position.xyz - fragPos);
+    // 漫反射
+    float diff = max(dot(normal, lightDir), 0.0);
+    // 镜面光
+    vec3 reflectDir = reflect(-lightDir, normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), materialParams.x);
+    // 衰减
+    float distance = length(light.position.xyz - fragPos);
+    float attenuation = 1.0 / (light.attenuation.x + light.attenuation.y * distance + light.attenuation.z * (distance * distance));
+    // 聚光灯调整
+    float theta = dot(lightDir, normalize(-light.direction.xyz));
+    float epsilon = light.cone.x - light.cone.y;
+    float intensity = clamp((theta - light.cone.y) / epsilon, 0.0, 1.0);
+    // 合并结果
+    vec3 ambient = light.ambient.rgb * diffuseColor;
+    vec3 diffuse = light.diffuse.rgb * diff * diffuseColor;
+    vec3 specular = light.specular.rgb * spec * specularColor;
+    return (ambient + diffuse + specular) * attenuation * intensity;
+}
@@ -0,0 +1,11 @@
+#version 330 core
+// 延迟渲染的光照阶段：一个覆盖全屏的三角形，不需要顶点缓冲 (配合空的 VAO 使用)
+out vec2 TexCoords;
+
+void main()
+{
+    // gl_VertexID 0, 1, 2 -> (0, 0) (2, 0) (0, 2)，裁剪后正好覆盖 [0, 1]^2
+    vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    TexCoords = position;
+    gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+}
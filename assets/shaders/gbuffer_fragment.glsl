@@ -0,0 +1,37 @@
+#version 330 core
+// 延迟渲染的几何阶段：只写表面属性，不计算光照 (见 deferred_shading.h)
+layout (location = 0) out vec4 gAlbedoSpec; // rgb = 漫反射颜色, a = 镜面强度
+layout (location = 1) out vec2 gNormal;     // 八面体编码的世界空间法线
+
+// 输入来自顶点着色器 (与前向渲染共用 main_vertex.glsl / main_vertex_instanced.glsl)
+in vec3 FragPos;
+in vec3 Normal;
+in vec2 TexCoords;
+
+// 命名与 Mesh::Draw 的约定一致：material.texture_diffuse1 / material.texture_specular1
+struct Material {
+    sampler2D texture_diffuse1;
+    sampler2D texture_specular1;
+};
+
+uniform Material material;
+
+// 单位向量 -> 八面体展开后的 [-1, 1]^2 (与 main_vertex.glsl 的 decode_octahedral 互逆)
+vec2 encode_octahedral(vec3 n)
+{
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    vec2 e = n.xy;
+    if(n.z < 0.0)
+        e = (1.0 - abs(n.yx)) * vec2(e.x >= 0.0 ? 1.0 : -1.0, e.y >= 0.0 ? 1.0 : -1.0);
+    return e;
+}
+
+void main()
+{
+    vec3 diffuseColor = vec3(texture(material.texture_diffuse1, TexCoords));
+    vec3 specularColor = vec3(texture(material.texture_specular1, TexCoords));
+
+    // 镜面贴图只保留亮度，和漫反射颜色挤在同一个 RGBA8 里
+    gAlbedoSpec = vec4(diffuseColor, dot(specularColor, vec3(0.2126, 0.7152, 0.0722)));
+    gNormal = encode_octahedral(normalize(Normal));
+}
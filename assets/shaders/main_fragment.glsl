@@ -6,118 +6,209 @@ in vec3 FragPos;
 in vec3 Normal;
 in vec2 TexCoords;
 
-// 材质结构体
+// 材质结构体 (只剩采样器，采样器不能放进 Uniform Block)
+// 命名与 Mesh::Draw 的约定一致：material.texture_diffuse1 / material.texture_specular1
 struct Material {
-    sampler2D diffuse;
-    sampler2D specular;
-    float shininess;
+    sampler2D texture_diffuse1;
+    sampler2D texture_specular1;
 };
 
+// 以下结构体都是 std140 布局，与 C++ 端 uniform_blocks.h 一一对应
+// 统一使用 vec4，避免 vec3 的对齐问题
+
 // 定向光结构体
 struct DirLight {
-    vec3 direction;
+    vec4 direction;
 
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
+    vec4 ambient;
+    vec4 diffuse;
+    vec4 specular;
 };
 
 // 点光源结构体
 struct PointLight {
-    vec3 position;
+    vec4 position;
 
-    float constant;
-    float linear;
-    float quadratic;
+    vec4 ambient;
+    vec4 diffuse;
+    vec4 specular;
 
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
+    vec4 attenuation; // x = constant, y = linear, z = quadratic
 };
 
 // 聚光灯结构体
 struct SpotLight {
-    bool enabled; // 开关
-
-    vec3 position;
-    vec3 direction;
-    float cutOff;      // 内切角余弦值
-    float outerCutOff; // 外切角余弦值
+    vec4 position;
+    vec4 direction;
 
-    float constant;
-    float linear;
-    float quadratic;
+    vec4 ambient;
+    vec4 diffuse;
+    vec4 specular;
 
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
+    vec4 attenuation; // x = constant, y = linear, z = quadratic
+    vec4 cone;        // x = 内切角余弦值, y = 外切角余弦值, z = 开关
 };
 // -------------------------
 
 #define NR_POINT_LIGHTS 4
 
-uniform vec3 viewPos;
-uniform DirLight dirLight;
-uniform PointLight pointLights[NR_POINT_LIGHTS];
-uniform SpotLight spotLight;
+// 变体特性 (见 shader_permutations.h)：由 C++ 端注入，关闭的光源和贴图在编译时就被去掉
+// 没有注入时 (通用版本) 全部开启，聚光灯的开关在运行时判断
+#ifndef SHADER_PERMUTATION
+#define POINT_LIGHT_COUNT NR_POINT_LIGHTS
+#define HAS_DIR_LIGHT
+#define HAS_SPOT_LIGHT
+#define HAS_SHADOWS
+#define HAS_DIFFUSE_MAP
+#define HAS_SPECULAR_MAP
+#endif
+
+layout (std140) uniform CameraBlock
+{
+    mat4 view;
+    mat4 projection;
+    vec4 viewPos;
+};
+
+layout (std140) uniform LightsBlock
+{
+    DirLight dirLight;
+    PointLight pointLights[NR_POINT_LIGHTS];
+    SpotLight spotLight;
+};
+
+layout (std140) uniform MaterialBlock
+{
+    vec4 materialParams; // x = shininess
+};
+
+// 定向光的级联阴影 (见 shadow_cascades.h)
+#define NR_SHADOW_CASCADES 4
+
+layout (std140) uniform ShadowBlock
+{
+    mat4 lightSpace[NR_SHADOW_CASCADES]; // 世界空间 -> 各级阴影贴图 (xyz 都在 [0, 1])
+    vec4 cascadeSplits;  // 各级覆盖到的最远观察深度
+    vec4 cascadeTexels;  // 各级一个 texel 的世界尺寸
+    vec4 shadowParams;   // x = 级数 (0 = 关闭), y = 深度偏移, z = 法线偏移 (texel), w = 1 / 分辨率
+};
+
+// 每一级是纹理数组的一层，开启了深度比较
+uniform sampler2DArrayShadow shadowMap;
+
 uniform Material material;
 
 // 函数声明
-vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir);
-vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
-vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
+vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir, vec3 diffuseColor, vec3 specularColor);
+float CalcDirShadow(vec3 fragPos, vec3 normal, vec3 lightDir);
+vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir, vec3 diffuseColor, vec3 specularColor);
+vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir, vec3 diffuseColor, vec3 specularColor);
 
 void main()
 {
     // 属性
     vec3 norm = normalize(Normal);
-    vec3 viewDir = normalize(viewPos - FragPos);
-    
-    vec3 result = CalcDirLight(dirLight, norm, viewDir);
-
-    for(int i = 0; i < NR_POINT_LIGHTS; i++)
-        result += CalcPointLight(pointLights[i], norm, FragPos, viewDir);    
-    
-    if(spotLight.enabled)
-    {
-        result += CalcSpotLight(spotLight, norm, FragPos, viewDir);
-    }
+    vec3 viewDir = normalize(viewPos.xyz - FragPos);
+
+    // 贴图每个像素只采样一次，所有光源共用 (没有贴图的材质用固定颜色)
+#ifdef HAS_DIFFUSE_MAP
+    vec3 diffuseColor = vec3(texture(material.texture_diffuse1, TexCoords));
+#else
+    vec3 diffuseColor = vec3(0.8);
+#endif
+#ifdef HAS_SPECULAR_MAP
+    vec3 specularColor = vec3(texture(material.texture_specular1, TexCoords));
+#else
+    vec3 specularColor = vec3(0.0);
+#endif
+
+    vec3 result = vec3(0.0);
+#ifdef HAS_DIR_LIGHT
+    result += CalcDirLight(dirLight, norm, viewDir, diffuseColor, specularColor);
+#endif
+
+    // 循环次数是编译期常量，驱动可以完全展开
+    for(int i = 0; i < POINT_LIGHT_COUNT; i++)
+        result += CalcPointLight(pointLights[i], norm, FragPos, viewDir, diffuseColor, specularColor);
+
+#ifdef HAS_SPOT_LIGHT
+#ifndef SHADER_PERMUTATION
+    if(spotLight.cone.z > 0.5)
+#endif
+        result += CalcSpotLight(spotLight, norm, FragPos, viewDir, diffuseColor, specularColor);
+#endif
 
     FragColor = vec4(result, 1.0);
 }
 
 // 计算定向光
-vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir)
+vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir, vec3 diffuseColor, vec3 specularColor)
 {
-    vec3 lightDir = normalize(-light.direction);
+    vec3 lightDir = normalize(-light.direction.xyz);
     // 漫反射
     float diff = max(dot(normal, lightDir), 0.0);
     // 镜面光
     vec3 reflectDir = reflect(-lightDir, normal);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), materialParams.x);
     // 合并结果
-    vec3 ambient = light.ambient * vec3(texture(material.diffuse, TexCoords));
-    vec3 diffuse = light.diffuse * diff * vec3(texture(material.diffuse, TexCoords));
-    vec3 specular = light.specular * spec * vec3(texture(material.specular, TexCoords));
-    return (ambient + diffuse + specular);
+    vec3 ambient = light.ambient.rgb * diffuseColor;
+    vec3 diffuse = light.diffuse.rgb * diff * diffuseColor;
+    vec3 specular = light.specular.rgb * spec * specularColor;
+    // 阴影只遮挡漫反射和镜面光
+#ifdef HAS_SHADOWS
+    float shadow = CalcDirShadow(FragPos, normal, lightDir);
+#else
+    float shadow = 1.0;
+#endif
+    return (ambient + (diffuse + specular) * shadow);
+}
+
+// 定向光的可见度 (0 = 完全在阴影里, 1 = 完全照亮)
+float CalcDirShadow(vec3 fragPos, vec3 normal, vec3 lightDir)
+{
+    int count = int(shadowParams.x);
+    if(count == 0)
+        return 1.0;
+
+    // 按观察深度选择级数，超出最后一级的范围不投阴影
+    float viewDepth = -(view * vec4(fragPos, 1.0)).z;
+    int cascade = 0;
+    while(cascade < count - 1 && viewDepth > cascadeSplits[cascade])
+        cascade++;
+    if(viewDepth > cascadeSplits[count - 1])
+        return 1.0;
+
+    // 法线偏移：沿法线把采样点推出表面，掠射角越大推得越远
+    float slope = 1.0 - max(dot(normal, lightDir), 0.0);
+    vec3 samplePos = fragPos + normal * (shadowParams.z * cascadeTexels[cascade] * slope);
+    vec3 coord = (lightSpace[cascade] * vec4(samplePos, 1.0)).xyz;
+    if(coord.z > 1.0)
+        return 1.0;
+
+    // 3x3 PCF (每次采样硬件再做 2x2 比较的双线性插值)
+    float lit = 0.0;
+    for(int x = -1; x <= 1; x++)
+        for(int y = -1; y <= 1; y++)
+            lit += texture(shadowMap, vec4(coord.xy + vec2(x, y) * shadowParams.w, float(cascade), coord.z - shadowParams.y));
+    return lit / 9.0;
 }
 
 // 计算点光源
-vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
+vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir, vec3 diffuseColor, vec3 specularColor)
 {
-    vec3 lightDir = normalize(light.position - fragPos);
+    vec3 lightDir = normalize(light.position.xyz - fragPos);
     // 漫反射
     float diff = max(dot(normal, lightDir), 0.0);
     // 镜面光
     vec3 reflectDir = reflect(-lightDir, normal);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), materialParams.x);
     // 衰减
-    float distance = length(light.position - fragPos);
-    float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));
+    float distance = length(light.position.xyz - fragPos);
+    float attenuation = 1.0 / (light.attenuation.x + light.attenuation.y * distance + light.attenuation.z * (distance * distance));
     // 合并结果
-    vec3 ambient = light.ambient * vec3(texture(material.diffuse, TexCoords));
-    vec3 diffuse = light.diffuse * diff * vec3(texture(material.diffuse, TexCoords));
-    vec3 specular = light.specular * spec * vec3(texture(material.specular, TexCoords));
+    vec3 ambient = light.ambient.rgb * diffuseColor;
+    vec3 diffuse = light.diffuse.rgb * diff * diffuseColor;
+    vec3 specular = light.specular.rgb * spec * specularColor;
     ambient *= attenuation;
     diffuse *= attenuation;
     specular *= attenuation;
@@ -125,27 +216,27 @@ vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
 }
 
 // 计算聚光灯
-vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
+vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir, vec3 diffuseColor, vec3 specularColor)
 {
-    vec3 lightDir = normalize(light.position - fragPos);
+    vec3 lightDir = normalize(light.position.xyz - fragPos);
     // 漫反射
     float diff = max(dot(normal, lightDir), 0.0);
     // 镜面光
     vec3 reflectDir = reflect(-lightDir, normal);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), materialParams.x);
     // 衰减
-    float distance = length(light.position - fragPos);
-    float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));
+    float distance = length(light.position.xyz - fragPos);
+    float attenuation = 1.0 / (light.attenuation.x + light.attenuation.y * distance + light.attenuation.z * (distance * distance));
     // 聚光灯调整
-    float theta = dot(lightDir, normalize(-light.direction));
-    float epsilon = light.cutOff - light.outerCutOff;
-    float intensity = clamp((theta - light.outerCutOff) / epsilon, 0.0, 1.0);
+    float theta = dot(lightDir, normalize(-light.direction.xyz));
+    float epsilon = light.cone.x - light.cone.y;
+    float intensity = clamp((theta - light.cone.y) / epsilon, 0.0, 1.0);
     // 合并结果
-    vec3 ambient = light.ambient * vec3(texture(material.diffuse, TexCoords));
-    vec3 diffuse = light.diffuse * diff * vec3(texture(material.diffuse, TexCoords));
-    vec3 specular = light.specular * spec * vec3(texture(material.specular, TexCoords));
+    vec3 ambient = light.ambient.rgb * diffuseColor;
+    vec3 diffuse = light.diffuse.rgb * diff * diffuseColor;
+    vec3 specular = light.specular.rgb * spec * specularColor;
     ambient *= attenuation * intensity;
     diffuse *= attenuation * intensity;
     specular *= attenuation * intensity;
     return (ambient + diffuse + specular);
-}
\ No newline at end of file
+}
@@ -7,14 +7,39 @@ out vec3 FragPos;
 out vec3 Normal;
 out vec2 TexCoords;
 
+// 摄像机数据 (每帧由 C++ 端整块上传，见 uniform_blocks.h)
+layout (std140) uniform CameraBlock
+{
+    mat4 view;
+    mat4 projection;
+    vec4 viewPos;
+};
+
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+
+// 顶点解码参数 (每个网格一组，见 vertex_format.h)
+// 量化位置: 存储值 [0,1] * positionScale + positionOffset；未量化时为 1 和 0
+uniform vec3 positionScale;
+uniform vec3 positionOffset;
+// 法线是否为八面体编码 (只有 xy 两个分量)
+uniform bool octahedralNormals;
+
+vec3 decode_octahedral(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
 
 void main()
 {
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
-    FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal;
+    vec3 position = aPos * positionScale + positionOffset;
+    vec3 normal = octahedralNormals ? decode_octahedral(aNormal.xy) : aNormal;
+
+    gl_Position = projection * view * model * vec4(position, 1.0);
+    FragPos = vec3(model * vec4(position, 1.0));
+    Normal = mat3(transpose(inverse(model))) * normal;
     TexCoords = aTexCoords;
-}
\ No newline at end of file
+}
@@ -0,0 +1,46 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+
+// 每实例属性 (见 instanced_mesh.h)
+// mat4 占用 location 3~6
+layout (location = 3) in mat4 aInstanceModel;
+
+out vec3 FragPos; 
+out vec3 Normal;
+out vec2 TexCoords;
+
+layout (std140) uniform CameraBlock
+{
+    mat4 view;
+    mat4 projection;
+    vec4 viewPos;
+};
+
+// 顶点解码参数 (每个网格一组，见 vertex_format.h)
+// 量化位置: 存储值 [0,1] * positionScale + positionOffset；未量化时为 1 和 0
+uniform vec3 positionScale;
+uniform vec3 positionOffset;
+// 法线是否为八面体编码 (只有 xy 两个分量)
+uniform bool octahedralNormals;
+
+vec3 decode_octahedral(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
+
+void main()
+{
+    vec3 position = aPos * positionScale + positionOffset;
+    vec3 normal = octahedralNormals ? decode_octahedral(aNormal.xy) : aNormal;
+
+    gl_Position = projection * view * aInstanceModel * vec4(position, 1.0);
+    FragPos = vec3(aInstanceModel * vec4(position, 1.0));
+    Normal = mat3(transpose(inverse(aInstanceModel))) * normal;
+    TexCoords = aTexCoords;
+}
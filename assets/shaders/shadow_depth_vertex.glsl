@@ -0,0 +1,15 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+
+// 阴影贴图的深度渲染：只需要位置 (见 shadow_cascades.h)
+uniform mat4 model;
+uniform mat4 lightSpace; // 当前这一级的 光源 Projection * View
+
+// 顶点解码参数 (见 vertex_format.h)
+uniform vec3 positionScale;
+uniform vec3 positionOffset;
+
+void main()
+{
+    gl_Position = lightSpace * model * vec4(aPos * positionScale + positionOffset, 1.0);
+}
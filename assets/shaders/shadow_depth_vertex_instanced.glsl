@@ -0,0 +1,16 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+
+// 每实例属性 (见 instanced_mesh.h)，mat4 占用 location 3~6
+layout (location = 3) in mat4 aInstanceModel;
+
+uniform mat4 lightSpace; // 当前这一级的 光源 Projection * View
+
+// 顶点解码参数 (见 vertex_format.h)
+uniform vec3 positionScale;
+uniform vec3 positionOffset;
+
+void main()
+{
+    gl_Position = lightSpace * aInstanceModel * vec4(aPos * positionScale + positionOffset, 1.0);
+}
@@ -0,0 +1,365 @@
+// shadow-bench：无头、可复现的渲染基准测试
+//
+// 渲染到离屏帧缓冲 (不显示窗口，没有显示服务器时用 OSMesa)，所以可以在没有 GPU 的 Linux 机器上
+// 用 Mesa llvmpipe 运行。摄像机沿固定的脚本路径移动 N 帧，路径只取决于帧号，和真实时间无关；
+// 最后把 CPU 帧时间、GPU 时间 (时间戳查询) 的均值/分位数、Draw Call 数量和最后一帧画面的哈希输出为 JSON。
+//
+// 用法 (在仓库根目录运行)：
+//   shadow-bench [--frames N] [--warmup N] [--width W] [--height H]
+//                [--clustered] [--lights N] [--no-shadows] [--no-shadow-cache] [--deferred]
+//                [--no-occlusion] [--headless | --hidden] [--output file.json]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "core/window.h"
+#include "core/jobs.h"
+#include "core/profiler.h"
+#include "renderer/camera.h"
+#include "renderer/async_loader.h"
+#include "renderer/resource_manager.h"
+#include "renderer/geometry_arena.h"
+#include "renderer/stream_buffer.h"
+#include "renderer/framebuffer.h"
+#include "scene/demo_scene.h"
+
+namespace {
+    struct BenchConfig {
+        int frames = 600;           // 参与统计的帧数
+        int warmup = 60;            // 预热帧 (不统计：着色器编译、驱动内部缓存、LOD 稳定)
+        int width = 1280;
+        int height = 720;
+        bool clustered = false;     // 使用分簇光照
+        int extra_lights = 0;       // 分簇光照的额外点光源数量
+        bool shadows = true;        // 定向光的级联阴影
+        bool shadow_cache = true;   // 缓存静态投影物的阴影层
+        bool deferred = false;      // 延迟渲染 (G-buffer + 屏幕空间光照)
+        bool occlusion = true;      // 软件遮挡剔除
+        window_mode mode = window_mode::HIDDEN;
+        std::string output;         // 为空时输出到标准输出
+    };
+
+    // 一组样本的统计量
+    struct Summary {
+        std::size_t samples = 0;
+        double mean = 0.0;
+        double min = 0.0;
+        double p50 = 0.0;
+        double p95 = 0.0;
+        double p99 = 0.0;
+        double max = 0.0;
+    };
+
+    void print_usage()
+    {
+        std::cout << "usage: shadow-bench [--frames N] [--warmup N] [--width W] [--height H]\n"
+                     "                    [--clustered] [--lights N] [--no-shadows] [--no-shadow-cache] [--deferred]\n"
+                     "                    [--no-occlusion] [--headless | --hidden] [--output file.json]" << std::endl;
+    }
+
+    bool parse_args(int argc, char** argv, BenchConfig& config)
+    {
+        // 默认：没有显示服务器时走无头模式
+        const char* display = std::getenv("DISPLAY");
+        const char* wayland = std::getenv("WAYLAND_DISPLAY");
+        bool has_display = (display && *display) || (wayland && *wayland);
+        config.mode = has_display ? window_mode::HIDDEN : window_mode::HEADLESS;
+
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            bool has_value = i + 1 < argc;
+            if (arg == "--frames" && has_value)
+                config.frames = std::atoi(argv[++i]);
+            else if (arg == "--warmup" && has_value)
+                config.warmup = std::atoi(argv[++i]);
+            else if (arg == "--width" && has_value)
+                config.width = std::atoi(argv[++i]);
+            else if (arg == "--height" && has_value)
+                config.height = std::atoi(argv[++i]);
+            else if (arg == "--lights" && has_value) {
+                config.extra_lights = std::clamp(std::atoi(argv[++i]), 0, DemoScene::MAX_EXTRA_LIGHTS);
+                config.clustered = true;
+            }
+            else if (arg == "--clustered")
+                config.clustered = true;
+            else if (arg == "--no-shadows")
+                config.shadows = false;
+            else if (arg == "--no-shadow-cache")
+                config.shadow_cache = false;
+            else if (arg == "--deferred")
+                config.deferred = true;
+            else if (arg == "--no-occlusion")
+                config.occlusion = false;
+            else if (arg == "--headless")
+                config.mode = window_mode::HEADLESS;
+            else if (arg == "--hidden")
+                config.mode = window_mode::HIDDEN;
+            else if (arg == "--output" && has_value)
+                config.output = argv[++i];
+            else {
+                std::cout << "ERROR::BENCH::UNKNOWN_ARGUMENT: " << arg << std::endl;
+                return false;
+            }
+        }
+
+        if (config.frames <= 0 || config.warmup < 0 || config.width <= 0 || config.height <= 0) {
+            std::cout << "ERROR::BENCH::INVALID_ARGUMENTS" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // 脚本化的摄像机路径：t 在 [0, 1) 内绕场景中心转一圈
+    // 同时上下起伏、拉近拉远，覆盖不同的剔除结果和 LOD 级别
+    void place_camera(Camera& camera, float t)
+    {
+        const glm::vec3 center(0.0f, 0.0f, -6.0f);
+        const float two_pi = 6.28318530718f;
+
+        float angle = two_pi * t;
+        float radius = 10.0f + 5.0f * std::sin(2.0f * two_pi * t);
+        float height = 1.0f + 3.0f * std::sin(3.0f * two_pi * t);
+
+        camera.position = center + glm::vec3(radius * std::sin(angle), height, radius * std::cos(angle));
+        camera.look_at(center);
+    }
+
+    // 最近秩法 (nearest-rank) 取分位数，samples 必须已排序
+    double percentile(const std::vector<double>& sorted, double p)
+    {
+        std::size_t rank = static_cast<std::size_t>(std::ceil(p / 100.0 * sorted.size()));
+        return sorted[std::clamp<std::size_t>(rank, 1, sorted.size()) - 1];
+    }
+
+    Summary summarize(std::vector<double> samples)
+    {
+        Summary summary;
+        summary.samples = samples.size();
+        if (samples.empty())
+            return summary;
+
+        std::sort(samples.begin(), samples.end());
+        double sum = 0.0;
+        for (double value : samples)
+            sum += value;
+
+        summary.mean = sum / samples.size();
+        summary.min = samples.front();
+        summary.p50 = percentile(samples, 50.0);
+        summary.p95 = percentile(samples, 95.0);
+        summary.p99 = percentile(samples, 99.0);
+        summary.max = samples.back();
+        return summary;
+    }
+
+    // 画面哈希 (FNV-1a 64)，用来确认不同运行画的是同一个东西
+    uint64_t hash_pixels(const std::vector<uint8_t>& pixels)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        for (uint8_t byte : pixels) {
+            hash ^= byte;
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    void write_json_string(std::ostream& out, const std::string& text)
+    {
+        out << '"';
+        for (char c : text) {
+            if (c == '"' || c == '\\')
+                out << '\\';
+            if (static_cast<unsigned char>(c) >= 0x20)
+                out << c;
+        }
+        out << '"';
+    }
+
+    void write_summary(std::ostream& out, const char* name, const Summary& summary)
+    {
+        out << "  \"" << name << "\": {\"samples\": " << summary.samples
+            << ", \"mean\": " << summary.mean << ", \"min\": " << summary.min
+            << ", \"p50\": " << summary.p50 << ", \"p95\": " << summary.p95
+            << ", \"p99\": " << summary.p99 << ", \"max\": " << summary.max << "}";
+    }
+
+    std::string gl_string(GLenum name)
+    {
+        const GLubyte* value = glGetString(name);
+        return value ? reinterpret_cast<const char*>(value) : "";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    BenchConfig config;
+    if (!parse_args(argc, argv, config)) {
+        print_usage();
+        return 2;
+    }
+
+    // -----------------------------------------------------
+    // 上下文与离屏目标
+    // -----------------------------------------------------
+    Window bench_window(config.width, config.height, "Shadow Bench", config.mode);
+    // 不等垂直同步 (无头模式下本来就没有)
+    glfwSwapInterval(0);
+    glEnable(GL_DEPTH_TEST);
+
+    Framebuffer target(config.width, config.height);
+    if (!target.is_complete())
+        return 1;
+
+    // 逐帧收集 GPU 时间 (结果晚几帧才回来，按帧号放回对应位置)
+    const int total_frames = config.warmup + config.frames;
+    std::vector<double> frame_gpu_ms(total_frames, -1.0);
+    Profiler::init();
+    Profiler::set_frame_callback([&](const ProfileFrame& frame) {
+        if (frame.index < frame_gpu_ms.size())
+            frame_gpu_ms[frame.index] = frame.gpu_ms;
+    });
+
+    // -----------------------------------------------------
+    // 场景 (与编辑器相同的初始化顺序)
+    // -----------------------------------------------------
+    JobSystem::init();
+    AsyncLoader async_loader;
+    GeometryArena geometry_arena;
+    ResourceManager resources(&async_loader);
+    resources.set_geometry_arena(&geometry_arena);
+
+    StreamBuffer frame_stream;
+    geometry_arena.set_stream_buffer(&frame_stream);
+
+    DemoScene scene(resources, frame_stream);
+    scene.cluster_params.enable = config.clustered;
+    scene.cluster_params.extra_point_lights = config.extra_lights;
+    scene.shadow_params.enable = config.shadows;
+    scene.shadow_params.cache_static = config.shadow_cache;
+    scene.shading = config.deferred ? shading_path::DEFERRED : shading_path::FORWARD;
+    scene.occlusion_params.enable = config.occlusion;
+
+    // 计时之前把所有资源加载完，保证每次运行画的内容相同
+    async_loader.flush();
+
+    Camera camera;
+    std::vector<double> frame_cpu_ms(total_frames, 0.0);
+    std::vector<double> frame_draw_calls(total_frames, 0.0);
+    std::vector<double> frame_visible(total_frames, 0.0);
+    std::vector<double> frame_shadow_layers(total_frames, 0.0);
+    std::vector<double> frame_occluded(total_frames, 0.0);
+
+    // -----------------------------------------------------
+    // 帧循环
+    // -----------------------------------------------------
+    for (int frame = 0; frame < total_frames; frame++) {
+        auto start = std::chrono::steady_clock::now();
+
+        // 预热帧走同一条路径的开头，统计帧正好走完一圈
+        int path_frame = frame < config.warmup ? frame : frame - config.warmup;
+        place_camera(camera, static_cast<float>(path_frame) / config.frames);
+
+        Profiler::begin_frame();
+        frame_stream.begin_frame();
+        async_loader.update(2.0f);
+
+        target.bind();
+        scene.render(camera, (float)config.width, (float)config.height);
+
+        frame_stream.end_frame();
+        Profiler::end_frame();
+        // 没有交换链：手动提交命令，避免驱动把几帧的命令攒在一起
+        glFlush();
+
+        frame_cpu_ms[frame] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        frame_draw_calls[frame] = scene.get_render_stats().draw_calls;
+        frame_visible[frame] = scene.get_culling_stats().visible;
+        frame_shadow_layers[frame] = scene.get_shadow_stats().static_layers_rendered;
+        frame_occluded[frame] = scene.get_occlusion_stats().occluded;
+    }
+
+    // 读回还在途的 GPU 计时，再读回最后一帧画面
+    Profiler::flush();
+    uint64_t image_hash = hash_pixels(target.read_pixels());
+    Framebuffer::unbind();
+    // 之后不再有任务 (加载器析构时队列已经清空)
+    JobSystem::shutdown();
+
+    // -----------------------------------------------------
+    // 统计 (只统计预热之后的帧)
+    // -----------------------------------------------------
+    std::vector<double> cpu_samples(frame_cpu_ms.begin() + config.warmup, frame_cpu_ms.end());
+    std::vector<double> draw_samples(frame_draw_calls.begin() + config.warmup, frame_draw_calls.end());
+    std::vector<double> visible_samples(frame_visible.begin() + config.warmup, frame_visible.end());
+    std::vector<double> shadow_layer_samples(frame_shadow_layers.begin() + config.warmup, frame_shadow_layers.end());
+    std::vector<double> occluded_samples(frame_occluded.begin() + config.warmup, frame_occluded.end());
+    std::vector<double> gpu_samples;
+    for (int frame = config.warmup; frame < total_frames; frame++) {
+        if (frame_gpu_ms[frame] >= 0.0)
+            gpu_samples.push_back(frame_gpu_ms[frame]);
+    }
+
+    Summary cpu = summarize(cpu_samples);
+    Summary gpu = summarize(gpu_samples);
+    Summary draws = summarize(draw_samples);
+    Summary visible = summarize(visible_samples);
+    Summary shadow_layers = summarize(shadow_layer_samples);
+    Summary occluded = summarize(occluded_samples);
+    double total_draws = 0.0;
+    for (double value : draw_samples)
+        total_draws += value;
+
+    // -----------------------------------------------------
+    // 输出 JSON
+    // -----------------------------------------------------
+    std::ofstream file;
+    if (!config.output.empty()) {
+        file.open(config.output, std::ios::trunc);
+        if (!file) {
+            std::cout << "ERROR::BENCH::CANNOT_WRITE_OUTPUT: " << config.output << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& out = config.output.empty() ? std::cout : file;
+
+    char hash_text[17];
+    std::snprintf(hash_text, sizeof(hash_text), "%016llx", static_cast<unsigned long long>(image_hash));
+
+    out.setf(std::ios::fixed);
+    out.precision(4);
+    out << "{\n";
+    out << "  \"benchmark\": \"shadow-bench\",\n";
+    out << "  \"renderer\": "; write_json_string(out, gl_string(GL_RENDERER)); out << ",\n";
+    out << "  \"gl_version\": "; write_json_string(out, gl_string(GL_VERSION)); out << ",\n";
+    out << "  \"config\": {\"frames\": " << config.frames << ", \"warmup\": " << config.warmup
+        << ", \"width\": " << config.width << ", \"height\": " << config.height
+        << ", \"clustered\": " << (config.clustered ? "true" : "false")
+        << ", \"extra_lights\": " << config.extra_lights
+        << ", \"shadows\": " << (config.shadows ? "true" : "false")
+        << ", \"shadow_cache\": " << (config.shadow_cache ? "true" : "false")
+        << ", \"deferred\": " << (config.deferred ? "true" : "false")
+        << ", \"occlusion\": " << (config.occlusion ? "true" : "false")
+        << ", \"headless\": " << (config.mode == window_mode::HEADLESS ? "true" : "false") << "},\n";
+    write_summary(out, "cpu_frame_ms", cpu); out << ",\n";
+    write_summary(out, "gpu_frame_ms", gpu); out << ",\n";
+    write_summary(out, "draw_calls", draws); out << ",\n";
+    write_summary(out, "visible_objects", visible); out << ",\n";
+    // 每帧重画的静态阴影层数 (缓存命中时为 0)
+    write_summary(out, "shadow_static_layers", shadow_layers); out << ",\n";
+    // 视锥内但被遮挡剔除掉的物体
+    write_summary(out, "occluded_objects", occluded); out << ",\n";
+    out << "  \"total_draw_calls\": " << static_cast<uint64_t>(total_draws) << ",\n";
+    out << "  \"gpu_frames_missing\": " << config.frames - static_cast<int>(gpu.samples) << ",\n";
+    out << "  \"image_hash\": \"" << hash_text << "\"\n";
+    out << "}" << std::endl;
+
+    Profiler::shutdown();
+    return 0;
+}
@@ -0,0 +1,232 @@
+// shadow-transform-bench：变换内核的微基准
+//
+// 同一组随机生成的物体 (两层层级：少量根节点 + 挂在根节点下的子节点)，分别用两种方式算出世界矩阵和世界包围盒：
+// - 逐个物体：Transform::get_model_matrix -> parent_world * local -> AABB::transformed
+// - 批量内核：compose_trs_batch -> multiply_parent_batch -> transform_aabb_batch (标量 / SSE2 / AVX2 各跑一遍)
+// 每种方式重复多次取中位数，输出耗时、相对逐个物体的加速比，并检查结果与逐个物体的版本一致 (允许浮点舍入误差)。
+// 不需要窗口和 GPU。
+//
+// 用法：
+//   shadow-transform-bench [--objects N] [--iterations N]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "core/cpu_features.h"
+#include "scene/bounds.h"
+#include "scene/transform.h"
+#include "scene/transform_kernels.h"
+
+namespace {
+    struct BenchConfig {
+        int objects = 100000;
+        int iterations = 50;        // 每种方式重复的次数 (取中位数)
+    };
+
+    // 测试数据：AoS 的 Transform 给逐个物体的路径用，SoA 的分量给批量内核用
+    struct Objects {
+        std::vector<Transform> transforms;
+        std::vector<float>     channels[10]; // 位置 xyz、四元数 xyzw、缩放 xyz
+        std::vector<uint32_t>  parents;      // 根节点为 UINT32_MAX，父节点总在子节点前面
+        std::vector<AABB>      local_bounds;
+        uint32_t roots = 0;
+
+        TransformSoA soa() const
+        {
+            return {
+                { channels[0].data(), channels[1].data(), channels[2].data() },
+                { channels[3].data(), channels[4].data(), channels[5].data(), channels[6].data() },
+                { channels[7].data(), channels[8].data(), channels[9].data() }
+            };
+        }
+    };
+
+    // 一次完整计算的输出
+    struct Results {
+        std::vector<glm::mat4> local_matrices;
+        std::vector<glm::mat4> world_matrices;
+        std::vector<AABB>      world_bounds;
+    };
+
+    void print_usage()
+    {
+        std::cout << "usage: shadow-transform-bench [--objects N] [--iterations N]" << std::endl;
+    }
+
+    bool parse_args(int argc, char** argv, BenchConfig& config)
+    {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            bool has_value = i + 1 < argc;
+            if (arg == "--objects" && has_value)
+                config.objects = std::atoi(argv[++i]);
+            else if (arg == "--iterations" && has_value)
+                config.iterations = std::atoi(argv[++i]);
+            else {
+                print_usage();
+                return false;
+            }
+        }
+        config.objects = std::max(config.objects, 1);
+        config.iterations = std::max(config.iterations, 1);
+        return true;
+    }
+
+    Objects generate(uint32_t count)
+    {
+        Objects objects;
+        std::mt19937 rng(1234);
+        std::uniform_real_distribution<float> position(-50.0f, 50.0f);
+        std::uniform_real_distribution<float> angle(-180.0f, 180.0f);
+        std::uniform_real_distribution<float> scale(0.5f, 2.0f);
+        std::uniform_real_distribution<float> extent(0.1f, 3.0f);
+
+        // 每 64 个物体一个根节点，其余的子节点均匀挂在根节点下
+        objects.roots = std::max(count / 64, 1u);
+        objects.transforms.resize(count);
+        objects.parents.resize(count);
+        objects.local_bounds.resize(count);
+        for (auto& values : objects.channels)
+            values.resize(count);
+
+        for (uint32_t i = 0; i < count; i++) {
+            Transform& t = objects.transforms[i];
+            t.position = glm::vec3(position(rng), position(rng), position(rng));
+            t.set_euler_degrees(glm::vec3(angle(rng), angle(rng), angle(rng)));
+            t.scale = glm::vec3(scale(rng), scale(rng), scale(rng));
+
+            float values[10] = { t.position.x, t.position.y, t.position.z,
+                                 t.rotation.x, t.rotation.y, t.rotation.z, t.rotation.w,
+                                 t.scale.x, t.scale.y, t.scale.z };
+            for (int c = 0; c < 10; c++)
+                objects.channels[c][i] = values[c];
+
+            objects.parents[i] = i < objects.roots ? UINT32_MAX : i % objects.roots;
+
+            glm::vec3 center(position(rng) * 0.05f, position(rng) * 0.05f, position(rng) * 0.05f);
+            glm::vec3 half(extent(rng), extent(rng), extent(rng));
+            objects.local_bounds[i].min = center - half;
+            objects.local_bounds[i].max = center + half;
+        }
+        return objects;
+    }
+
+    void run_per_object(const Objects& objects, Results& results)
+    {
+        const std::size_t count = objects.transforms.size();
+        for (std::size_t i = 0; i < count; i++) {
+            results.local_matrices[i] = objects.transforms[i].get_model_matrix();
+            uint32_t parent = objects.parents[i];
+            results.world_matrices[i] = parent != UINT32_MAX ? results.world_matrices[parent] * results.local_matrices[i]
+                                                             : results.local_matrices[i];
+            results.world_bounds[i] = objects.local_bounds[i].transformed(results.world_matrices[i]);
+        }
+    }
+
+    // 根节点一批，子节点一批 (子节点之间互不依赖)
+    void run_batched(const Objects& objects, const std::vector<uint32_t>& slots, Results& results)
+    {
+        const std::size_t count = objects.transforms.size();
+        compose_trs_batch(objects.soa(), 0, count, results.local_matrices.data());
+        multiply_parent_batch(slots.data(), objects.parents.data(), objects.roots,
+                              results.local_matrices.data(), results.world_matrices.data());
+        multiply_parent_batch(slots.data() + objects.roots, objects.parents.data() + objects.roots, count - objects.roots,
+                              results.local_matrices.data(), results.world_matrices.data());
+        transform_aabb_batch(objects.local_bounds.data(), results.world_matrices.data(), count, results.world_bounds.data());
+    }
+
+    // 重复 iterations 次，返回耗时的中位数 (毫秒)
+    template<typename Fn>
+    double measure(int iterations, Fn&& fn)
+    {
+        std::vector<double> samples;
+        for (int i = 0; i < iterations; i++) {
+            auto start = std::chrono::steady_clock::now();
+            fn();
+            auto end = std::chrono::steady_clock::now();
+            samples.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+        }
+        std::sort(samples.begin(), samples.end());
+        return samples[samples.size() / 2];
+    }
+
+    // 与参考结果的最大误差 (相对于数值的量级)
+    float max_error(const Results& reference, const Results& results)
+    {
+        auto relative = [](float a, float b) { return std::abs(a - b) / std::max(1.0f, std::abs(a)); };
+
+        float error = 0.0f;
+        for (std::size_t i = 0; i < reference.world_matrices.size(); i++) {
+            for (int c = 0; c < 4; c++)
+                for (int r = 0; r < 4; r++)
+                    error = std::max(error, relative(reference.world_matrices[i][c][r], results.world_matrices[i][c][r]));
+            for (int k = 0; k < 3; k++) {
+                error = std::max(error, relative(reference.world_bounds[i].min[k], results.world_bounds[i].min[k]));
+                error = std::max(error, relative(reference.world_bounds[i].max[k], results.world_bounds[i].max[k]));
+            }
+        }
+        return error;
+    }
+
+    void resize(Results& results, std::size_t count)
+    {
+        results.local_matrices.resize(count);
+        results.world_matrices.resize(count);
+        results.world_bounds.resize(count);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    BenchConfig config;
+    if (!parse_args(argc, argv, config))
+        return 1;
+
+    const uint32_t count = static_cast<uint32_t>(config.objects);
+    Objects objects = generate(count);
+    std::vector<uint32_t> slots(count);
+    for (uint32_t i = 0; i < count; i++)
+        slots[i] = i;
+
+    Results reference;
+    resize(reference, count);
+    double per_object_ms = measure(config.iterations, [&]() { run_per_object(objects, reference); });
+
+    std::printf("objects: %u (%u roots), iterations: %d, cpu: %s\n",
+                count, objects.roots, config.iterations, simd_level_name(detect_simd_level()));
+    std::printf("%-12s %10.3f ms\n", "per-object", per_object_ms);
+
+    // 误差上限：不同版本只是运算顺序 / FMA 带来的舍入差别
+    const float tolerance = 1e-4f;
+    bool all_match = true;
+    const simd_level levels[] = { simd_level::SCALAR, simd_level::SSE, simd_level::AVX2 };
+    for (simd_level level : levels) {
+        if (static_cast<int>(level) > static_cast<int>(detect_simd_level()))
+            continue;
+        set_transform_kernel_level(level);
+
+        Results results;
+        resize(results, count);
+        double batched_ms = measure(config.iterations, [&]() { run_batched(objects, slots, results); });
+        float error = max_error(reference, results);
+        bool match = error <= tolerance;
+        all_match = all_match && match;
+
+        std::string name = std::string("batch ") + simd_level_name(level);
+        std::printf("%-12s %10.3f ms  x%.2f  max error %.2e %s\n",
+                    name.c_str(), batched_ms, per_object_ms / batched_ms, error, match ? "" : "MISMATCH");
+    }
+
+    if (!all_match) {
+        std::cout << "ERROR::TRANSFORM_BENCH::RESULT_MISMATCH" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include "cpu_features.h"
+
+#if SHADOW_SIMD_X86
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace {
+#if SHADOW_SIMD_X86
+    void cpuid(int leaf, int subleaf, unsigned int registers[4])
+    {
+#ifdef _MSC_VER
+        int values[4];
+        __cpuidex(values, leaf, subleaf);
+        for (int i = 0; i < 4; i++)
+            registers[i] = static_cast<unsigned int>(values[i]);
+#else
+        __cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+    }
+
+    // XCR0：操作系统在上下文切换时保存了哪些寄存器
+    unsigned long long read_xcr0()
+    {
+#ifdef _MSC_VER
+        return _xgetbv(0);
+#else
+        unsigned int eax, edx;
+        __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+        return (static_cast<unsigned long long>(edx) << 32) | eax;
+#endif
+    }
+#endif
+
+    simd_level detect()
+    {
+#if SHADOW_SIMD_X86
+        unsigned int registers[4];
+        cpuid(0, 0, registers);
+        unsigned int max_leaf = registers[0];
+
+        cpuid(1, 0, registers);
+        bool sse2    = (registers[3] & (1u << 26)) != 0;
+        bool fma     = (registers[2] & (1u << 12)) != 0;
+        bool osxsave = (registers[2] & (1u << 27)) != 0;
+        bool avx     = (registers[2] & (1u << 28)) != 0;
+        if (!sse2)
+            return simd_level::SCALAR;
+
+        // AVX 寄存器需要操作系统支持：XCR0 的 SSE (bit 1) 和 AVX (bit 2) 状态都要开启
+        bool os_avx = osxsave && avx && (read_xcr0() & 0x6) == 0x6;
+        bool avx2 = false;
+        if (max_leaf >= 7) {
+            cpuid(7, 0, registers);
+            avx2 = (registers[1] & (1u << 5)) != 0;
+        }
+        return os_avx && avx2 && fma ? simd_level::AVX2 : simd_level::SSE;
+#else
+        return simd_level::SCALAR;
+#endif
+    }
+}
+
+simd_level detect_simd_level()
+{
+    static const simd_level level = detect();
+    return level;
+}
+
+const char* simd_level_name(simd_level level)
+{
+    switch (level) {
+        case simd_level::SSE:  return "SSE2";
+        case simd_level::AVX2: return "AVX2";
+        default:               return "Scalar";
+    }
+}
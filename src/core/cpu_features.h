@@ -0,0 +1,20 @@
+#pragma once
+
+// x86 平台才有 SSE/AVX 内核 (ARM 等其他平台只用标量版本)
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SHADOW_SIMD_X86 1
+#else
+#define SHADOW_SIMD_X86 0
+#endif
+
+// SIMD 档位 (从低到高)
+enum class simd_level {
+    SCALAR,
+    SSE,  // SSE2 (x86-64 上总是可用)
+    AVX2  // AVX2 + FMA，并且操作系统会保存 YMM 寄存器
+};
+
+// 运行时检测 CPU 支持的最高档位 (第一次调用时检测，之后直接返回缓存的结果)
+simd_level detect_simd_level();
+
+const char* simd_level_name(simd_level level);
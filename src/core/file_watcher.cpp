@@ -0,0 +1,203 @@
+#include "file_watcher.h"
+
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#else
+#include <unordered_map>
+#endif
+
+namespace {
+    std::string normalize(const std::filesystem::path& path)
+    {
+        std::string normalized = path.lexically_normal().generic_string();
+        while (normalized.size() > 1 && normalized.back() == '/')
+            normalized.pop_back();
+        return normalized;
+    }
+}
+
+FileWatcher::FileWatcher() = default;
+
+FileWatcher::~FileWatcher()
+{
+    stopping = true;
+#ifdef __linux__
+    if (wake_pipe[1] >= 0) {
+        char byte = 0;
+        ssize_t written = write(wake_pipe[1], &byte, 1);
+        (void)written;
+    }
+#else
+    wake.notify_all();
+#endif
+    if (thread.joinable())
+        thread.join();
+
+#ifdef __linux__
+    if (inotify_fd >= 0)
+        close(inotify_fd);
+    for (int fd : wake_pipe) {
+        if (fd >= 0)
+            close(fd);
+    }
+#endif
+}
+
+bool FileWatcher::watch_directory(const std::string& directory)
+{
+    std::error_code error;
+    if (!std::filesystem::is_directory(directory, error)) {
+        std::cout << "ERROR::FILE_WATCHER::NOT_A_DIRECTORY: " << directory << std::endl;
+        return false;
+    }
+    std::string normalized = normalize(directory);
+
+#ifdef __linux__
+    if (inotify_fd < 0) {
+        inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (inotify_fd < 0 || pipe(wake_pipe) != 0) {
+            // 回到完全没有初始化的状态：只有 inotify 没有唤醒管道时，监视线程停不下来
+            std::cout << "ERROR::FILE_WATCHER::INOTIFY_INIT_FAILED" << std::endl;
+            if (inotify_fd >= 0)
+                close(inotify_fd);
+            inotify_fd = -1;
+            wake_pipe[0] = wake_pipe[1] = -1;
+            return false;
+        }
+    }
+
+    int descriptor = inotify_add_watch(inotify_fd, normalized.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (descriptor < 0) {
+        std::cout << "ERROR::FILE_WATCHER::WATCH_FAILED: " << normalized << std::endl;
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        directories.push_back(normalized);
+        watch_descriptors.push_back(descriptor);
+    }
+#else
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        directories.push_back(normalized);
+    }
+#endif
+
+    if (!thread.joinable()) {
+        watching = true;
+        thread = std::thread(&FileWatcher::run, this);
+    }
+    return true;
+}
+
+std::vector<std::string> FileWatcher::poll_changes()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::string> result(changed.begin(), changed.end());
+    changed.clear();
+    return result;
+}
+
+void FileWatcher::record(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    changed.insert(path);
+}
+
+#ifdef __linux__
+void FileWatcher::run()
+{
+    // inotify_event 后面紧跟着变长的文件名，缓冲按结构体对齐
+    alignas(inotify_event) char buffer[4096];
+
+    while (!stopping) {
+        pollfd fds[2] = { { inotify_fd, POLLIN, 0 }, { wake_pipe[0], POLLIN, 0 } };
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR)
+                continue; // 被信号打断
+            // 其他错误重试也不会好，继续循环只会空转：停止监视 (is_watching 变为 false)
+            std::cout << "ERROR::FILE_WATCHER::POLL_FAILED: " << std::strerror(errno) << std::endl;
+            break;
+        }
+        if (fds[1].revents != 0)
+            break;
+        if (fds[0].revents & (POLLERR | POLLNVAL)) {
+            std::cout << "ERROR::FILE_WATCHER::POLL_FAILED: inotify descriptor is no longer valid" << std::endl;
+            break;
+        }
+
+        ssize_t length;
+        while ((length = read(inotify_fd, buffer, sizeof(buffer))) > 0) {
+            for (char* cursor = buffer; cursor < buffer + length; ) {
+                const inotify_event* event = reinterpret_cast<const inotify_event*>(cursor);
+                cursor += sizeof(inotify_event) + event->len;
+                if (event->len == 0 || (event->mask & IN_ISDIR))
+                    continue;
+
+                std::string directory;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    for (std::size_t i = 0; i < watch_descriptors.size(); i++) {
+                        if (watch_descriptors[i] == event->wd) {
+                            directory = directories[i];
+                            break;
+                        }
+                    }
+                }
+                if (!directory.empty())
+                    record(directory + '/' + event->name);
+            }
+        }
+    }
+    watching = false;
+}
+#else
+void FileWatcher::run()
+{
+    // 没有 inotify：定时扫描，比较修改时间
+    std::unordered_map<std::string, std::filesystem::file_time_type> timestamps;
+    std::unordered_set<std::string> scanned; // 扫描过的目录，第一次扫描只记录时间不报告修改
+
+    while (!stopping) {
+        std::vector<std::string> current;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            current = directories;
+        }
+
+        for (const std::string& directory : current) {
+            bool first_scan = scanned.insert(directory).second;
+            std::error_code error;
+            for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+                if (!entry.is_regular_file(error))
+                    continue;
+                std::string path = normalize(entry.path());
+                auto time = entry.last_write_time(error);
+                auto it = timestamps.find(path);
+                if (it == timestamps.end()) {
+                    timestamps.emplace(path, time);
+                    if (!first_scan)
+                        record(path);
+                }
+                else if (it->second != time) {
+                    it->second = time;
+                    record(path);
+                }
+            }
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        wake.wait_for(lock, std::chrono::milliseconds(500), [this] { return stopping.load(); });
+    }
+    watching = false;
+}
+#endif
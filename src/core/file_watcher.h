@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+// FileWatcher：监视若干目录里文件的修改 (不递归子目录)
+//
+// 监视在自己的后台线程里进行，不占用任务系统的工作线程 (它大部分时间都在阻塞等待)：
+// - Linux：inotify，后台线程阻塞在 poll 上，文件写完关闭 (IN_CLOSE_WRITE) 或者被改名覆盖 (IN_MOVED_TO) 时记录下来
+//   (很多编辑器保存时先写临时文件再改名，只监视 IN_MODIFY 会在写到一半时就触发)
+// - 其他平台：每 500ms 比较一次目录里文件的修改时间
+// 修改过的文件放进一个去重的集合，由使用方 (通常是 GL 线程) 每帧取走。
+class FileWatcher
+{
+public:
+    FileWatcher();
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    // 开始监视一个目录，第一次调用时启动后台线程；目录不存在或者监视失败时返回 false
+    bool watch_directory(const std::string& directory);
+
+    // 取出上次调用之后修改过的文件 (目录 + '/' + 文件名，已规范化)，任意线程都可以调用
+    std::vector<std::string> poll_changes();
+
+    bool is_watching() const { return watching.load(); }
+
+private:
+    void run();
+    void record(const std::string& path);
+
+    std::thread thread;
+    std::atomic<bool> watching{ false };
+    std::atomic<bool> stopping{ false };
+
+    std::mutex mutex;
+    std::vector<std::string> directories;
+    std::unordered_set<std::string> changed;
+
+#ifdef __linux__
+    int inotify_fd = -1;
+    int wake_pipe[2] = { -1, -1 };      // 析构时写一个字节，唤醒阻塞在 poll 上的后台线程
+    std::vector<int> watch_descriptors; // 和 directories 一一对应
+#else
+    std::condition_variable wake;
+#endif
+};
@@ -0,0 +1,477 @@
+#include "jobs.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// 一个任务
+// refs: 外部句柄 1 + 未完成 1；两者都释放后删除 (完成和句柄释放可能发生在不同线程，谁最后谁删除)
+struct Job {
+    std::function<void()> function;
+    Job* parent = nullptr;
+    std::atomic<int> unfinished{ 1 };    // 函数本身 1 + 未完成的子任务
+    std::atomic<int> dependencies{ 1 };  // 未完成的前置任务 + 1 (submit 之前一直持有)
+    std::atomic<int> refs{ 2 };
+    std::vector<Job*> successors;        // 完成后要通知的后继任务 (只在提交之前修改)
+    bool background = false;
+};
+
+namespace {
+    // Chase-Lev work-stealing 双端队列 (固定容量)
+    // 所有者在底部 push/pop，其他线程在顶部 steal；内存序按 Lê 等人 "Correct and Efficient
+    // Work-Stealing for Weak Memory Models" (PPoPP 2013) 的 C11 版本
+    class WorkQueue
+    {
+    public:
+        static const int64_t MASK = JobSystem::QUEUE_CAPACITY - 1;
+        static_assert((JobSystem::QUEUE_CAPACITY & MASK) == 0, "QUEUE_CAPACITY must be a power of two");
+
+        // 只能由所有者调用，满了返回 false
+        bool push(Job* job)
+        {
+            int64_t b = bottom.load(std::memory_order_relaxed);
+            int64_t t = top.load(std::memory_order_acquire);
+            if (b - t >= static_cast<int64_t>(JobSystem::QUEUE_CAPACITY))
+                return false;
+
+            slots[b & MASK].store(job, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            bottom.store(b + 1, std::memory_order_release);
+            return true;
+        }
+
+        // 只能由所有者调用
+        Job* pop()
+        {
+            int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+            bottom.store(b, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t t = top.load(std::memory_order_relaxed);
+
+            if (t > b) {
+                // 空
+                bottom.store(b + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+
+            Job* job = slots[b & MASK].load(std::memory_order_relaxed);
+            if (t == b) {
+                // 最后一个：和偷取的线程竞争
+                if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                    job = nullptr;
+                bottom.store(b + 1, std::memory_order_relaxed);
+            }
+            return job;
+        }
+
+        // 任何线程都可以调用，没偷到 (空或者竞争失败) 返回空
+        Job* steal()
+        {
+            int64_t t = top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t b = bottom.load(std::memory_order_acquire);
+            if (t >= b)
+                return nullptr;
+
+            Job* job = slots[t & MASK].load(std::memory_order_relaxed);
+            if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                return nullptr;
+            return job;
+        }
+
+    private:
+        alignas(64) std::atomic<int64_t> top{ 0 };
+        alignas(64) std::atomic<int64_t> bottom{ 0 };
+        std::atomic<Job*> slots[JobSystem::QUEUE_CAPACITY] = {};
+    };
+
+    // 每个线程自己的计数 (避免共享缓存行)
+    struct alignas(64) ThreadCounters {
+        std::atomic<uint64_t> executed{ 0 };
+        std::atomic<uint64_t> stolen{ 0 };
+        std::atomic<uint64_t> inline_runs{ 0 };
+        std::atomic<uint64_t> background{ 0 };
+    };
+
+    struct JobSystemState {
+        bool initialized = false;
+        std::vector<std::thread> threads;
+        std::vector<std::unique_ptr<WorkQueue>> queues;         // [0] 主线程, [1..N] 工作线程
+        std::vector<std::unique_ptr<ThreadCounters>> counters;  // 同上，最后一个给池外的线程
+
+        // 后台任务
+        std::mutex background_mutex;
+        std::deque<Job*> background;
+
+        // 睡眠与唤醒：每次提交都递增 work_epoch，工作线程只在 epoch 没有变化时睡眠
+        std::mutex sleep_mutex;
+        std::condition_variable wake;
+        std::atomic<uint64_t> work_epoch{ 0 };
+        std::atomic<unsigned int> sleeping{ 0 };
+        std::atomic<bool> quit{ false };
+    };
+
+    JobSystemState state;
+    ThreadCounters external_counters; // 没有 init 时使用
+    thread_local int thread_index = -1;
+    thread_local uint32_t steal_seed = 0;
+
+    ThreadCounters& counters_for_thread()
+    {
+        if (!state.initialized)
+            return external_counters;
+        if (thread_index < 0)
+            return *state.counters.back();
+        return *state.counters[thread_index];
+    }
+
+    void release_job(Job* job)
+    {
+        if (job->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            delete job;
+    }
+
+    void execute(Job* job);
+
+    void wake_worker()
+    {
+        state.work_epoch.fetch_add(1);
+        if (state.sleeping.load() > 0) {
+            // 先拿一下锁：保证正在进入睡眠的线程要么看到新的 epoch，要么收到通知
+            { std::lock_guard<std::mutex> lock(state.sleep_mutex); }
+            state.wake.notify_one();
+        }
+    }
+
+    // 放进当前线程的队列；不在池内或者队列满了就直接执行
+    void enqueue(Job* job)
+    {
+        if (!state.initialized || thread_index < 0 || !state.queues[thread_index]->push(job)) {
+            counters_for_thread().inline_runs.fetch_add(1, std::memory_order_relaxed);
+            execute(job);
+            return;
+        }
+        wake_worker();
+    }
+
+    // 函数和所有子任务都执行完：通知后继任务和父任务
+    void finish(Job* job)
+    {
+        if (job->unfinished.fetch_sub(1, std::memory_order_acq_rel) != 1)
+            return;
+
+        for (Job* successor : job->successors) {
+            if (successor->dependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                enqueue(successor);
+        }
+
+        Job* parent = job->parent;
+        release_job(job);
+        if (parent)
+            finish(parent);
+    }
+
+    void execute(Job* job)
+    {
+        if (job->function)
+            job->function();
+
+        ThreadCounters& counters = counters_for_thread();
+        counters.executed.fetch_add(1, std::memory_order_relaxed);
+        if (job->background)
+            counters.background.fetch_add(1, std::memory_order_relaxed);
+
+        finish(job);
+    }
+
+    // 找一个可以执行的任务：自己的队列 -> 偷别人的 -> (允许时) 后台队列
+    Job* find_work(int index, bool allow_background)
+    {
+        if (Job* job = state.queues[index]->pop())
+            return job;
+
+        // 从随机位置开始轮询，避免所有线程都去偷同一个队列
+        unsigned int count = static_cast<unsigned int>(state.queues.size());
+        steal_seed = steal_seed * 1664525u + 1013904223u;
+        unsigned int start = (steal_seed >> 16) % count;
+        for (unsigned int i = 0; i < count; i++) {
+            unsigned int victim = (start + i) % count;
+            if (victim == static_cast<unsigned int>(index))
+                continue;
+            if (Job* job = state.queues[victim]->steal()) {
+                state.counters[index]->stolen.fetch_add(1, std::memory_order_relaxed);
+                return job;
+            }
+        }
+
+        if (allow_background) {
+            std::lock_guard<std::mutex> lock(state.background_mutex);
+            if (!state.background.empty()) {
+                Job* job = state.background.front();
+                state.background.pop_front();
+                return job;
+            }
+        }
+        return nullptr;
+    }
+
+    void worker_loop(int index)
+    {
+        thread_index = index;
+        steal_seed = static_cast<uint32_t>(index) * 2654435761u;
+
+        for (;;) {
+            uint64_t seen = state.work_epoch.load();
+            if (Job* job = find_work(index, true)) {
+                execute(job);
+                continue;
+            }
+
+            // 没有任务了才检查退出，保证已经提交的任务都能执行完
+            if (state.quit.load())
+                return;
+
+            std::unique_lock<std::mutex> lock(state.sleep_mutex);
+            state.sleeping.fetch_add(1);
+            state.wake.wait(lock, [&]() { return state.quit.load() || state.work_epoch.load() != seen; });
+            state.sleeping.fetch_sub(1);
+        }
+    }
+}
+
+void JobSystem::init(unsigned int worker_count)
+{
+    if (state.initialized)
+        return;
+
+    // 主线程也会执行任务，所以默认少开一个
+    if (worker_count == 0) {
+        unsigned int hardware = std::thread::hardware_concurrency();
+        worker_count = hardware > 1 ? hardware - 1 : 1;
+    }
+
+    state.quit = false;
+    for (unsigned int i = 0; i <= worker_count; i++) {
+        state.queues.push_back(std::make_unique<WorkQueue>());
+        state.counters.push_back(std::make_unique<ThreadCounters>());
+    }
+    state.counters.push_back(std::make_unique<ThreadCounters>()); // 池外的线程
+    state.initialized = true;
+
+    thread_index = 0;
+    steal_seed = 1;
+    for (unsigned int i = 1; i <= worker_count; i++)
+        state.threads.emplace_back(worker_loop, static_cast<int>(i));
+}
+
+void JobSystem::shutdown()
+{
+    if (!state.initialized)
+        return;
+
+    // 主线程队列里剩下的任务先在这里执行完 (工作线程退出前会把后台队列清空)
+    while (Job* job = state.queues[0]->pop())
+        execute(job);
+
+    {
+        std::lock_guard<std::mutex> lock(state.sleep_mutex);
+        state.quit = true;
+    }
+    state.wake.notify_all();
+    for (std::thread& thread : state.threads)
+        thread.join();
+
+    state.threads.clear();
+    state.queues.clear();
+    state.counters.clear();
+    state.initialized = false;
+    thread_index = -1;
+}
+
+bool JobSystem::is_initialized()
+{
+    return state.initialized;
+}
+
+unsigned int JobSystem::get_worker_count()
+{
+    return static_cast<unsigned int>(state.threads.size());
+}
+
+int JobSystem::get_thread_index()
+{
+    return thread_index;
+}
+
+Job* JobSystem::create(std::function<void()> function, Job* parent)
+{
+    Job* job = new Job();
+    job->function = std::move(function);
+    job->parent = parent;
+    // 父任务此时还没有完成 (通常就是正在执行的任务)，子任务完成之前它也不会完成
+    if (parent)
+        parent->unfinished.fetch_add(1, std::memory_order_relaxed);
+    return job;
+}
+
+void JobSystem::submit(Job* job)
+{
+    if (job->dependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        enqueue(job);
+}
+
+void JobSystem::wait(Job* job)
+{
+    while (job->unfinished.load(std::memory_order_acquire) != 0) {
+        // 等待期间帮忙执行每帧的任务 (不接后台任务)
+        if (state.initialized && thread_index >= 0) {
+            if (Job* other = find_work(thread_index, false)) {
+                execute(other);
+                continue;
+            }
+        }
+        std::this_thread::yield();
+    }
+    release_job(job);
+}
+
+void JobSystem::release(Job* job)
+{
+    release_job(job);
+}
+
+bool JobSystem::is_finished(const Job* job)
+{
+    return job->unfinished.load(std::memory_order_acquire) == 0;
+}
+
+Job* JobSystem::run(std::function<void()> function, Job* parent)
+{
+    Job* job = create(std::move(function), parent);
+    submit(job);
+    return job;
+}
+
+void JobSystem::parallel_for(unsigned int count, unsigned int batch_size,
+                             const std::function<void(unsigned int, unsigned int)>& function)
+{
+    if (count == 0)
+        return;
+    batch_size = std::max(batch_size, 1u);
+
+    // 只有一段，或者没有别的线程可以分担：直接执行
+    if (count <= batch_size || !state.initialized || thread_index < 0) {
+        function(0, count);
+        return;
+    }
+
+    // 所有段都是一个空的根任务的子任务，等根任务完成就是等全部完成
+    Job* root = create(nullptr);
+    for (unsigned int begin = 0; begin < count; begin += batch_size) {
+        unsigned int end = std::min(begin + batch_size, count);
+        Job* batch = create([&function, begin, end]() { function(begin, end); }, root);
+        submit(batch);
+        release(batch);
+    }
+    submit(root);
+    wait(root);
+}
+
+void JobSystem::dispatch_background(std::function<void()> function)
+{
+    if (!state.initialized || state.threads.empty()) {
+        counters_for_thread().inline_runs.fetch_add(1, std::memory_order_relaxed);
+        function();
+        return;
+    }
+
+    // 没有外部句柄，执行完自动删除
+    Job* job = create(std::move(function));
+    job->background = true;
+    job->dependencies = 0;
+    job->refs = 1;
+    {
+        std::lock_guard<std::mutex> lock(state.background_mutex);
+        state.background.push_back(job);
+    }
+    wake_worker();
+}
+
+void JobSystem::add_dependency(Job* job, Job* before)
+{
+    job->dependencies.fetch_add(1, std::memory_order_relaxed);
+    before->successors.push_back(job);
+}
+
+JobStats JobSystem::get_stats()
+{
+    JobStats stats;
+    stats.workers = get_worker_count();
+
+    auto accumulate = [&stats](const ThreadCounters& counters) {
+        stats.executed += counters.executed.load(std::memory_order_relaxed);
+        stats.stolen += counters.stolen.load(std::memory_order_relaxed);
+        stats.inline_runs += counters.inline_runs.load(std::memory_order_relaxed);
+        stats.background_executed += counters.background.load(std::memory_order_relaxed);
+    };
+    accumulate(external_counters);
+    for (const std::unique_ptr<ThreadCounters>& counters : state.counters)
+        accumulate(*counters);
+
+    if (state.initialized) {
+        std::lock_guard<std::mutex> lock(state.background_mutex);
+        stats.background_pending = static_cast<unsigned int>(state.background.size());
+    }
+    return stats;
+}
+
+// ---------------------------------------------------------
+// JobGraph
+// ---------------------------------------------------------
+
+JobGraph::Node JobGraph::add(std::function<void()> function)
+{
+    nodes.push_back({ std::move(function), {} });
+    return static_cast<Node>(nodes.size() - 1);
+}
+
+void JobGraph::depend(Node node, Node before)
+{
+    // 忽略这条边会让两个任务同时执行 (数据竞争)，比直接停下来更难查：按编程错误处理
+    if (before >= node || node >= nodes.size()) {
+        std::cout << "ERROR::JOBS::INVALID_DEPENDENCY: node " << node << " after node " << before
+                  << " (the earlier node must be added first, " << nodes.size() << " nodes)" << std::endl;
+        std::abort();
+    }
+    nodes[node].after.push_back(before);
+}
+
+void JobGraph::run()
+{
+    if (nodes.empty())
+        return;
+
+    // 先把所有任务和依赖都建好再提交，前置任务不会在连线之前完成
+    jobs.clear();
+    // 任务里只存节点函数的指针，不拷贝 std::function
+    for (const NodeInfo& node : nodes) {
+        const std::function<void()>* function = &node.function;
+        jobs.push_back(JobSystem::create([function]() { (*function)(); }));
+    }
+    for (std::size_t i = 0; i < nodes.size(); i++) {
+        for (Node before : nodes[i].after)
+            JobSystem::add_dependency(jobs[i], jobs[before]);
+    }
+
+    for (Job* job : jobs)
+        JobSystem::submit(job);
+    for (Job* job : jobs)
+        JobSystem::wait(job);
+    jobs.clear();
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+struct Job;
+
+// 任务系统统计 (累计值)
+struct JobStats {
+    unsigned int workers = 0;           // 工作线程数 (不含主线程)
+    uint64_t executed = 0;              // 执行过的任务数
+    uint64_t stolen = 0;                // 其中从别的线程队列里偷来的
+    uint64_t inline_runs = 0;           // 队列满或不在池内的线程提交时直接执行的任务
+    uint64_t background_executed = 0;   // 执行过的后台任务
+    unsigned int background_pending = 0;// 排队中的后台任务
+};
+
+// JobSystem：work-stealing 线程池
+//
+// 每个线程 (主线程 + 工作线程) 有一个无锁的 Chase-Lev 双端队列：
+// 自己从底部压入/弹出 (后进先出，缓存友好)，空闲的线程从别人的顶部偷任务 (先进先出，偷到的通常是大块工作)。
+// 工作线程找不到任务时睡眠，有新任务提交时被唤醒。
+//
+// 任务之间有两种关系：
+//   父子：创建时指定 parent，父任务要等函数本身和所有子任务都执行完才算完成
+//   依赖：见 JobGraph，前置任务完成 (包括它的子任务) 之后后继任务才进入队列
+//
+// wait() 不会阻塞线程：等待期间当前线程帮忙执行队列里的其他任务，所以任务里也可以再等待子任务。
+//
+// 后台任务 (资源解码、模型导入等一次可能几百毫秒的工作) 放在单独的队列里，只有空闲的工作线程会接手；
+// 主线程等待每帧任务时不会去执行它们，避免一帧被一个长任务卡住。
+//
+// 没有调用 init (或者从池外的线程提交) 时任务直接在调用线程上顺序执行，结果相同。
+class JobSystem
+{
+public:
+    // 每个线程队列的容量，满了之后新任务直接在提交线程上执行
+    static const unsigned int QUEUE_CAPACITY = 4096;
+
+    // 调用 init 的线程成为 0 号线程 (主线程)
+    // worker_count 为 0 时按 CPU 核心数自动选择 (至少 1 个，保证后台任务有人执行)
+    static void init(unsigned int worker_count = 0);
+    // 等待所有已提交的任务 (包括后台任务) 执行完，然后结束工作线程
+    static void shutdown();
+
+    static bool is_initialized();
+    static unsigned int get_worker_count();
+    // 当前线程的编号：0 是主线程，1..N 是工作线程，池外的线程为 -1
+    static int get_thread_index();
+
+    // 创建任务 (还没有提交)，返回的句柄必须交给 wait() 或 release()
+    static Job* create(std::function<void()> function, Job* parent = nullptr);
+    // 提交任务：没有未完成的前置任务时立刻进入当前线程的队列
+    static void submit(Job* job);
+    // 等待任务完成 (期间帮忙执行其他任务)，然后释放句柄
+    static void wait(Job* job);
+    // 不再关心结果时释放句柄 (任务照常执行)
+    static void release(Job* job);
+    // 任务是否已经完成 (包括子任务)
+    static bool is_finished(const Job* job);
+
+    // 创建 + 提交
+    static Job* run(std::function<void()> function, Job* parent = nullptr);
+
+    // 把 [0, count) 按 batch_size 切成若干段并行执行 function(begin, end)，全部完成后返回
+    // 调用线程也参与执行
+    static void parallel_for(unsigned int count, unsigned int batch_size,
+                             const std::function<void(unsigned int, unsigned int)>& function);
+
+    // 提交一个后台任务 (不需要等待)
+    static void dispatch_background(std::function<void()> function);
+
+    static JobStats get_stats();
+
+private:
+    friend class JobGraph;
+
+    // 让 job 在 before 完成之后才执行 (两个都必须还没有提交)
+    static void add_dependency(Job* job, Job* before);
+};
+
+// JobGraph：一组有依赖关系的任务 (每帧的阶段划分)
+//
+// 图只描述结构，可以构建一次、每帧执行；节点函数通过捕获的对象读取每帧的输入。
+// 节点里可以再用 parallel_for 或者子任务继续拆分。
+class JobGraph
+{
+public:
+    using Node = unsigned int;
+
+    // 添加一个节点
+    Node add(std::function<void()> function);
+    // node 在 before 完成之后才执行 (before 必须是先添加的节点，所以图里不会有环；否则打印错误并终止)
+    void depend(Node node, Node before);
+
+    // 提交所有节点并等待全部完成 (调用线程参与执行)
+    void run();
+
+    void clear() { nodes.clear(); }
+    std::size_t size() const { return nodes.size(); }
+
+private:
+    struct NodeInfo {
+        std::function<void()> function;
+        std::vector<Node> after; // 前置节点
+    };
+
+    std::vector<NodeInfo> nodes;
+    std::vector<Job*> jobs; // run 期间的任务句柄 (复用内存)
+};
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// 只读的内存映射文件
+// 文件内容直接映射到进程地址空间，由操作系统按页调入，不需要先 read 到缓冲区里
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    // 禁止拷贝，允许移动 (映射只能释放一次)
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    // 打开并映射整个文件，失败 (不存在/空文件/映射失败) 返回 false
+    bool open(const std::string& path);
+
+    // 解除映射并关闭文件
+    void close();
+
+    bool is_open() const { return data != nullptr; }
+    const uint8_t* get_data() const { return data; }
+    std::size_t get_size() const { return size; }
+
+private:
+    const uint8_t* data = nullptr;
+    std::size_t size = 0;
+
+#ifdef _WIN32
+    void* file_handle = nullptr;
+    void* mapping_handle = nullptr;
+#else
+    int file_descriptor = -1;
+#endif
+};
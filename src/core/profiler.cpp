@@ -0,0 +1,319 @@
+#include "profiler.h"
+
+#include <glad/glad.h>
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+namespace {
+    using clock_type = std::chrono::steady_clock;
+
+    // 一个在途的帧：CPU 部分已经完成，GPU 时间戳还没读回
+    struct PendingFrame {
+        ProfileFrame frame;
+        std::vector<int> node_queries;   // 节点 -> 开始时间戳在 queries 中的下标 (结束是下一个)，-1 为没有 GPU 计时
+        std::vector<GLuint> queries;     // 查询对象池 (跨帧复用，不够时扩充)
+        unsigned int used_queries = 0;
+        bool pending = false;
+    };
+
+    struct ProfilerState {
+        bool initialized = false;
+        std::thread::id main_thread;     // 只记录这个线程上的区间
+        clock_type::time_point origin;
+        clock_type::time_point frame_start;
+        uint64_t frame_index = 0;
+
+        PendingFrame frames[Profiler::QUERY_FRAMES];
+        PendingFrame* current = nullptr;
+        std::vector<int> stack;          // 当前打开的区间 (节点下标)
+
+        ProfileFrame last_frame;
+        float cpu_history[Profiler::HISTORY_SIZE] = {};
+        float gpu_history[Profiler::HISTORY_SIZE] = {};
+        unsigned int history_offset = 0;
+        uint64_t dropped_frames = 0;
+
+        std::deque<ProfileFrame> trace;
+        std::function<void(const ProfileFrame&)> frame_callback;
+    };
+
+    ProfilerState state;
+
+    double elapsed_ms(clock_type::time_point from, clock_type::time_point to)
+    {
+        return std::chrono::duration<double, std::milli>(to - from).count();
+    }
+
+    // 取一个空闲的查询对象，返回它在池中的下标
+    unsigned int acquire_query(PendingFrame& pending)
+    {
+        if (pending.used_queries == pending.queries.size()) {
+            std::size_t old_size = pending.queries.size();
+            pending.queries.resize(old_size > 0 ? old_size * 2 : 32);
+            glGenQueries(static_cast<GLsizei>(pending.queries.size() - old_size), pending.queries.data() + old_size);
+        }
+        return pending.used_queries++;
+    }
+
+    // 读回一帧的 GPU 时间戳，wait 为 false 时结果还没有准备好就返回 false (不等待)
+    bool resolve(PendingFrame& pending, bool wait)
+    {
+        ProfileFrame& frame = pending.frame;
+        if (!wait && !pending.node_queries.empty() && pending.node_queries[0] >= 0) {
+            // 查询按提交顺序完成：最后提交的是根节点 (整帧) 的结束时间戳，它有结果了其余的也都有了
+            GLint available = 0;
+            glGetQueryObjectiv(pending.queries[pending.node_queries[0] + 1], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available)
+                return false;
+        }
+
+        // 根节点 (整帧) 总是第一个带 GPU 计时的节点，其余节点的起点相对它
+        GLuint64 frame_begin = 0;
+        bool has_begin = false;
+        for (std::size_t i = 0; i < frame.nodes.size(); i++) {
+            int query = pending.node_queries[i];
+            if (query < 0)
+                continue;
+
+            GLuint64 begin = 0, end = 0;
+            glGetQueryObjectui64v(pending.queries[query], GL_QUERY_RESULT, &begin);
+            glGetQueryObjectui64v(pending.queries[query + 1], GL_QUERY_RESULT, &end);
+            if (!has_begin) {
+                frame_begin = begin;
+                has_begin = true;
+            }
+
+            ProfileNode& node = frame.nodes[i];
+            node.gpu_start_ms = (begin - frame_begin) / 1.0e6;
+            node.gpu_ms = (end - begin) / 1.0e6;
+        }
+        if (!frame.nodes.empty())
+            frame.gpu_ms = frame.nodes[0].gpu_ms;
+        return true;
+    }
+
+    void publish(const ProfileFrame& frame)
+    {
+        state.last_frame = frame;
+        state.cpu_history[state.history_offset] = static_cast<float>(frame.cpu_ms);
+        state.gpu_history[state.history_offset] = static_cast<float>(frame.gpu_ms > 0.0 ? frame.gpu_ms : 0.0);
+        state.history_offset = (state.history_offset + 1) % Profiler::HISTORY_SIZE;
+
+        state.trace.push_back(frame);
+        if (state.trace.size() > Profiler::TRACE_FRAMES)
+            state.trace.pop_front();
+
+        if (state.frame_callback)
+            state.frame_callback(frame);
+    }
+
+    // 写一个 JSON 字符串 (区间名都是代码里的字面量，只需要处理引号和反斜杠)
+    void write_json_string(std::ofstream& out, const char* text)
+    {
+        out << '"';
+        for (const char* c = text; *c; c++) {
+            if (*c == '"' || *c == '\\')
+                out << '\\';
+            out << *c;
+        }
+        out << '"';
+    }
+}
+
+bool Profiler::enabled = true;
+bool Profiler::enabled_next = true;
+
+void Profiler::init()
+{
+    state = ProfilerState();
+    state.origin = clock_type::now();
+    state.main_thread = std::this_thread::get_id();
+    state.initialized = true;
+}
+
+void Profiler::shutdown()
+{
+    for (PendingFrame& pending : state.frames) {
+        if (!pending.queries.empty())
+            glDeleteQueries(static_cast<GLsizei>(pending.queries.size()), pending.queries.data());
+        pending.queries.clear();
+    }
+    state.initialized = false;
+}
+
+void Profiler::begin_frame()
+{
+    // 开关只在帧边界生效，保证区间成对
+    enabled = enabled_next && state.initialized;
+    if (!enabled)
+        return;
+
+    // -> 轮到的这一格是 QUERY_FRAMES 帧之前的，先尝试读回它的结果
+    PendingFrame& pending = state.frames[state.frame_index % QUERY_FRAMES];
+    if (pending.pending) {
+        if (resolve(pending, false))
+            publish(pending.frame);
+        else
+            state.dropped_frames++;
+        pending.pending = false;
+    }
+
+    // -> 开始新的一帧
+    pending.frame.index = state.frame_index++;
+    pending.frame.nodes.clear();
+    pending.frame.gpu_ms = -1.0;
+    pending.node_queries.clear();
+    pending.used_queries = 0;
+    state.current = &pending;
+    state.stack.clear();
+
+    state.frame_start = clock_type::now();
+    pending.frame.start_us = elapsed_ms(state.origin, state.frame_start) * 1000.0;
+    begin_scope("Frame", true);
+}
+
+void Profiler::end_frame()
+{
+    if (!enabled || !state.current)
+        return;
+
+    // 没有关闭的区间一起结束 (正常情况下只剩根节点)
+    while (!state.stack.empty())
+        end_scope();
+
+    PendingFrame& pending = *state.current;
+    pending.frame.cpu_ms = pending.frame.nodes[0].cpu_ms;
+    pending.pending = true;
+    state.current = nullptr;
+}
+
+void Profiler::flush()
+{
+    // 按帧的先后顺序读回 (下一个要复用的格子是最旧的)
+    for (unsigned int i = 0; i < QUERY_FRAMES; i++) {
+        PendingFrame& pending = state.frames[(state.frame_index + i) % QUERY_FRAMES];
+        if (!pending.pending)
+            continue;
+        resolve(pending, true);
+        publish(pending.frame);
+        pending.pending = false;
+    }
+}
+
+void Profiler::begin_scope(const char* name, bool gpu)
+{
+    // 任务系统的工作线程上执行的区间直接忽略 (计时树和 GL 查询都只属于主线程)
+    // 先比较线程：enabled 和 current 由主线程每帧修改，工作线程不能读
+    // (main_thread 在 init 里写入，init 在任务系统启动之前调用，之后不再修改)
+    if (std::this_thread::get_id() != state.main_thread || !enabled || !state.current)
+        return;
+
+    PendingFrame& pending = *state.current;
+    ProfileNode node;
+    node.name = name;
+    node.parent = state.stack.empty() ? -1 : state.stack.back();
+    node.depth = static_cast<unsigned int>(state.stack.size());
+    node.cpu_start_ms = elapsed_ms(state.frame_start, clock_type::now());
+
+    int query = -1;
+    if (gpu) {
+        query = static_cast<int>(acquire_query(pending));
+        acquire_query(pending); // 结束时间戳紧跟在后面
+        glQueryCounter(pending.queries[query], GL_TIMESTAMP);
+    }
+
+    state.stack.push_back(static_cast<int>(pending.frame.nodes.size()));
+    pending.frame.nodes.push_back(node);
+    pending.node_queries.push_back(query);
+}
+
+void Profiler::end_scope()
+{
+    if (std::this_thread::get_id() != state.main_thread || !enabled || !state.current || state.stack.empty())
+        return;
+
+    PendingFrame& pending = *state.current;
+    int index = state.stack.back();
+    state.stack.pop_back();
+
+    ProfileNode& node = pending.frame.nodes[index];
+    node.cpu_ms = elapsed_ms(state.frame_start, clock_type::now()) - node.cpu_start_ms;
+
+    int query = pending.node_queries[index];
+    if (query >= 0)
+        glQueryCounter(pending.queries[query + 1], GL_TIMESTAMP);
+}
+
+void Profiler::set_frame_callback(std::function<void(const ProfileFrame&)> callback)
+{
+    state.frame_callback = std::move(callback);
+}
+
+const ProfileFrame& Profiler::get_last_frame()
+{
+    return state.last_frame;
+}
+
+const float* Profiler::get_cpu_history()
+{
+    return state.cpu_history;
+}
+
+const float* Profiler::get_gpu_history()
+{
+    return state.gpu_history;
+}
+
+unsigned int Profiler::get_history_offset()
+{
+    return state.history_offset;
+}
+
+uint64_t Profiler::get_dropped_frames()
+{
+    return state.dropped_frames;
+}
+
+bool Profiler::save_chrome_trace(const std::string& path)
+{
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) {
+        std::cout << "ERROR::PROFILER::CANNOT_WRITE_TRACE: " << path << std::endl;
+        return false;
+    }
+
+    // 完整事件 ("ph":"X")，时间单位是微秒
+    // CPU 在线程 1，GPU 在线程 2；GPU 时钟和 CPU 时钟不同，GPU 区间以本帧开始时间为起点对齐
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}},\n";
+    out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}";
+
+    out.setf(std::ios::fixed);
+    out.precision(3);
+    for (const ProfileFrame& frame : state.trace) {
+        for (const ProfileNode& node : frame.nodes) {
+            out << ",\n{\"name\":";
+            write_json_string(out, node.name);
+            out << ",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":" << frame.start_us + node.cpu_start_ms * 1000.0
+                << ",\"dur\":" << node.cpu_ms * 1000.0 << ",\"args\":{\"frame\":" << frame.index << "}}";
+
+            if (node.gpu_ms >= 0.0) {
+                out << ",\n{\"name\":";
+                write_json_string(out, node.name);
+                out << ",\"cat\":\"gpu\",\"ph\":\"X\",\"pid\":1,\"tid\":2,\"ts\":" << frame.start_us + node.gpu_start_ms * 1000.0
+                    << ",\"dur\":" << node.gpu_ms * 1000.0 << ",\"args\":{\"frame\":" << frame.index << "}}";
+            }
+        }
+    }
+    out << "\n]}\n";
+
+    if (!out) {
+        std::cout << "ERROR::PROFILER::TRACE_WRITE_FAILED: " << path << std::endl;
+        return false;
+    }
+    std::cout << "PROFILER::TRACE_SAVED: " << path << " (" << state.trace.size() << " frames)" << std::endl;
+    return true;
+}
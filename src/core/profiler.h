@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// 一个计时区间 (一帧内按先序排列，父节点总是在子节点之前)
+struct ProfileNode {
+    const char* name = "";     // 必须是字符串字面量 (只保存指针)
+    int parent = -1;           // 父节点下标，-1 表示根 (整帧)
+    unsigned int depth = 0;
+    double cpu_start_ms = 0.0; // 相对帧开始
+    double cpu_ms = 0.0;
+    double gpu_start_ms = -1.0; // 相对本帧第一个 GPU 时间戳，没有 GPU 计时为 -1
+    double gpu_ms = -1.0;
+};
+
+// 一帧的计时结果
+struct ProfileFrame {
+    uint64_t index = 0;
+    double start_us = 0.0;     // 帧开始时间 (相对 Profiler::init，Chrome trace 用)
+    double cpu_ms = 0.0;
+    double gpu_ms = -1.0;
+    std::vector<ProfileNode> nodes;
+};
+
+// Profiler：CPU/GPU 帧分析器
+//
+// CPU 区间用 steady_clock 计时；GPU 区间在开始和结束各插入一个 glQueryCounter(GL_TIMESTAMP)。
+// (GL_TIME_ELAPSED 查询同一时间只能有一个处于活动状态，不能嵌套，所以用时间戳对代替，结果相同)
+// 查询结果要等 GPU 执行完才能读，这里按 QUERY_FRAMES 帧轮换查询对象，
+// 读取的是几帧之前的结果，并且先检查 GL_QUERY_RESULT_AVAILABLE，所以从不阻塞 CPU
+// (还没有结果的帧直接丢弃，计入 dropped_frames)。
+//
+// 只在 GL 线程 (主线程) 上使用；其他线程上的区间 (比如任务系统里执行的代码) 会被忽略。
+class Profiler
+{
+public:
+    static const unsigned int QUERY_FRAMES = 3;   // 同时在途的帧数
+    static const unsigned int HISTORY_SIZE = 240; // 帧时间曲线的长度
+    static const unsigned int TRACE_FRAMES = 600; // 导出 Chrome trace 时保留的帧数
+
+    // 需要 GL 上下文 (创建查询对象)；在主线程上、启动任务系统之前调用
+    static void init();
+    static void shutdown();
+
+    // 每帧开始/结束时调用一次，整帧是计时树的根
+    static void begin_frame();
+    static void end_frame();
+
+    // 等待并读回所有在途帧的结果 (会阻塞，只在退出或基准测试结束时用)
+    static void flush();
+
+    // 手动开始/结束一个区间 (一般用 PROFILE_SCOPE)
+    // gpu 为 true 时同时记录 GPU 时间 (只对发出 GL 命令的区间有意义)
+    static void begin_scope(const char* name, bool gpu = true);
+    static void end_scope();
+
+    static void set_enabled(bool value) { enabled_next = value; }
+    static bool is_enabled() { return enabled; }
+
+    // 最近一个拿到 GPU 结果的帧
+    static const ProfileFrame& get_last_frame();
+
+    // 帧时间曲线 (环形，get_history_offset 是最旧的一个样本)，GPU 没有结果时为 0
+    static const float* get_cpu_history();
+    static const float* get_gpu_history();
+    static unsigned int get_history_offset();
+    static uint64_t get_dropped_frames();
+
+    // 每个拿到 GPU 结果的帧都会回调一次 (基准测试用它收集逐帧数据)
+    static void set_frame_callback(std::function<void(const ProfileFrame&)> callback);
+
+    // 把保留的帧导出为 Chrome trace_event JSON (chrome://tracing 或 Perfetto 打开)
+    static bool save_chrome_trace(const std::string& path);
+
+private:
+    static bool enabled;
+    static bool enabled_next;
+};
+
+// RAII 区间：构造时开始，析构时结束
+class ProfileScope
+{
+public:
+    explicit ProfileScope(const char* name, bool gpu = true) { Profiler::begin_scope(name, gpu); }
+    ~ProfileScope() { Profiler::end_scope(); }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+// 计时到当前作用域结束 (CPU + GPU)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profile_scope_, __LINE__)(name)
+// 只计 CPU 时间 (不发出 GL 命令的区间，省掉两个查询)
+#define PROFILE_CPU_SCOPE(name) ProfileScope PROFILE_CONCAT(profile_scope_, __LINE__)(name, false)
@@ -1,10 +1,23 @@
 ﻿#include "window.h"
 
-Window::Window(int width, int height, const char* title)
+Window::Window(int width, int height, const char* title, window_mode mode)
     : width(width), height(height), window(nullptr)
 {
+    // 无头模式：不连接显示服务器 (必须在 glfwInit 之前设置)
+#ifdef GLFW_PLATFORM_NULL
+    if (mode == window_mode::HEADLESS)
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+#else
+    if (mode == window_mode::HEADLESS)
+        std::cout << "Headless mode requires GLFW 3.4, falling back to a hidden window" << std::endl;
+#endif
+
     // 初始化 GLFW
-    glfwInit();
+    if (!glfwInit())
+    {
+        std::cout << "Failed to initialize GLFW" << std::endl;
+        exit(-1);
+    }
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
@@ -13,6 +26,14 @@ Window::Window(int width, int height, const char* title)
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 #endif
 
+    // 离屏渲染不需要显示窗口；无头模式用 OSMesa 创建上下文 (Mesa llvmpipe 软件光栅化)
+    if (mode != window_mode::WINDOWED)
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+#ifdef GLFW_PLATFORM_NULL
+    if (mode == window_mode::HEADLESS)
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+#endif
+
     // 创建窗口
     window = glfwCreateWindow(width, height, title, NULL, NULL);
     if (window == NULL)
@@ -5,10 +5,17 @@
 #include <string>
 #include <iostream>
 
+// 窗口模式
+enum class window_mode {
+    WINDOWED,   // 普通的可见窗口
+    HIDDEN,     // 不显示的窗口 (仍然需要显示服务器，比如 X11/Xvfb)，用于离屏渲染
+    HEADLESS    // 不连接显示服务器：GLFW 的 Null 平台 + OSMesa 软件上下文 (需要 GLFW 3.4)
+};
+
 class Window {
 public:
     // 构造函数：负责初始化窗口和OpenGL上下文
-    Window(int width, int height, const char* title);
+    Window(int width, int height, const char* title, window_mode mode = window_mode::WINDOWED);
     // 析构函数：负责清理资源
     ~Window();
 
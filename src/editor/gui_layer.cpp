@@ -4,6 +4,42 @@
 #include "imgui_impl_glfw.h"
 #include "imgui_impl_opengl3.h"
 #include <GLFW/glfw3.h> // 需要 GLFW 定义
+#include "../core/profiler.h"
+
+namespace {
+    // 画一个计时节点和它的子树 (节点按先序排列)，返回子树之后的下一个节点
+    std::size_t render_profile_node(const std::vector<ProfileNode>& nodes, std::size_t index)
+    {
+        const ProfileNode& node = nodes[index];
+        bool has_children = index + 1 < nodes.size() && nodes[index + 1].depth > node.depth;
+
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_SpanFullWidth | ImGuiTreeNodeFlags_DefaultOpen;
+        if (!has_children)
+            flags |= ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_NoTreePushOnOpen;
+        bool open = ImGui::TreeNodeEx(reinterpret_cast<void*>(static_cast<intptr_t>(index)), flags, "%s", node.name);
+
+        ImGui::TableNextColumn();
+        ImGui::Text("%.3f", node.cpu_ms);
+        ImGui::TableNextColumn();
+        if (node.gpu_ms >= 0.0)
+            ImGui::Text("%.3f", node.gpu_ms);
+        else
+            ImGui::TextDisabled("-");
+
+        std::size_t next = index + 1;
+        while (next < nodes.size() && nodes[next].depth > node.depth) {
+            if (open)
+                next = render_profile_node(nodes, next);
+            else
+                next++;
+        }
+        if (has_children && open)
+            ImGui::TreePop();
+        return next;
+    }
+}
 
 void GuiLayer::init(void* window) {
     IMGUI_CHECKVERSION();
@@ -67,6 +103,228 @@ void GuiLayer::render_panel(glm::vec3* clear_color, bool* is_mouse_locked,
     ImGui::End();
 }
 
+void GuiLayer::render_stats(const RenderQueueStats& stats, const CullingStats& culling)
+{
+    // 同名窗口会追加到已有的 Inspector 面板中
+    ImGui::Begin("BowieEngine Inspector");
+
+    if (ImGui::CollapsingHeader("Render Queue", ImGuiTreeNodeFlags_DefaultOpen)) {
+        ImGui::Text("Draw Calls: %u", stats.draw_calls);
+        // 实际绑定次数 / 相比逐个绘制省下的次数
+        ImGui::Text("Program Binds: %u (saved %u)", stats.program_binds, stats.program_binds_saved);
+        ImGui::Text("Texture Binds: %u (saved %u)", stats.texture_binds, stats.texture_binds_saved);
+        ImGui::Text("VAO Binds:     %u (saved %u)", stats.vao_binds, stats.vao_binds_saved);
+        ImGui::Text("Multi-Draw: %u batches, %u meshes", stats.multi_draw_batches, stats.batched_draws);
+    }
+
+    if (ImGui::CollapsingHeader("Culling", ImGuiTreeNodeFlags_DefaultOpen)) {
+        ImGui::Text("Visible: %u / %u", culling.visible, culling.tested);
+    }
+
+    ImGui::End();
+}
+
+void GuiLayer::render_shading_path(shading_path* path, const DeferredStats& stats)
+{
+    ImGui::Begin("BowieEngine Inspector");
+
+    if (ImGui::CollapsingHeader("Shading Path", ImGuiTreeNodeFlags_DefaultOpen)) {
+        int current = static_cast<int>(*path);
+        const char* names[] = { "Forward", "Deferred" };
+        if (ImGui::Combo("Path", &current, names, IM_ARRAYSIZE(names)))
+            *path = static_cast<shading_path>(current);
+        if (stats.active) {
+            // 每像素 12 字节：albedo/镜面 RGBA8 + 法线 RG16F + 深度
+            ImGui::Text("G-Buffer: %d x %d, %.1f MB", stats.width, stats.height,
+                        stats.gbuffer_bytes / (1024.0f * 1024.0f));
+        }
+    }
+
+    ImGui::End();
+}
+
+void GuiLayer::render_clustered_lighting(ClusteredLightingParams* params, const ClusterStats& stats, int max_extra_lights)
+{
+    ImGui::Begin("BowieEngine Inspector");
+
+    if (ImGui::CollapsingHeader("Clustered Lighting", ImGuiTreeNodeFlags_DefaultOpen)) {
+        ImGui::Checkbox("Enable##Cluster", &params->enable);
+        ImGui::SliderInt("Extra Lights", &params->extra_point_lights, 0, max_extra_lights);
+        if (params->enable) {
+            ImGui::Text("Grid: %u x %u x %u", ClusteredLighting::GRID_X, ClusteredLighting::GRID_Y, ClusteredLighting::GRID_Z);
+            ImGui::Text("Lights: %u (binned %u)", stats.lights, stats.binned_lights);
+            ImGui::Text("Occupied Clusters: %u / %u", stats.occupied_clusters, ClusteredLighting::CLUSTER_COUNT);
+            ImGui::Text("Light Indices: %u (max %u per cluster)", stats.light_indices, stats.max_cluster_lights);
+            if (stats.overflow)
+                ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.3f, 1.0f), "Light buffer overflow, some lights dropped");
+        }
+    }
+
+    ImGui::End();
+}
+
+void GuiLayer::render_occlusion(OcclusionParams* params, const OcclusionStats& stats)
+{
+    ImGui::Begin("BowieEngine Inspector");
+
+    if (ImGui::CollapsingHeader("Occlusion Culling", ImGuiTreeNodeFlags_DefaultOpen)) {
+        ImGui::Checkbox("Enable##Occlusion", &params->enable);
+        ImGui::SliderFloat("Min Occluder Size", &params->min_occluder_size, 0.0f, 0.5f);
+        if (params->enable) {
+            ImGui::Text("Occluders: %u (%u triangles)", stats.occluders, stats.triangles);
+            ImGui::Text("Occluded: %u / %u", stats.occluded, stats.tested);
+        }
+    }
+
+    ImGui::End();
+}
+
+void GuiLayer::render_shadows(ShadowParams* params, const ShadowStats& stats)
+{
+    ImGui::Begin("BowieEngine Inspector");
+
+    if (ImGui::CollapsingHeader("Shadows", ImGuiTreeNodeFlags_DefaultOpen)) {
+        ImGui::Checkbox("Enable##Shadow", &params->enable);
+        ImGui::SliderInt("Cascades", &params->cascade_count, 1, MAX_SHADOW_CASCADES);
+        ImGui::SliderFloat("Distance", &params->max_distance, 5.0f, 100.0f);
+        ImGui::SliderFloat("Split Lambda", &params->split_lambda, 0.0f, 1.0f);
+        ImGui::SliderFloat("Depth Bias", &params->depth_bias, 0.0f, 0.01f, "%.4f");
+        ImGui::SliderFloat("Normal Bias", &params->normal_bias, 0.0f, 5.0f);
+        ImGui::Checkbox("Cache Static Casters", &params->cache_static);
+        if (params->enable) {
+            // 缓存命中时静态层不重画，只有动态投影物的层需要复制和叠加
+            ImGui::Text("Static Layers Rendered: %u / %u", stats.static_layers_rendered, stats.cascades);
+            ImGui::Text("Layers Composited: %u", stats.layers_composited);
+            ImGui::Text("Casters: %u static, %u dynamic", stats.static_casters, stats.dynamic_casters);
+        }
+    }
+
+    ImGui::End();
+}
+
+void GuiLayer::render_resource_stats(const ResourceStats& resources, const AsyncLoaderStats& loader)
+{
+    ImGui::Begin("BowieEngine Inspector");
+
+    if (ImGui::CollapsingHeader("Resources")) {
+        ImGui::Text("Textures: %u  Models: %u  Shaders: %u", resources.textures, resources.models, resources.shaders);
+        ImGui::Text("Memory: %.1f / %.1f MB (%u unused)", resources.memory_bytes / (1024.0f * 1024.0f),
+                    resources.memory_budget / (1024.0f * 1024.0f), resources.unused);
+        ImGui::Text("Hits: %llu  Misses: %llu  Evictions: %llu", (unsigned long long)resources.hits,
+                    (unsigned long long)resources.misses, (unsigned long long)resources.evictions);
+
+        ImGui::Separator();
+        ImGui::Text("Pending Jobs: %u", loader.pending_jobs);
+        ImGui::Text("Pending Uploads: %u", loader.pending_uploads);
+        ImGui::Text("This Frame: %u textures, %u models", loader.uploaded_textures, loader.uploaded_models);
+        ImGui::Text("Uploaded: %.1f KB in %.2f ms", loader.uploaded_bytes / 1024.0f, loader.upload_ms);
+    }
+
+    ImGui::End();
+}
+
+void GuiLayer::render_shader_stats(const ShaderCacheStats& cache, const ShaderReloadStats& reload)
+{
+    ImGui::Begin("BowieEngine Inspector");
+
+    if (ImGui::CollapsingHeader("Shaders")) {
+        ImGui::Text("Binary Cache: %s", cache.supported ? "on" : "unsupported");
+        ImGui::Text("Hits: %u  Misses: %u  Rejected: %u  Stored: %u", cache.hits, cache.misses, cache.rejected, cache.stored);
+
+        ImGui::Separator();
+        ImGui::Text("Hot Reload: %s (%u shaders)", reload.watching ? "watching" : "off", reload.shaders);
+        ImGui::Text("Pending: %u  Reloaded: %llu  Failed: %llu", reload.pending,
+                    (unsigned long long)reload.reloads, (unsigned long long)reload.failures);
+    }
+
+    ImGui::End();
+}
+
+void GuiLayer::render_geometry_stats(const GeometryArenaStats& stats)
+{
+    ImGui::Begin("BowieEngine Inspector");
+
+    if (ImGui::CollapsingHeader("Geometry Arena")) {
+        ImGui::Text("Pages: %u  Meshes: %u  MDI: %s", stats.pages, stats.allocations, stats.multi_draw_indirect ? "yes" : "no");
+        ImGui::Text("Vertices: %.1f / %.1f MB", stats.vertex_bytes_used / (1024.0f * 1024.0f), stats.vertex_bytes_capacity / (1024.0f * 1024.0f));
+        ImGui::Text("Indices:  %.1f / %.1f MB", stats.index_bytes_used / (1024.0f * 1024.0f), stats.index_bytes_capacity / (1024.0f * 1024.0f));
+        ImGui::Text("Defragmented: %llu pages, %.1f KB moved", (unsigned long long)stats.defragmentations, stats.moved_bytes / 1024.0f);
+    }
+
+    ImGui::End();
+}
+
+void GuiLayer::render_stream_stats(const StreamBufferStats& stats)
+{
+    ImGui::Begin("BowieEngine Inspector");
+
+    if (ImGui::CollapsingHeader("Stream Buffer")) {
+        ImGui::Text("Mode: %s x %u frames", stats.persistent ? "persistent map" : "unsynchronized map", StreamBuffer::FRAME_COUNT);
+        ImGui::Text("Last Frame: %.1f / %.1f KB (%u allocations)", stats.used_bytes / 1024.0f, stats.frame_capacity / 1024.0f, stats.allocations);
+        ImGui::Text("Peak: %.1f KB", stats.peak_bytes / 1024.0f);
+        ImGui::Text("Fence Stalls: %llu (%.2f ms this frame)", (unsigned long long)stats.stalls, stats.wait_ms);
+        if (stats.overflows > 0)
+            ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.3f, 1.0f), "%u allocations overflowed, buffer grown", stats.overflows);
+    }
+
+    ImGui::End();
+}
+
+void GuiLayer::render_job_stats(const JobStats& stats)
+{
+    ImGui::Begin("BowieEngine Inspector");
+
+    if (ImGui::CollapsingHeader("Job System")) {
+        ImGui::Text("Workers: %u (+ main thread)", stats.workers);
+        ImGui::Text("Executed: %llu (stolen %llu, inline %llu)", (unsigned long long)stats.executed,
+                    (unsigned long long)stats.stolen, (unsigned long long)stats.inline_runs);
+        ImGui::Text("Background: %llu done, %u pending", (unsigned long long)stats.background_executed, stats.background_pending);
+    }
+
+    ImGui::End();
+}
+
+void GuiLayer::render_profiler()
+{
+    ImGui::Begin("BowieEngine Inspector");
+
+    if (ImGui::CollapsingHeader("Profiler", ImGuiTreeNodeFlags_DefaultOpen)) {
+        bool enabled = Profiler::is_enabled();
+        if (ImGui::Checkbox("Enable##Profiler", &enabled))
+            Profiler::set_enabled(enabled);
+
+        const ProfileFrame& frame = Profiler::get_last_frame();
+        ImGui::Text("Frame %llu: CPU %.2f ms  GPU %.2f ms", (unsigned long long)frame.index, frame.cpu_ms, frame.gpu_ms > 0.0 ? frame.gpu_ms : 0.0);
+
+        // 帧时间曲线 (环形缓冲，offset 是最旧的样本)
+        ImGui::PlotLines("CPU ms", Profiler::get_cpu_history(), Profiler::HISTORY_SIZE, Profiler::get_history_offset(),
+                         nullptr, 0.0f, 33.3f, ImVec2(0.0f, 50.0f));
+        ImGui::PlotLines("GPU ms", Profiler::get_gpu_history(), Profiler::HISTORY_SIZE, Profiler::get_history_offset(),
+                         nullptr, 0.0f, 33.3f, ImVec2(0.0f, 50.0f));
+
+        // 每个区间的计时树
+        if (!frame.nodes.empty() && ImGui::BeginTable("ProfileTree", 3, ImGuiTableFlags_BordersOuter | ImGuiTableFlags_RowBg)) {
+            ImGui::TableSetupColumn("Scope", ImGuiTableColumnFlags_WidthStretch);
+            ImGui::TableSetupColumn("CPU ms", ImGuiTableColumnFlags_WidthFixed, 60.0f);
+            ImGui::TableSetupColumn("GPU ms", ImGuiTableColumnFlags_WidthFixed, 60.0f);
+            ImGui::TableHeadersRow();
+            for (std::size_t i = 0; i < frame.nodes.size(); )
+                i = render_profile_node(frame.nodes, i);
+            ImGui::EndTable();
+        }
+
+        if (Profiler::get_dropped_frames() > 0)
+            ImGui::TextDisabled("Dropped (GPU results late): %llu", (unsigned long long)Profiler::get_dropped_frames());
+
+        if (ImGui::Button("Save Chrome Trace"))
+            Profiler::save_chrome_trace("profile_trace.json");
+        ImGui::SameLine();
+        ImGui::TextDisabled("(last %u frames -> profile_trace.json)", Profiler::TRACE_FRAMES);
+    }
+
+    ImGui::End();
+}
+
 void GuiLayer::shutdown() {
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
@@ -2,6 +2,19 @@
 
 // 引入共享参数结构
 #include "../scene/light_params.h"
+#include "../renderer/render_queue.h"
+#include "../renderer/frustum_culler.h"
+#include "../renderer/occlusion_culler.h"
+#include "../renderer/light_clusters.h"
+#include "../renderer/shadow_cascades.h"
+#include "../renderer/deferred_shading.h"
+#include "../renderer/async_loader.h"
+#include "../renderer/resource_manager.h"
+#include "../renderer/shader_cache.h"
+#include "../renderer/shader_reloader.h"
+#include "../renderer/geometry_arena.h"
+#include "../renderer/stream_buffer.h"
+#include "../core/jobs.h"
 
 class GuiLayer {
 public:
@@ -24,6 +37,39 @@ public:
         SpotLightParams* spot_light
     );
 
+    // 渲染队列和剔除统计 (追加在属性面板里)
+    static void render_stats(const RenderQueueStats& stats, const CullingStats& culling);
+
+    // 着色路径 (前向 / 延迟) 和 G-buffer 统计 (追加在属性面板里)
+    static void render_shading_path(shading_path* path, const DeferredStats& stats);
+
+    // 分簇光照设置和统计 (追加在属性面板里)
+    static void render_clustered_lighting(ClusteredLightingParams* params, const ClusterStats& stats, int max_extra_lights);
+
+    // 软件遮挡剔除设置和统计 (追加在属性面板里)
+    static void render_occlusion(OcclusionParams* params, const OcclusionStats& stats);
+
+    // 级联阴影设置和缓存统计 (追加在属性面板里)
+    static void render_shadows(ShadowParams* params, const ShadowStats& stats);
+
+    // 资源缓存和异步加载统计 (追加在属性面板里)
+    static void render_resource_stats(const ResourceStats& resources, const AsyncLoaderStats& loader);
+
+    // 程序二进制缓存和热重载统计
+    static void render_shader_stats(const ShaderCacheStats& cache, const ShaderReloadStats& reload);
+
+    // 几何池的占用和整理统计
+    static void render_geometry_stats(const GeometryArenaStats& stats);
+
+    // 每帧环形缓冲的用量和栅栏等待
+    static void render_stream_stats(const StreamBufferStats& stats);
+
+    // 任务系统的线程数和执行/偷取计数
+    static void render_job_stats(const JobStats& stats);
+
+    // 帧分析器：帧时间曲线 + 每个区间的 CPU/GPU 时间树，可以导出 Chrome trace
+    static void render_profiler();
+
     // 清理资源
     static void shutdown();
 };
\ No newline at end of file
@@ -0,0 +1,298 @@
+#include "async_loader.h"
+
+#include "model.h"
+#include "../core/profiler.h"
+#include "../core/jobs.h"
+
+#include <stb_image.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+namespace {
+    // 每一步最多往 PBO 里拷贝的字节数，大纹理会被拆成多步 (可能跨多帧) 完成
+    const std::size_t UPLOAD_CHUNK_BYTES = 1 << 20;
+
+    GLenum format_for_channels(int channels)
+    {
+        switch (channels) {
+            case 1:  return GL_RED;
+            case 2:  return GL_RG;
+            case 3:  return GL_RGB;
+            default: return GL_RGBA;
+        }
+    }
+}
+
+// 工作线程解码出来的图片
+struct AsyncLoader::DecodedImage {
+    uint64_t request = 0;
+    unsigned char* pixels = nullptr; // stbi_load 的结果，失败时为空
+    int width = 0, height = 0, channels = 0;
+
+    ~DecodedImage() { if (pixels) stbi_image_free(pixels); }
+};
+
+// 工作线程导入好的模型
+struct AsyncLoader::ImportedModel {
+    uint64_t request = 0;
+    bool success = false;
+    ModelData data;
+    ResourceManager* resources = nullptr;
+};
+
+// 正在上传的纹理
+struct AsyncLoader::TextureUpload {
+    TextureHandle texture;
+    std::unique_ptr<DecodedImage> image;
+    std::size_t size = 0;   // 像素数据总字节数
+    std::size_t copied = 0; // 已经拷进 PBO 的字节数
+    unsigned int pbo = 0;
+};
+
+AsyncTexture::~AsyncTexture()
+{
+    if (id != 0)
+        glDeleteTextures(1, &id);
+}
+
+AsyncLoader::AsyncLoader() = default;
+
+AsyncLoader::~AsyncLoader()
+{
+    // 还没开始的任务直接跳过，正在执行的等它结束 (任务里会访问 this)
+    cancelled = true;
+    while (running_jobs.load() > 0)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    // 还没上传完的纹理：释放 PBO (像素内存由 DecodedImage 释放)
+    for (const std::unique_ptr<TextureUpload>& upload : texture_uploads) {
+        if (upload->pbo != 0)
+            glDeleteBuffers(1, &upload->pbo);
+    }
+}
+
+TextureHandle AsyncLoader::load_texture(const std::string& path, bool flip_vertically, const glm::vec4& placeholder)
+{
+    TextureHandle texture = std::make_shared<AsyncTexture>();
+    texture->path = path;
+
+    // 先放一张 1x1 的占位图，纹理 ID 立刻可用
+    unsigned char color[4];
+    for (int i = 0; i < 4; i++)
+        color[i] = static_cast<unsigned char>(glm::clamp(placeholder[i], 0.0f, 1.0f) * 255.0f + 0.5f);
+
+    glGenTextures(1, &texture->id);
+    glBindTexture(GL_TEXTURE_2D, texture->id);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, color);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    // 工作线程只拿到请求编号和路径，句柄始终留在 GL 线程 (AsyncTexture 析构会调用 GL)
+    uint64_t request = next_request++;
+    pending_textures[request] = texture;
+
+    enqueue([this, request, path, flip_vertically]() {
+        std::unique_ptr<DecodedImage> image = std::make_unique<DecodedImage>();
+        image->request = request;
+
+        // 翻转设置是线程局部的，不会影响其他线程同时进行的解码
+        stbi_set_flip_vertically_on_load_thread(flip_vertically ? 1 : 0);
+        image->pixels = stbi_load(path.c_str(), &image->width, &image->height, &image->channels, 0);
+        if (!image->pixels)
+            std::cout << "Texture failed to load at path: " << path << std::endl;
+
+        std::lock_guard<std::mutex> lock(done_mutex);
+        decoded_images.push_back(std::move(image));
+    });
+    return texture;
+}
+
+ModelHandle AsyncLoader::load_model(const std::string& path, ResourceManager* resources, const VertexFormat& format)
+{
+    ModelHandle model = std::make_shared<AsyncModel>();
+    model->path = path;
+
+    uint64_t request = next_request++;
+    pending_models[request] = model;
+
+    enqueue([this, request, path, resources, format]() {
+        std::unique_ptr<ImportedModel> imported = std::make_unique<ImportedModel>();
+        imported->request = request;
+        imported->resources = resources;
+        imported->success = Model::importData(path, imported->data, format);
+
+        std::lock_guard<std::mutex> lock(done_mutex);
+        imported_models.push_back(std::move(imported));
+    });
+    return model;
+}
+
+void AsyncLoader::update(float budget_ms)
+{
+    PROFILE_SCOPE("Async Upload");
+    auto start = std::chrono::steady_clock::now();
+    auto elapsed_ms = [start]() {
+        return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    stats.uploaded_textures = 0;
+    stats.uploaded_models = 0;
+    stats.uploaded_bytes = 0;
+
+    // -> 取出工作线程完成的结果
+    std::vector<std::unique_ptr<DecodedImage>> images;
+    std::vector<std::unique_ptr<ImportedModel>> models;
+    {
+        std::lock_guard<std::mutex> lock(done_mutex);
+        images.swap(decoded_images);
+        models.swap(imported_models);
+    }
+
+    for (std::unique_ptr<DecodedImage>& image : images) {
+        auto it = pending_textures.find(image->request);
+        if (it == pending_textures.end())
+            continue;
+        TextureHandle texture = std::move(it->second);
+        pending_textures.erase(it);
+
+        if (!image->pixels) {
+            texture->state = load_state::FAILED;
+            continue;
+        }
+
+        std::unique_ptr<TextureUpload> upload = std::make_unique<TextureUpload>();
+        upload->size = std::size_t(image->width) * image->height * image->channels;
+        upload->texture = std::move(texture);
+        upload->image = std::move(image);
+        upload->texture->state = load_state::UPLOADING;
+        texture_uploads.push_back(std::move(upload));
+    }
+    for (std::unique_ptr<ImportedModel>& imported : models)
+        model_uploads.push_back(std::move(imported));
+
+    // -> 在预算内上传，每帧至少推进一步
+    bool progressed = false;
+    while (!model_uploads.empty() && (!progressed || elapsed_ms() < budget_ms)) {
+        std::unique_ptr<ImportedModel> imported = std::move(model_uploads.front());
+        model_uploads.pop_front();
+        progressed = true;
+
+        auto it = pending_models.find(imported->request);
+        if (it == pending_models.end())
+            continue;
+        ModelHandle model = std::move(it->second);
+        pending_models.erase(it);
+
+        if (!imported->success) {
+            model->state = load_state::FAILED;
+            continue;
+        }
+
+        // 网格缓冲一次性创建，纹理通过资源管理器再走本加载器的异步流程
+        model->model = std::make_shared<Model>(imported->data, imported->resources);
+        model->state = load_state::READY;
+        stats.uploaded_models++;
+    }
+
+    while (!texture_uploads.empty() && (!progressed || elapsed_ms() < budget_ms)) {
+        progressed = true;
+        if (step_texture_upload(*texture_uploads.front()))
+            texture_uploads.pop_front();
+    }
+
+    stats.pending_jobs = running_jobs.load();
+    stats.pending_uploads = static_cast<unsigned int>(texture_uploads.size() + model_uploads.size());
+    stats.upload_ms = elapsed_ms();
+}
+
+bool AsyncLoader::step_texture_upload(TextureUpload& upload)
+{
+    // -> 分块拷贝进 PBO
+    // 每块映射的都是还没写过的区域，UNSYNCHRONIZED 不会等待 GPU，INVALIDATE_RANGE 告诉驱动不需要旧内容
+    if (upload.pbo == 0) {
+        glGenBuffers(1, &upload.pbo);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, upload.pbo);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, upload.size, nullptr, GL_STREAM_DRAW);
+    }
+    else {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, upload.pbo);
+    }
+
+    std::size_t chunk = std::min(UPLOAD_CHUNK_BYTES, upload.size - upload.copied);
+    const unsigned char* source = upload.image->pixels + upload.copied;
+    void* destination = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, upload.copied, chunk,
+                                         GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    if (destination) {
+        std::memcpy(destination, source, chunk);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    }
+    else {
+        // 映射失败时退回普通的缓冲更新
+        glBufferSubData(GL_PIXEL_UNPACK_BUFFER, upload.copied, chunk, source);
+    }
+    upload.copied += chunk;
+    stats.uploaded_bytes += chunk;
+
+    if (upload.copied < upload.size) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return false;
+    }
+
+    // -> 数据全部到位：从 PBO 提交给纹理 (最后一个参数是 PBO 内的偏移)，替换占位图
+    AsyncTexture& texture = *upload.texture;
+    DecodedImage& image = *upload.image;
+    GLenum format = format_for_channels(image.channels);
+
+    glBindTexture(GL_TEXTURE_2D, texture.id);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // stb_image 的行是紧密排列的
+    glTexImage2D(GL_TEXTURE_2D, 0, format, image.width, image.height, 0, format, GL_UNSIGNED_BYTE, nullptr);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glGenerateMipmap(GL_TEXTURE_2D);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    glDeleteBuffers(1, &upload.pbo);
+    upload.pbo = 0;
+
+    texture.width = image.width;
+    texture.height = image.height;
+    texture.channels = image.channels;
+    texture.state = load_state::READY;
+    stats.uploaded_textures++;
+    return true;
+}
+
+void AsyncLoader::flush()
+{
+    while (!is_idle()) {
+        update(1000.0f);
+        if (texture_uploads.empty() && model_uploads.empty())
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+bool AsyncLoader::is_idle() const
+{
+    // 请求在上传完成之前一直留在 pending 表或上传队列里
+    return pending_textures.empty() && pending_models.empty() &&
+           texture_uploads.empty() && model_uploads.empty();
+}
+
+void AsyncLoader::enqueue(std::function<void()> job)
+{
+    // 解码/导入作为任务系统的后台任务执行 (只由空闲的工作线程接手，不占用每帧任务)
+    running_jobs++;
+    JobSystem::dispatch_background([this, job = std::move(job)]() {
+        if (!cancelled.load())
+            job();
+        // 最后一步：计数归零后加载器可能马上被销毁，之后不能再访问 this
+        running_jobs--;
+    });
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "vertex_format.h"
+
+class Model;
+class AsyncLoader;
+class ResourceManager;
+
+// 异步资源的加载状态
+enum class load_state {
+    PENDING,   // 排队或正在工作线程上解码
+    UPLOADING, // 数据已就绪，正在分批上传到 GPU
+    READY,     // 可以正常使用
+    FAILED     // 加载失败 (纹理会一直保持占位图)
+};
+
+// 异步纹理 (也是 ResourceManager 管理的纹理资源，同步加载的纹理直接处于 READY 状态)
+// 纹理 ID 在请求时就已经分配好并填入 1x1 的占位图，可以立刻交给 Mesh 使用；
+// 真正的图片上传完成后同一个 ID 的内容被替换，使用方不需要做任何切换
+struct AsyncTexture {
+    unsigned int id = 0;
+    std::string path;
+    int width = 1, height = 1;
+    int channels = 4;
+    std::atomic<load_state> state{ load_state::PENDING };
+
+    bool is_ready() const { return state.load() == load_state::READY; }
+
+    // 释放 GL 纹理：句柄只在 GL 线程上创建和销毁
+    ~AsyncTexture();
+};
+
+// 异步模型：导入 (Assimp 或 .smesh 缓存) 在工作线程上完成，Mesh 缓冲在 GL 线程上创建
+struct AsyncModel {
+    std::string path;
+    std::shared_ptr<Model> model; // READY 之后有效
+    std::atomic<load_state> state{ load_state::PENDING };
+
+    bool is_ready() const { return state.load() == load_state::READY; }
+};
+
+using TextureHandle = std::shared_ptr<AsyncTexture>;
+using ModelHandle = std::shared_ptr<AsyncModel>;
+
+// 每帧的上传统计
+struct AsyncLoaderStats {
+    unsigned int pending_jobs = 0;        // 等待或正在解码的任务
+    unsigned int pending_uploads = 0;     // 等待上传到 GPU 的资源
+    unsigned int uploaded_textures = 0;   // 本帧完成的纹理
+    unsigned int uploaded_models = 0;     // 本帧完成的模型
+    std::size_t uploaded_bytes = 0;       // 本帧上传的字节数
+    float upload_ms = 0.0f;               // 本帧上传耗时
+};
+
+// AsyncLoader：后台解码 + 分帧上传
+//
+// 请求 (load_texture / load_model) 只在 GL 线程上调用：立刻返回句柄，解码任务作为后台任务交给任务系统 (core/jobs.h)。
+// 工作线程解码图片 (stb_image) / 导入模型，结果放进完成队列。
+// GL 线程每帧调用 update(budget)，在时间预算内把像素分块拷进 PBO (Pixel Buffer Object)，
+// 大纹理的拷贝会跨多帧完成，全部到位后才从 PBO 提交给纹理，在此之前一直显示占位图
+class AsyncLoader
+{
+public:
+    AsyncLoader();
+    ~AsyncLoader();
+
+    AsyncLoader(const AsyncLoader&) = delete;
+    AsyncLoader& operator=(const AsyncLoader&) = delete;
+
+    // 请求加载纹理 (flip_vertically: 是否上下翻转，OpenGL 的纹理原点在左下角)
+    // placeholder: 数据到达前显示的颜色
+    TextureHandle load_texture(const std::string& path, bool flip_vertically = true,
+                               const glm::vec4& placeholder = glm::vec4(0.5f, 0.5f, 0.5f, 1.0f));
+
+    // 请求加载模型
+    // resources 不为空时模型的纹理通过资源管理器加载 (异步、去重)，否则在上传时同步加载
+    // format 为模型在 GPU 上的顶点格式
+    ModelHandle load_model(const std::string& path, ResourceManager* resources = nullptr,
+                           const VertexFormat& format = VertexFormat::standard());
+
+    // GL 线程每帧调用：在 budget_ms 毫秒内尽量多地上传已解码的数据
+    // 每帧至少推进一步，保证预算很小时也能完成加载
+    void update(float budget_ms = 2.0f);
+
+    // 阻塞直到所有请求都完成 (加载界面 / 测试用)
+    void flush();
+
+    // 是否还有未完成的请求
+    bool is_idle() const;
+
+    const AsyncLoaderStats& get_stats() const { return stats; }
+
+private:
+    struct DecodedImage;
+    struct ImportedModel;
+    struct TextureUpload;
+
+    void enqueue(std::function<void()> job);
+    bool step_texture_upload(TextureUpload& upload);
+
+    // 后台任务 (排队中 + 执行中)
+    std::atomic<unsigned int> running_jobs{ 0 };
+    std::atomic<bool> cancelled{ false };
+
+    // 完成队列 (工作线程写，GL 线程读)
+    mutable std::mutex done_mutex;
+    std::vector<std::unique_ptr<DecodedImage>> decoded_images;
+    std::vector<std::unique_ptr<ImportedModel>> imported_models;
+
+    // GL 线程独占的状态
+    uint64_t next_request = 1;
+    std::unordered_map<uint64_t, TextureHandle> pending_textures;
+    std::unordered_map<uint64_t, ModelHandle> pending_models;
+    std::deque<std::unique_ptr<TextureUpload>> texture_uploads;
+    std::deque<std::unique_ptr<ImportedModel>> model_uploads;
+
+    AsyncLoaderStats stats;
+};
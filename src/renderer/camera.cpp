@@ -49,6 +49,12 @@ glm::mat4 Camera::get_projection_matrix(float width, float height) const
     return glm::perspective(glm::radians(zoom), width / height, near_plane, far_plane);
 }
 
+// 获取视锥体
+Frustum Camera::get_frustum(float width, float height) const
+{
+    return Frustum::from_matrix(get_projection_matrix(width, height) * get_view_matrix());
+}
+
 // 处理键盘移动
 void Camera::process_keyboard(camera_movement direction, float delta_time)
 {
@@ -102,6 +108,20 @@ void Camera::process_mouse_scroll(float yoffset)
         zoom = 45.0f;
 }
 
+// 朝向某一点
+void Camera::look_at(const glm::vec3& target)
+{
+    glm::vec3 direction = target - position;
+    if (glm::length(direction) < 1e-6f)
+        return;
+    direction = glm::normalize(direction);
+
+    // update_camera_vectors 的逆运算
+    pitch = glm::degrees(asin(glm::clamp(direction.y, -1.0f, 1.0f)));
+    yaw   = glm::degrees(atan2(direction.z, direction.x));
+    update_camera_vectors();
+}
+
 // 更新内部向量
 void Camera::update_camera_vectors()
 {
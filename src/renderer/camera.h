@@ -4,6 +4,8 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include "../scene/bounds.h"
+
 // 定义相机移动方向的枚举
 enum class camera_movement {
     FORWARD,
@@ -67,6 +69,10 @@ public:
     // 需要传入当前窗口/视口的宽高来计算宽高比 (Aspect Ratio)
     glm::mat4 get_projection_matrix(float width, float height) const;
 
+    // 获取视锥体 (世界空间的 6 个平面)
+    // 由 get_projection_matrix * get_view_matrix 推导，参数含义同上
+    Frustum get_frustum(float width, float height) const;
+
     // --- 输入处理 ---
 
     // 处理键盘输入 (位置移动)
@@ -78,6 +84,9 @@ public:
     // 处理鼠标滚轮 (FOV缩放)
     void process_mouse_scroll(float yoffset);
 
+    // 朝向某一点 (由方向反推欧拉角，用于脚本化的摄像机路径)
+    void look_at(const glm::vec3& target);
+
 private:
     // 根据当前的欧拉角更新 Front, Right, Up 向量
     void update_camera_vectors();
@@ -0,0 +1,281 @@
+#include "cooked_mesh.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace {
+    const std::size_t SECTION_ALIGNMENT = 16;
+
+    std::size_t align_up(std::size_t value)
+    {
+        return (value + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1);
+    }
+
+    // 索引段里每个子网格补齐到 4 字节
+    std::size_t index_padding(std::size_t size)
+    {
+        return (size + 3) & ~std::size_t(3);
+    }
+
+    void store_bounds(const AABB& box, const BoundingSphere& sphere, float* out_min, float* out_max, float* out_center, float& out_radius)
+    {
+        for (int i = 0; i < 3; i++) {
+            out_min[i] = box.min[i];
+            out_max[i] = box.max[i];
+            out_center[i] = sphere.center[i];
+        }
+        out_radius = sphere.radius;
+    }
+
+    // 段 [offset, offset + size) 是否完整落在文件内
+    bool section_in_file(uint64_t offset, uint64_t size, std::size_t file_size)
+    {
+        return offset <= file_size && size <= file_size - offset;
+    }
+
+    const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+    const uint64_t FNV_PRIME = 1099511628211ull;
+
+    uint64_t fnv1a(const uint8_t* data, std::size_t size, uint64_t hash)
+    {
+        for (std::size_t i = 0; i < size; i++) {
+            hash ^= data[i];
+            hash *= FNV_PRIME;
+        }
+        return hash;
+    }
+}
+
+uint64_t hash_source_file(const std::string& path, uint32_t import_flags, const VertexFormat& format)
+{
+    MappedFile source;
+    if (!source.open(path))
+        return 0;
+
+    uint64_t hash = fnv1a(source.get_data(), source.get_size(), FNV_OFFSET_BASIS);
+
+    // 导入参数、顶点格式和文件版本也参与哈希：改了 aiProcess 标志、顶点格式或者缓存格式，旧缓存一样要重新生成
+    uint32_t salt[4] = { import_flags, SMESH_VERSION, static_cast<uint32_t>(sizeof(Vertex)), format.key() };
+    hash = fnv1a(reinterpret_cast<const uint8_t*>(salt), sizeof(salt), hash);
+    return hash != 0 ? hash : 1;
+}
+
+bool write_cooked_model(const std::string& path, uint64_t source_hash, const VertexFormat& format,
+                        const std::vector<MeshData>& meshes, const AABB& bounds, const BoundingSphere& bounding_sphere)
+{
+    SMeshHeader header = {};
+    header.magic = SMESH_MAGIC;
+    header.version = SMESH_VERSION;
+    header.source_hash = source_hash;
+    header.vertex_format = format.key();
+    header.vertex_stride = format.stride();
+    header.mesh_count = static_cast<uint32_t>(meshes.size());
+    store_bounds(bounds, bounding_sphere, header.bounds_min, header.bounds_max, header.sphere_center, header.sphere_radius);
+
+    // -> 子网格记录、纹理引用和字符串表
+    std::vector<SMeshRecord> records(meshes.size());
+    std::vector<SMeshLod> lods;
+    std::vector<SMeshTexture> textures;
+    std::string strings;
+
+    for (std::size_t i = 0; i < meshes.size(); i++) {
+        const MeshData& mesh = meshes[i];
+        SMeshRecord& record = records[i];
+        record = {};
+        record.vertex_offset = header.vertex_data_size;
+        record.vertex_count = mesh.vertexCount;
+        record.index_offset = header.index_data_size;
+        record.index_count = mesh.indexCount;
+        record.index_size = mesh.indexSize;
+        record.first_texture = static_cast<uint32_t>(textures.size());
+        record.texture_count = static_cast<uint32_t>(mesh.textures.size());
+        record.first_lod = static_cast<uint32_t>(lods.size());
+        record.lod_count = static_cast<uint32_t>(mesh.lods.size());
+        store_bounds(mesh.bounds, mesh.boundingSphere, record.bounds_min, record.bounds_max, record.sphere_center, record.sphere_radius);
+        for (int column = 0; column < 4; column++)
+            for (int row = 0; row < 4; row++)
+                record.node_transform[column * 4 + row] = mesh.nodeTransform[column][row];
+
+        for (const MeshLod& lod : mesh.lods)
+            lods.push_back({ lod.firstIndex, lod.indexCount, lod.error, 0 });
+
+        for (const MeshTextureRef& texture : mesh.textures) {
+            SMeshTexture entry;
+            entry.type_offset = static_cast<uint32_t>(strings.size());
+            entry.type_length = static_cast<uint32_t>(texture.type.size());
+            strings += texture.type;
+            entry.path_offset = static_cast<uint32_t>(strings.size());
+            entry.path_length = static_cast<uint32_t>(texture.path.size());
+            strings += texture.path;
+            textures.push_back(entry);
+        }
+
+        // 每个子网格的索引补齐到 4 字节，16 位和 32 位索引可以混在一个段里
+        header.vertex_data_size += mesh.vertexData.size();
+        header.index_data_size += index_padding(mesh.indexData.size());
+    }
+    header.lod_count = static_cast<uint32_t>(lods.size());
+    header.texture_count = static_cast<uint32_t>(textures.size());
+    header.string_table_size = static_cast<uint32_t>(strings.size());
+
+    // -> 计算每一段的偏移
+    std::size_t offset = align_up(sizeof(SMeshHeader));
+    header.records_offset = offset;
+    offset = align_up(offset + records.size() * sizeof(SMeshRecord));
+    header.lods_offset = offset;
+    offset = align_up(offset + lods.size() * sizeof(SMeshLod));
+    header.textures_offset = offset;
+    offset = align_up(offset + textures.size() * sizeof(SMeshTexture));
+    header.string_table_offset = offset;
+    offset = align_up(offset + strings.size());
+    header.vertex_data_offset = offset;
+    offset = align_up(offset + header.vertex_data_size);
+    header.index_data_offset = offset;
+
+    // -> 先写临时文件再改名，写到一半失败不会留下损坏的缓存
+    std::string temp_path = path + ".tmp";
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            std::cout << "ERROR::SMESH::CANNOT_WRITE: " << temp_path << std::endl;
+            return false;
+        }
+
+        auto write_at = [&out](uint64_t section_offset, const void* data, std::size_t size) {
+            // 补齐到段的起始位置
+            static const char padding[SECTION_ALIGNMENT] = {};
+            std::size_t position = static_cast<std::size_t>(out.tellp());
+            if (section_offset > position)
+                out.write(padding, static_cast<std::streamsize>(section_offset - position));
+            if (size > 0)
+                out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        };
+
+        write_at(0, &header, sizeof(header));
+        write_at(header.records_offset, records.data(), records.size() * sizeof(SMeshRecord));
+        write_at(header.lods_offset, lods.data(), lods.size() * sizeof(SMeshLod));
+        write_at(header.textures_offset, textures.data(), textures.size() * sizeof(SMeshTexture));
+        write_at(header.string_table_offset, strings.data(), strings.size());
+
+        // 所有子网格的顶点连续写入，然后是所有索引
+        write_at(header.vertex_data_offset, nullptr, 0);
+        for (const MeshData& mesh : meshes)
+            out.write(reinterpret_cast<const char*>(mesh.vertexData.data()), static_cast<std::streamsize>(mesh.vertexData.size()));
+        write_at(header.index_data_offset, nullptr, 0);
+        for (const MeshData& mesh : meshes) {
+            static const char padding[4] = {};
+            out.write(reinterpret_cast<const char*>(mesh.indexData.data()), static_cast<std::streamsize>(mesh.indexData.size()));
+            out.write(padding, static_cast<std::streamsize>(index_padding(mesh.indexData.size()) - mesh.indexData.size()));
+        }
+
+        if (!out) {
+            std::cout << "ERROR::SMESH::WRITE_FAILED: " << temp_path << std::endl;
+            out.close();
+            std::filesystem::remove(temp_path);
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temp_path, path, error);
+    if (error) {
+        std::cout << "ERROR::SMESH::RENAME_FAILED: " << path << " (" << error.message() << ")" << std::endl;
+        std::filesystem::remove(temp_path, error);
+        return false;
+    }
+    return true;
+}
+
+bool CookedModelFile::open(const std::string& path, uint64_t expected_hash)
+{
+    close();
+    if (!file.open(path))
+        return false;
+
+    const uint8_t* data = file.get_data();
+    std::size_t size = file.get_size();
+
+    // -> 头部校验：魔数、版本、顶点布局、源文件哈希
+    if (size < sizeof(SMeshHeader)) {
+        file.close();
+        return false;
+    }
+    const SMeshHeader* candidate = reinterpret_cast<const SMeshHeader*>(data);
+    if (candidate->magic != SMESH_MAGIC || candidate->version != SMESH_VERSION ||
+        !VertexFormat::from_key(candidate->vertex_format, format) || candidate->vertex_stride != format.stride() ||
+        candidate->source_hash != expected_hash) {
+        file.close();
+        return false;
+    }
+
+    // -> 每一段都必须完整落在文件内
+    bool valid =
+        section_in_file(candidate->records_offset, uint64_t(candidate->mesh_count) * sizeof(SMeshRecord), size) &&
+        section_in_file(candidate->lods_offset, uint64_t(candidate->lod_count) * sizeof(SMeshLod), size) &&
+        section_in_file(candidate->textures_offset, uint64_t(candidate->texture_count) * sizeof(SMeshTexture), size) &&
+        section_in_file(candidate->string_table_offset, candidate->string_table_size, size) &&
+        section_in_file(candidate->vertex_data_offset, candidate->vertex_data_size, size) &&
+        section_in_file(candidate->index_data_offset, candidate->index_data_size, size) &&
+        candidate->vertex_data_offset % 4 == 0 &&
+        candidate->index_data_offset % 4 == 0;
+
+    if (valid) {
+        records = reinterpret_cast<const SMeshRecord*>(data + candidate->records_offset);
+        lods = reinterpret_cast<const SMeshLod*>(data + candidate->lods_offset);
+        textures = reinterpret_cast<const SMeshTexture*>(data + candidate->textures_offset);
+
+        for (uint32_t i = 0; valid && i < candidate->mesh_count; i++) {
+            const SMeshRecord& record = records[i];
+            valid = (record.index_size == 2 || record.index_size == 4) &&
+                    record.vertex_offset % 4 == 0 && record.index_offset % record.index_size == 0 &&
+                    section_in_file(record.vertex_offset, uint64_t(record.vertex_count) * candidate->vertex_stride, candidate->vertex_data_size) &&
+                    section_in_file(record.index_offset, uint64_t(record.index_count) * record.index_size, candidate->index_data_size) &&
+                    uint64_t(record.first_texture) + record.texture_count <= candidate->texture_count &&
+                    record.lod_count > 0 && uint64_t(record.first_lod) + record.lod_count <= candidate->lod_count;
+
+            // 每个 LOD 级别都必须落在所属子网格的索引范围内
+            for (uint32_t l = record.first_lod; valid && l < record.first_lod + record.lod_count; l++)
+                valid = uint64_t(lods[l].first_index) + lods[l].index_count <= record.index_count;
+        }
+        for (uint32_t i = 0; valid && i < candidate->texture_count; i++) {
+            const SMeshTexture& texture = textures[i];
+            valid = uint64_t(texture.type_offset) + texture.type_length <= candidate->string_table_size &&
+                    uint64_t(texture.path_offset) + texture.path_length <= candidate->string_table_size;
+        }
+    }
+
+    if (!valid) {
+        std::cout << "ERROR::SMESH::CORRUPTED_FILE: " << path << std::endl;
+        file.close();
+        records = nullptr;
+        lods = nullptr;
+        textures = nullptr;
+        return false;
+    }
+
+    header = candidate;
+    strings = reinterpret_cast<const char*>(data + header->string_table_offset);
+    vertices = data + header->vertex_data_offset;
+    indices = data + header->index_data_offset;
+    return true;
+}
+
+std::vector<MeshLod> CookedModelFile::get_lods(const SMeshRecord& mesh) const
+{
+    std::vector<MeshLod> result;
+    result.reserve(mesh.lod_count);
+    for (uint32_t l = mesh.first_lod; l < mesh.first_lod + mesh.lod_count; l++)
+        result.push_back({ lods[l].first_index, lods[l].index_count, lods[l].error });
+    return result;
+}
+
+std::string_view CookedModelFile::get_texture_type(unsigned int index) const
+{
+    return std::string_view(strings + textures[index].type_offset, textures[index].type_length);
+}
+
+std::string_view CookedModelFile::get_texture_path(unsigned int index) const
+{
+    return std::string_view(strings + textures[index].path_offset, textures[index].path_length);
+}
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../core/mapped_file.h"
+#include "../scene/bounds.h"
+#include "mesh.h"
+
+// .smesh：烘焙好的模型缓存
+//
+// Assimp 导入 (三角化、生成法线、切线空间) 的结果按 GPU 布局 (导入时选定的 VertexFormat) 直接写进文件，
+// 运行时把文件 mmap 进来，顶点/索引段的指针直接交给 glBufferData，不再逐顶点转换。
+// 文件里记录了源文件内容 + 导入参数 (含顶点格式) 的哈希，源文件或格式变化时缓存自动失效。
+//
+// 文件布局 (小端，每一段按 16 字节对齐)：
+//   [SMeshHeader]
+//   [SMeshRecord  x mesh_count]      每个子网格的顶点/索引范围、纹理范围、LOD 范围、包围体、节点变换
+//   [SMeshLod     x lod_count]       每个 LOD 级别在所属子网格索引里的范围和几何误差
+//   [SMeshTexture x texture_count]   纹理引用 (类型 + 相对路径，指向字符串表)
+//   [字符串表]
+//   [顶点数据]                        按顶点格式打包，所有子网格连续存放
+//   [索引数据]                        每个子网格 16 或 32 位，相对于所在子网格的第一个顶点，按 4 字节对齐
+//                                    (子网格的所有 LOD 级别连续存放，共用子网格的顶点)
+
+const uint32_t SMESH_MAGIC = 0x48534D53; // "SMSH"
+const uint32_t SMESH_VERSION = 5;        // 格式或导入流程变化时递增，旧缓存自动失效
+
+struct SMeshHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t source_hash;
+
+    uint32_t vertex_format;       // VertexFormat::key()
+    uint32_t vertex_stride;       // 与 vertex_format 一致，不一致时拒绝加载
+    uint32_t mesh_count;
+    uint32_t texture_count;
+    uint32_t string_table_size;
+    uint32_t lod_count;
+
+    uint64_t records_offset;
+    uint64_t lods_offset;
+    uint64_t textures_offset;
+    uint64_t string_table_offset;
+    uint64_t vertex_data_offset;
+    uint64_t vertex_data_size;    // 字节
+    uint64_t index_data_offset;
+    uint64_t index_data_size;     // 字节
+
+    float bounds_min[3];
+    float bounds_max[3];
+    float sphere_center[3];
+    float sphere_radius;
+};
+
+struct SMeshRecord {
+    uint64_t vertex_offset;       // 在顶点段内的字节偏移
+    uint64_t index_offset;        // 在索引段内的字节偏移
+    uint32_t vertex_count;
+    uint32_t index_count;
+    uint32_t index_size;          // 2 或 4
+    uint32_t first_texture;
+    uint32_t texture_count;
+    uint32_t first_lod;
+    uint32_t lod_count;           // 至少为 1
+    uint32_t reserved;
+
+    float bounds_min[3];
+    float bounds_max[3];
+    float sphere_center[3];
+    float sphere_radius;
+
+    float node_transform[16];     // 所在 Assimp 节点到模型根节点的累积变换 (列主序)
+};
+
+struct SMeshLod {
+    uint32_t first_index;         // 相对于所在子网格的索引起点
+    uint32_t index_count;
+    float    error;
+    uint32_t reserved;
+};
+
+struct SMeshTexture {
+    uint32_t type_offset;
+    uint32_t type_length;
+    uint32_t path_offset;
+    uint32_t path_length;
+};
+
+// 导入阶段的 CPU 端数据 (还没有上传到 GPU)
+struct MeshTextureRef {
+    std::string type; // "texture_diffuse" / "texture_specular" / "texture_normal"
+    std::string path; // 相对于模型目录的路径
+};
+
+// 顶点和索引已经按导入时选定的 VertexFormat 打包，可以直接上传或写入缓存
+struct MeshData {
+    std::vector<uint8_t>        vertexData;
+    std::vector<uint8_t>        indexData;
+    unsigned int vertexCount = 0;
+    unsigned int indexCount = 0;      // 所有 LOD 级别的索引总数
+    unsigned int indexSize = 4;
+    std::vector<MeshLod>        lods; // 至少一级
+    std::vector<MeshTextureRef> textures;
+    AABB           bounds;        // 网格自身坐标系下的包围体 (不含节点变换)
+    BoundingSphere boundingSphere;
+    glm::mat4      nodeTransform = glm::mat4(1.0f); // 所在节点到模型根节点的累积变换
+};
+
+// 文件里的包围体 <-> 运行时结构
+inline AABB read_aabb(const float* min, const float* max)
+{
+    AABB box;
+    box.min = glm::vec3(min[0], min[1], min[2]);
+    box.max = glm::vec3(max[0], max[1], max[2]);
+    return box;
+}
+
+inline BoundingSphere read_bounding_sphere(const float* center, float radius)
+{
+    BoundingSphere sphere;
+    sphere.center = glm::vec3(center[0], center[1], center[2]);
+    sphere.radius = radius;
+    return sphere;
+}
+
+inline glm::mat4 read_matrix(const float* values)
+{
+    glm::mat4 matrix;
+    for (int column = 0; column < 4; column++)
+        matrix[column] = glm::vec4(values[column * 4], values[column * 4 + 1], values[column * 4 + 2], values[column * 4 + 3]);
+    return matrix;
+}
+
+// 源文件内容 + 导入参数 + 顶点格式的 64 位哈希 (FNV-1a)，源文件无法读取时返回 0
+uint64_t hash_source_file(const std::string& path, uint32_t import_flags, const VertexFormat& format);
+
+// 把导入结果写成 .smesh 文件，成功返回 true
+bool write_cooked_model(const std::string& path, uint64_t source_hash, const VertexFormat& format,
+                        const std::vector<MeshData>& meshes, const AABB& bounds, const BoundingSphere& bounding_sphere);
+
+// 只读的 .smesh 视图：打开时校验头部和所有段的范围，之后的访问都直接指向映射内存
+class CookedModelFile
+{
+public:
+    // 打开并校验，expected_hash 不匹配 (缓存过期) 时返回 false
+    bool open(const std::string& path, uint64_t expected_hash);
+    void close() { file.close(); header = nullptr; }
+
+    const SMeshHeader& get_header() const { return *header; }
+    const VertexFormat& get_vertex_format() const { return format; }
+    unsigned int get_mesh_count() const { return header->mesh_count; }
+    const SMeshRecord& get_mesh(unsigned int index) const { return records[index]; }
+
+    const uint8_t* get_vertex_data(const SMeshRecord& mesh) const { return vertices + mesh.vertex_offset; }
+    const uint8_t* get_index_data(const SMeshRecord& mesh) const { return indices + mesh.index_offset; }
+
+    // 子网格的 LOD 链
+    std::vector<MeshLod> get_lods(const SMeshRecord& mesh) const;
+
+    std::string_view get_texture_type(unsigned int index) const;
+    std::string_view get_texture_path(unsigned int index) const;
+
+private:
+    MappedFile file;
+    const SMeshHeader*  header = nullptr;
+    const SMeshRecord*  records = nullptr;
+    const SMeshLod*     lods = nullptr;
+    const SMeshTexture* textures = nullptr;
+    const char*         strings = nullptr;
+    const uint8_t*      vertices = nullptr;
+    const uint8_t*      indices = nullptr;
+    VertexFormat        format;
+};
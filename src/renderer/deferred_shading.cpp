@@ -0,0 +1,135 @@
+#include "../renderer/deferred_shading.h"
+#include "../core/profiler.h"
+
+#include <iostream>
+
+namespace {
+    // 用于 G-buffer 的 2D 纹理：最近点采样 (光照阶段按像素一一对应地读取)
+    unsigned int create_target(GLint internal_format, int width, int height, GLenum format, GLenum type)
+    {
+        unsigned int texture = 0;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, internal_format, width, height, 0, format, type, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        return texture;
+    }
+
+    // 每像素的字节数：RGBA8 + RG16F + DEPTH24_STENCIL8
+    const std::size_t GBUFFER_BYTES_PER_PIXEL = 4 + 4 + 4;
+}
+
+DeferredShading::DeferredShading()
+{
+    glGenVertexArrays(1, &fullscreen_vao);
+}
+
+DeferredShading::~DeferredShading()
+{
+    destroy_targets();
+    glDeleteVertexArrays(1, &fullscreen_vao);
+}
+
+void DeferredShading::create_targets(int width, int height)
+{
+    destroy_targets();
+
+    albedo_texture = create_target(GL_RGBA8, width, height, GL_RGBA, GL_UNSIGNED_BYTE);
+    normal_texture = create_target(GL_RG16F, width, height, GL_RG, GL_HALF_FLOAT);
+    depth_texture = create_target(GL_DEPTH24_STENCIL8, width, height, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8);
+
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, albedo_texture, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, normal_texture, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, depth_texture, 0);
+    GLenum draw_buffers[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+    glDrawBuffers(2, draw_buffers);
+
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "ERROR::DEFERRED_SHADING::INCOMPLETE_FRAMEBUFFER: 0x" << std::hex << status << std::dec << std::endl;
+    glBindFramebuffer(GL_FRAMEBUFFER, previous_fbo);
+
+    stats.width = width;
+    stats.height = height;
+    stats.gbuffer_bytes = static_cast<std::size_t>(width) * height * GBUFFER_BYTES_PER_PIXEL;
+}
+
+void DeferredShading::destroy_targets()
+{
+    if (fbo == 0)
+        return;
+    glDeleteFramebuffers(1, &fbo);
+    glDeleteTextures(1, &albedo_texture);
+    glDeleteTextures(1, &normal_texture);
+    glDeleteTextures(1, &depth_texture);
+    fbo = albedo_texture = normal_texture = depth_texture = 0;
+    stats.width = stats.height = 0;
+    stats.gbuffer_bytes = 0;
+}
+
+void DeferredShading::begin_geometry(int width, int height)
+{
+    // 记下调用方的帧缓冲和视口，end_geometry 时恢复
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previous_fbo);
+    glGetIntegerv(GL_VIEWPORT, previous_viewport);
+
+    if (width < 1) width = 1;
+    if (height < 1) height = 1;
+    if (fbo == 0 || width != stats.width || height != stats.height)
+        create_targets(width, height);
+    stats.active = true;
+
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fbo);
+    glViewport(0, 0, width, height);
+
+    // 按附件清空，不改动调用方的清屏颜色；法线清成 0 (光照阶段本来就会丢弃背景像素)
+    const float zero[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    glClearBufferfv(GL_COLOR, 0, zero);
+    glClearBufferfv(GL_COLOR, 1, zero);
+    glClearBufferfi(GL_DEPTH_STENCIL, 0, 1.0f, 0);
+}
+
+void DeferredShading::end_geometry()
+{
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, previous_fbo);
+    glViewport(previous_viewport[0], previous_viewport[1], previous_viewport[2], previous_viewport[3]);
+}
+
+void DeferredShading::draw_lighting(Shader& lighting_shader, const glm::mat4& view_projection)
+{
+    PROFILE_SCOPE("Deferred Lighting");
+
+    lighting_shader.use();
+    lighting_shader.setMat4("inverseViewProjection", glm::inverse(view_projection));
+
+    glActiveTexture(GL_TEXTURE0 + ALBEDO_UNIT);
+    glBindTexture(GL_TEXTURE_2D, albedo_texture);
+    glActiveTexture(GL_TEXTURE0 + NORMAL_UNIT);
+    glBindTexture(GL_TEXTURE_2D, normal_texture);
+    glActiveTexture(GL_TEXTURE0 + DEPTH_UNIT);
+    glBindTexture(GL_TEXTURE_2D, depth_texture);
+    glActiveTexture(GL_TEXTURE0);
+
+    // 着色器把 G-buffer 的深度写到 gl_FragDepth：深度测试总是通过，相当于顺便复制了深度缓冲
+    // (比 glBlitFramebuffer 少一次拷贝，也不要求两边的深度格式一致)
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_ALWAYS);
+    glBindVertexArray(fullscreen_vao);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+    glDepthFunc(GL_LESS);
+}
+
+void DeferredShading::setup_shader(Shader& shader)
+{
+    shader.use();
+    shader.setInt("gAlbedo", ALBEDO_UNIT);
+    shader.setInt("gNormal", NORMAL_UNIT);
+    shader.setInt("gDepth", DEPTH_UNIT);
+}
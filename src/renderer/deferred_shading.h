@@ -0,0 +1,74 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+
+#include "../renderer/shader.h"
+
+// 延迟渲染的统计
+struct DeferredStats {
+    bool active = false;            // 上一帧是否走了延迟渲染
+    int width = 0;                  // G-buffer 尺寸 (跟随视口)
+    int height = 0;
+    std::size_t gbuffer_bytes = 0;  // G-buffer 占用的显存
+};
+
+// DeferredShading：延迟渲染的 G-buffer 和屏幕空间光照
+//
+// 几何阶段只把表面属性写进一个紧凑的 G-buffer (每像素 12 字节)：
+//   albedo:  RGBA8，rgb = 漫反射颜色，a = 镜面强度 (镜面贴图的亮度)
+//   normal:  RG16F，八面体编码的世界空间法线
+//   depth:   DEPTH24_STENCIL8 纹理，光照阶段用逆 Projection * View 重建世界坐标，不单独存位置
+// 光照阶段画一个覆盖全屏的三角形，每个像素只计算一次光照，几何阶段的 overdraw 不再重复计算光照；
+// 点光源和聚光灯按分簇光照的屏幕格子 / 深度切片挑选 (见 light_clusters.h)，关闭分簇时退回固定的 4 个点光源。
+// 光照着色器同时把 G-buffer 的深度写进当前帧缓冲，之后的前向绘制 (半透明、灯泡) 仍然能和场景做深度测试。
+class DeferredShading
+{
+public:
+    // G-buffer 固定占用的纹理单元 (在阴影贴图之后)
+    static const int ALBEDO_UNIT = 12;
+    static const int NORMAL_UNIT = 13;
+    static const int DEPTH_UNIT = 14;
+
+    DeferredShading();
+    ~DeferredShading();
+
+    // 禁止拷贝，防止重复删除 GL 对象
+    DeferredShading(const DeferredShading&) = delete;
+    DeferredShading& operator=(const DeferredShading&) = delete;
+
+    // 开始几何阶段：G-buffer 按需 (重新) 创建成 width x height，绑定并清空
+    // 之后用 G-buffer 着色器 (gbuffer_fragment.glsl) 绘制不透明物体
+    void begin_geometry(int width, int height);
+    // 结束几何阶段，恢复调用 begin_geometry 之前的帧缓冲和视口
+    void end_geometry();
+
+    // 光照阶段：把 G-buffer 绑定到固定的纹理单元，用 lighting_shader 画全屏三角形到当前帧缓冲
+    // 背景像素 (深度为 1) 被丢弃，保留清屏颜色
+    void draw_lighting(Shader& lighting_shader, const glm::mat4& view_projection);
+
+    // 设置光照 Shader 里的 G-buffer 采样器 (gAlbedo / gNormal / gDepth)，每个 Shader 链接后调用一次
+    static void setup_shader(Shader& shader);
+
+    // 本帧没有走延迟渲染 (统计里的 active 置为 false)
+    void mark_inactive() { stats.active = false; }
+
+    const DeferredStats& get_stats() const { return stats; }
+
+private:
+    void create_targets(int width, int height);
+    void destroy_targets();
+
+    unsigned int fbo = 0;
+    unsigned int albedo_texture = 0;
+    unsigned int normal_texture = 0;
+    unsigned int depth_texture = 0;
+    unsigned int fullscreen_vao = 0;   // 空的 VAO，全屏三角形的顶点由 gl_VertexID 生成
+
+    // begin_geometry 之前的帧缓冲和视口
+    GLint previous_fbo = 0;
+    GLint previous_viewport[4] = {};
+
+    DeferredStats stats;
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <vector>
+
+// Framebuffer：离屏渲染目标
+// 一个 RGBA8 颜色纹理 + 一个 24 位深度 / 8 位模板的 Renderbuffer
+class Framebuffer
+{
+public:
+    Framebuffer(int width, int height);
+    ~Framebuffer();
+
+    // 禁止拷贝，防止两个对象重复删除同一组 GL 对象
+    Framebuffer(const Framebuffer&) = delete;
+    Framebuffer& operator=(const Framebuffer&) = delete;
+
+    // 创建是否成功 (附件组合被驱动接受)
+    bool is_complete() const { return complete; }
+
+    // 绑定为绘制目标并把视口设为整个附件
+    void bind() const;
+    // 切回默认帧缓冲 (窗口)
+    static void unbind();
+
+    // 读回颜色附件 (RGBA8，按行自下而上)，会等待 GPU 画完
+    std::vector<uint8_t> read_pixels() const;
+
+    unsigned int get_id() const { return fbo; }
+    unsigned int get_color_texture() const { return color_texture; }
+    int get_width() const { return width; }
+    int get_height() const { return height; }
+
+private:
+    unsigned int fbo = 0;
+    unsigned int color_texture = 0;
+    unsigned int depth_stencil = 0;
+    int width = 0;
+    int height = 0;
+    bool complete = false;
+};
@@ -0,0 +1,163 @@
+#include "../renderer/frustum_culler.h"
+
+#include <cmath>
+
+// 检测 SSE 支持：x64 平台一定有 SSE2
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define SHADOW_CULL_SSE 1
+    #include <emmintrin.h>
+#else
+    #define SHADOW_CULL_SSE 0
+#endif
+
+void FrustumCuller::clear()
+{
+    count = 0;
+    center_x.clear(); center_y.clear(); center_z.clear();
+    extent_x.clear(); extent_y.clear(); extent_z.clear();
+    visible_indices.clear();
+    stats = CullingStats();
+}
+
+uint32_t FrustumCuller::add(const AABB& local_bounds, const glm::mat4& model)
+{
+    return add(local_bounds.transformed(model));
+}
+
+uint32_t FrustumCuller::add(const AABB& world_bounds)
+{
+    glm::vec3 c = world_bounds.center();
+    glm::vec3 e = world_bounds.extents();
+
+    center_x.push_back(c.x); center_y.push_back(c.y); center_z.push_back(c.z);
+    extent_x.push_back(e.x); extent_y.push_back(e.y); extent_z.push_back(e.z);
+
+    return count++;
+}
+
+unsigned int FrustumCuller::cull(const Frustum& frustum)
+{
+    visible.resize(count);
+    visible_indices.clear();
+
+    unsigned int visible_count = cull_aabbs(frustum,
+                                            center_x.data(), center_y.data(), center_z.data(),
+                                            extent_x.data(), extent_y.data(), extent_z.data(),
+                                            count, visible.data());
+
+    visible_indices.reserve(visible_count);
+    for (uint32_t i = 0; i < count; i++) {
+        if (visible[i])
+            visible_indices.push_back(i);
+    }
+
+    stats.tested = count;
+    stats.visible = visible_count;
+    return visible_count;
+}
+
+unsigned int FrustumCuller::cull_aabbs(const Frustum& frustum,
+                                       const float* cx, const float* cy, const float* cz,
+                                       const float* ex, const float* ey, const float* ez,
+                                       unsigned int count, uint8_t* out_visible)
+{
+    unsigned int visible_count = 0;
+    unsigned int i = 0;
+
+#if SHADOW_CULL_SSE
+    // 把 6 个平面预先展开到寄存器：法线分量、绝对值、常数项
+    __m128 nx[Frustum::PLANE_COUNT], ny[Frustum::PLANE_COUNT], nz[Frustum::PLANE_COUNT], nw[Frustum::PLANE_COUNT];
+    __m128 ax[Frustum::PLANE_COUNT], ay[Frustum::PLANE_COUNT], az[Frustum::PLANE_COUNT];
+    for (int p = 0; p < Frustum::PLANE_COUNT; p++) {
+        const glm::vec4& plane = frustum.planes[p];
+        nx[p] = _mm_set1_ps(plane.x);
+        ny[p] = _mm_set1_ps(plane.y);
+        nz[p] = _mm_set1_ps(plane.z);
+        nw[p] = _mm_set1_ps(plane.w);
+        ax[p] = _mm_set1_ps(std::abs(plane.x));
+        ay[p] = _mm_set1_ps(std::abs(plane.y));
+        az[p] = _mm_set1_ps(std::abs(plane.z));
+    }
+    const __m128 zero = _mm_setzero_ps();
+
+    // 一次处理 4 个包围盒
+    for (; i + 4 <= count; i += 4) {
+        __m128 x = _mm_loadu_ps(cx + i), y = _mm_loadu_ps(cy + i), z = _mm_loadu_ps(cz + i);
+        __m128 hx = _mm_loadu_ps(ex + i), hy = _mm_loadu_ps(ey + i), hz = _mm_loadu_ps(ez + i);
+
+        __m128 outside = _mm_setzero_ps();
+        for (int p = 0; p < Frustum::PLANE_COUNT; p++) {
+            // d = dot(n, c) + w ; r = dot(|n|, e) ; d + r < 0 则完全在平面外
+            __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx[p], x), _mm_mul_ps(ny[p], y)),
+                                  _mm_add_ps(_mm_mul_ps(nz[p], z), nw[p]));
+            __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax[p], hx), _mm_mul_ps(ay[p], hy)),
+                                  _mm_mul_ps(az[p], hz));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(d, r), zero));
+        }
+
+        int mask = _mm_movemask_ps(outside);
+        for (int k = 0; k < 4; k++) {
+            uint8_t v = (mask & (1 << k)) ? 0 : 1;
+            out_visible[i + k] = v;
+            visible_count += v;
+        }
+    }
+#endif
+
+    // 标量版本 (也负责处理 SIMD 剩下的尾部)
+    for (; i < count; i++) {
+        bool inside = true;
+        for (int p = 0; p < Frustum::PLANE_COUNT && inside; p++) {
+            const glm::vec4& plane = frustum.planes[p];
+            float d = plane.x * cx[i] + plane.y * cy[i] + plane.z * cz[i] + plane.w;
+            float r = std::abs(plane.x) * ex[i] + std::abs(plane.y) * ey[i] + std::abs(plane.z) * ez[i];
+            inside = d + r >= 0.0f;
+        }
+        out_visible[i] = inside ? 1 : 0;
+        visible_count += inside ? 1 : 0;
+    }
+
+    return visible_count;
+}
+
+unsigned int FrustumCuller::cull_spheres(const Frustum& frustum,
+                                         const float* cx, const float* cy, const float* cz,
+                                         const float* radius, unsigned int count, uint8_t* out_visible)
+{
+    unsigned int visible_count = 0;
+    unsigned int i = 0;
+
+#if SHADOW_CULL_SSE
+    for (; i + 4 <= count; i += 4) {
+        __m128 x = _mm_loadu_ps(cx + i), y = _mm_loadu_ps(cy + i), z = _mm_loadu_ps(cz + i);
+        __m128 neg_r = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(radius + i));
+
+        __m128 outside = _mm_setzero_ps();
+        for (int p = 0; p < Frustum::PLANE_COUNT; p++) {
+            const glm::vec4& plane = frustum.planes[p];
+            __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.x), x), _mm_mul_ps(_mm_set1_ps(plane.y), y)),
+                                  _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.z), z), _mm_set1_ps(plane.w)));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(d, neg_r));
+        }
+
+        int mask = _mm_movemask_ps(outside);
+        for (int k = 0; k < 4; k++) {
+            uint8_t v = (mask & (1 << k)) ? 0 : 1;
+            out_visible[i + k] = v;
+            visible_count += v;
+        }
+    }
+#endif
+
+    for (; i < count; i++) {
+        bool inside = true;
+        for (int p = 0; p < Frustum::PLANE_COUNT && inside; p++) {
+            const glm::vec4& plane = frustum.planes[p];
+            inside = plane.x * cx[i] + plane.y * cy[i] + plane.z * cz[i] + plane.w >= -radius[i];
+        }
+        out_visible[i] = inside ? 1 : 0;
+        visible_count += inside ? 1 : 0;
+    }
+
+    return visible_count;
+}
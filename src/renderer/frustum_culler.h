@@ -0,0 +1,64 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+#include "../scene/bounds.h"
+
+// 每帧的剔除统计
+struct CullingStats {
+    unsigned int tested = 0;   // 参与测试的物体数
+    unsigned int visible = 0;  // 通过测试的物体数
+};
+
+// FrustumCuller：批量视锥剔除
+//
+// 物体的世界空间包围盒以 SoA (Structure of Arrays) 形式存放：
+// 中心 x/y/z 和半长 x/y/z 各占一个连续数组。
+// 这样一次可以把 4 个物体装进一组 SSE 寄存器，同时和一个平面做测试；
+// 不支持 SSE 的平台自动退回标量版本，结果完全一致
+class FrustumCuller
+{
+public:
+    // 清空本帧提交的包围盒
+    void clear();
+
+    // 添加一个物体：局部包围盒 + 模型矩阵 (内部变换到世界空间)
+    // 返回物体在本批次中的下标
+    uint32_t add(const AABB& local_bounds, const glm::mat4& model);
+
+    // 添加一个已经在世界空间的包围盒
+    uint32_t add(const AABB& world_bounds);
+
+    // 对所有物体执行剔除，返回可见数量
+    unsigned int cull(const Frustum& frustum);
+
+    // 查询结果 (cull 之后有效)
+    bool is_visible(uint32_t index) const { return visible[index] != 0; }
+    const std::vector<uint32_t>& get_visible_indices() const { return visible_indices; }
+    unsigned int size() const { return count; }
+    const CullingStats& get_stats() const { return stats; }
+
+    // 底层批量接口：对 SoA 数组做测试，结果写入 out_visible (1 可见 / 0 剔除)
+    // 数组长度至少为 count，返回可见数量
+    static unsigned int cull_aabbs(const Frustum& frustum,
+                                   const float* center_x, const float* center_y, const float* center_z,
+                                   const float* extent_x, const float* extent_y, const float* extent_z,
+                                   unsigned int count, uint8_t* out_visible);
+
+    static unsigned int cull_spheres(const Frustum& frustum,
+                                     const float* center_x, const float* center_y, const float* center_z,
+                                     const float* radius, unsigned int count, uint8_t* out_visible);
+
+private:
+    unsigned int count = 0;
+
+    // 世界空间包围盒 (SoA)
+    std::vector<float> center_x, center_y, center_z;
+    std::vector<float> extent_x, extent_y, extent_z;
+
+    std::vector<uint8_t>  visible;
+    std::vector<uint32_t> visible_indices;
+
+    CullingStats stats;
+};
@@ -0,0 +1,411 @@
+#include "geometry_arena.h"
+#include "stream_buffer.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace {
+    uint32_t align_up(uint32_t value, uint32_t alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// RangeAllocator
+// ---------------------------------------------------------------------------
+
+RangeAllocator::RangeAllocator(uint32_t capacity)
+    : capacity(capacity), free_total(capacity)
+{
+    if (capacity > 0)
+        free_blocks[0] = capacity;
+}
+
+uint32_t RangeAllocator::allocate(uint32_t size, uint32_t alignment)
+{
+    if (size == 0 || size > free_total)
+        return INVALID;
+
+    // 最佳适配：放得下的空闲块中浪费最少的
+    auto best = free_blocks.end();
+    uint32_t best_waste = ~0u;
+    for (auto it = free_blocks.begin(); it != free_blocks.end(); ++it) {
+        uint32_t start = align_up(it->first, alignment);
+        uint32_t end = it->first + it->second;
+        if (start + size > end)
+            continue;
+        uint32_t waste = it->second - size;
+        if (waste < best_waste) {
+            best = it;
+            best_waste = waste;
+            if (waste == 0)
+                break;
+        }
+    }
+    if (best == free_blocks.end())
+        return INVALID;
+
+    uint32_t block_offset = best->first;
+    uint32_t block_end = best->first + best->second;
+    uint32_t start = align_up(block_offset, alignment);
+    free_blocks.erase(best);
+
+    // 对齐留下的前缀和用剩的后缀依然是空闲块
+    if (start > block_offset)
+        free_blocks[block_offset] = start - block_offset;
+    if (start + size < block_end)
+        free_blocks[start + size] = block_end - (start + size);
+
+    free_total -= size;
+    return start;
+}
+
+void RangeAllocator::free(uint32_t offset, uint32_t size)
+{
+    if (size == 0)
+        return;
+    free_total += size;
+
+    // 与后一个空闲块合并
+    auto next = free_blocks.lower_bound(offset);
+    if (next != free_blocks.end() && next->first == offset + size) {
+        size += next->second;
+        next = free_blocks.erase(next);
+    }
+
+    // 与前一个空闲块合并
+    if (next != free_blocks.begin()) {
+        auto previous = std::prev(next);
+        if (previous->first + previous->second == offset) {
+            previous->second += size;
+            return;
+        }
+    }
+    free_blocks[offset] = size;
+}
+
+void RangeAllocator::reset(uint32_t used)
+{
+    free_blocks.clear();
+    free_total = capacity - used;
+    if (free_total > 0)
+        free_blocks[used] = free_total;
+}
+
+uint32_t RangeAllocator::get_largest_free() const
+{
+    uint32_t largest = 0;
+    for (const auto& [offset, size] : free_blocks)
+        largest = std::max(largest, size);
+    return largest;
+}
+
+float RangeAllocator::get_fragmentation() const
+{
+    if (free_total == 0)
+        return 0.0f;
+    return 1.0f - static_cast<float>(get_largest_free()) / static_cast<float>(free_total);
+}
+
+// ---------------------------------------------------------------------------
+// GeometryArena
+// ---------------------------------------------------------------------------
+
+GeometryArena::GeometryArena(std::size_t page_vertex_bytes, std::size_t page_index_bytes)
+    : page_vertex_bytes(page_vertex_bytes), page_index_bytes(page_index_bytes)
+{
+    glGenBuffers(1, &scratch_buffer);
+    glGenBuffers(1, &instance_buffer);
+    reserve_instances(64);
+
+    // MDI 需要 GL 4.3 (glMultiDrawElementsIndirect + 命令里的 base_instance)
+#ifdef GL_VERSION_4_3
+    multi_draw_indirect = GLAD_GL_VERSION_4_3 != 0;
+    if (multi_draw_indirect)
+        glGenBuffers(1, &indirect_buffer);
+#endif
+    stats.multi_draw_indirect = multi_draw_indirect;
+}
+
+GeometryArena::~GeometryArena()
+{
+    for (Page& page : pages) {
+        glDeleteVertexArrays(1, &page.vao);
+        glDeleteBuffers(1, &page.vertex_buffer);
+        glDeleteBuffers(1, &page.index_buffer);
+    }
+    glDeleteBuffers(1, &scratch_buffer);
+    glDeleteBuffers(1, &instance_buffer);
+    if (indirect_buffer != 0)
+        glDeleteBuffers(1, &indirect_buffer);
+}
+
+uint32_t GeometryArena::allocate(const VertexFormat& format, const void* vertex_data, uint32_t vertex_count,
+                                 const void* index_data, uint32_t index_bytes)
+{
+    if (vertex_count == 0)
+        return INVALID_HANDLE;
+
+    // -> 先在已有的同格式页里找，放不下再开新页
+    GeometryRange range;
+    bool found = false;
+    for (uint32_t page = 0; page < pages.size() && !found; page++) {
+        if (pages[page].format == format)
+            found = allocate_in_page(page, vertex_count, index_bytes, range);
+    }
+    if (!found) {
+        uint32_t page = create_page(format, vertex_count, index_bytes);
+        found = allocate_in_page(page, vertex_count, index_bytes, range);
+        if (!found) {
+            std::cout << "ERROR::GEOMETRY_ARENA::ALLOCATION_FAILED: " << vertex_count << " vertices, " << index_bytes << " index bytes" << std::endl;
+            return INVALID_HANDLE;
+        }
+    }
+
+    // -> 上传 (使用 COPY_WRITE 绑定点，不影响当前 VAO 记录的 EBO)
+    const Page& page = pages[range.page];
+    std::size_t stride = page.format.stride();
+    glBindBuffer(GL_COPY_WRITE_BUFFER, page.vertex_buffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, std::size_t(range.base_vertex) * stride, std::size_t(vertex_count) * stride, vertex_data);
+    if (index_bytes > 0) {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, page.index_buffer);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, range.index_offset, index_bytes, index_data);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    uint32_t handle;
+    if (!free_handles.empty()) {
+        handle = free_handles.back();
+        free_handles.pop_back();
+        ranges[handle] = range;
+    }
+    else {
+        handle = static_cast<uint32_t>(ranges.size());
+        ranges.push_back(range);
+    }
+    return handle;
+}
+
+bool GeometryArena::allocate_in_page(uint32_t page_index, uint32_t vertex_count, uint32_t index_bytes, GeometryRange& range)
+{
+    Page& page = pages[page_index];
+    uint32_t base_vertex = page.vertices.allocate(vertex_count);
+    if (base_vertex == RangeAllocator::INVALID)
+        return false;
+
+    // 索引按 4 字节分配，16 位和 32 位索引可以混放，整理时也不会破坏对齐
+    uint32_t index_offset = 0;
+    if (index_bytes > 0) {
+        index_offset = page.indices.allocate(align_up(index_bytes, 4), 4);
+        if (index_offset == RangeAllocator::INVALID) {
+            page.vertices.free(base_vertex, vertex_count);
+            return false;
+        }
+    }
+
+    range.page = page_index;
+    range.base_vertex = base_vertex;
+    range.vertex_count = vertex_count;
+    range.index_offset = index_offset;
+    range.index_bytes = index_bytes;
+    range.live = true;
+    return true;
+}
+
+uint32_t GeometryArena::create_page(const VertexFormat& format, uint32_t vertex_count, uint32_t index_bytes)
+{
+    uint32_t stride = format.stride();
+    uint32_t vertex_capacity = std::max(static_cast<uint32_t>(page_vertex_bytes / stride), vertex_count);
+    uint32_t index_capacity = std::max(static_cast<uint32_t>(page_index_bytes), align_up(index_bytes, 4));
+
+    Page page;
+    page.format = format;
+    page.vertices = RangeAllocator(vertex_capacity);
+    page.indices = RangeAllocator(index_capacity);
+
+    glGenVertexArrays(1, &page.vao);
+    glGenBuffers(1, &page.vertex_buffer);
+    glGenBuffers(1, &page.index_buffer);
+
+    glBindVertexArray(page.vao);
+
+    glBindBuffer(GL_ARRAY_BUFFER, page.vertex_buffer);
+    glBufferData(GL_ARRAY_BUFFER, std::size_t(vertex_capacity) * stride, NULL, GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, page.index_buffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, index_capacity, NULL, GL_STATIC_DRAW);
+    setup_vertex_attributes(format);
+
+    // MDI 的实例属性 (与 InstancedMesh 相同的 location，普通着色器不读取它们)
+    InstancedMesh::bind_instance_attributes(instance_buffer, 0);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    pages.push_back(std::move(page));
+    return static_cast<uint32_t>(pages.size() - 1);
+}
+
+void GeometryArena::free(uint32_t handle)
+{
+    if (handle >= ranges.size() || !ranges[handle].live)
+        return;
+
+    GeometryRange& range = ranges[handle];
+    Page& page = pages[range.page];
+    page.vertices.free(range.base_vertex, range.vertex_count);
+    if (range.index_bytes > 0)
+        page.indices.free(range.index_offset, align_up(range.index_bytes, 4));
+
+    range.live = false;
+    free_handles.push_back(handle);
+}
+
+void GeometryArena::defragment(float threshold)
+{
+    for (uint32_t page = 0; page < pages.size(); page++) {
+        if (pages[page].vertices.get_fragmentation() > threshold || pages[page].indices.get_fragmentation() > threshold)
+            defragment_page(page);
+    }
+}
+
+void GeometryArena::defragment_page(uint32_t page_index)
+{
+    Page& page = pages[page_index];
+    uint32_t stride = page.format.stride();
+
+    std::vector<GeometryRange*> live;
+    for (GeometryRange& range : ranges) {
+        if (range.live && range.page == page_index)
+            live.push_back(&range);
+    }
+
+    // -> 顶点：按原来的顺序依次压到页首
+    std::sort(live.begin(), live.end(), [](const GeometryRange* a, const GeometryRange* b) { return a->base_vertex < b->base_vertex; });
+    std::vector<Move> moves;
+    uint32_t used_vertices = 0;
+    for (GeometryRange* range : live) {
+        moves.push_back({ range->base_vertex * stride, used_vertices * stride, range->vertex_count * stride });
+        range->base_vertex = used_vertices;
+        used_vertices += range->vertex_count;
+    }
+    move_ranges(page.vertex_buffer, moves, used_vertices * stride);
+    page.vertices.reset(used_vertices);
+
+    // -> 索引 (每段按 4 字节占位，压缩后依然对齐)
+    std::sort(live.begin(), live.end(), [](const GeometryRange* a, const GeometryRange* b) { return a->index_offset < b->index_offset; });
+    moves.clear();
+    uint32_t used_indices = 0;
+    for (GeometryRange* range : live) {
+        if (range->index_bytes == 0)
+            continue;
+        uint32_t size = align_up(range->index_bytes, 4);
+        moves.push_back({ range->index_offset, used_indices, size });
+        range->index_offset = used_indices;
+        used_indices += size;
+    }
+    move_ranges(page.index_buffer, moves, used_indices);
+    page.indices.reset(used_indices);
+
+    stats.defragmentations++;
+    stats.moved_bytes += std::size_t(used_vertices) * stride + used_indices;
+}
+
+void GeometryArena::move_ranges(unsigned int buffer, const std::vector<Move>& moves, uint32_t used_bytes)
+{
+    if (used_bytes == 0)
+        return;
+
+    // 同一个缓冲内重叠区域的 glCopyBufferSubData 是未定义的，所以先压缩到临时缓冲再整体拷回
+    glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, scratch_buffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, used_bytes, NULL, GL_STREAM_COPY);
+    for (const Move& move : moves)
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, move.from, move.to, move.size);
+
+    glBindBuffer(GL_COPY_READ_BUFFER, scratch_buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, used_bytes);
+
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void GeometryArena::reserve_instances(std::size_t count)
+{
+    if (count <= instance_capacity)
+        return;
+    while (instance_capacity < count)
+        instance_capacity = instance_capacity > 0 ? instance_capacity * 2 : 64;
+
+    // 缓冲对象不变 (只重新分配存储)，各页 VAO 里记录的属性依然有效
+    glBindBuffer(GL_COPY_WRITE_BUFFER, instance_buffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, instance_capacity * sizeof(InstanceData), NULL, GL_STREAM_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void GeometryArena::multi_draw(GLenum index_type, const std::vector<DrawElementsIndirectCommand>& commands,
+                               const std::vector<InstanceData>& instances)
+{
+#ifdef GL_VERSION_4_3
+    if (!multi_draw_indirect || commands.empty())
+        return;
+
+    std::size_t instance_bytes = instances.size() * sizeof(InstanceData);
+    std::size_t command_bytes = commands.size() * sizeof(DrawElementsIndirectCommand);
+
+    // -> 实例数据：优先写进环形缓冲，否则孤立池自己的实例缓冲后重新写入
+    // 实例属性每次都重新指向本批数据的位置 (调用方已经绑定了页的 VAO)
+    StreamRange instance_range = stream ? stream->write(instances.data(), instance_bytes) : StreamRange();
+    if (instance_range.valid()) {
+        InstancedMesh::bind_instance_attributes(instance_range.buffer, instance_range.offset);
+    }
+    else {
+        reserve_instances(instances.size());
+        glBindBuffer(GL_COPY_WRITE_BUFFER, instance_buffer);
+        glBufferData(GL_COPY_WRITE_BUFFER, instance_capacity * sizeof(InstanceData), NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, 0, instance_bytes, instances.data());
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        InstancedMesh::bind_instance_attributes(instance_buffer, 0);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // -> 命令缓冲 (同样优先使用环形缓冲，间接绘制的参数是缓冲内的偏移)
+    StreamRange command_range = stream ? stream->write(commands.data(), command_bytes, 4) : StreamRange();
+    const void* indirect = nullptr;
+    if (command_range.valid()) {
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, command_range.buffer);
+        indirect = reinterpret_cast<const void*>(static_cast<uintptr_t>(command_range.offset));
+    }
+    else {
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect_buffer);
+        if (commands.size() > indirect_capacity)
+            indirect_capacity = std::max<std::size_t>(commands.size(), indirect_capacity * 2);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, indirect_capacity * sizeof(DrawElementsIndirectCommand), NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, command_bytes, commands.data());
+    }
+
+    glMultiDrawElementsIndirect(GL_TRIANGLES, index_type, indirect, static_cast<GLsizei>(commands.size()), 0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+#else
+    (void)index_type;
+    (void)commands;
+    (void)instances;
+#endif
+}
+
+const GeometryArenaStats& GeometryArena::get_stats()
+{
+    stats.pages = static_cast<unsigned int>(pages.size());
+    stats.allocations = static_cast<unsigned int>(ranges.size() - free_handles.size());
+    stats.vertex_bytes_used = stats.vertex_bytes_capacity = 0;
+    stats.index_bytes_used = stats.index_bytes_capacity = 0;
+    for (const Page& page : pages) {
+        std::size_t stride = page.format.stride();
+        stats.vertex_bytes_capacity += std::size_t(page.vertices.get_capacity()) * stride;
+        stats.vertex_bytes_used += std::size_t(page.vertices.get_capacity() - page.vertices.get_free()) * stride;
+        stats.index_bytes_capacity += page.indices.get_capacity();
+        stats.index_bytes_used += page.indices.get_capacity() - page.indices.get_free();
+    }
+    return stats;
+}
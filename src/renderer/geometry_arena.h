@@ -0,0 +1,160 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "vertex_format.h"
+#include "instanced_mesh.h"
+
+class StreamBuffer;
+
+// 范围分配器：在 [0, capacity) 中分配连续的区间 (单位由使用者决定：顶点或字节)
+// 空闲块按偏移有序存放，分配使用最佳适配，释放时与相邻的空闲块合并
+class RangeAllocator
+{
+public:
+    static const uint32_t INVALID = ~0u;
+
+    explicit RangeAllocator(uint32_t capacity = 0);
+
+    // 分配 size 个单位，起点按 alignment 对齐，失败返回 INVALID
+    uint32_t allocate(uint32_t size, uint32_t alignment = 1);
+    void free(uint32_t offset, uint32_t size);
+
+    // 整理之后调用：前 used 个单位全部被占用，其余是一整块空闲
+    void reset(uint32_t used);
+
+    uint32_t get_capacity() const { return capacity; }
+    uint32_t get_free() const { return free_total; }
+    uint32_t get_largest_free() const;
+
+    // 碎片率：1 - 最大空闲块 / 空闲总量 (0 表示空闲空间是连续的)
+    float get_fragmentation() const;
+
+private:
+    uint32_t capacity;
+    uint32_t free_total;
+    std::map<uint32_t, uint32_t> free_blocks; // 偏移 -> 大小
+};
+
+// 一个网格在几何池中的位置
+struct GeometryRange {
+    uint32_t page = 0;
+    uint32_t base_vertex = 0;   // 页内的第一个顶点 (glDrawElementsBaseVertex 的 basevertex)
+    uint32_t vertex_count = 0;
+    uint32_t index_offset = 0;  // 页内索引缓冲的字节偏移 (4 字节对齐)
+    uint32_t index_bytes = 0;
+    bool live = false;
+};
+
+// 与 GL 的 DrawElementsIndirectCommand 布局一致
+struct DrawElementsIndirectCommand {
+    uint32_t count;
+    uint32_t instance_count;
+    uint32_t first_index;       // 以索引为单位
+    int32_t  base_vertex;
+    uint32_t base_instance;     // 实例属性从这里开始读 (每条命令一组模型矩阵)
+};
+
+struct GeometryArenaStats {
+    unsigned int pages = 0;
+    unsigned int allocations = 0;
+    std::size_t vertex_bytes_used = 0;
+    std::size_t vertex_bytes_capacity = 0;
+    std::size_t index_bytes_used = 0;
+    std::size_t index_bytes_capacity = 0;
+    uint64_t defragmentations = 0;    // 累计整理的页数
+    std::size_t moved_bytes = 0;      // 累计整理时搬运的字节数
+    bool multi_draw_indirect = false;
+};
+
+// GeometryArena：所有网格共用的几何池
+//
+// 顶点和索引从少数几个大缓冲里子分配，而不是每个网格各自一套 VAO/VBO/EBO。
+// 缓冲按 "页" 组织：一页 = 一种顶点格式的一个大 VBO + 一个大 IBO + 一个 VAO，
+// 同一页里的所有网格共用 VAO，用 glDrawElementsBaseVertex 按偏移绘制，排序后相邻的网格不需要切换 VAO。
+// 页一旦创建就不会重新分配 (放不下时开新页)，所以外部记录的 VAO/缓冲对象始终有效；
+// 整理碎片只改变页内的偏移，网格通过句柄在绘制时读取最新的位置。
+//
+// GL 4.3 可用时还支持 Multi-Draw-Indirect：同一页、同一材质的一批网格一次 glMultiDrawElementsIndirect 画完，
+// 模型矩阵作为实例属性 (与 InstancedMesh 相同的 location) 按 base_instance 读取。
+//
+// 只在 GL 线程上使用。
+class GeometryArena
+{
+public:
+    static const uint32_t INVALID_HANDLE = ~0u;
+
+    // 每页的默认大小 (单个网格更大时按需要开一个更大的页)
+    explicit GeometryArena(std::size_t page_vertex_bytes = 32u << 20, std::size_t page_index_bytes = 16u << 20);
+    ~GeometryArena();
+
+    GeometryArena(const GeometryArena&) = delete;
+    GeometryArena& operator=(const GeometryArena&) = delete;
+
+    // 分配并上传一个网格 (数据已经是 format 描述的 GPU 布局)，失败返回 INVALID_HANDLE
+    uint32_t allocate(const VertexFormat& format, const void* vertex_data, uint32_t vertex_count,
+                      const void* index_data, uint32_t index_bytes);
+    void free(uint32_t handle);
+
+    const GeometryRange& get_range(uint32_t handle) const { return ranges[handle]; }
+    unsigned int get_vao(uint32_t handle) const { return pages[ranges[handle].page].vao; }
+    unsigned int get_vertex_buffer(uint32_t handle) const { return pages[ranges[handle].page].vertex_buffer; }
+    unsigned int get_index_buffer(uint32_t handle) const { return pages[ranges[handle].page].index_buffer; }
+
+    // 整理碎片：碎片率超过 threshold 的页把存活的网格压缩到页首
+    void defragment(float threshold = 0.25f);
+
+    bool supports_multi_draw_indirect() const { return multi_draw_indirect; }
+
+    // 设置后 MDI 的实例数据和命令写进环形缓冲 (见 stream_buffer.h)，放不下时退回池自己的缓冲
+    void set_stream_buffer(StreamBuffer* ring) { stream = ring; }
+
+    // 一次 MDI 绘制 (调用方已经绑定了命令所在页的 VAO)
+    // instances[i] 是 base_instance 为 i 的命令使用的实例数据
+    void multi_draw(GLenum index_type, const std::vector<DrawElementsIndirectCommand>& commands,
+                    const std::vector<InstanceData>& instances);
+
+    const GeometryArenaStats& get_stats();
+
+private:
+    struct Page {
+        VertexFormat format;
+        unsigned int vao = 0;
+        unsigned int vertex_buffer = 0;
+        unsigned int index_buffer = 0;
+        RangeAllocator vertices; // 单位：顶点
+        RangeAllocator indices;  // 单位：字节
+    };
+
+    // 在页内分配，成功时填好 range
+    bool allocate_in_page(uint32_t page, uint32_t vertex_count, uint32_t index_bytes, GeometryRange& range);
+    uint32_t create_page(const VertexFormat& format, uint32_t vertex_count, uint32_t index_bytes);
+    void defragment_page(uint32_t page);
+
+    // 把 [offset, offset + size) 的内容按 moves 搬到新的位置 (通过临时缓冲，源和目标可以重叠)
+    struct Move { uint32_t from, to, size; };
+    void move_ranges(unsigned int buffer, const std::vector<Move>& moves, uint32_t used_bytes);
+
+    void reserve_instances(std::size_t count);
+
+    std::size_t page_vertex_bytes;
+    std::size_t page_index_bytes;
+
+    std::vector<Page> pages;
+    std::vector<GeometryRange> ranges;  // 句柄 -> 位置
+    std::vector<uint32_t> free_handles;
+
+    unsigned int scratch_buffer = 0;    // 整理碎片用的临时缓冲
+    unsigned int instance_buffer = 0;   // MDI 的实例数据 (所有页的 VAO 都挂着它)
+    unsigned int indirect_buffer = 0;   // MDI 的命令
+    std::size_t instance_capacity = 0;
+    std::size_t indirect_capacity = 0;
+    bool multi_draw_indirect = false;
+    StreamBuffer* stream = nullptr;
+
+    GeometryArenaStats stats;
+};
@@ -0,0 +1,122 @@
+#include "../renderer/instanced_mesh.h"
+#include "../renderer/stream_buffer.h"
+
+#include <cstddef>
+
+InstancedMesh::InstancedMesh(Mesh& mesh, unsigned int initial_capacity)
+    : mesh(mesh), vao(0), instance_vbo(0), capacity(initial_capacity > 0 ? initial_capacity : 1), uploaded_count(0)
+{
+    instances.reserve(capacity);
+
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &instance_vbo);
+
+    glBindVertexArray(vao);
+
+    // 顶点数据直接复用原 Mesh 的 VBO/EBO
+    mesh.bindVertexBuffers();
+
+    // 预先分配实例缓冲，后续每帧流式更新
+    glBindBuffer(GL_ARRAY_BUFFER, instance_vbo);
+    glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(InstanceData), NULL, GL_STREAM_DRAW);
+    bind_instance_attributes(instance_vbo, 0);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void InstancedMesh::bind_instance_attributes(unsigned int buffer, std::size_t offset)
+{
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+
+    // mat4 按列拆成 4 个 vec4 属性
+    for (unsigned int i = 0; i < 4; i++) {
+        unsigned int location = INSTANCE_MODEL_LOCATION + i;
+        glEnableVertexAttribArray(location);
+        glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+                              (void*)(offset + offsetof(InstanceData, model) + i * sizeof(glm::vec4)));
+        // 除数为 1：每个实例前进一次，而不是每个顶点
+        glVertexAttribDivisor(location, 1);
+    }
+
+    // 实例颜色
+    glEnableVertexAttribArray(INSTANCE_COLOR_LOCATION);
+    glVertexAttribPointer(INSTANCE_COLOR_LOCATION, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+                          (void*)(offset + offsetof(InstanceData, color)));
+    glVertexAttribDivisor(INSTANCE_COLOR_LOCATION, 1);
+}
+
+InstancedMesh::~InstancedMesh()
+{
+    glDeleteBuffers(1, &instance_vbo);
+    glDeleteVertexArrays(1, &vao);
+}
+
+void InstancedMesh::clear()
+{
+    instances.clear();
+}
+
+void InstancedMesh::add_instance(const glm::mat4& model, const glm::vec4& color)
+{
+    instances.push_back({ model, color });
+}
+
+void InstancedMesh::upload(StreamBuffer* ring)
+{
+    uploaded_count = static_cast<unsigned int>(instances.size());
+    if (uploaded_count == 0)
+        return;
+
+    // -> 环形缓冲：写进本帧的一段，VAO 里的实例属性指过去 (GL 3.3 没有 glBindVertexBuffer，只能重新设置指针)
+    if (ring) {
+        StreamRange range = ring->write(instances.data(), uploaded_count * sizeof(InstanceData));
+        if (range.valid()) {
+            glBindVertexArray(vao);
+            bind_instance_attributes(range.buffer, range.offset);
+            glBindVertexArray(0);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            streamed = true;
+            return;
+        }
+    }
+
+    // 上一帧指向了环形缓冲，先指回自己的实例缓冲
+    if (streamed) {
+        glBindVertexArray(vao);
+        bind_instance_attributes(instance_vbo, 0);
+        glBindVertexArray(0);
+        streamed = false;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, instance_vbo);
+
+    if (uploaded_count > capacity) {
+        // 容量不够：按 2 倍扩容，避免每帧都重新分配
+        while (capacity < uploaded_count)
+            capacity *= 2;
+        glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(InstanceData), instances.data(), GL_STREAM_DRAW);
+    } else {
+        // 缓冲孤立 (Orphaning)：先用 NULL 重新声明存储，驱动会给一块新内存，
+        // 这样就不用等 GPU 读完上一帧的数据，再写入本帧数据
+        glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(InstanceData), NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, uploaded_count * sizeof(InstanceData), instances.data());
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void InstancedMesh::Draw(Shader& shader)
+{
+    if (uploaded_count == 0)
+        return;
+
+    mesh.bindTextures(shader);
+    mesh.bindVertexDecode(shader);
+
+    glBindVertexArray(vao);
+    mesh.issueDrawCall(uploaded_count);
+    glBindVertexArray(0);
+
+    glActiveTexture(GL_TEXTURE0);
+}
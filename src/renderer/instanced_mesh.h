@@ -0,0 +1,73 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include "mesh.h"
+#include "shader.h"
+
+class StreamBuffer;
+
+// 实例属性在 Shader 中的 location 约定
+// mat4 会占用连续 4 个 location (每列一个 vec4)
+const unsigned int INSTANCE_MODEL_LOCATION = 3; // 3, 4, 5, 6
+const unsigned int INSTANCE_COLOR_LOCATION = 7;
+
+// 单个实例的数据 (紧凑排列，直接作为顶点缓冲上传)
+struct InstanceData {
+    glm::mat4 model;
+    glm::vec4 color;
+};
+
+// InstancedMesh：在一个普通 Mesh 之上叠加 "每实例" 数据
+// 所有实例的模型矩阵 (以及可选的颜色) 放在一个流式更新的顶点缓冲里，
+// 通过 glVertexAttribDivisor(…, 1) 让它们按实例而不是按顶点前进，
+// 最终一个 glDrawElementsInstanced/glDrawArraysInstanced 画出所有实例
+//
+// 它拥有自己的 VAO：顶点/索引缓冲与原 Mesh 共享，实例属性独立，
+// 因此多个 InstancedMesh 可以共享同一个 Mesh 而互不干扰
+class InstancedMesh
+{
+public:
+    // 本帧要绘制的实例 (CPU 端)，每帧 clear() 后重新填充
+    std::vector<InstanceData> instances;
+
+    // 构造函数：mesh 必须比 InstancedMesh 活得更久
+    InstancedMesh(Mesh& mesh, unsigned int initial_capacity = 64);
+
+    // 析构函数：释放实例缓冲和 VAO
+    ~InstancedMesh();
+
+    InstancedMesh(const InstancedMesh&) = delete;
+    InstancedMesh& operator=(const InstancedMesh&) = delete;
+
+    // 清空实例列表 (不释放内存)
+    void clear();
+
+    // 追加一个实例
+    void add_instance(const glm::mat4& model, const glm::vec4& color = glm::vec4(1.0f));
+
+    // 把 instances 上传到 GPU (每帧调用一次)
+    // 给出环形缓冲时写进它本帧的一段，实例属性直接指向那里；否则 (或放不下时) 孤立并更新自己的实例缓冲
+    void upload(StreamBuffer* ring = nullptr);
+
+    // 一次 Draw Call 绘制所有实例
+    // Shader 需要从 INSTANCE_MODEL_LOCATION 读取模型矩阵 (见 main_vertex_instanced.glsl)
+    void Draw(Shader& shader);
+
+    // 把实例属性 (location 3~7，布局为 InstanceData) 指向 buffer 的 offset 处 (调用前需要绑定 VAO)
+    // 几何池的 MDI 也用它让页的 VAO 读取每条命令的模型矩阵
+    static void bind_instance_attributes(unsigned int buffer, std::size_t offset);
+
+    const Mesh& get_mesh() const { return mesh; }
+    unsigned int get_vao() const { return vao; }
+    unsigned int get_instance_count() const { return uploaded_count; }
+
+private:
+    Mesh& mesh;
+    unsigned int vao;
+    unsigned int instance_vbo;
+    unsigned int capacity;        // 实例缓冲当前能容纳的实例数
+    unsigned int uploaded_count;  // 最近一次 upload() 上传的实例数
+    bool streamed = false;        // 实例属性当前是否指向环形缓冲
+};
@@ -0,0 +1,326 @@
+#include "../renderer/light_clusters.h"
+#include "../core/profiler.h"
+#include "../core/jobs.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+
+namespace {
+    // 每个光源在光源数据缓冲里占用的 texel 数
+    const unsigned int TEXELS_PER_LIGHT = 4;
+}
+
+ClusteredLighting::ClusteredLighting(unsigned int max_lights)
+    : cluster_ubo(sizeof(ClusterBlock), CLUSTER_BLOCK_BINDING)
+{
+    // 纹理缓冲的 texel 数量有上限 (规范保证至少 65536)
+    GLint max_texels = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &max_texels);
+    if (max_texels <= 0)
+        max_texels = 65536;
+
+    this->max_lights = std::min(max_lights, static_cast<unsigned int>(max_texels) / TEXELS_PER_LIGHT);
+    max_indices = static_cast<unsigned int>(max_texels);
+
+    create_texture_buffer(light_data, GL_RGBA32F);
+    create_texture_buffer(cluster_grid, GL_RG32UI);
+    create_texture_buffer(light_indices, GL_R32UI);
+
+    cluster_bounds.resize(CLUSTER_COUNT);
+    slice_pairs.resize(GRID_Z);
+    slice_indices.resize(GRID_Z);
+    grid.resize(CLUSTER_COUNT);
+}
+
+ClusteredLighting::~ClusteredLighting()
+{
+    for (TextureBuffer* target : { &light_data, &cluster_grid, &light_indices }) {
+        glDeleteTextures(1, &target->texture);
+        glDeleteBuffers(1, &target->buffer);
+    }
+}
+
+void ClusteredLighting::create_texture_buffer(TextureBuffer& target, GLenum format)
+{
+    glGenBuffers(1, &target.buffer);
+    glGenTextures(1, &target.texture);
+
+    // 先分配一个最小的缓冲，保证纹理视图始终有效
+    target.capacity = 16;
+    glBindBuffer(GL_TEXTURE_BUFFER, target.buffer);
+    glBufferData(GL_TEXTURE_BUFFER, target.capacity, NULL, GL_STREAM_DRAW);
+
+    glBindTexture(GL_TEXTURE_BUFFER, target.texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, format, target.buffer);
+
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void ClusteredLighting::upload_buffer(TextureBuffer& target, const void* data, std::size_t size)
+{
+    if (size == 0)
+        return;
+
+    glBindBuffer(GL_TEXTURE_BUFFER, target.buffer);
+
+    // 容量不够时按 2 倍扩容 (纹理视图引用的是缓冲对象，重新分配后不需要再调用 glTexBuffer)
+    while (target.capacity < size)
+        target.capacity *= 2;
+
+    // 每帧重新分配 (孤立旧缓冲)，避免等待 GPU 读完上一帧的数据
+    glBufferData(GL_TEXTURE_BUFFER, target.capacity, NULL, GL_STREAM_DRAW);
+    glBufferSubData(GL_TEXTURE_BUFFER, 0, size, data);
+
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void ClusteredLighting::update(const std::vector<LightSource>& lights,
+                               const glm::mat4& view, const glm::mat4& projection,
+                               float near_plane, float far_plane,
+                               float width, float height, const glm::vec3& ambient)
+{
+    bin(lights, view, projection, near_plane, far_plane, width, height, ambient);
+    upload();
+}
+
+void ClusteredLighting::bin(const std::vector<LightSource>& lights,
+                            const glm::mat4& view, const glm::mat4& projection,
+                            float near_plane, float far_plane,
+                            float width, float height, const glm::vec3& ambient)
+{
+    PROFILE_CPU_SCOPE("Light Binning");
+    stats = ClusterStats();
+
+    unsigned int light_count = static_cast<unsigned int>(lights.size());
+    if (light_count > max_lights) {
+        light_count = max_lights;
+        stats.overflow = true;
+    }
+    stats.lights = light_count;
+
+    // 对数深度切片: slice = log(depth) * scale + bias
+    // 近处的切片薄、远处的切片厚，与透视投影的精度分布一致
+    float log_ratio = std::log(far_plane / near_plane);
+    float new_slice_scale = GRID_Z / log_ratio;
+    float new_slice_bias = -static_cast<float>(GRID_Z) * std::log(near_plane) / log_ratio;
+
+    auto depth_to_slice = [&](float depth) {
+        float slice = std::log(std::max(depth, near_plane)) * new_slice_scale + new_slice_bias;
+        return std::clamp(static_cast<int>(std::floor(slice)), 0, static_cast<int>(GRID_Z) - 1);
+    };
+    auto ndc_to_tile = [](float ndc, unsigned int tiles) {
+        int tile = static_cast<int>(std::floor((ndc * 0.5f + 0.5f) * tiles));
+        return std::clamp(tile, 0, static_cast<int>(tiles) - 1);
+    };
+
+    // 投影或深度范围变化时才需要重新计算簇的包围盒
+    glm::vec4 new_projection_params(projection[0][0], projection[1][1], projection[2][0], projection[2][1]);
+    if (new_projection_params != projection_params || slice_scale != new_slice_scale || slice_bias != new_slice_bias) {
+        projection_params = new_projection_params;
+        slice_scale = new_slice_scale;
+        slice_bias = new_slice_bias;
+        compute_cluster_bounds();
+    }
+
+    // -> 计算每个光源的影响范围，并打包光源数据
+    light_bounds.resize(light_count);
+    light_texels.resize(static_cast<std::size_t>(light_count) * TEXELS_PER_LIGHT);
+
+    for (unsigned int i = 0; i < light_count; i++) {
+        const LightSource& light = lights[i];
+        float max_intensity = std::max(light.color.r, std::max(light.color.g, light.color.b));
+        float range = compute_light_range(light.constant, light.linear, light.quadratic, max_intensity);
+
+        glm::vec4* texels = &light_texels[static_cast<std::size_t>(i) * TEXELS_PER_LIGHT];
+        texels[0] = glm::vec4(light.position, range);
+        texels[1] = glm::vec4(light.color, light.is_spot ? 1.0f : 0.0f);
+        texels[2] = glm::vec4(glm::normalize(light.direction), light.cos_outer);
+        texels[3] = glm::vec4(light.constant, light.linear, light.quadratic, light.cos_inner);
+
+        LightBounds& bounds = light_bounds[i];
+        bounds = { glm::vec4(0.0f), 1, 0, 1, 0, 1, 0 }; // 空
+
+        // 观察空间里摄像机看向 -Z，深度取正值
+        glm::vec3 center = glm::vec3(view * glm::vec4(light.position, 1.0f));
+        float depth = -center.z;
+        if (range <= 0.0f || depth + range < near_plane || depth - range > far_plane)
+            continue;
+
+        // 先求一个保守的格子范围，分簇时再逐个簇做精确的球体测试
+        int x0 = 0, x1 = GRID_X - 1, y0 = 0, y1 = GRID_Y - 1;
+        if (depth - range > near_plane) {
+            // 把球的包围盒 8 个角投影到屏幕上，取覆盖的格子范围
+            // 球穿过近平面时投影不稳定，直接覆盖整个屏幕
+            glm::vec2 ndc_min(FLT_MAX), ndc_max(-FLT_MAX);
+            for (int corner = 0; corner < 8; corner++) {
+                glm::vec3 offset((corner & 1) ? range : -range,
+                                 (corner & 2) ? range : -range,
+                                 (corner & 4) ? range : -range);
+                glm::vec4 clip = projection * glm::vec4(center + offset, 1.0f);
+                glm::vec2 ndc = glm::vec2(clip) / clip.w;
+                ndc_min = glm::min(ndc_min, ndc);
+                ndc_max = glm::max(ndc_max, ndc);
+            }
+            if (ndc_max.x < -1.0f || ndc_min.x > 1.0f || ndc_max.y < -1.0f || ndc_min.y > 1.0f)
+                continue;
+
+            x0 = ndc_to_tile(ndc_min.x, GRID_X);
+            x1 = ndc_to_tile(ndc_max.x, GRID_X);
+            y0 = ndc_to_tile(ndc_min.y, GRID_Y);
+            y1 = ndc_to_tile(ndc_max.y, GRID_Y);
+        }
+
+        bounds = { glm::vec4(center, range), x0, x1, y0, y1, depth_to_slice(depth - range), depth_to_slice(depth + range) };
+        stats.binned_lights++;
+    }
+
+    // -> 每个深度切片独立分簇 (并行)
+    JobSystem::parallel_for(GRID_Z, 1, [this](unsigned int begin, unsigned int end) {
+        for (unsigned int z = begin; z < end; z++)
+            bin_slice(z);
+    });
+
+    // -> 合并：切片内偏移加上前面所有切片的索引数量，得到全局偏移
+    indices.clear();
+    uint32_t base = 0;
+    for (unsigned int z = 0; z < GRID_Z; z++) {
+        const std::vector<uint32_t>& local = slice_indices[z];
+        glm::uvec2* cells = &grid[z * GRID_X * GRID_Y];
+
+        for (unsigned int c = 0; c < GRID_X * GRID_Y; c++) {
+            glm::uvec2& cell = cells[c];
+            cell.x += base;
+            if (cell.x + cell.y > max_indices) {
+                // 索引缓冲装不下，截断这个簇的列表
+                cell.y = cell.x < max_indices ? max_indices - cell.x : 0;
+                stats.overflow = true;
+            }
+            if (cell.y > 0)
+                stats.occupied_clusters++;
+            stats.max_cluster_lights = std::max(stats.max_cluster_lights, cell.y);
+        }
+
+        std::size_t copy_count = std::min<std::size_t>(local.size(), max_indices - std::min(base, max_indices));
+        indices.insert(indices.end(), local.begin(), local.begin() + copy_count);
+        base += static_cast<uint32_t>(local.size());
+    }
+    stats.light_indices = static_cast<unsigned int>(indices.size());
+
+    cluster_block.grid_size = glm::uvec4(GRID_X, GRID_Y, GRID_Z, light_count);
+    cluster_block.screen_params = glm::vec4(width, height, slice_scale, slice_bias);
+    cluster_block.ambient = glm::vec4(ambient, 0.0f);
+}
+
+void ClusteredLighting::upload()
+{
+    PROFILE_SCOPE("Light Upload");
+    upload_buffer(light_data, light_texels.data(), light_texels.size() * sizeof(glm::vec4));
+    upload_buffer(cluster_grid, grid.data(), grid.size() * sizeof(glm::uvec2));
+    upload_buffer(light_indices, indices.data(), indices.size() * sizeof(uint32_t));
+
+    if (stream)
+        cluster_ubo.stream(*stream, cluster_block);
+    else
+        cluster_ubo.update(cluster_block);
+}
+
+void ClusteredLighting::compute_cluster_bounds()
+{
+    // 每个簇在观察空间的包围盒：格子的四个角分别取切片前后两个深度
+    for (unsigned int z = 0; z < GRID_Z; z++) {
+        float near_depth = std::exp((z - slice_bias) / slice_scale);
+        float far_depth = std::exp((z + 1 - slice_bias) / slice_scale);
+
+        for (unsigned int y = 0; y < GRID_Y; y++) {
+            for (unsigned int x = 0; x < GRID_X; x++) {
+                AABB& box = cluster_bounds[(z * GRID_Y + y) * GRID_X + x];
+                box = AABB();
+                for (int corner = 0; corner < 8; corner++) {
+                    float ndc_x = (x + (corner & 1)) * (2.0f / GRID_X) - 1.0f;
+                    float ndc_y = (y + ((corner >> 1) & 1)) * (2.0f / GRID_Y) - 1.0f;
+                    float depth = (corner & 4) ? far_depth : near_depth;
+                    // 透视投影的逆变换: ndc = (P00 * x + P20 * z) / -z
+                    box.expand(glm::vec3((ndc_x + projection_params.z) * depth / projection_params.x,
+                                         (ndc_y + projection_params.w) * depth / projection_params.y,
+                                         -depth));
+                }
+            }
+        }
+    }
+}
+
+void ClusteredLighting::bin_slice(unsigned int z)
+{
+    // 在任务系统的线程上运行：只写本切片的网格单元、配对列表和索引列表
+    const int slice = static_cast<int>(z);
+    const unsigned int tiles = GRID_X * GRID_Y;
+    glm::uvec2* cells = &grid[z * tiles];
+    std::vector<glm::uvec2>& pairs = slice_pairs[z];
+    std::vector<uint32_t>& out = slice_indices[z];
+
+    const AABB* slice_bounds = &cluster_bounds[z * tiles];
+
+    // 第一遍：球体与簇包围盒求交，记录 (簇, 光源) 配对并统计每个簇的光源数量
+    for (unsigned int c = 0; c < tiles; c++)
+        cells[c] = glm::uvec2(0u, 0u);
+    pairs.clear();
+
+    for (uint32_t i = 0; i < light_bounds.size(); i++) {
+        const LightBounds& bounds = light_bounds[i];
+        if (slice < bounds.z0 || slice > bounds.z1)
+            continue;
+        glm::vec3 center = glm::vec3(bounds.sphere);
+        float radius_sq = bounds.sphere.w * bounds.sphere.w;
+
+        for (int y = bounds.y0; y <= bounds.y1; y++) {
+            for (int x = bounds.x0; x <= bounds.x1; x++) {
+                unsigned int c = y * GRID_X + x;
+                // 球心到簇包围盒的最近距离
+                const AABB& box = slice_bounds[c];
+                float dx = std::max(std::max(box.min.x - center.x, center.x - box.max.x), 0.0f);
+                float dy = std::max(std::max(box.min.y - center.y, center.y - box.max.y), 0.0f);
+                float dz = std::max(std::max(box.min.z - center.z, center.z - box.max.z), 0.0f);
+                if (dx * dx + dy * dy + dz * dz > radius_sq)
+                    continue;
+                pairs.push_back(glm::uvec2(c, i));
+                cells[c].y++;
+            }
+        }
+    }
+
+    // 前缀和得到切片内偏移，数量清零后作为写入游标
+    uint32_t offset = 0;
+    for (unsigned int c = 0; c < tiles; c++) {
+        cells[c].x = offset;
+        offset += cells[c].y;
+        cells[c].y = 0;
+    }
+    out.resize(offset);
+
+    // 第二遍：按配对顺序写入光源下标 (光源按下标递增，结果与线程调度无关)
+    for (const glm::uvec2& pair : pairs) {
+        glm::uvec2& cell = cells[pair.x];
+        out[cell.x + cell.y++] = pair.y;
+    }
+}
+
+void ClusteredLighting::bind() const
+{
+    glActiveTexture(GL_TEXTURE0 + LIGHT_DATA_UNIT);
+    glBindTexture(GL_TEXTURE_BUFFER, light_data.texture);
+    glActiveTexture(GL_TEXTURE0 + CLUSTER_GRID_UNIT);
+    glBindTexture(GL_TEXTURE_BUFFER, cluster_grid.texture);
+    glActiveTexture(GL_TEXTURE0 + LIGHT_INDEX_UNIT);
+    glBindTexture(GL_TEXTURE_BUFFER, light_indices.texture);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void ClusteredLighting::setup_shader(Shader& shader)
+{
+    shader.use();
+    shader.setInt("lightData", LIGHT_DATA_UNIT);
+    shader.setInt("clusterGrid", CLUSTER_GRID_UNIT);
+    shader.setInt("lightIndices", LIGHT_INDEX_UNIT);
+}
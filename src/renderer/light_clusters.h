@@ -0,0 +1,129 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+#include "../scene/bounds.h"
+#include "../scene/light_params.h"
+#include "../renderer/shader.h"
+#include "../renderer/uniform_buffer.h"
+#include "../renderer/uniform_blocks.h"
+
+// 每帧的分簇统计
+struct ClusterStats {
+    unsigned int lights = 0;            // 提交的光源数量
+    unsigned int binned_lights = 0;     // 至少落进一个簇的光源数量
+    unsigned int light_indices = 0;     // 所有簇的光源索引总数
+    unsigned int occupied_clusters = 0; // 至少有一个光源的簇数量
+    unsigned int max_cluster_lights = 0;// 单个簇里最多的光源数量
+    bool overflow = false;              // 超出纹理缓冲容量，部分光源被丢弃
+};
+
+// ClusteredLighting：分簇前向渲染 (Clustered Forward)
+//
+// 把视锥体按屏幕 16x9 的格子、深度方向 24 个对数切片划分成三维网格 (簇)。
+// 每帧在 CPU 上把光源 (按衰减算出影响半径的球体) 分到它覆盖的簇里，
+// 深度切片之间互不依赖，通过任务系统并行处理 (见 core/jobs.h)。
+// 结果通过三个纹理缓冲 (Texture Buffer，GL 3.3 可用) 交给片段着色器：
+//   光源数据: RGBA32F，每个光源 4 个 texel
+//   簇网格:   RG32UI，每个簇 (索引偏移, 光源数量)
+//   光源索引: R32UI，所有簇的光源下标连续存放
+// 片段着色器根据 gl_FragCoord 和观察空间深度找到所在的簇，只计算影响这个簇的光源
+class ClusteredLighting
+{
+public:
+    // 网格尺寸
+    static const unsigned int GRID_X = 16;
+    static const unsigned int GRID_Y = 9;
+    static const unsigned int GRID_Z = 24;
+    static const unsigned int CLUSTER_COUNT = GRID_X * GRID_Y * GRID_Z;
+
+    // 纹理缓冲固定占用的纹理单元 (避开网格材质使用的低位单元)
+    static const int LIGHT_DATA_UNIT = 8;
+    static const int CLUSTER_GRID_UNIT = 9;
+    static const int LIGHT_INDEX_UNIT = 10;
+
+    // max_lights: 最多支持的光源数量 (还会受 GL_MAX_TEXTURE_BUFFER_SIZE 限制)
+    explicit ClusteredLighting(unsigned int max_lights = 4096);
+    ~ClusteredLighting();
+
+    // 禁止拷贝，防止重复删除 GL 对象
+    ClusteredLighting(const ClusteredLighting&) = delete;
+    ClusteredLighting& operator=(const ClusteredLighting&) = delete;
+
+    // 分簇并上传本帧的光源 (= bin + upload)
+    // view / projection: 摄像机矩阵; width / height: 视口尺寸 (与 gl_FragCoord 一致)
+    // ambient: 点光源的环境光颜色 (随衰减变化)
+    void update(const std::vector<LightSource>& lights,
+                const glm::mat4& view, const glm::mat4& projection,
+                float near_plane, float far_plane,
+                float width, float height, const glm::vec3& ambient);
+
+    // 只做 CPU 部分的分簇，不调用 GL，可以在任务系统的任意线程上执行
+    void bin(const std::vector<LightSource>& lights,
+             const glm::mat4& view, const glm::mat4& projection,
+             float near_plane, float far_plane,
+             float width, float height, const glm::vec3& ambient);
+    // 把 bin 的结果上传到纹理缓冲和 ClusterBlock (GL 线程)
+    void upload();
+
+    // 设置后 ClusterBlock 每帧写进环形缓冲 (见 stream_buffer.h)，不再 glBufferSubData
+    void set_stream_buffer(StreamBuffer* ring) { stream = ring; }
+
+    // 把三个纹理缓冲绑定到固定的纹理单元 (ClusterBlock 已经绑定在 CLUSTER_BLOCK_BINDING)
+    void bind() const;
+
+    // 设置 Shader 里的纹理缓冲采样器 (lightData / clusterGrid / lightIndices)
+    // 采样器的值属于 Program 状态，每个 Shader 链接后调用一次即可
+    static void setup_shader(Shader& shader);
+
+    const ClusterStats& get_stats() const { return stats; }
+    unsigned int get_max_lights() const { return max_lights; }
+
+private:
+    // 每个光源的观察空间球体，以及它在网格里可能覆盖的范围 (闭区间)，x0 > x1 表示不影响任何簇
+    struct LightBounds {
+        glm::vec4 sphere; // xyz = 观察空间中心, w = 影响半径
+        int x0, x1, y0, y1, z0, z1;
+    };
+
+    // 一个纹理缓冲：缓冲对象 + 纹理视图
+    struct TextureBuffer {
+        unsigned int buffer = 0;
+        unsigned int texture = 0;
+        std::size_t capacity = 0; // 字节
+    };
+
+    void create_texture_buffer(TextureBuffer& target, GLenum format);
+    void upload_buffer(TextureBuffer& target, const void* data, std::size_t size);
+    void compute_cluster_bounds();
+    void bin_slice(unsigned int z);
+
+    unsigned int max_lights = 0;
+    unsigned int max_indices = 0;
+
+    // 深度切片参数和投影参数 (P00, P11, P20, P21)，以及由它们算出的每个簇的观察空间包围盒
+    float slice_scale = 0.0f;
+    float slice_bias = 0.0f;
+    glm::vec4 projection_params = glm::vec4(0.0f);
+    std::vector<AABB> cluster_bounds;
+
+    TextureBuffer light_data;
+    TextureBuffer cluster_grid;
+    TextureBuffer light_indices;
+    UniformBuffer cluster_ubo;
+    ClusterBlock cluster_block;
+    StreamBuffer* stream = nullptr;
+
+    // 本帧的中间数据
+    std::vector<LightBounds> light_bounds;
+    std::vector<glm::vec4> light_texels;
+    std::vector<std::vector<glm::uvec2>> slice_pairs; // 每个深度切片的 (簇, 光源) 配对
+    std::vector<std::vector<uint32_t>> slice_indices; // 每个深度切片的局部索引列表
+    std::vector<glm::uvec2> grid;                     // (偏移, 数量)，先是切片内偏移，合并后变成全局偏移
+    std::vector<uint32_t> indices;
+
+    ClusterStats stats;
+};
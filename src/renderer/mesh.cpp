@@ -1,98 +1,229 @@
 ﻿#include "mesh.h"
+#include "geometry_arena.h"
+
+#include <algorithm>
 
 Mesh::Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<TextureInfo> textures)
 {
     this->vertices = vertices;
     this->indices = indices;
     this->textures = textures;
+    this->vertexCount = static_cast<unsigned int>(this->vertices.size());
+    this->indexCount = static_cast<unsigned int>(this->indices.size());
+    if (this->indexCount > 0)
+        this->lods.push_back({ 0, this->indexCount, 0.0f });
+
+    // 计算局部空间包围体，供视锥剔除使用
+    bounds = compute_aabb(this->vertices.data(), vertexCount, sizeof(Vertex));
+    boundingSphere = compute_bounding_sphere(this->vertices.data(), vertexCount, sizeof(Vertex), bounds);
+
+    buildSamplerNames();
 
     // 创建 Mesh 后立即建立缓冲区
-    setupMesh();
+    setupMesh(this->vertices.data(), this->indices.data());
 }
 
-void Mesh::setupMesh()
+Mesh::Mesh(const void* vertexData, unsigned int vertexCount, const VertexFormat& format,
+           const void* indexData, unsigned int indexCount, unsigned int indexSize,
+           std::vector<TextureInfo> textures, const AABB& bounds, const BoundingSphere& boundingSphere,
+           std::vector<MeshLod> lods, GeometryArena* arena)
 {
+    this->arena = arena;
+    this->textures = textures;
+    this->vertexCount = vertexCount;
+    this->indexCount = indexCount;
+    this->format = format;
+    this->indexSize = indexSize;
+    this->decode = make_vertex_decode(format, bounds);
+    this->bounds = bounds;
+    this->boundingSphere = boundingSphere;
+    this->lods = std::move(lods);
+    if (this->lods.empty() && indexCount > 0)
+        this->lods.push_back({ 0, indexCount, 0.0f });
+
+    buildSamplerNames();
+    setupMesh(vertexData, indexData);
+}
+
+void Mesh::buildSamplerNames()
+{
+    // 预先生成采样器名字
+    // 命名约定：material.texture_diffuse1, material.texture_specular1, ...
+    unsigned int diffuseNr = 1;
+    unsigned int specularNr = 1;
+    for (const TextureInfo& texture : this->textures)
+    {
+        std::string number;
+        const std::string& name = texture.type;
+
+        if (name == "texture_diffuse")
+            number = std::to_string(diffuseNr++);
+        else if (name == "texture_specular")
+            number = std::to_string(specularNr++);
+
+        samplerNames.push_back("material." + name + number);
+    }
+}
+
+void Mesh::setupMesh(const void* vertexData, const void* indexData)
+{
+    // 优先从几何池子分配：不创建自己的缓冲，VAO 使用池中同格式的那一个
+    if (arena != nullptr) {
+        geometry = arena->allocate(format, vertexData, vertexCount, indexData, indexCount * indexSize);
+        if (geometry != GeometryArena::INVALID_HANDLE) {
+            VAO = arena->get_vao(geometry);
+            return;
+        }
+        arena = nullptr;
+    }
+
     // 生成缓冲对象 ID
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
     // 如果有索引数据，才生成 EBO
-    if (!indices.empty()) {
+    if (indexCount > 0) {
         glGenBuffers(1, &EBO);
     }
 
     glBindVertexArray(VAO);
 
     // 绑定并填充 VBO
-    // 这里的关键是 &vertices[0]，直接获取 vector 内部数组的指针
+    // 数据已经是 format 描述的 GPU 布局，可以原样上传
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, vertexCount * format.stride(), vertexData, GL_STATIC_DRAW);
 
     // 绑定并填充 EBO (如果存在)
-    if (!indices.empty()) {
+    if (indexCount > 0) {
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * indexSize, indexData, GL_STATIC_DRAW);
     }
 
-    // 设置顶点属性指针
-    // 这里的 offsetof(Struct, Member) 是 C++ 的宏，能自动计算成员变量在结构体内的字节偏移量
-    // 极其方便，不用手动算 float 大小了
+    // 设置顶点属性指针，记录到 VAO 中
+    bindVertexBuffers();
 
-    // 位置 Position (Location = 0)
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+    // 解绑 VAO 防止意外修改
+    glBindVertexArray(0);
+}
 
-    // 法线 Normal (Location = 1)
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
+void Mesh::release()
+{
+    if (arena != nullptr) {
+        arena->free(geometry);
+        arena = nullptr;
+        VAO = 0;
+        return;
+    }
 
-    // 纹理坐标 TexCoords (Location = 2)
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
+    if (EBO != 0)
+        glDeleteBuffers(1, &EBO);
+    if (VBO != 0)
+        glDeleteBuffers(1, &VBO);
+    if (VAO != 0)
+        glDeleteVertexArrays(1, &VAO);
+    VAO = VBO = EBO = 0;
+}
 
-    // 解绑 VAO 防止意外修改
-    glBindVertexArray(0);
+void Mesh::bindVertexBuffers() const
+{
+    // 几何池中的网格绑定所在页的缓冲，绘制时用 basevertex 和索引偏移定位
+    glBindBuffer(GL_ARRAY_BUFFER, arena != nullptr ? arena->get_vertex_buffer(geometry) : VBO);
+
+    // EBO 的绑定是记录在 VAO 里的
+    if (indexCount > 0) {
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, arena != nullptr ? arena->get_index_buffer(geometry) : EBO);
+    }
+
+    // 设置顶点属性指针 (类型、分量数和偏移由顶点格式决定)
+    setup_vertex_attributes(format);
 }
 
-void Mesh::Draw(Shader& shader)
+void Mesh::bindTextures(Shader& shader) const
 {
     // 绑定纹理
     // 这里的逻辑是为了应对 Shader 中可能有多个漫反射/镜面光贴图的情况
-    // 命名约定：material.texture_diffuse1, material.texture_specular1, ...
-    unsigned int diffuseNr = 1;
-    unsigned int specularNr = 1;
-
     for (unsigned int i = 0; i < textures.size(); i++)
     {
         // 激活对应的纹理单元
         glActiveTexture(GL_TEXTURE0 + i);
 
-        std::string number;
-        std::string name = textures[i].type;
-
-        if (name == "texture_diffuse")
-            number = std::to_string(diffuseNr++);
-        else if (name == "texture_specular")
-            number = std::to_string(specularNr++);
-
-        // 设置 Shader 中的采样器 Uniform
-        // 最终拼接出类似 "material.texture_diffuse1" 的字符串
-        shader.setInt(("material." + name + number).c_str(), i);
+        // 设置 Shader 中的采样器 Uniform (名字在构造时已经生成好了)
+        shader.setInt(samplerNames[i], i);
 
         // 绑定纹理 ID
         glBindTexture(GL_TEXTURE_2D, textures[i].id);
     }
+}
 
-    // 绘制网格
-    glBindVertexArray(VAO);
+void Mesh::bindVertexDecode(Shader& shader) const
+{
+    const VertexDecodeLocations& locations = shader.getVertexDecodeLocations();
+    shader.setVec3(locations.positionScale, decode.position_scale);
+    shader.setVec3(locations.positionOffset, decode.position_offset);
+    shader.setInt(locations.octahedralNormals, decode.octahedral_normals ? 1 : 0);
+}
 
-    if (!indices.empty()) {
+unsigned int Mesh::selectLod(float pixelsPerUnit, float threshold, float hysteresis, unsigned int current) const
+{
+    if (lods.size() <= 1)
+        return 0;
+    current = std::min(current, static_cast<unsigned int>(lods.size() - 1));
+
+    // 当前级别误差太大：退回到满足阈值的最粗一级
+    if (lods[current].error * pixelsPerUnit > threshold * (1.0f + hysteresis)) {
+        while (current > 0 && lods[current].error * pixelsPerUnit > threshold)
+            current--;
+        return current;
+    }
+
+    // 更粗的级别误差足够小 (留出余量) 时才切换过去
+    while (current + 1 < lods.size() && lods[current + 1].error * pixelsPerUnit <= threshold * (1.0f - hysteresis))
+        current++;
+    return current;
+}
+
+unsigned int Mesh::getFirstIndex(unsigned int lod) const
+{
+    unsigned int first = getLod(lod).firstIndex;
+    if (arena != nullptr)
+        first += arena->get_range(geometry).index_offset / indexSize;
+    return first;
+}
+
+int Mesh::getBaseVertex() const
+{
+    return arena != nullptr ? static_cast<int>(arena->get_range(geometry).base_vertex) : 0;
+}
+
+void Mesh::issueDrawCall(unsigned int instance_count, unsigned int lod) const
+{
+    if (indexCount > 0) {
         // 如果有索引，使用 glDrawElements (通常用于 Assimp 加载的模型)
-        glDrawElements(GL_TRIANGLES, static_cast<unsigned int>(indices.size()), GL_UNSIGNED_INT, 0);
+        // 每个 LOD 级别是索引缓冲里的一段；几何池中的网格再加上所在区间的偏移和 basevertex
+        const MeshLod& level = getLod(lod);
+        const void* offset = reinterpret_cast<const void*>(static_cast<uintptr_t>(getFirstIndex(lod)) * indexSize);
+        GLint baseVertex = getBaseVertex();
+        if (instance_count > 0)
+            glDrawElementsInstancedBaseVertex(GL_TRIANGLES, level.indexCount, index_type_for(indexSize), offset, instance_count, baseVertex);
+        else
+            glDrawElementsBaseVertex(GL_TRIANGLES, level.indexCount, index_type_for(indexSize), offset, baseVertex);
     } else {
         // 如果没有索引，使用 glDrawArrays (通常用于你的手写顶点)
-        glDrawArrays(GL_TRIANGLES, 0, static_cast<unsigned int>(vertices.size()));
+        GLint first = getBaseVertex();
+        if (instance_count > 0)
+            glDrawArraysInstanced(GL_TRIANGLES, first, vertexCount, instance_count);
+        else
+            glDrawArrays(GL_TRIANGLES, first, vertexCount);
     }
+}
 
+void Mesh::Draw(Shader& shader, unsigned int lod)
+{
+    bindTextures(shader);
+    bindVertexDecode(shader);
+
+    // 绘制网格
+    glBindVertexArray(VAO);
+    issueDrawCall(0, lod);
     glBindVertexArray(0);
 
     // 恢复默认激活纹理单元，是个好习惯
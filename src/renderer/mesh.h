@@ -2,18 +2,14 @@
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
+#include <algorithm>
 #include <string>
 #include <vector>
 #include "shader.h" // 引用你之前的 Shader 类
+#include "vertex_format.h" // Vertex 和压缩顶点格式
+#include "../scene/bounds.h"
 
-// 定义顶点的标准格式
-// 这种结构体在内存中是紧凑排列的：PX,PY,PZ, NX,NY,NZ, U,V
-// 这与 OpenGL 的缓冲布局完美对应
-struct Vertex {
-    glm::vec3 Position;
-    glm::vec3 Normal;
-    glm::vec2 TexCoords;
-};
+class GeometryArena;
 
 // 用于 Mesh 内部记录纹理信息的轻量级结构
 struct TextureInfo {
@@ -22,24 +18,111 @@ struct TextureInfo {
     std::string path;  // (可选) 用于防止重复加载，Assimp 模型加载时会用到
 };
 
+// 一个 LOD 级别：索引缓冲里的一段，所有级别共用同一个顶点缓冲
+struct MeshLod {
+    unsigned int firstIndex = 0;
+    unsigned int indexCount = 0;
+    float error = 0.0f; // 相对原始网格的几何误差 (局部空间的距离)，第 0 级为 0
+};
+
 class Mesh {
 public:
     // 网格数据
+    // 注意：从 GPU 布局数据直接创建 (比如 .smesh 缓存) 的网格不保留 CPU 端副本，vertices/indices 为空
     std::vector<Vertex>       vertices;
     std::vector<unsigned int> indices;
     std::vector<TextureInfo>  textures;
 
+    // 顶点/索引数量 (绘制时使用，不依赖 CPU 端副本)
+    unsigned int vertexCount = 0;
+    unsigned int indexCount = 0;
+
+    // GPU 缓冲里的顶点布局和索引宽度 (2 或 4 字节)
+    VertexFormat format;
+    unsigned int indexSize = 4;
+
+    // 顶点着色器的解码参数 (反量化位置、八面体法线)
+    VertexDecode decode;
+
+    // LOD 链 (第 0 级是完整网格，误差逐级增大)，没有索引的网格为空
+    std::vector<MeshLod> lods;
+
+    // 每个纹理对应的采样器 Uniform 名字 (如 "material.texture_diffuse1")
+    // 构造时一次性生成，绘制时不再拼接字符串；第 i 个纹理固定绑定到纹理单元 i
+    std::vector<std::string>  samplerNames;
+
+    // 局部空间的包围体 (setupMesh 时根据顶点计算)
+    AABB           bounds;
+    BoundingSphere boundingSphere;
+
     // 构造函数
     // 灵活支持有索引(模型)和无索引(手写顶点)的情况
     Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<TextureInfo> textures);
 
-    // 绘制函数
-    void Draw(Shader& shader);
+    // 直接从已经按 format 打包好的数据创建 (数据原样交给 glBufferData，不做任何转换也不保留副本)
+    // 包围体由调用方提供 (通常是导入时预先算好的，量化位置时也是打包用的包围盒)
+    // lods 为空时整个索引缓冲就是唯一的一级
+    // 给出 arena 时顶点/索引从几何池里子分配，VAO 是池中同格式网格共用的那一个 (分配失败时退回独立缓冲)
+    Mesh(const void* vertexData, unsigned int vertexCount, const VertexFormat& format,
+         const void* indexData, unsigned int indexCount, unsigned int indexSize,
+         std::vector<TextureInfo> textures, const AABB& bounds, const BoundingSphere& boundingSphere,
+         std::vector<MeshLod> lods = {}, GeometryArena* arena = nullptr);
+
+    // 绘制函数 (lod 为 LOD 级别)
+    void Draw(Shader& shader, unsigned int lod = 0);
+
+    // 获取 VAO
+    unsigned int getVAO() const { return VAO; }
+
+    // 几何池中的网格 (与同页的其他网格共用 VAO，可以合批成一次 MDI 绘制)
+    GeometryArena* getArena() const { return arena; }
+    uint32_t getGeometryHandle() const { return geometry; }
+    bool isInArena() const { return arena != nullptr; }
+
+    // 几何池里的位置：第 lod 级的第一个索引 (以索引为单位) 和 basevertex
+    // 整理碎片后会变化，每次绘制时重新读取
+    unsigned int getFirstIndex(unsigned int lod = 0) const;
+    int getBaseVertex() const;
+    const MeshLod& getLod(unsigned int lod) const { return lods[std::min(lod, static_cast<unsigned int>(lods.size() - 1))]; }
+
+    // 把本网格的 VBO/EBO 和顶点属性挂到 "当前绑定的" VAO 上
+    // InstancedMesh 用它来构建自己的 VAO (顶点数据共享，实例属性独立)
+    void bindVertexBuffers() const;
+
+    // 绑定纹理并设置对应的采样器 Uniform
+    void bindTextures(Shader& shader) const;
+
+    // 设置顶点解码 Uniform (positionScale / positionOffset / octahedralNormals)
+    void bindVertexDecode(Shader& shader) const;
+
+    // 按屏幕空间误差选择 LOD 级别
+    // pixelsPerUnit 是网格处一个局部空间单位对应的像素数，current 为上一帧的级别
+    // 变粗需要误差低于 threshold * (1 - hysteresis)，变细需要当前级别的误差超过 threshold * (1 + hysteresis)，
+    // 中间的区间保持不变，避免在阈值附近来回跳
+    unsigned int selectLod(float pixelsPerUnit, float threshold, float hysteresis, unsigned int current) const;
+
+    // GPU 缓冲占用的字节数
+    std::size_t getGpuBytes() const { return std::size_t(vertexCount) * format.stride() + std::size_t(indexCount) * indexSize; }
+
+    // 只发出 Draw Call，不绑定任何状态 (VAO/纹理需要调用方事先绑好)
+    // instance_count 为 0 表示普通绘制，否则为实例化绘制；lod 超出范围时使用最后一级
+    void issueDrawCall(unsigned int instance_count = 0, unsigned int lod = 0) const;
+
+    // 释放 VAO/VBO/EBO (几何池中的网格则归还占用的区间，共用的 VAO 不删除)
+    // Mesh 按值存放、可以拷贝，所以析构时不会自动释放，由持有者 (如 Model) 负责调用一次
+    void release();
 
 private:
     // 渲染数据对象
-    unsigned int VAO, VBO, EBO;
+    unsigned int VAO = 0, VBO = 0, EBO = 0;
+
+    // 几何池和句柄 (不在池中时 arena 为空)
+    GeometryArena* arena = nullptr;
+    uint32_t geometry = 0;
+
+    // 生成采样器名字
+    void buildSamplerNames();
 
     // 初始化缓冲区对象
-    void setupMesh();
+    void setupMesh(const void* vertexData, const void* indexData);
 };
\ No newline at end of file
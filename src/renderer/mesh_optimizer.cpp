@@ -0,0 +1,241 @@
+#include "mesh_optimizer.h"
+
+#include <algorithm>
+
+namespace {
+    // 顶点 -> 相邻三角形列表 (CSR 格式：offsets[v] .. offsets[v + 1])
+    struct TriangleAdjacency {
+        std::vector<unsigned int> offsets;
+        std::vector<unsigned int> triangles;
+
+        void build(const unsigned int* indices, unsigned int index_count, unsigned int vertex_count)
+        {
+            offsets.assign(vertex_count + 1, 0);
+            for (unsigned int i = 0; i < index_count; i++)
+                offsets[indices[i] + 1]++;
+            for (unsigned int v = 0; v < vertex_count; v++)
+                offsets[v + 1] += offsets[v];
+
+            triangles.resize(index_count);
+            std::vector<unsigned int> cursor(offsets.begin(), offsets.end() - 1);
+            for (unsigned int i = 0; i < index_count; i++)
+                triangles[cursor[indices[i]]++] = i / 3;
+        }
+    };
+}
+
+VertexCacheStats analyze_vertex_cache(const unsigned int* indices, unsigned int index_count, unsigned int vertex_count,
+                                      unsigned int cache_size)
+{
+    VertexCacheStats stats;
+    if (index_count < 3 || vertex_count == 0)
+        return stats;
+
+    // FIFO：记录每个顶点进入缓存时的 "时间戳"，当前时间戳减去它超过缓存大小就说明已经被挤出去了
+    std::vector<unsigned int> timestamps(vertex_count, 0);
+    unsigned int time = cache_size + 1;
+    unsigned int misses = 0;
+
+    for (unsigned int i = 0; i < index_count; i++) {
+        unsigned int v = indices[i];
+        if (time - timestamps[v] > cache_size) {
+            timestamps[v] = time++;
+            misses++;
+        }
+    }
+
+    stats.acmr = static_cast<float>(misses) / static_cast<float>(index_count / 3);
+    stats.atvr = static_cast<float>(misses) / static_cast<float>(vertex_count);
+    return stats;
+}
+
+void optimize_vertex_cache(unsigned int* indices, unsigned int index_count, unsigned int vertex_count,
+                           unsigned int cache_size, std::vector<unsigned int>* cluster_starts)
+{
+    unsigned int triangle_count = index_count / 3;
+    if (cluster_starts)
+        cluster_starts->clear();
+    if (triangle_count == 0)
+        return;
+
+    TriangleAdjacency adjacency;
+    adjacency.build(indices, index_count, vertex_count);
+
+    std::vector<unsigned int> live(vertex_count);      // 每个顶点还没输出的相邻三角形数
+    for (unsigned int v = 0; v < vertex_count; v++)
+        live[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+    std::vector<unsigned int> timestamps(vertex_count, 0);
+    std::vector<uint8_t> emitted(triangle_count, 0);
+    std::vector<unsigned int> dead_end;                // 最近使用过的顶点，找不到好的下一个顶点时从这里回溯
+    std::vector<unsigned int> candidates;
+    std::vector<unsigned int> output;
+    output.reserve(index_count);
+
+    unsigned int time = cache_size + 1;
+    unsigned int cursor = 0;                           // 顺序扫描的位置，回溯也失败时使用
+
+    // 跳过死胡同：先从最近用过的顶点里找还有剩余三角形的，再顺序扫描
+    auto skip_dead_end = [&]() -> int {
+        while (!dead_end.empty()) {
+            unsigned int v = dead_end.back();
+            dead_end.pop_back();
+            if (live[v] > 0)
+                return static_cast<int>(v);
+        }
+        while (cursor < vertex_count) {
+            if (live[cursor] > 0)
+                return static_cast<int>(cursor);
+            cursor++;
+        }
+        return -1;
+    };
+
+    int fan = skip_dead_end();
+    if (cluster_starts && fan >= 0)
+        cluster_starts->push_back(0);
+
+    while (fan >= 0) {
+        // -> 以 fan 为中心输出它所有还没输出的三角形
+        candidates.clear();
+        for (unsigned int a = adjacency.offsets[fan]; a < adjacency.offsets[fan + 1]; a++) {
+            unsigned int triangle = adjacency.triangles[a];
+            if (emitted[triangle])
+                continue;
+            emitted[triangle] = 1;
+
+            for (unsigned int k = 0; k < 3; k++) {
+                unsigned int v = indices[triangle * 3 + k];
+                output.push_back(v);
+                dead_end.push_back(v);
+                candidates.push_back(v);
+                live[v]--;
+                if (time - timestamps[v] > cache_size)
+                    timestamps[v] = time++;
+            }
+        }
+
+        // -> 选下一个中心：在缓存里、而且输出它剩余的三角形之后依然不会被挤出去的顶点中，选最早进入缓存的
+        int next = -1;
+        int best_priority = -1;
+        for (unsigned int v : candidates) {
+            if (live[v] == 0)
+                continue;
+            int priority = 0;
+            if (time - timestamps[v] + 2 * live[v] <= cache_size)
+                priority = static_cast<int>(time - timestamps[v]);
+            if (priority > best_priority) {
+                best_priority = priority;
+                next = static_cast<int>(v);
+            }
+        }
+
+        if (next < 0) {
+            // 没有合适的候选：缓存的局部性在这里断开，作为簇的边界
+            next = skip_dead_end();
+            if (cluster_starts && next >= 0)
+                cluster_starts->push_back(static_cast<unsigned int>(output.size() / 3));
+        }
+        fan = next;
+    }
+
+    std::copy(output.begin(), output.end(), indices);
+}
+
+void optimize_overdraw(unsigned int* indices, unsigned int index_count, const Vertex* vertices, unsigned int vertex_count,
+                       const std::vector<unsigned int>& cluster_starts)
+{
+    unsigned int triangle_count = index_count / 3;
+    if (cluster_starts.size() < 2 || triangle_count == 0 || vertex_count == 0)
+        return;
+
+    // 网格中心 (按面积加权的三角形中心)
+    struct Cluster {
+        unsigned int first, count;
+        glm::vec3 centroid = glm::vec3(0.0f);
+        glm::vec3 normal = glm::vec3(0.0f);
+        float area = 0.0f;
+        float potential = 0.0f;
+    };
+    std::vector<Cluster> clusters(cluster_starts.size());
+    glm::vec3 mesh_centroid(0.0f);
+    float mesh_area = 0.0f;
+
+    for (std::size_t c = 0; c < clusters.size(); c++) {
+        Cluster& cluster = clusters[c];
+        cluster.first = cluster_starts[c];
+        cluster.count = (c + 1 < cluster_starts.size() ? cluster_starts[c + 1] : triangle_count) - cluster.first;
+
+        for (unsigned int t = cluster.first; t < cluster.first + cluster.count; t++) {
+            const glm::vec3& a = vertices[indices[t * 3 + 0]].Position;
+            const glm::vec3& b = vertices[indices[t * 3 + 1]].Position;
+            const glm::vec3& d = vertices[indices[t * 3 + 2]].Position;
+            glm::vec3 cross = glm::cross(b - a, d - a);  // 长度为面积的两倍
+            float area = glm::length(cross) * 0.5f;
+            cluster.centroid += (a + b + d) * (area / 3.0f);
+            cluster.normal += cross;
+            cluster.area += area;
+        }
+        mesh_centroid += cluster.centroid;
+        mesh_area += cluster.area;
+        if (cluster.area > 0.0f)
+            cluster.centroid /= cluster.area;
+    }
+    if (mesh_area > 0.0f)
+        mesh_centroid /= mesh_area;
+
+    // 遮挡潜力：簇越靠外、越朝外，越可能挡住别的簇
+    for (Cluster& cluster : clusters) {
+        float length = glm::length(cluster.normal);
+        glm::vec3 normal = length > 0.0f ? cluster.normal / length : glm::vec3(0.0f);
+        cluster.potential = glm::dot(cluster.centroid - mesh_centroid, normal);
+    }
+    std::stable_sort(clusters.begin(), clusters.end(),
+                     [](const Cluster& a, const Cluster& b) { return a.potential > b.potential; });
+
+    std::vector<unsigned int> sorted;
+    sorted.reserve(index_count);
+    for (const Cluster& cluster : clusters)
+        sorted.insert(sorted.end(), indices + cluster.first * 3, indices + (cluster.first + cluster.count) * 3);
+    std::copy(sorted.begin(), sorted.end(), indices);
+}
+
+unsigned int optimize_vertex_fetch(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
+{
+    const unsigned int UNUSED = ~0u;
+    std::vector<unsigned int> remap(vertices.size(), UNUSED);
+    std::vector<Vertex> reordered;
+    reordered.reserve(vertices.size());
+
+    for (unsigned int& index : indices) {
+        if (remap[index] == UNUSED) {
+            remap[index] = static_cast<unsigned int>(reordered.size());
+            reordered.push_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+
+    vertices.swap(reordered);
+    return static_cast<unsigned int>(vertices.size());
+}
+
+MeshOptimizeReport optimize_mesh(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
+{
+    MeshOptimizeReport report;
+    unsigned int vertex_count = static_cast<unsigned int>(vertices.size());
+    unsigned int index_count = static_cast<unsigned int>(indices.size() / 3 * 3);
+    if (index_count == 0)
+        return report;
+
+    report.before = analyze_vertex_cache(indices.data(), index_count, vertex_count);
+
+    std::vector<unsigned int> cluster_starts;
+    optimize_vertex_cache(indices.data(), index_count, vertex_count, VERTEX_CACHE_SIZE, &cluster_starts);
+    optimize_overdraw(indices.data(), index_count, vertices.data(), vertex_count, cluster_starts);
+    report.clusters = static_cast<unsigned int>(cluster_starts.size());
+
+    unsigned int used = optimize_vertex_fetch(vertices, indices);
+    report.removed_vertices = vertex_count - used;
+
+    report.after = analyze_vertex_cache(indices.data(), index_count, used);
+    return report;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <vector>
+#include "vertex_format.h"
+
+// 导入阶段的网格优化 (只在 Assimp 导入时运行一次，结果写进 .smesh 缓存)
+//
+// 1. 顶点缓存优化 (Tipsify)：重排三角形，让相邻三角形尽量复用刚变换过的顶点 (Post-Transform Cache)
+// 2. 过度绘制优化：按 Tipsify 产生的簇排序，朝外的簇先画，提前深度测试能剔除更多片段
+// 3. 顶点读取优化：按索引中第一次出现的顺序重排顶点，顶点读取变成近似顺序访问
+//
+// 参考 Sander, Nehab, Barczak, "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw" (2007)
+
+// 模拟 FIFO 顶点缓存的统计结果
+struct VertexCacheStats {
+    float acmr = 0.0f; // Average Cache Miss Ratio：每个三角形需要变换的顶点数 (0.5 ~ 3，越小越好)
+    float atvr = 0.0f; // Average Transformed Vertex Ratio：变换次数 / 顶点数 (最好为 1)
+};
+
+// 一次优化前后的对比
+struct MeshOptimizeReport {
+    VertexCacheStats before;
+    VertexCacheStats after;
+    unsigned int clusters = 0;         // 过度绘制排序使用的簇数量
+    unsigned int removed_vertices = 0; // 没有被任何三角形引用、被丢弃的顶点
+};
+
+// 默认的模拟缓存大小 (与现代 GPU 的行为比较接近，Tipsify 也按这个大小优化)
+const unsigned int VERTEX_CACHE_SIZE = 16;
+
+// 用大小为 cache_size 的 FIFO 缓存模拟三角形列表的顶点变换
+VertexCacheStats analyze_vertex_cache(const unsigned int* indices, unsigned int index_count, unsigned int vertex_count,
+                                      unsigned int cache_size = VERTEX_CACHE_SIZE);
+
+// Tipsify：原地重排三角形顺序
+// cluster_starts 不为空时输出每个簇的第一个三角形下标 (簇的边界是缓存被 "冲掉" 的位置，在边界处重排不影响缓存命中)
+void optimize_vertex_cache(unsigned int* indices, unsigned int index_count, unsigned int vertex_count,
+                           unsigned int cache_size = VERTEX_CACHE_SIZE, std::vector<unsigned int>* cluster_starts = nullptr);
+
+// 按簇的 "遮挡潜力" 排序 (簇中心相对网格中心的方向与簇法线一致时先画)
+void optimize_overdraw(unsigned int* indices, unsigned int index_count, const Vertex* vertices, unsigned int vertex_count,
+                       const std::vector<unsigned int>& cluster_starts);
+
+// 按第一次被引用的顺序重排顶点并改写索引，没有被引用的顶点被丢弃，返回新的顶点数
+unsigned int optimize_vertex_fetch(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices);
+
+// 依次执行以上三步
+MeshOptimizeReport optimize_mesh(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices);
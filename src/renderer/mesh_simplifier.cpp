@@ -0,0 +1,339 @@
+#include "mesh_simplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <queue>
+
+namespace {
+    // 对称 4x4 误差矩阵 (只存上三角)，用 double 避免大量平面累加后的精度问题
+    // Q(p) = p^T A p + 2 b·p + c，weight 为累加的面积，用来把误差归一化成距离
+    struct Quadric {
+        double a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+        double b0 = 0, b1 = 0, b2 = 0;
+        double c = 0;
+        double weight = 0;
+
+        static Quadric from_plane(const glm::dvec3& n, double d, double w)
+        {
+            Quadric q;
+            q.a00 = w * n.x * n.x; q.a01 = w * n.x * n.y; q.a02 = w * n.x * n.z;
+            q.a11 = w * n.y * n.y; q.a12 = w * n.y * n.z; q.a22 = w * n.z * n.z;
+            q.b0 = w * n.x * d; q.b1 = w * n.y * d; q.b2 = w * n.z * d;
+            q.c = w * d * d;
+            q.weight = w;
+            return q;
+        }
+
+        Quadric& operator+=(const Quadric& o)
+        {
+            a00 += o.a00; a01 += o.a01; a02 += o.a02; a11 += o.a11; a12 += o.a12; a22 += o.a22;
+            b0 += o.b0; b1 += o.b1; b2 += o.b2;
+            c += o.c;
+            weight += o.weight;
+            return *this;
+        }
+
+        // 加权平方距离之和
+        double evaluate(const glm::dvec3& p) const
+        {
+            double rx = a00 * p.x + a01 * p.y + a02 * p.z;
+            double ry = a01 * p.x + a11 * p.y + a12 * p.z;
+            double rz = a02 * p.x + a12 * p.y + a22 * p.z;
+            return p.x * rx + p.y * ry + p.z * rz + 2.0 * (b0 * p.x + b1 * p.y + b2 * p.z) + c;
+        }
+    };
+
+    // 候选折叠 u -> v
+    struct Collapse {
+        float error;
+        unsigned int u, v;
+        bool operator>(const Collapse& o) const { return error > o.error; }
+    };
+
+    class QuadricSimplifier
+    {
+    public:
+        QuadricSimplifier(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices)
+            : vertices(vertices), indices(indices.begin(), indices.begin() + indices.size() / 3 * 3)
+        {
+            unsigned int vertex_count = static_cast<unsigned int>(vertices.size());
+            triangle_count = static_cast<unsigned int>(this->indices.size() / 3);
+            alive.assign(triangle_count, 1);
+            collapsed.assign(vertex_count, 0);
+            adjacency.resize(vertex_count);
+
+            build_canonical();
+            build_locks();
+
+            // -> 每个三角形的平面误差按面积加权累加到三个顶点 (接缝处的多个顶点共用一个误差矩阵)
+            quadrics.resize(vertex_count);
+            for (unsigned int t = 0; t < triangle_count; t++) {
+                glm::dvec3 p0 = position(this->indices[t * 3 + 0]);
+                glm::dvec3 p1 = position(this->indices[t * 3 + 1]);
+                glm::dvec3 p2 = position(this->indices[t * 3 + 2]);
+                glm::dvec3 normal = glm::cross(p1 - p0, p2 - p0);
+                double length = glm::length(normal);
+                if (length > 0.0) {
+                    normal /= length;
+                    Quadric q = Quadric::from_plane(normal, -glm::dot(normal, p0), length * 0.5);
+                    for (unsigned int k = 0; k < 3; k++)
+                        quadrics[canonical[this->indices[t * 3 + k]]] += q;
+                }
+                for (unsigned int k = 0; k < 3; k++)
+                    adjacency[this->indices[t * 3 + k]].push_back(t);
+            }
+
+            // -> 每条有向边入队一次 (被锁住的顶点不能作为折叠的起点)
+            for (unsigned int v = 0; v < vertex_count; v++) {
+                if (is_locked(v))
+                    continue;
+                gather_neighbours(v);
+                for (unsigned int w : neighbours)
+                    queue.push({ collapse_error(v, w), v, w });
+            }
+        }
+
+        // 折叠到三角形数不超过 target (或者没有可以折叠的边)
+        void run(unsigned int target_triangles)
+        {
+            while (triangle_count > target_triangles && !queue.empty()) {
+                Collapse candidate = queue.top();
+                queue.pop();
+
+                if (collapsed[candidate.u] || collapsed[candidate.v] || !is_adjacent(candidate.u, candidate.v))
+                    continue;
+
+                // 误差矩阵在候选入队之后变化过：perform 已经按新误差重新入队，这一条是过期的
+                float current = collapse_error(candidate.u, candidate.v);
+                if (current > candidate.error * 1.0001f + 1e-12f)
+                    continue;
+                if (flips_triangles(candidate.u, candidate.v))
+                    continue;
+
+                perform(candidate.u, candidate.v);
+                max_error = std::max(max_error, current);
+            }
+        }
+
+        unsigned int get_triangle_count() const { return triangle_count; }
+        float get_error() const { return max_error; }
+
+        std::vector<unsigned int> get_indices() const
+        {
+            std::vector<unsigned int> result;
+            result.reserve(std::size_t(triangle_count) * 3);
+            for (std::size_t t = 0; t < alive.size(); t++) {
+                if (alive[t])
+                    result.insert(result.end(), indices.begin() + t * 3, indices.begin() + t * 3 + 3);
+            }
+            return result;
+        }
+
+    private:
+        const std::vector<Vertex>& vertices;
+        std::vector<unsigned int> indices;
+        unsigned int triangle_count = 0;
+
+        std::vector<unsigned int> canonical;              // 同一位置的所有顶点映射到其中一个
+        std::vector<uint8_t> locked;                      // 按 canonical 索引：边界或接缝，不能被折叠走
+        std::vector<Quadric> quadrics;                    // 按 canonical 索引
+        std::vector<std::vector<unsigned int>> adjacency; // 顶点 -> 三角形 (包括已经删除的，用 alive 过滤)
+        std::vector<uint8_t> alive;
+        std::vector<uint8_t> collapsed;
+        std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> queue;
+        std::vector<unsigned int> neighbours;             // gather_neighbours 的结果 (复用内存)
+        float max_error = 0.0f;
+
+        glm::dvec3 position(unsigned int v) const { return glm::dvec3(vertices[v].Position); }
+
+        void build_canonical()
+        {
+            std::vector<unsigned int> order(vertices.size());
+            for (unsigned int i = 0; i < order.size(); i++)
+                order[i] = i;
+            auto less = [this](unsigned int a, unsigned int b) {
+                const glm::vec3& pa = vertices[a].Position;
+                const glm::vec3& pb = vertices[b].Position;
+                if (pa.x != pb.x) return pa.x < pb.x;
+                if (pa.y != pb.y) return pa.y < pb.y;
+                return pa.z < pb.z;
+            };
+            std::sort(order.begin(), order.end(), less);
+
+            canonical.resize(vertices.size());
+            locked.assign(vertices.size(), 0);
+            for (std::size_t i = 0; i < order.size(); ) {
+                std::size_t j = i + 1;
+                while (j < order.size() && vertices[order[j]].Position == vertices[order[i]].Position)
+                    j++;
+                for (std::size_t k = i; k < j; k++)
+                    canonical[order[k]] = order[i];
+                // 多个顶点共用一个位置 = 接缝
+                if (j - i > 1)
+                    locked[order[i]] = 1;
+                i = j;
+            }
+        }
+
+        void build_locks()
+        {
+            // 只被一个三角形使用的边 (按位置计算) 是开放边界，两端都锁住
+            std::vector<uint64_t> edges;
+            edges.reserve(indices.size());
+            for (std::size_t t = 0; t < indices.size(); t += 3) {
+                for (unsigned int k = 0; k < 3; k++) {
+                    uint64_t a = canonical[indices[t + k]], b = canonical[indices[t + (k + 1) % 3]];
+                    edges.push_back(a < b ? (a << 32) | b : (b << 32) | a);
+                }
+            }
+            std::sort(edges.begin(), edges.end());
+            for (std::size_t i = 0; i < edges.size(); ) {
+                std::size_t j = i + 1;
+                while (j < edges.size() && edges[j] == edges[i])
+                    j++;
+                if (j - i == 1) {
+                    locked[edges[i] >> 32] = 1;
+                    locked[edges[i] & 0xFFFFFFFFu] = 1;
+                }
+                i = j;
+            }
+        }
+
+        bool is_locked(unsigned int v) const { return locked[canonical[v]] != 0; }
+
+        float collapse_error(unsigned int u, unsigned int v) const
+        {
+            Quadric q = quadrics[canonical[u]];
+            q += quadrics[canonical[v]];
+            if (q.weight <= 0.0)
+                return 0.0f;
+            return static_cast<float>(std::sqrt(std::max(q.evaluate(position(v)), 0.0) / q.weight));
+        }
+
+        // 收集 v 的相邻顶点 (去重) 到 neighbours
+        void gather_neighbours(unsigned int v)
+        {
+            neighbours.clear();
+            for (unsigned int t : adjacency[v]) {
+                if (!alive[t])
+                    continue;
+                for (unsigned int k = 0; k < 3; k++) {
+                    unsigned int w = indices[t * 3 + k];
+                    if (canonical[w] != canonical[v])
+                        neighbours.push_back(w);
+                }
+            }
+            std::sort(neighbours.begin(), neighbours.end());
+            neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+        }
+
+        bool contains_position(unsigned int t, unsigned int v) const
+        {
+            unsigned int c = canonical[v];
+            return canonical[indices[t * 3 + 0]] == c || canonical[indices[t * 3 + 1]] == c || canonical[indices[t * 3 + 2]] == c;
+        }
+
+        bool is_adjacent(unsigned int u, unsigned int v) const
+        {
+            for (unsigned int t : adjacency[u]) {
+                if (alive[t] && contains_position(t, v))
+                    return true;
+            }
+            return false;
+        }
+
+        // 折叠后 u 周围保留下来的三角形是否翻面 (或者退化成一条线)
+        bool flips_triangles(unsigned int u, unsigned int v) const
+        {
+            glm::dvec3 target = position(v);
+            for (unsigned int t : adjacency[u]) {
+                if (!alive[t] || contains_position(t, v))
+                    continue;
+
+                glm::dvec3 p[3], q[3];
+                for (unsigned int k = 0; k < 3; k++) {
+                    unsigned int w = indices[t * 3 + k];
+                    p[k] = position(w);
+                    q[k] = w == u ? target : p[k];
+                }
+                glm::dvec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+                glm::dvec3 after = glm::cross(q[1] - q[0], q[2] - q[0]);
+                if (glm::dot(before, after) <= 0.0)
+                    return true;
+            }
+            return false;
+        }
+
+        void perform(unsigned int u, unsigned int v)
+        {
+            collapsed[u] = 1;
+            quadrics[canonical[v]] += quadrics[canonical[u]];
+
+            for (unsigned int t : adjacency[u]) {
+                if (!alive[t])
+                    continue;
+                if (contains_position(t, v)) {
+                    alive[t] = 0;
+                    triangle_count--;
+                    continue;
+                }
+                for (unsigned int k = 0; k < 3; k++) {
+                    if (indices[t * 3 + k] == u)
+                        indices[t * 3 + k] = v;
+                }
+                adjacency[v].push_back(t);
+            }
+            adjacency[u].clear();
+
+            std::vector<unsigned int>& around = adjacency[v];
+            around.erase(std::remove_if(around.begin(), around.end(), [this](unsigned int t) { return !alive[t]; }), around.end());
+
+            // 只有和 v 相连的边误差变了，按新误差重新入队 (旧的候选出队时会被丢弃)
+            gather_neighbours(v);
+            for (unsigned int w : neighbours) {
+                if (!is_locked(w))
+                    queue.push({ collapse_error(w, v), w, v });
+                if (!is_locked(v))
+                    queue.push({ collapse_error(v, w), v, w });
+            }
+        }
+    };
+}
+
+std::vector<unsigned int> simplify_mesh(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices,
+                                        unsigned int target_index_count, float* out_error)
+{
+    QuadricSimplifier simplifier(vertices, indices);
+    simplifier.run(target_index_count / 3);
+    if (out_error)
+        *out_error = simplifier.get_error();
+    return simplifier.get_indices();
+}
+
+std::vector<LodLevel> generate_lod_chain(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices,
+                                         unsigned int max_levels, float reduction)
+{
+    std::vector<LodLevel> levels;
+    levels.push_back({ indices, 0.0f });
+
+    unsigned int triangles = static_cast<unsigned int>(indices.size() / 3);
+    if (max_levels <= 1 || triangles < MIN_LOD_TRIANGLES * 2)
+        return levels;
+
+    // 一次简化过程中依次截取每一级，误差矩阵一直累加，误差相对的始终是原始网格
+    QuadricSimplifier simplifier(vertices, indices);
+    while (levels.size() < max_levels) {
+        unsigned int target = static_cast<unsigned int>(triangles * reduction);
+        if (target < MIN_LOD_TRIANGLES)
+            break;
+
+        simplifier.run(target);
+        unsigned int achieved = simplifier.get_triangle_count();
+        if (achieved > triangles * 0.85f)
+            break;
+
+        levels.push_back({ simplifier.get_indices(), simplifier.get_error() });
+        triangles = achieved;
+    }
+    return levels;
+}
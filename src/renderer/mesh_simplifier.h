@@ -0,0 +1,32 @@
+#pragma once
+
+#include <vector>
+#include "vertex_format.h"
+
+// 导入阶段的网格简化 (二次误差度量 QEM，Garland & Heckbert 1997)
+//
+// 采用 "半边折叠"：顶点 u 折叠到与它相邻的已有顶点 v 上，不产生新顶点，
+// 所以所有 LOD 级别都共用原始网格的顶点缓冲，每一级只是一份新的索引。
+// 为了不撕开网格：开放边界上的顶点、以及同一位置有多个顶点 (UV/法线接缝) 的顶点不会被折叠走。
+
+// LOD 链的最大级别数 (含第 0 级的原始网格)
+const unsigned int MAX_LOD_LEVELS = 5;
+
+// 三角形少于这个数时不再继续生成更粗的级别
+const unsigned int MIN_LOD_TRIANGLES = 64;
+
+// 一个 LOD 级别
+struct LodLevel {
+    std::vector<unsigned int> indices;
+    float error = 0.0f; // 相对原始网格的几何误差 (局部空间的距离，单调不减)
+};
+
+// 简化到不超过 target_index_count 个索引 (折叠不下去时会提前停止)
+// out_error 不为空时输出误差，含义同 LodLevel::error
+std::vector<unsigned int> simplify_mesh(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices,
+                                        unsigned int target_index_count, float* out_error = nullptr);
+
+// 生成 LOD 链：第 0 级是原始索引，之后每一级的三角形数约为上一级的 reduction 倍
+// 某一级减不下去 (少于 15%) 或者三角形已经很少时提前结束
+std::vector<LodLevel> generate_lod_chain(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices,
+                                         unsigned int max_levels = MAX_LOD_LEVELS, float reduction = 0.5f);
@@ -1,117 +1,274 @@
 ﻿#include "model.h"
+#include "resource_manager.h"
+#include "mesh_optimizer.h"
+#include "mesh_simplifier.h"
+#include "camera.h"
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
-#include <stb_image.h> // 需要直接使用 stb_image 加载纹理数据
+#include <algorithm>
 
-// 一个辅助函数：直接从文件加载纹理并返回 OpenGL ID
-// 这与你 core/texture.cpp 的逻辑类似，但这里作为内部工具函数使用
-unsigned int TextureFromFile(const char *path, const std::string &directory)
+// 构造函数实现
+Model::Model(std::string const &path, bool gamma, ResourceManager *resources, const VertexFormat &format)
 {
-    std::string filename = std::string(path);
-    filename = directory + '/' + filename;
+    ModelData data;
+    if (importData(path, data, format))
+        uploadModel(data, resources);
+}
 
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
+Model::Model(ModelData &data, ResourceManager *resources)
+{
+    uploadModel(data, resources);
+}
 
-    int width, height, nrComponents;
-    // 加载纹理数据
-    unsigned char *data = stbi_load(filename.c_str(), &width, &height, &nrComponents, 0);
-    if (data)
-    {
-        GLenum format;
-        if (nrComponents == 1)
-            format = GL_RED;
-        else if (nrComponents == 3)
-            format = GL_RGB;
-        else if (nrComponents == 4)
-            format = GL_RGBA;
+Model::~Model()
+{
+    for(Mesh &mesh : meshes)
+        mesh.release();
+}
 
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
+// 绘制函数实现
+void Model::Draw(Shader &shader)
+{
+    // 简单地遍历所有子网格并绘制
+    for(unsigned int i = 0; i < meshes.size(); i++)
+        meshes[i].Draw(shader);
+}
 
-        // 设置纹理环绕和过滤方式
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+// 按屏幕空间误差选择 LOD 后绘制
+void Model::Draw(Shader &shader, const glm::mat4 &model, const LodView &view, LodState &state)
+{
+    selectLods(model, view, state);
+    for(unsigned int i = 0; i < meshes.size(); i++)
+    {
+        shader.setMat4("model", model * meshTransforms[i]);
+        meshes[i].Draw(shader, state.levels[i]);
+    }
+}
 
-        stbi_image_free(data);
+// 提交到渲染队列
+void Model::Submit(RenderQueue &queue, Shader &shader, const glm::mat4 &model, float view_depth, const LodState *lods) const
+{
+    for(unsigned int i = 0; i < meshes.size(); i++)
+    {
+        unsigned int lod = lods && i < lods->levels.size() ? lods->levels[i] : 0;
+        queue.submit(render_pass::SOLID, shader, meshes[i], model * meshTransforms[i], view_depth, lod);
     }
-    else
+}
+
+void Model::Submit(RenderQueue &queue, const ShaderPermutations &permutations, uint32_t features, const glm::mat4 &model,
+                   float view_depth, const LodState *lods) const
+{
+    for(unsigned int i = 0; i < meshes.size(); i++)
     {
-        std::cout << "Texture failed to load at path: " << path << std::endl;
-        stbi_image_free(data);
+        unsigned int lod = lods && i < lods->levels.size() ? lods->levels[i] : 0;
+        Shader &shader = permutations.find(features | ShaderFeatures::for_material(meshes[i]));
+        queue.submit(render_pass::SOLID, shader, meshes[i], model * meshTransforms[i], view_depth, lod);
     }
+}
 
-    return textureID;
+uint32_t Model::getMaterialVariants() const
+{
+    uint32_t variants = 0;
+    for(const Mesh &mesh : meshes)
+        variants |= 1u << (ShaderFeatures::for_material(mesh) >> ShaderFeatures::MATERIAL_SHIFT);
+    return variants;
 }
 
-// 构造函数实现
-Model::Model(std::string const &path, bool gamma)
+// LOD 视图参数
+LodView LodView::fromCamera(const Camera &camera, float viewportHeight, float errorThreshold)
 {
-    loadModel(path);
+    LodView view;
+    view.cameraPosition = camera.position;
+    view.projectionScale = viewportHeight / (2.0f * std::tan(glm::radians(camera.zoom) * 0.5f));
+    view.nearPlane = camera.near_plane;
+    view.errorThreshold = errorThreshold;
+    return view;
 }
 
-// 绘制函数实现
-void Model::Draw(Shader &shader)
+// 为每个子网格选择 LOD 级别
+void Model::selectLods(const glm::mat4 &model, const LodView &view, LodState &state) const
 {
-    // 简单地遍历所有子网格并绘制
+    state.levels.resize(meshes.size(), 0);
     for(unsigned int i = 0; i < meshes.size(); i++)
-        meshes[i].Draw(shader);
+    {
+        // 误差是网格空间的距离，按 (模型矩阵 * 节点变换) 的最大缩放轴换算到世界空间
+        glm::mat4 meshModel = model * meshTransforms[i];
+        float scale = std::max({ glm::length(glm::vec3(meshModel[0])), glm::length(glm::vec3(meshModel[1])), glm::length(glm::vec3(meshModel[2])) });
+
+        // 用包围球上离摄像机最近的点估计距离 (摄像机在球内时取近平面)
+        BoundingSphere sphere = meshes[i].boundingSphere.transformed(meshModel);
+        float distance = std::max(glm::length(sphere.center - view.cameraPosition) - sphere.radius, view.nearPlane);
+        float pixelsPerUnit = view.projectionScale * scale / distance;
+        state.levels[i] = meshes[i].selectLod(pixelsPerUnit, view.errorThreshold, view.hysteresis, state.levels[i]);
+    }
 }
 
-// 加载模型主逻辑
-void Model::loadModel(std::string const &path)
-{
-    // 使用 Assimp 导入器读取文件
-    Assimp::Importer importer;
+namespace {
+    // Assimp 导入参数，同时参与缓存哈希：修改后旧的 .smesh 自动失效
     // aiProcess_Triangulate: 如果模型有四边形面，自动转换成三角形
     // aiProcess_FlipUVs: 翻转 Y 轴 UV（OpenGL 需要）
     // aiProcess_GenSmoothNormals: 如果模型没有法线，自动生成平滑法线
-    const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
+    const unsigned int IMPORT_FLAGS = aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs | aiProcess_CalcTangentSpace;
+
+    // Assimp 的矩阵是行主序 (a1..a4 是第一行)，glm 是列主序
+    glm::mat4 toGlm(const aiMatrix4x4 &m)
+    {
+        return glm::mat4(glm::vec4(m.a1, m.b1, m.c1, m.d1),
+                         glm::vec4(m.a2, m.b2, m.c2, m.d2),
+                         glm::vec4(m.a3, m.b3, m.c3, m.d3),
+                         glm::vec4(m.a4, m.b4, m.c4, m.d4));
+    }
+}
+
+// 导入模型数据 (只做 CPU 端工作)
+bool Model::importData(std::string const &path, ModelData &data, const VertexFormat &format)
+{
+    // 以此路径为基准，提取目录路径（用于之后加载同目录下的纹理文件）
+    data.directory = path.substr(0, path.find_last_of('/'));
+    data.format = format;
+
+    // 先尝试缓存：源文件内容和导入参数都没变时，直接映射 .smesh，跳过 Assimp
+    std::string cookedPath = path + ".smesh";
+    uint64_t sourceHash = hash_source_file(path, IMPORT_FLAGS, format);
+    if (sourceHash != 0 && loadCooked(cookedPath, sourceHash, data))
+        return true;
+
+    // 使用 Assimp 导入器读取文件 (每次导入使用独立的 Importer，多个线程可以同时导入)
+    Assimp::Importer importer;
+    const aiScene* scene = importer.ReadFile(path, IMPORT_FLAGS);
 
     // 检查错误
     // 如果 scene 为空，或者标志位不完整，或者根节点为空，说明加载失败
     if(!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
     {
         std::cout << "ERROR::ASSIMP:: " << importer.GetErrorString() << std::endl;
+        return false;
+    }
+
+    // 开始递归处理根节点，得到 CPU 端数据
+    processNode(scene->mRootNode, scene, format, data.meshes, glm::mat4(1.0f));
+    computeBounds(data);
+
+    // 写入缓存，下次启动直接使用
+    if (sourceHash != 0)
+        write_cooked_model(cookedPath, sourceHash, format, data.meshes, data.bounds, data.boundingSphere);
+    return true;
+}
+
+// 尝试映射 .smesh 缓存
+bool Model::loadCooked(std::string const &cookedPath, uint64_t sourceHash, ModelData &data)
+{
+    if (!data.cooked.open(cookedPath, sourceHash))
+        return false;
+
+    const SMeshHeader &header = data.cooked.get_header();
+    data.bounds = read_aabb(header.bounds_min, header.bounds_max);
+    data.boundingSphere = read_bounding_sphere(header.sphere_center, header.sphere_radius);
+    data.fromCache = true;
+    return true;
+}
+
+// 上传到 GPU
+void Model::uploadModel(ModelData &data, ResourceManager *resources)
+{
+    // 有资源管理器时网格从它的几何池里子分配
+    GeometryArena *arena = resources ? resources->get_geometry_arena() : nullptr;
+
+    directory = data.directory;
+    bounds = data.bounds;
+    boundingSphere = data.boundingSphere;
+
+    if (data.fromCache)
+    {
+        const CookedModelFile &cooked = data.cooked;
+        meshes.reserve(cooked.get_mesh_count());
+        meshTransforms.reserve(cooked.get_mesh_count());
+        for(unsigned int i = 0; i < cooked.get_mesh_count(); i++)
+        {
+            const SMeshRecord &record = cooked.get_mesh(i);
+
+            std::vector<TextureInfo> textures;
+            for(unsigned int t = record.first_texture; t < record.first_texture + record.texture_count; t++)
+                textures.push_back(loadTexture(std::string(cooked.get_texture_path(t)), std::string(cooked.get_texture_type(t)), resources));
+
+            // 顶点/索引指针直接指向映射内存，glBufferData 复制完之后文件就可以关闭了
+            meshes.emplace_back(cooked.get_vertex_data(record), record.vertex_count, cooked.get_vertex_format(),
+                                cooked.get_index_data(record), record.index_count, record.index_size, textures,
+                                read_aabb(record.bounds_min, record.bounds_max),
+                                read_bounding_sphere(record.sphere_center, record.sphere_radius),
+                                cooked.get_lods(record), arena);
+            meshTransforms.push_back(read_matrix(record.node_transform));
+        }
+        data.cooked.close();
         return;
     }
 
-    // 以此路径为基准，提取目录路径（用于之后加载同目录下的纹理文件）
-    directory = path.substr(0, path.find_last_of('/'));
+    meshes.reserve(data.meshes.size());
+    meshTransforms.reserve(data.meshes.size());
+    for(const MeshData &mesh : data.meshes)
+    {
+        std::vector<TextureInfo> textures;
+        for(const MeshTextureRef &ref : mesh.textures)
+            textures.push_back(loadTexture(ref.path, ref.type, resources));
+
+        meshes.emplace_back(mesh.vertexData.data(), mesh.vertexCount, data.format,
+                            mesh.indexData.data(), mesh.indexCount, mesh.indexSize,
+                            textures, mesh.bounds, mesh.boundingSphere, mesh.lods, arena);
+        meshTransforms.push_back(mesh.nodeTransform);
+    }
+}
 
-    // 开始递归处理根节点
-    processNode(scene->mRootNode, scene);
+// 合并所有子网格的包围体 (先按节点变换换到模型空间)
+void Model::computeBounds(ModelData &data)
+{
+    data.bounds = AABB();
+    for(const MeshData &mesh : data.meshes)
+        data.bounds.expand(mesh.bounds.transformed(mesh.nodeTransform));
+
+    data.boundingSphere.center = data.bounds.center();
+    data.boundingSphere.radius = 0.0f;
+    for(const MeshData &mesh : data.meshes)
+    {
+        BoundingSphere sphere = mesh.boundingSphere.transformed(mesh.nodeTransform);
+        float reach = glm::length(sphere.center - data.boundingSphere.center) + sphere.radius;
+        data.boundingSphere.radius = std::max(data.boundingSphere.radius, reach);
+    }
 }
 
 // 递归处理节点
-void Model::processNode(aiNode *node, const aiScene *scene)
+void Model::processNode(aiNode *node, const aiScene *scene, const VertexFormat &format, std::vector<MeshData> &meshData,
+                        const glm::mat4 &parentTransform)
 {
+    // 节点的变换相对于父节点，累乘得到相对于根节点的变换
+    glm::mat4 nodeTransform = parentTransform * toGlm(node->mTransformation);
+
     // 处理当前节点下的所有网格
     for(unsigned int i = 0; i < node->mNumMeshes; i++)
     {
         // 节点中只存储了网格的索引，真正的数据在 scene->mMeshes 中
         aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-        meshes.push_back(processMesh(mesh, scene));
+        meshData.push_back(processMesh(mesh, scene, format));
+        meshData.back().nodeTransform = nodeTransform;
     }
 
     // 递归处理子节点
     for(unsigned int i = 0; i < node->mNumChildren; i++)
     {
-        processNode(node->mChildren[i], scene);
+        processNode(node->mChildren[i], scene, format, meshData, nodeTransform);
     }
 }
 
 // 将 Assimp 网格数据转换为我们的 Mesh 数据
-Mesh Model::processMesh(aiMesh *mesh, const aiScene *scene)
+MeshData Model::processMesh(aiMesh *mesh, const aiScene *scene, const VertexFormat &format)
 {
-    // 准备数据容器
+    // 准备数据容器 (先用标准的 Vertex 布局，最后再打包)
+    MeshData data;
     std::vector<Vertex> vertices;
     std::vector<unsigned int> indices;
-    std::vector<TextureInfo> textures;
+    std::vector<MeshTextureRef> &textures = data.textures;
+    vertices.reserve(mesh->mNumVertices);
+    indices.reserve(mesh->mNumFaces * 3);
 
     // 处理顶点数据
     for(unsigned int i = 0; i < mesh->mNumVertices; i++)
@@ -172,63 +329,97 @@ Mesh Model::processMesh(aiMesh *mesh, const aiScene *scene)
             indices.push_back(face.mIndices[j]);
     }
 
+    // 优化三角形和顶点顺序 (顶点缓存 -> 过度绘制 -> 顶点读取)，只在导入时做一次
+    MeshOptimizeReport report = optimize_mesh(vertices, indices);
+    std::cout << "MESH_OPT::" << (mesh->mName.length > 0 ? mesh->mName.C_Str() : "<unnamed>")
+              << " ACMR " << report.before.acmr << " -> " << report.after.acmr
+              << ", ATVR " << report.before.atvr << " -> " << report.after.atvr
+              << " (" << report.clusters << " clusters";
+    if (report.removed_vertices > 0)
+        std::cout << ", " << report.removed_vertices << " unused vertices removed";
+    std::cout << ")" << std::endl;
+
+    // 生成 LOD 链：所有级别共用上面的顶点，索引依次接在同一个索引缓冲里
+    std::vector<LodLevel> levels = generate_lod_chain(vertices, indices);
+    std::vector<unsigned int> lodIndices;
+    for(unsigned int i = 0; i < levels.size(); i++)
+    {
+        LodLevel &level = levels[i];
+        if (i > 0)
+            optimize_vertex_cache(level.indices.data(), static_cast<unsigned int>(level.indices.size()), static_cast<unsigned int>(vertices.size()));
+        data.lods.push_back({ static_cast<unsigned int>(lodIndices.size()), static_cast<unsigned int>(level.indices.size()), level.error });
+        lodIndices.insert(lodIndices.end(), level.indices.begin(), level.indices.end());
+    }
+    if (levels.size() > 1)
+    {
+        std::cout << "MESH_LOD::" << (mesh->mName.length > 0 ? mesh->mName.C_Str() : "<unnamed>") << " " << levels.size() << " levels:";
+        for(const MeshLod &lod : data.lods)
+            std::cout << " " << lod.indexCount / 3 << " (error " << lod.error << ")";
+        std::cout << std::endl;
+    }
+
     // 处理材质 (纹理)
     if(mesh->mMaterialIndex >= 0)
     {
         aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
 
         // 漫反射贴图 -> texture_diffuse
-        std::vector<TextureInfo> diffuseMaps = loadMaterialTextures(material, aiTextureType_DIFFUSE, "texture_diffuse");
+        std::vector<MeshTextureRef> diffuseMaps = collectMaterialTextures(material, aiTextureType_DIFFUSE, "texture_diffuse");
         textures.insert(textures.end(), diffuseMaps.begin(), diffuseMaps.end());
 
         // 镜面光贴图 -> texture_specular
-        std::vector<TextureInfo> specularMaps = loadMaterialTextures(material, aiTextureType_SPECULAR, "texture_specular");
+        std::vector<MeshTextureRef> specularMaps = collectMaterialTextures(material, aiTextureType_SPECULAR, "texture_specular");
         textures.insert(textures.end(), specularMaps.begin(), specularMaps.end());
 
         // 法线贴图 (通常 Assimp 中是 HEIGHT 类型，或者 NORMALS 类型，具体看模型格式)
-        std::vector<TextureInfo> normalMaps = loadMaterialTextures(material, aiTextureType_HEIGHT, "texture_normal");
+        std::vector<MeshTextureRef> normalMaps = collectMaterialTextures(material, aiTextureType_HEIGHT, "texture_normal");
         textures.insert(textures.end(), normalMaps.begin(), normalMaps.end());
     }
 
-    // 返回构建好的 Mesh 对象
-    return Mesh(vertices, indices, textures);
+    // 局部空间包围体 (会一起写进缓存)
+    data.bounds = compute_aabb(vertices.data(), static_cast<unsigned int>(vertices.size()), sizeof(Vertex));
+    data.boundingSphere = compute_bounding_sphere(vertices.data(), static_cast<unsigned int>(vertices.size()), sizeof(Vertex), data.bounds);
+
+    // 按顶点格式打包 (量化位置使用上面算出的包围盒)
+    data.vertexCount = static_cast<unsigned int>(vertices.size());
+    data.indexCount = static_cast<unsigned int>(lodIndices.size());
+    data.indexSize = index_size_for(format, data.vertexCount);
+    pack_vertices(vertices.data(), data.vertexCount, format, data.bounds, data.vertexData);
+    pack_indices(lodIndices.data(), data.indexCount, data.indexSize, data.indexData);
+
+    return data;
 }
 
-// 加载材质纹理
-std::vector<TextureInfo> Model::loadMaterialTextures(aiMaterial *mat, aiTextureType type, std::string typeName)
+// 收集材质纹理引用
+std::vector<MeshTextureRef> Model::collectMaterialTextures(aiMaterial *mat, aiTextureType type, std::string typeName)
 {
-    std::vector<TextureInfo> textures;
+    std::vector<MeshTextureRef> textures;
 
     // 遍历该类型的所有纹理
     for(unsigned int i = 0; i < mat->GetTextureCount(type); i++)
     {
         aiString str;
         mat->GetTexture(type, i, &str);
-
-        // 检查是否已经加载过该纹理（优化）
-        bool skip = false;
-        for(unsigned int j = 0; j < textures_loaded.size(); j++)
-        {
-            if(std::strcmp(textures_loaded[j].path.data(), str.C_Str()) == 0)
-            {
-                textures.push_back(textures_loaded[j]);
-                skip = true;
-                break;
-            }
-        }
-
-        // 如果没加载过，则加载
-        if(!skip)
-        {
-            TextureInfo texture;
-            // 调用辅助函数加载图片文件
-            texture.id = TextureFromFile(str.C_Str(), this->directory);
-            texture.type = typeName;
-            texture.path = str.C_Str(); // 保存路径用于下次对比
-
-            textures.push_back(texture);
-            textures_loaded.push_back(texture);  // 加入缓存
-        }
+        textures.push_back({ typeName, str.C_Str() });
     }
     return textures;
-}
\ No newline at end of file
+}
+
+// 加载纹理
+TextureInfo Model::loadTexture(const std::string &path, const std::string &typeName, ResourceManager *resources)
+{
+    // 同一模型内按路径查哈希表；跨模型的去重由资源管理器负责
+    TextureHandle &handle = textureHandles[path];
+    if (!handle)
+    {
+        // 有资源管理器时走它的缓存 (可能是异步加载：先拿到占位图的纹理 ID，数据到达后内容自动替换)
+        std::string fullPath = this->directory + '/' + path;
+        handle = resources ? resources->load_texture(fullPath) : ResourceManager::load_texture_uncached(fullPath);
+    }
+
+    TextureInfo texture;
+    texture.id = handle->id;
+    texture.type = typeName;
+    texture.path = path;
+    return texture;
+}
@@ -3,6 +3,7 @@
 #include <vector>
 #include <string>
 #include <iostream>
+#include <unordered_map>
 
 // 引入 Assimp 库头文件
 #include <assimp/Importer.hpp>
@@ -12,6 +13,41 @@
 // 引入你自己的 Mesh 和 Shader 类
 #include "mesh.h"
 #include "shader.h"
+#include "shader_permutations.h"
+#include "render_queue.h"
+#include "cooked_mesh.h"
+#include "async_loader.h"
+
+class Camera;
+
+// 导入结果：纯 CPU 数据，不涉及任何 GL 调用，可以在工作线程上生成
+struct ModelData {
+    std::string directory;        // 模型所在目录 (纹理路径相对于它)
+    VertexFormat format;          // 导入时选定的顶点格式
+    std::vector<MeshData> meshes; // Assimp 导入的结果 (已按 format 打包)
+    CookedModelFile cooked;       // 命中缓存时使用：顶点/索引直接指向映射内存
+    bool fromCache = false;
+
+    AABB bounds;
+    BoundingSphere boundingSphere;
+};
+
+// LOD 选择的视图参数 (每帧根据摄像机生成一次)
+struct LodView {
+    glm::vec3 cameraPosition = glm::vec3(0.0f);
+    float projectionScale = 1.0f; // viewportHeight / (2 * tan(fov / 2))：距离为 1 处一个单位长度对应的像素数
+    float nearPlane = 0.1f;
+    float errorThreshold = 1.0f;  // 允许的屏幕空间误差 (像素)
+    float hysteresis = 0.25f;     // 切换的滞后区间 (相对阈值的比例)
+
+    static LodView fromCamera(const Camera &camera, float viewportHeight, float errorThreshold = 1.0f);
+};
+
+// 一个模型实例的 LOD 状态：每个子网格当前的级别
+// 需要跨帧保留 (滞后切换依赖上一帧的级别)；模型被多个物体共用时每个物体一份
+struct LodState {
+    std::vector<unsigned int> levels;
+};
 
 // Model 类：负责加载外部 3D 模型文件（如 .obj, .fbx）
 // 它包含一个 Mesh 对象的数组，因为一个复杂的模型通常由多个子网格组成
@@ -21,34 +57,85 @@ public:
     // 存储模型包含的所有网格
     std::vector<Mesh> meshes;
 
-    // 纹理缓存：防止同一个纹理被重复加载
-    // 这里的 TextureInfo 是我们在 mesh.h 中定义的结构体
-    std::vector<TextureInfo> textures_loaded;
+    // 每个子网格在模型空间里的变换 (Assimp 节点层级从根节点累乘下来的结果，与 meshes 一一对应)
+    std::vector<glm::mat4> meshTransforms;
+
+    // 整个模型的局部空间包围体 (所有子网格合并)
+    AABB bounds;
+    BoundingSphere boundingSphere;
 
     // 模型文件所在的目录路径（用于加载相对路径的纹理）
     std::string directory;
 
-    // 构造函数：传入文件路径即可加载
+    // 构造函数：传入文件路径即可加载 (同步导入 + 上传)
+    // 首次加载时用 Assimp 导入并在旁边写一份 <path>.smesh 缓存，之后源文件不变就直接映射缓存
     // gamma 参数用于伽马校正，目前我们暂时默认为 false
-    Model(std::string const &path, bool gamma = false);
+    // resources 不为空时纹理通过资源管理器加载 (多个模型共用同一张贴图)
+    // format 为 GPU 缓冲里的顶点格式 (VertexFormat::compact() 可以把顶点缩小一半)
+    Model(std::string const &path, bool gamma = false, ResourceManager *resources = nullptr,
+          const VertexFormat &format = VertexFormat::standard());
+
+    // 从已经导入好的数据创建 (只做 GPU 上传，必须在 GL 线程调用)
+    Model(ModelData &data, ResourceManager *resources = nullptr);
+
+    // 释放所有子网格的 GPU 缓冲 (模型由资源管理器共享，禁止拷贝)
+    ~Model();
+    Model(const Model&) = delete;
+    Model& operator=(const Model&) = delete;
+
+    // 导入模型数据 (不调用 GL，线程安全)，失败返回 false
+    static bool importData(std::string const &path, ModelData &data, const VertexFormat &format = VertexFormat::standard());
 
-    // 绘制函数：遍历所有网格并调用它们的 Draw
+    // 绘制函数：遍历所有网格并调用它们的 Draw (完整精度，模型矩阵 Uniform 由调用方设置，不含节点变换)
     void Draw(Shader &shader);
 
+    // 按投影到屏幕上的几何误差为每个子网格选择 LOD 级别再绘制
+    // 每个子网格的 "model" Uniform 设置为 model * 节点变换
+    void Draw(Shader &shader, const glm::mat4 &model, const LodView &view, LodState &state);
+
+    // 根据摄像机 FOV 和距离更新 state 中每个子网格的 LOD 级别
+    void selectLods(const glm::mat4 &model, const LodView &view, LodState &state) const;
+
+    // 提交到渲染队列：每个子网格一条命令，由队列统一排序后绘制
+    // lods 为空时全部使用第 0 级
+    void Submit(RenderQueue &queue, Shader &shader, const glm::mat4 &model, float view_depth = 0.0f,
+                const LodState *lods = nullptr) const;
+
+    // 同上，每个子网格按自己的贴图从 permutations 里取最精简的变体 (features 是与网格无关的特性，比如光源)
+    // 只查表 (ShaderPermutations::find)，可以在任务里调用
+    void Submit(RenderQueue &queue, const ShaderPermutations &permutations, uint32_t features, const glm::mat4 &model,
+                float view_depth = 0.0f, const LodState *lods = nullptr) const;
+
+    // 子网格用到的贴图组合：第 i 位表示有子网格的材质特性 (ShaderFeatures::for_material) 为 i << MATERIAL_SHIFT
+    uint32_t getMaterialVariants() const;
+
 private:
+    // 本模型用到的纹理 (相对路径 -> 句柄)，同一路径只加载一次，同时保持纹理存活
+    std::unordered_map<std::string, TextureHandle> textureHandles;
+
     // --- 内部处理函数 ---
 
-    // 加载模型的入口函数
-    void loadModel(std::string const &path);
+    // 把导入好的数据上传到 GPU
+    void uploadModel(ModelData &data, ResourceManager *resources);
+
+    // 尝试映射 .smesh 缓存，缓存不存在或已过期时返回 false
+    static bool loadCooked(std::string const &cookedPath, uint64_t sourceHash, ModelData &data);
 
     // 递归处理 Assimp 的节点树
     // Assimp 将模型加载为节点树结构，我们需要递归遍历每个节点来获取 Mesh
-    void processNode(aiNode *node, const aiScene *scene);
+    // parentTransform 为父节点到根节点的累积变换，节点自己的变换乘上去之后记录到它的每个网格里
+    static void processNode(aiNode *node, const aiScene *scene, const VertexFormat &format, std::vector<MeshData> &meshData,
+                            const glm::mat4 &parentTransform);
+
+    // 将 Assimp 的 aiMesh 数据转换为 CPU 端的 MeshData (按 format 打包，可以直接写入缓存或上传)
+    static MeshData processMesh(aiMesh *mesh, const aiScene *scene, const VertexFormat &format);
+
+    // 收集材质中某一类型的纹理引用
+    static std::vector<MeshTextureRef> collectMaterialTextures(aiMaterial *mat, aiTextureType type, std::string typeName);
 
-    // 将 Assimp 的 aiMesh 数据转换为我们需要 Mesh 类数据
-    Mesh processMesh(aiMesh *mesh, const aiScene *scene);
+    // 加载纹理 (同一路径只加载一次，结果缓存在 textureHandles 中)
+    TextureInfo loadTexture(const std::string &path, const std::string &typeName, ResourceManager *resources);
 
-    // 加载材质纹理
-    // 检查材质中是否有纹理，如果有则加载，并处理缓存逻辑
-    std::vector<TextureInfo> loadMaterialTextures(aiMaterial *mat, aiTextureType type, std::string typeName);
+    // 合并所有子网格的包围体
+    static void computeBounds(ModelData &data);
 };
\ No newline at end of file
@@ -0,0 +1,354 @@
+#include "../renderer/occlusion_culler.h"
+#include "../renderer/mesh.h"
+#include "../core/jobs.h"
+#include "../core/profiler.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if SHADOW_SIMD_X86
+#include <emmintrin.h>
+
+// AVX2 版本在 occlusion_culler_avx2.cpp 里 (单独用 AVX2 编译选项编译)
+namespace occlusion_avx2 {
+    void rasterize_triangle(const OcclusionTriangle& triangle, float* depth, int width, int y0, int y1);
+}
+#endif
+
+namespace {
+    // 测试时的深度容差 (相对值)：物体最近的深度和遮挡物几乎相同时按可见处理 (比如遮挡物就是物体自己)
+    const float DEPTH_EPSILON = 1e-3f;
+
+    // ------------------------------------------------------------------------
+    // 标量版本：逐像素计算三条边函数，三条都非负的像素取较近的深度
+    // ------------------------------------------------------------------------
+    void rasterize_scalar(const OcclusionTriangle& t, float* depth, int width, int y0, int y1)
+    {
+        int row_begin = std::max(t.min_y, y0);
+        int row_end = std::min(t.max_y, y1 - 1);
+        for (int y = row_begin; y <= row_end; y++) {
+            float py = y + 0.5f;
+            float row_e0 = t.edge_b[0] * py + t.edge_c[0];
+            float row_e1 = t.edge_b[1] * py + t.edge_c[1];
+            float row_e2 = t.edge_b[2] * py + t.edge_c[2];
+            float row_z = t.depth_b * py + t.depth_c;
+            float* row = depth + static_cast<std::size_t>(y) * width;
+
+            for (int x = t.min_x; x <= t.max_x; x++) {
+                float px = x + 0.5f;
+                if (t.edge_a[0] * px + row_e0 < 0.0f || t.edge_a[1] * px + row_e1 < 0.0f || t.edge_a[2] * px + row_e2 < 0.0f)
+                    continue;
+                row[x] = std::max(row[x], t.depth_a * px + row_z);
+            }
+        }
+    }
+
+#if SHADOW_SIMD_X86
+    // ------------------------------------------------------------------------
+    // SSE2 版本：一行里 4 个像素一组 (从 4 对齐的位置开始，缓冲宽度是 8 的倍数，不会越界)
+    // ------------------------------------------------------------------------
+    void rasterize_sse(const OcclusionTriangle& t, float* depth, int width, int y0, int y1)
+    {
+        int row_begin = std::max(t.min_y, y0);
+        int row_end = std::min(t.max_y, y1 - 1);
+        int x_begin = t.min_x & ~3;
+
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 lane = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+        const __m128 a0 = _mm_set1_ps(t.edge_a[0]), a1 = _mm_set1_ps(t.edge_a[1]), a2 = _mm_set1_ps(t.edge_a[2]);
+        const __m128 az = _mm_set1_ps(t.depth_a);
+
+        for (int y = row_begin; y <= row_end; y++) {
+            float py = y + 0.5f;
+            const __m128 row_e0 = _mm_set1_ps(t.edge_b[0] * py + t.edge_c[0]);
+            const __m128 row_e1 = _mm_set1_ps(t.edge_b[1] * py + t.edge_c[1]);
+            const __m128 row_e2 = _mm_set1_ps(t.edge_b[2] * py + t.edge_c[2]);
+            const __m128 row_z = _mm_set1_ps(t.depth_b * py + t.depth_c);
+            float* row = depth + static_cast<std::size_t>(y) * width;
+
+            for (int x = x_begin; x <= t.max_x; x += 4) {
+                __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), lane);
+                // 任意一条边函数为负的像素不在三角形内
+                __m128 outside = _mm_or_ps(_mm_cmplt_ps(_mm_add_ps(_mm_mul_ps(a0, px), row_e0), zero),
+                                 _mm_or_ps(_mm_cmplt_ps(_mm_add_ps(_mm_mul_ps(a1, px), row_e1), zero),
+                                           _mm_cmplt_ps(_mm_add_ps(_mm_mul_ps(a2, px), row_e2), zero)));
+                if (_mm_movemask_ps(outside) == 0xF)
+                    continue;
+
+                __m128 z = _mm_add_ps(_mm_mul_ps(az, px), row_z);
+                __m128 current = _mm_loadu_ps(row + x);
+                __m128 nearer = _mm_max_ps(current, z);
+                _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(outside, current), _mm_andnot_ps(outside, nearer)));
+            }
+        }
+    }
+#endif
+
+    void rasterize_triangle(simd_level level, const OcclusionTriangle& triangle, float* depth, int width, int y0, int y1)
+    {
+        switch (level) {
+#if SHADOW_SIMD_X86
+            case simd_level::AVX2: occlusion_avx2::rasterize_triangle(triangle, depth, width, y0, y1); return;
+            case simd_level::SSE:  rasterize_sse(triangle, depth, width, y0, y1); return;
+#endif
+            default: rasterize_scalar(triangle, depth, width, y0, y1); return;
+        }
+    }
+
+    // 近平面 (GL 裁剪空间 z >= -w) 的有向距离
+    float near_distance(const glm::vec4& v)
+    {
+        return v.z + v.w;
+    }
+}
+
+OccluderMesh OccluderMesh::from_mesh(const Mesh& mesh)
+{
+    OccluderMesh occluder;
+    if (mesh.vertices.empty())
+        return occluder;
+
+    occluder.positions.reserve(mesh.vertices.size());
+    for (const Vertex& vertex : mesh.vertices)
+        occluder.positions.push_back(vertex.Position);
+
+    // 没有索引的网格 (手写的立方体) 按顺序每 3 个顶点一个三角形
+    if (!mesh.indices.empty()) {
+        occluder.indices.assign(mesh.indices.begin(), mesh.indices.end());
+    } else {
+        occluder.indices.resize(occluder.positions.size() / 3 * 3);
+        for (uint32_t i = 0; i < occluder.indices.size(); i++)
+            occluder.indices[i] = i;
+    }
+    return occluder;
+}
+
+OcclusionCuller::OcclusionCuller(int width, int height)
+{
+    this->width = std::max((width + 7) & ~7, 8);
+    this->height = std::max((height + BAND_HEIGHT - 1) / BAND_HEIGHT * BAND_HEIGHT, BAND_HEIGHT);
+    tiles_x = this->width / TILE_SIZE;
+    tiles_y = this->height / TILE_SIZE;
+    depth.assign(static_cast<std::size_t>(this->width) * this->height, 0.0f);
+    tile_depth.assign(static_cast<std::size_t>(tiles_x) * tiles_y, 0.0f);
+    level = detect_simd_level();
+}
+
+void OcclusionCuller::set_simd_level(simd_level requested)
+{
+    simd_level supported = detect_simd_level();
+    level = static_cast<int>(requested) > static_cast<int>(supported) ? supported : requested;
+}
+
+void OcclusionCuller::begin(const glm::mat4& matrix)
+{
+    view_projection = matrix;
+    triangles.clear();
+    stats = OcclusionStats();
+}
+
+void OcclusionCuller::add_occluder(const OccluderMesh& mesh, const glm::mat4& model)
+{
+    if (mesh.empty())
+        return;
+    stats.occluders++;
+
+    glm::mat4 mvp = view_projection * model;
+    clip_positions.resize(mesh.positions.size());
+    for (std::size_t i = 0; i < mesh.positions.size(); i++)
+        clip_positions[i] = mvp * glm::vec4(mesh.positions[i], 1.0f);
+
+    for (std::size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+        const glm::vec4* v[3] = { &clip_positions[mesh.indices[i]], &clip_positions[mesh.indices[i + 1]], &clip_positions[mesh.indices[i + 2]] };
+        float d[3] = { near_distance(*v[0]), near_distance(*v[1]), near_distance(*v[2]) };
+
+        if (d[0] >= 0.0f && d[1] >= 0.0f && d[2] >= 0.0f) {
+            add_triangle(*v[0], *v[1], *v[2]);
+            continue;
+        }
+        if (d[0] < 0.0f && d[1] < 0.0f && d[2] < 0.0f)
+            continue;
+
+        // -> 穿过近平面：裁剪成最多 4 个顶点的多边形，再拆成三角扇
+        glm::vec4 polygon[4];
+        int count = 0;
+        for (int k = 0; k < 3; k++) {
+            int next = (k + 1) % 3;
+            if (d[k] >= 0.0f)
+                polygon[count++] = *v[k];
+            if ((d[k] >= 0.0f) != (d[next] >= 0.0f))
+                polygon[count++] = glm::mix(*v[k], *v[next], d[k] / (d[k] - d[next]));
+        }
+        for (int k = 1; k + 1 < count; k++)
+            add_triangle(polygon[0], polygon[k], polygon[k + 1]);
+    }
+}
+
+void OcclusionCuller::add_triangle(const glm::vec4& v0, const glm::vec4& v1, const glm::vec4& v2)
+{
+    // 裁剪空间 -> 像素坐标 (y 向上) 和 1 / w
+    // 近平面裁剪之后 w 不小于近平面距离，不会除以 0
+    const glm::vec4* clip[3] = { &v0, &v1, &v2 };
+    double x[3], y[3], z[3];
+    for (int k = 0; k < 3; k++) {
+        double inv_w = 1.0 / std::max(clip[k]->w, 1e-6f);
+        x[k] = (clip[k]->x * inv_w * 0.5 + 0.5) * width;
+        y[k] = (clip[k]->y * inv_w * 0.5 + 0.5) * height;
+        z[k] = inv_w;
+    }
+
+    // 双面：顺时针的三角形交换两个顶点 (封闭网格的背面更远，不影响结果；单面的墙也能直接当遮挡物)
+    double area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+    if (area < 0.0) {
+        std::swap(x[1], x[2]);
+        std::swap(y[1], y[2]);
+        std::swap(z[1], z[2]);
+        area = -area;
+    }
+    if (area < 1e-8)
+        return;
+
+    // 覆盖到的像素中心：[ceil(min - 0.5), floor(max - 0.5)]，先在浮点里限制范围再转整数 (屏幕外的顶点可能非常远)
+    double min_x = std::ceil(std::min({ x[0], x[1], x[2] }) - 0.5), max_x = std::floor(std::max({ x[0], x[1], x[2] }) - 0.5);
+    double min_y = std::ceil(std::min({ y[0], y[1], y[2] }) - 0.5), max_y = std::floor(std::max({ y[0], y[1], y[2] }) - 0.5);
+    if (max_x < 0.0 || max_y < 0.0 || min_x > width - 1 || min_y > height - 1 || min_x > max_x || min_y > max_y)
+        return;
+
+    OcclusionTriangle triangle;
+    triangle.min_x = static_cast<int>(std::max(min_x, 0.0));
+    triangle.max_x = static_cast<int>(std::min(max_x, width - 1.0));
+    triangle.min_y = static_cast<int>(std::max(min_y, 0.0));
+    triangle.max_y = static_cast<int>(std::min(max_y, height - 1.0));
+
+    // 边 k 从顶点 k 指向顶点 k + 1，逆时针时三角形在每条边的左侧 (边函数为正)
+    for (int k = 0; k < 3; k++) {
+        int next = (k + 1) % 3;
+        double a = y[k] - y[next];
+        double b = x[next] - x[k];
+        triangle.edge_a[k] = static_cast<float>(a);
+        triangle.edge_b[k] = static_cast<float>(b);
+        triangle.edge_c[k] = static_cast<float>(-(a * x[k] + b * y[k]));
+    }
+
+    // 深度平面 z = depth_a * x + depth_b * y + depth_c
+    double dzdx = ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) / area;
+    double dzdy = ((z[2] - z[0]) * (x[1] - x[0]) - (z[1] - z[0]) * (x[2] - x[0])) / area;
+    triangle.depth_a = static_cast<float>(dzdx);
+    triangle.depth_b = static_cast<float>(dzdy);
+    triangle.depth_c = static_cast<float>(z[0] - dzdx * x[0] - dzdy * y[0]);
+
+    triangles.push_back(triangle);
+    stats.triangles++;
+}
+
+void OcclusionCuller::rasterize()
+{
+    PROFILE_CPU_SCOPE("Occlusion Raster");
+
+    int bands = height / BAND_HEIGHT;
+    JobSystem::parallel_for(static_cast<unsigned int>(bands), 1, [this](unsigned int begin, unsigned int end) {
+        for (unsigned int band = begin; band < end; band++)
+            rasterize_band(static_cast<int>(band));
+    });
+}
+
+void OcclusionCuller::rasterize_band(int band)
+{
+    int y0 = band * BAND_HEIGHT;
+    int y1 = y0 + BAND_HEIGHT;
+
+    // -> 清空这一条，画进和它相交的三角形
+    std::fill(depth.begin() + static_cast<std::size_t>(y0) * width, depth.begin() + static_cast<std::size_t>(y1) * width, 0.0f);
+    for (const OcclusionTriangle& triangle : triangles) {
+        if (triangle.max_y < y0 || triangle.min_y >= y1)
+            continue;
+        rasterize_triangle(level, triangle, depth.data(), width, y0, y1);
+    }
+
+    // -> 块层：每个 8x8 块里最远的深度
+    for (int ty = y0 / TILE_SIZE; ty < y1 / TILE_SIZE; ty++) {
+        for (int tx = 0; tx < tiles_x; tx++) {
+            float farthest = depth[static_cast<std::size_t>(ty * TILE_SIZE) * width + tx * TILE_SIZE];
+            for (int y = ty * TILE_SIZE; y < (ty + 1) * TILE_SIZE; y++) {
+                const float* row = depth.data() + static_cast<std::size_t>(y) * width + tx * TILE_SIZE;
+                for (int x = 0; x < TILE_SIZE; x++)
+                    farthest = std::min(farthest, row[x]);
+            }
+            tile_depth[static_cast<std::size_t>(ty) * tiles_x + tx] = farthest;
+        }
+    }
+}
+
+bool OcclusionCuller::is_visible(const AABB& world_bounds) const
+{
+    if (triangles.empty() || !world_bounds.is_valid())
+        return true;
+
+    // -> 8 个角投影到屏幕：屏幕矩形 + 最近的深度 (w 是位置的线性函数，最小值一定在某个角上)
+    float min_x = 1e30f, min_y = 1e30f, max_x = -1e30f, max_y = -1e30f;
+    float nearest = 0.0f;
+    for (int corner = 0; corner < 8; corner++) {
+        glm::vec3 p((corner & 1) ? world_bounds.max.x : world_bounds.min.x,
+                    (corner & 2) ? world_bounds.max.y : world_bounds.min.y,
+                    (corner & 4) ? world_bounds.max.z : world_bounds.min.z);
+        glm::vec4 clip = view_projection * glm::vec4(p, 1.0f);
+        // 穿过近平面：投影不再是凸包，直接按可见处理
+        if (near_distance(clip) <= 0.0f || clip.w <= 1e-6f)
+            return true;
+
+        float inv_w = 1.0f / clip.w;
+        float sx = (clip.x * inv_w * 0.5f + 0.5f) * width;
+        float sy = (clip.y * inv_w * 0.5f + 0.5f) * height;
+        min_x = std::min(min_x, sx); max_x = std::max(max_x, sx);
+        min_y = std::min(min_y, sy); max_y = std::max(max_y, sy);
+        nearest = std::max(nearest, inv_w);
+    }
+
+    // 完全在屏幕之外 (交给视锥剔除)
+    if (max_x < 0.0f || max_y < 0.0f || min_x >= width || min_y >= height)
+        return true;
+
+    int x0 = static_cast<int>(std::max(min_x, 0.0f));
+    int y0 = static_cast<int>(std::max(min_y, 0.0f));
+    int x1 = static_cast<int>(std::min(max_x, width - 1.0f));
+    int y1 = static_cast<int>(std::min(max_y, height - 1.0f));
+
+    // 遮挡物的深度 (1 / w) 必须明显大于物体最近的深度才算遮住
+    float limit = nearest * (1.0f + DEPTH_EPSILON);
+
+    // -> 先查块：整块都比物体近就跳过，否则逐像素检查块和矩形相交的部分
+    for (int ty = y0 / TILE_SIZE; ty <= y1 / TILE_SIZE; ty++) {
+        for (int tx = x0 / TILE_SIZE; tx <= x1 / TILE_SIZE; tx++) {
+            if (tile_depth[static_cast<std::size_t>(ty) * tiles_x + tx] > limit)
+                continue;
+
+            int px0 = std::max(x0, tx * TILE_SIZE), px1 = std::min(x1, tx * TILE_SIZE + TILE_SIZE - 1);
+            int py0 = std::max(y0, ty * TILE_SIZE), py1 = std::min(y1, ty * TILE_SIZE + TILE_SIZE - 1);
+            for (int y = py0; y <= py1; y++) {
+                const float* row = depth.data() + static_cast<std::size_t>(y) * width;
+                for (int x = px0; x <= px1; x++) {
+                    if (row[x] <= limit)
+                        return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+unsigned int OcclusionCuller::cull(const AABB* bounds, std::vector<uint32_t>& objects)
+{
+    PROFILE_CPU_SCOPE("Occlusion Test");
+
+    std::size_t kept = 0;
+    for (uint32_t id : objects) {
+        if (is_visible(bounds[id]))
+            objects[kept++] = id;
+    }
+
+    unsigned int occluded = static_cast<unsigned int>(objects.size() - kept);
+    stats.tested += static_cast<unsigned int>(objects.size());
+    stats.occluded += occluded;
+    objects.resize(kept);
+    return occluded;
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+#include "../core/cpu_features.h"
+#include "../scene/bounds.h"
+
+class Mesh;
+
+// 每帧的遮挡剔除统计
+struct OcclusionStats {
+    unsigned int occluders = 0;  // 画进深度缓冲的遮挡物
+    unsigned int triangles = 0;  // 光栅化的三角形 (近平面裁剪之后，不含完全在屏幕外的)
+    unsigned int tested = 0;     // 参与测试的物体
+    unsigned int occluded = 0;   // 被遮挡剔除的物体
+};
+
+// 遮挡物的几何：局部空间的三角形 (双面，不区分绕序)，通常是网格的简化版本
+// 遮挡物必须完全在它代表的物体内部 (比物体大会把后面实际可见的物体剔除掉)
+struct OccluderMesh {
+    std::vector<glm::vec3> positions;
+    std::vector<uint32_t>  indices;   // 每 3 个一个三角形
+
+    // 从网格的 CPU 端副本提取 (没有副本的网格返回空的遮挡物)
+    static OccluderMesh from_mesh(const Mesh& mesh);
+
+    bool empty() const { return indices.empty(); }
+};
+
+// 光栅化内核的输入：一个已经完成设置的屏幕空间三角形
+// 边函数 e = a * x + b * y + c 在三角形内部为非负，深度 (1 / w) 是屏幕坐标的线性函数
+struct OcclusionTriangle {
+    float edge_a[3], edge_b[3], edge_c[3];
+    float depth_a, depth_b, depth_c;
+    int min_x, max_x, min_y, max_y;   // 包围矩形 (像素，闭区间，已经限制在缓冲范围内)
+};
+
+// OcclusionCuller：CPU 软件遮挡剔除
+//
+// 每帧把少量大的遮挡物光栅化进一个低分辨率的深度缓冲 (默认 256x128)，再用物体的世界包围盒去测试：
+// - 深度存的是 1 / w (离摄像机越近越大)，它在屏幕空间是线性的，插值不需要透视校正
+// - 缓冲按 16 行一条切成若干条带，通过任务系统并行光栅化 (core/jobs.h)；每个三角形只在和自己的包围矩形相交的条带里光栅化
+// - 行内的像素用 SIMD 一次处理 4 个 (SSE2) 或 8 个 (AVX2)，按 CPU 支持的最高档选择，也可以强制较低的档位；
+//   三档的深度缓冲逐位相同 (见 tests/occlusion_culler_test.cpp)
+// - 条带画完后顺便算出每个 8x8 块里最远的深度，组成第二层 (层次深度缓冲)
+// 测试时取包围盒 8 个角投影后的屏幕矩形和最近的深度：先查块，块里最远的深度都比物体近才算整块遮住；
+// 没遮住的块再逐像素检查。包围盒穿过近平面或者完全在屏幕之外时按可见处理。
+// 只用 CPU，不需要 GL 上下文。
+class OcclusionCuller
+{
+public:
+    static constexpr int TILE_SIZE = 8;     // 第二层一个块的边长 (像素)
+    static constexpr int BAND_HEIGHT = 16;  // 并行光栅化时一条的行数 (TILE_SIZE 的整数倍)
+
+    // width 向上取整到 8 的倍数，height 向上取整到 BAND_HEIGHT 的倍数
+    explicit OcclusionCuller(int width = 256, int height = 128);
+
+    // 开始新的一帧：清空深度缓冲和遮挡物，记下摄像机的 Projection * View
+    void begin(const glm::mat4& view_projection);
+
+    // 添加一个遮挡物 (变换、近平面裁剪和三角形设置在这里完成)，begin 之后、rasterize 之前调用
+    void add_occluder(const OccluderMesh& mesh, const glm::mat4& model);
+
+    // 光栅化所有遮挡物并构建块层 (可以在任务里调用，内部再并行)
+    void rasterize();
+
+    // 包围盒是否可能可见 (rasterize 之后调用，只读，可以多线程同时调用)
+    bool is_visible(const AABB& world_bounds) const;
+
+    // 批量测试：objects 里是物体编号，bounds[编号] 为世界包围盒，被遮挡的物体从 objects 里移除
+    // 返回剔除的数量
+    unsigned int cull(const AABB* bounds, std::vector<uint32_t>& objects);
+
+    // 光栅化使用的 SIMD 档位 (超过 CPU 支持的档位时取支持的最高档)
+    void set_simd_level(simd_level level);
+    simd_level get_simd_level() const { return level; }
+
+    int get_width() const { return width; }
+    int get_height() const { return height; }
+    // 像素 (x, y) 的深度 1 / w (0 表示没有遮挡物)，y 从下往上
+    float get_depth(int x, int y) const { return depth[static_cast<std::size_t>(y) * width + x]; }
+
+    const OcclusionStats& get_stats() const { return stats; }
+
+private:
+    void add_triangle(const glm::vec4& v0, const glm::vec4& v1, const glm::vec4& v2);
+    void rasterize_band(int band);
+
+    int width = 0;
+    int height = 0;
+    int tiles_x = 0;
+    int tiles_y = 0;
+    simd_level level = simd_level::SCALAR;
+
+    glm::mat4 view_projection = glm::mat4(1.0f);
+
+    std::vector<float> depth;       // width * height，每个像素最近的遮挡物深度
+    std::vector<float> tile_depth;  // tiles_x * tiles_y，每个块里最远的深度 (块里的最小值)
+    std::vector<OcclusionTriangle> triangles;
+
+    // 变换后的顶点 (裁剪空间)，跨帧复用
+    std::vector<glm::vec4> clip_positions;
+
+    OcclusionStats stats;
+};
@@ -0,0 +1,49 @@
+// 遮挡剔除光栅化的 AVX2 版本
+// 这个文件单独用 AVX2 编译选项编译 (见 CMakeLists.txt)，只有运行时检测到 CPU 支持时才会被调用。
+// 乘加分开做、不用 FMA (CMake 里同时关掉了编译器自动合并乘加)：舍入和标量/SSE 版本一样，三档的深度逐位相同。
+// 和 transform_kernels_avx2.cpp 一样，这里不调用头文件里的 inline 函数 (包括 std::min/max)，
+// 避免链接器让其他文件共用这里编译出的 AVX2 版本。
+#include "occlusion_culler.h"
+
+#if SHADOW_SIMD_X86
+#include <immintrin.h>
+#include <cstddef>
+
+namespace occlusion_avx2 {
+    // 一行里 8 个像素一组 (从 8 对齐的位置开始，缓冲宽度是 8 的倍数，不会越界)
+    void rasterize_triangle(const OcclusionTriangle& t, float* depth, int width, int y0, int y1)
+    {
+        int row_begin = t.min_y > y0 ? t.min_y : y0;
+        int row_end = t.max_y < y1 - 1 ? t.max_y : y1 - 1;
+        int x_begin = t.min_x & ~7;
+
+        const __m256 zero = _mm256_setzero_ps();
+        const __m256 lane = _mm256_set_ps(7.5f, 6.5f, 5.5f, 4.5f, 3.5f, 2.5f, 1.5f, 0.5f);
+        const __m256 a0 = _mm256_set1_ps(t.edge_a[0]), a1 = _mm256_set1_ps(t.edge_a[1]), a2 = _mm256_set1_ps(t.edge_a[2]);
+        const __m256 az = _mm256_set1_ps(t.depth_a);
+
+        for (int y = row_begin; y <= row_end; y++) {
+            float py = y + 0.5f;
+            const __m256 row_e0 = _mm256_set1_ps(t.edge_b[0] * py + t.edge_c[0]);
+            const __m256 row_e1 = _mm256_set1_ps(t.edge_b[1] * py + t.edge_c[1]);
+            const __m256 row_e2 = _mm256_set1_ps(t.edge_b[2] * py + t.edge_c[2]);
+            const __m256 row_z = _mm256_set1_ps(t.depth_b * py + t.depth_c);
+            float* row = depth + static_cast<std::size_t>(y) * width;
+
+            for (int x = x_begin; x <= t.max_x; x += 8) {
+                __m256 px = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(x)), lane);
+                // 任意一条边函数为负的像素不在三角形内
+                __m256 outside = _mm256_or_ps(_mm256_cmp_ps(_mm256_add_ps(_mm256_mul_ps(a0, px), row_e0), zero, _CMP_LT_OQ),
+                                 _mm256_or_ps(_mm256_cmp_ps(_mm256_add_ps(_mm256_mul_ps(a1, px), row_e1), zero, _CMP_LT_OQ),
+                                              _mm256_cmp_ps(_mm256_add_ps(_mm256_mul_ps(a2, px), row_e2), zero, _CMP_LT_OQ)));
+                if (_mm256_movemask_ps(outside) == 0xFF)
+                    continue;
+
+                __m256 z = _mm256_add_ps(_mm256_mul_ps(az, px), row_z);
+                __m256 current = _mm256_loadu_ps(row + x);
+                _mm256_storeu_ps(row + x, _mm256_blendv_ps(_mm256_max_ps(current, z), current, outside));
+            }
+        }
+    }
+}
+#endif
@@ -0,0 +1,320 @@
+#include "../renderer/render_queue.h"
+#include "../core/profiler.h"
+
+#include <algorithm>
+
+namespace {
+    // 执行阶段跟踪的纹理单元数量 (超过的部分不做冗余检测)
+    const unsigned int MAX_TRACKED_TEXTURE_UNITS = 16;
+
+    // 把一组纹理 ID 折叠成 16 位的材质键
+    // 纹理组合相同的网格会得到相同的键，从而在排序后相邻
+    uint64_t hash_textures(const std::vector<TextureInfo>& textures)
+    {
+        uint32_t hash = 2166136261u; // FNV-1a
+        for (const TextureInfo& texture : textures) {
+            hash ^= texture.id;
+            hash *= 16777619u;
+        }
+        return (hash ^ (hash >> 16)) & 0xFFFF;
+    }
+}
+
+void RenderQueue::set_depth_range(float near_plane, float far_plane)
+{
+    depth_near = near_plane;
+    depth_far = far_plane > near_plane ? far_plane : near_plane + 1.0f;
+}
+
+void RenderQueue::clear()
+{
+    commands.clear();
+    entries.clear();
+    program_slots.clear();
+    last_program_slot = 0;
+    sorted = false;
+    stats = RenderQueueStats();
+}
+
+uint32_t RenderQueue::program_slot(unsigned int program)
+{
+    // 连续提交的绘制大多用同一个 Program，先看上一次的
+    if (last_program_slot < program_slots.size() && program_slots[last_program_slot] == program)
+        return last_program_slot;
+
+    auto it = std::find(program_slots.begin(), program_slots.end(), program);
+    if (it == program_slots.end())
+        it = program_slots.insert(program_slots.end(), program);
+    last_program_slot = static_cast<uint32_t>(it - program_slots.begin());
+    return last_program_slot;
+}
+
+uint64_t RenderQueue::make_key(render_pass pass, uint32_t program_index, const Mesh& mesh, unsigned int vao, float view_depth) const
+{
+    // 深度量化到 24 位
+    float normalized = (view_depth - depth_near) / (depth_far - depth_near);
+    if (!(normalized >= 0.0f))
+        normalized = 0.0f; // NaN (退化的模型矩阵) 会穿过 clamp，转成整数是未定义行为
+    normalized = std::clamp(normalized, 0.0f, 1.0f);
+    uint64_t depth = static_cast<uint64_t>(normalized * 16777215.0f) & 0xFFFFFF;
+
+    uint64_t pass_bits = static_cast<uint64_t>(pass) & 0x3;
+    uint64_t shader_bits = program_index & 0x3FF;
+    uint64_t material_bits = hash_textures(mesh.textures);
+    uint64_t vao_bits = vao & 0xFFF;
+
+    if (pass == render_pass::TRANSLUCENT) {
+        // 半透明：深度优先，并且取反 -> 远的先画
+        return (pass_bits << 62) | ((0xFFFFFF - depth) << 38) | (shader_bits << 28) | (material_bits << 12) | vao_bits;
+    }
+
+    // 不透明：状态优先，同状态内近的先画 (利于 Early-Z)
+    return (pass_bits << 62) | (shader_bits << 52) | (material_bits << 36) | (vao_bits << 24) | depth;
+}
+
+void RenderQueue::push(render_pass pass, const DrawCommand& command, float view_depth)
+{
+    SortEntry entry;
+    entry.key = make_key(pass, program_slot(command.shader->ID), *command.mesh, command.vao, view_depth);
+    entry.index = static_cast<uint32_t>(commands.size());
+
+    commands.push_back(command);
+    entries.push_back(entry);
+    sorted = false;
+}
+
+void RenderQueue::submit(render_pass pass, Shader& shader, const Mesh& mesh, const glm::mat4& model, float view_depth,
+                         unsigned int lod)
+{
+    push(pass, { &shader, &mesh, mesh.getVAO(), 0, lod, model }, view_depth);
+}
+
+void RenderQueue::submit(render_pass pass, Shader& shader, const InstancedMesh& instanced, float view_depth)
+{
+    if (instanced.get_instance_count() == 0)
+        return;
+
+    push(pass, { &shader, &instanced.get_mesh(), instanced.get_vao(), instanced.get_instance_count(), 0, glm::mat4(1.0f) }, view_depth);
+}
+
+void RenderQueue::radix_sort()
+{
+    // LSD 基数排序：8 轮，每轮按 8 位分桶，稳定且 O(n)
+    const size_t count = entries.size();
+    scratch.resize(count);
+
+    SortEntry* src = entries.data();
+    SortEntry* dst = scratch.data();
+
+    for (int shift = 0; shift < 64; shift += 8) {
+        size_t histogram[256] = {};
+        for (size_t i = 0; i < count; i++)
+            histogram[(src[i].key >> shift) & 0xFF]++;
+
+        // 这一字节所有键都相同 (很常见，比如 pass 位)，这一轮可以跳过
+        if (histogram[(src[0].key >> shift) & 0xFF] == count)
+            continue;
+
+        size_t offset = 0;
+        for (size_t& bucket : histogram) {
+            size_t bucket_count = bucket;
+            bucket = offset;
+            offset += bucket_count;
+        }
+
+        for (size_t i = 0; i < count; i++)
+            dst[histogram[(src[i].key >> shift) & 0xFF]++] = src[i];
+
+        std::swap(src, dst);
+    }
+
+    // 结果落在了辅助缓冲里，交换回来
+    if (src != entries.data())
+        entries.swap(scratch);
+}
+
+void RenderQueue::set_batch_shader(const Shader& shader, Shader& batched)
+{
+    batch_shaders[&shader] = &batched;
+}
+
+std::size_t RenderQueue::batch_end(std::size_t first, std::size_t end) const
+{
+    const DrawCommand& head = commands[entries[first].index];
+    const Mesh& mesh = *head.mesh;
+    if (head.instance_count != 0 || !mesh.isInArena() || mesh.indexCount == 0 ||
+        !mesh.getArena()->supports_multi_draw_indirect() || batch_shaders.count(head.shader) == 0)
+        return first + 1;
+
+    // 同一个 Shader、同一页 (VAO)、同样的纹理、索引宽度和解码参数才能放进同一次 MDI
+    std::size_t last = first + 1;
+    for (; last < end; last++) {
+        const DrawCommand& command = commands[entries[last].index];
+        const Mesh& other = *command.mesh;
+        if (command.instance_count != 0 || command.shader != head.shader || command.vao != head.vao ||
+            other.getArena() != mesh.getArena() || other.indexCount == 0 || other.indexSize != mesh.indexSize ||
+            other.decode != mesh.decode || other.textures.size() != mesh.textures.size())
+            break;
+
+        bool same_textures = true;
+        for (std::size_t i = 0; i < mesh.textures.size() && same_textures; i++)
+            same_textures = other.textures[i].id == mesh.textures[i].id;
+        if (!same_textures)
+            break;
+    }
+    return last;
+}
+
+void RenderQueue::execute()
+{
+    execute(render_pass::SOLID, render_pass::OVERLAY);
+}
+
+void RenderQueue::execute(render_pass first, render_pass last)
+{
+    PROFILE_SCOPE("Render Queue");
+    if (entries.empty())
+        return;
+
+    if (!sorted) {
+        radix_sort();
+        sorted = true;
+    }
+
+    // pass 在键的最高位，排序后每个阶段是连续的一段
+    auto pass_of = [](const SortEntry& entry) { return static_cast<uint8_t>(entry.key >> 62); };
+    std::size_t begin = std::partition_point(entries.begin(), entries.end(), [&](const SortEntry& entry) {
+        return pass_of(entry) < static_cast<uint8_t>(first);
+    }) - entries.begin();
+    std::size_t end = std::partition_point(entries.begin() + begin, entries.end(), [&](const SortEntry& entry) {
+        return pass_of(entry) <= static_cast<uint8_t>(last);
+    }) - entries.begin();
+    if (begin == end)
+        return;
+
+    // 当前的 GL 状态 (只在变化时才发出绑定调用)
+    unsigned int current_program = 0;
+    unsigned int current_vao = 0;
+    unsigned int bound_textures[MAX_TRACKED_TEXTURE_UNITS] = {};
+    int model_location = -1;
+
+    // 采样器 Uniform 是 Program 的状态，同一个 Program 同一个位置只需要设置一次
+    // 每次执行重新记录，避免 Program 重新链接后缓存失效
+    sampler_units.clear();
+
+    // 顶点解码参数同样是 Program 的状态：记录每个 Program 最后一次设置的值
+    // 同一种顶点格式、同一个网格连续绘制时不需要重复设置
+    program_decodes.clear();
+
+    // 绑定一条命令需要的 Program/纹理/解码参数/VAO (合批时 shader 是合批版本)
+    auto bind_state = [&](Shader& shader, const DrawCommand& command) {
+        const Mesh& mesh = *command.mesh;
+
+        // Program
+        if (shader.ID != current_program) {
+            shader.use();
+            current_program = shader.ID;
+            model_location = shader.getUniformLocation("model");
+            stats.program_binds++;
+        } else {
+            stats.program_binds_saved++;
+        }
+
+        // 纹理：第 i 个纹理固定使用纹理单元 i (与 Mesh::bindTextures 的约定一致)
+        for (unsigned int i = 0; i < mesh.textures.size(); i++) {
+            int location = shader.getUniformLocation(mesh.samplerNames[i]);
+            if (location >= 0) {
+                auto it = std::find_if(sampler_units.begin(), sampler_units.end(), [&](const SamplerUnit& sampler) {
+                    return sampler.program == current_program && sampler.location == location;
+                });
+                if (it == sampler_units.end()) {
+                    shader.setInt(location, i);
+                    sampler_units.push_back({ current_program, location, static_cast<int>(i) });
+                } else if (it->unit != static_cast<int>(i)) {
+                    shader.setInt(location, i);
+                    it->unit = i;
+                }
+            }
+
+            unsigned int texture_id = mesh.textures[i].id;
+            if (i >= MAX_TRACKED_TEXTURE_UNITS || bound_textures[i] != texture_id) {
+                glActiveTexture(GL_TEXTURE0 + i);
+                glBindTexture(GL_TEXTURE_2D, texture_id);
+                if (i < MAX_TRACKED_TEXTURE_UNITS)
+                    bound_textures[i] = texture_id;
+                stats.texture_binds++;
+            } else {
+                stats.texture_binds_saved++;
+            }
+        }
+
+        // 顶点解码
+        auto decode_it = std::find_if(program_decodes.begin(), program_decodes.end(), [&](const ProgramDecode& entry) {
+            return entry.program == current_program;
+        });
+        if (decode_it == program_decodes.end()) {
+            mesh.bindVertexDecode(shader);
+            program_decodes.push_back({ current_program, mesh.decode });
+        } else if (decode_it->decode != mesh.decode) {
+            mesh.bindVertexDecode(shader);
+            decode_it->decode = mesh.decode;
+        }
+
+        // VAO
+        if (command.vao != current_vao) {
+            glBindVertexArray(command.vao);
+            current_vao = command.vao;
+            stats.vao_binds++;
+        } else {
+            stats.vao_binds_saved++;
+        }
+    };
+
+    std::size_t position = begin;
+    while (position < end) {
+        const DrawCommand& command = commands[entries[position].index];
+        const Mesh& mesh = *command.mesh;
+
+        // 几何池中可以合批的一段：一次 MDI，第 k 个网格的模型矩阵是第 k 个实例
+        std::size_t batch_last = batch_end(position, end);
+        if (batch_last - position >= 2) {
+            bind_state(*batch_shaders[command.shader], command);
+
+            batch_commands.clear();
+            batch_instances.clear();
+            for (std::size_t i = position; i < batch_last; i++) {
+                const DrawCommand& batched = commands[entries[i].index];
+                const Mesh& batched_mesh = *batched.mesh;
+                DrawElementsIndirectCommand draw;
+                draw.count = batched_mesh.getLod(batched.lod).indexCount;
+                draw.instance_count = 1;
+                draw.first_index = batched_mesh.getFirstIndex(batched.lod);
+                draw.base_vertex = batched_mesh.getBaseVertex();
+                draw.base_instance = static_cast<uint32_t>(batch_instances.size());
+                batch_commands.push_back(draw);
+                batch_instances.push_back({ batched.model, glm::vec4(1.0f) });
+            }
+            mesh.getArena()->multi_draw(index_type_for(mesh.indexSize), batch_commands, batch_instances);
+
+            stats.draw_calls++;
+            stats.multi_draw_batches++;
+            stats.batched_draws += static_cast<unsigned int>(batch_last - position);
+            position = batch_last;
+            continue;
+        }
+
+        bind_state(*command.shader, command);
+
+        // 非实例化绘制需要设置模型矩阵；实例化的矩阵在实例缓冲里
+        if (command.instance_count == 0)
+            command.shader->setMat4(model_location, command.model);
+
+        mesh.issueDrawCall(command.instance_count, command.lod);
+        stats.draw_calls++;
+        position++;
+    }
+
+    // 恢复默认状态，避免影响队列之外的绘制 (比如 ImGui)
+    glBindVertexArray(0);
+    glActiveTexture(GL_TEXTURE0);
+}
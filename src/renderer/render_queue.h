@@ -0,0 +1,134 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "mesh.h"
+#include "shader.h"
+#include "instanced_mesh.h"
+#include "geometry_arena.h"
+
+// 渲染阶段 (排序键的最高位，决定大的绘制顺序)
+enum class render_pass : uint8_t {
+    SOLID       = 0,   // 不透明物体：按状态排序，同状态内由近到远
+    TRANSLUCENT = 1,   // 半透明物体：严格由远到近
+    OVERLAY     = 2    // 叠加层 (灯泡、调试几何等)
+};
+
+// 每帧的状态切换统计
+// "saved" 是相对于逐个绘制 (每个 Draw 都重新绑定 Program/纹理/VAO) 省下来的次数
+struct RenderQueueStats {
+    unsigned int draw_calls = 0;
+    unsigned int program_binds = 0;
+    unsigned int texture_binds = 0;
+    unsigned int vao_binds = 0;
+    unsigned int program_binds_saved = 0;
+    unsigned int texture_binds_saved = 0;
+    unsigned int vao_binds_saved = 0;
+    unsigned int multi_draw_batches = 0;  // glMultiDrawElementsIndirect 调用次数 (每次计入一个 draw call)
+    unsigned int batched_draws = 0;       // 被合并进 MDI 的网格数
+};
+
+// RenderQueue：先收集、再排序、最后统一执行的绘制队列
+//
+// 每个 Draw 被打包成一个 64 位排序键：
+//   不透明: [pass:2][shader:10][material:16][vao:12][depth:24]
+//   半透明: [pass:2][depth:24 (取反)][shader:10][material:16][vao:12]
+// shader 是本帧第一次遇到这个 Program 的先后编号 (不直接用 Program ID：ID 相差 1024 的倍数会落进同一个桶)
+// 每帧对键做一次基数排序，执行时只在状态真正变化时才调用 glUseProgram/glBindTexture/glBindVertexArray
+//
+// 几何池中的网格共用每页的 VAO，排序后同一 Shader、同一材质、同一页的网格是连续的；
+// GL 4.3 可用并且 Shader 登记了合批版本时，这样的一段命令合并成一次 glMultiDrawElementsIndirect
+class RenderQueue
+{
+public:
+    // 深度量化的范围 (一般就是摄像机的近/远平面)
+    void set_depth_range(float near_plane, float far_plane);
+
+    // 清空上一帧提交的内容 (统计也在这里清零)
+    void clear();
+
+    // 提交一个普通网格
+    // view_depth 为物体到摄像机的距离，用于同状态内排序；lod 为网格的 LOD 级别
+    void submit(render_pass pass, Shader& shader, const Mesh& mesh, const glm::mat4& model, float view_depth = 0.0f,
+                unsigned int lod = 0);
+
+    // 提交一个实例化网格 (实例数据需要事先 upload)
+    void submit(render_pass pass, Shader& shader, const InstancedMesh& instanced, float view_depth = 0.0f);
+
+    // 登记 shader 的合批版本：顶点着色器从实例属性读取模型矩阵 (与实例化着色器相同)，其余完全一致
+    // 只有登记过的 Shader 才会参与 MDI 合批
+    void set_batch_shader(const Shader& shader, Shader& batched);
+
+    // 排序并执行所有绘制
+    void execute();
+
+    // 只执行 [first, last] 这几个阶段的绘制 (比如延迟渲染先画不透明物体，屏幕空间光照之后再画叠加层)
+    // 提交之后只排序一次；同一帧的多次执行，统计累加
+    void execute(render_pass first, render_pass last);
+
+    unsigned int size() const { return static_cast<unsigned int>(commands.size()); }
+    const RenderQueueStats& get_stats() const { return stats; }
+
+private:
+    // 一条绘制命令
+    struct DrawCommand {
+        Shader*      shader;
+        const Mesh*  mesh;            // 提供纹理、采样器名字和绘制参数
+        unsigned int vao;
+        unsigned int instance_count;  // 0 表示非实例化
+        unsigned int lod;             // 网格的 LOD 级别
+        glm::mat4    model;           // 非实例化时使用
+    };
+
+    // 排序用的 (键, 命令下标) 对
+    struct SortEntry {
+        uint64_t key;
+        uint32_t index;
+    };
+
+    std::vector<DrawCommand> commands;
+    std::vector<SortEntry>   entries;
+    std::vector<SortEntry>   scratch;   // 基数排序的辅助缓冲，跨帧复用
+    bool sorted = false;                // entries 已经排好序 (提交新的绘制后失效)
+
+    float depth_near = 0.1f;
+    float depth_far  = 100.0f;
+
+    RenderQueueStats stats;
+
+    // Shader -> 合批版本的 Shader (按对象而不是 Program ID：热重载后 ID 会变)
+    std::unordered_map<const Shader*, Shader*> batch_shaders;
+
+    // MDI 的命令和实例数据，跨帧复用
+    std::vector<DrawElementsIndirectCommand> batch_commands;
+    std::vector<InstanceData> batch_instances;
+
+    // 执行阶段记录的 Program 状态：每次 execute 清空 (Program 可能重新链接)，容量跨帧复用
+    // 每帧用到的 Program 只有几个，线性查找比哈希表快，也不会分配内存
+    struct SamplerUnit {
+        unsigned int program;
+        int location;
+        int unit;
+    };
+    struct ProgramDecode {
+        unsigned int program;
+        VertexDecode decode;
+    };
+    std::vector<SamplerUnit>   sampler_units;
+    std::vector<ProgramDecode> program_decodes;
+
+    // 本帧提交过的 Program ID，下标就是排序键里的 shader 字段 (每帧只有几个，线性查找)
+    std::vector<unsigned int> program_slots;
+    uint32_t last_program_slot = 0;
+
+    uint32_t program_slot(unsigned int program);
+    uint64_t make_key(render_pass pass, uint32_t program_index, const Mesh& mesh, unsigned int vao, float view_depth) const;
+    void push(render_pass pass, const DrawCommand& command, float view_depth);
+    void radix_sort();
+
+    // 从 entries[first] 开始、不超过 end 的可以合并成一次 MDI 的命令段的末尾 (不能合并时返回 first + 1)
+    std::size_t batch_end(std::size_t first, std::size_t end) const;
+};
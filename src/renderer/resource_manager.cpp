@@ -0,0 +1,253 @@
+#include "resource_manager.h"
+
+#include "geometry_arena.h"
+#include "model.h"
+#include "shader_reloader.h"
+#include "texture.h"
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <iostream>
+
+namespace {
+    const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+    const uint64_t FNV_PRIME = 1099511628211ull;
+
+    // 64 位 FNV-1a，seed 用来区分资源类型和加载参数
+    uint64_t hash_key(const std::string& key, uint64_t seed)
+    {
+        uint64_t hash = FNV_OFFSET_BASIS ^ (seed * FNV_PRIME);
+        for (unsigned char c : key) {
+            hash ^= c;
+            hash *= FNV_PRIME;
+        }
+        return hash;
+    }
+
+    std::shared_ptr<Shader> create_shader(const std::string& vertex_path, const std::string& fragment_path,
+                                          const std::string& defines, ShaderCache* cache)
+    {
+        // Shader 本身不删除程序对象，由最后一个持有者负责 (热重载替换程序时旧的程序由 Shader 自己删除)
+        return std::shared_ptr<Shader>(new Shader(vertex_path.c_str(), fragment_path.c_str(), cache, defines), [](Shader* shader) {
+            glDeleteProgram(shader->ID);
+            delete shader;
+        });
+    }
+}
+
+ResourceManager::ResourceManager(AsyncLoader* loader, std::size_t memory_budget)
+    : loader(loader), memory_budget(memory_budget)
+{
+    stats.memory_budget = memory_budget;
+}
+
+ResourceManager::~ResourceManager()
+{
+    // 先释放模型 (它们持有纹理句柄)，再释放其余资源
+    for (auto& [hash, entry] : entries) {
+        if (entry.type == resource_type::MODEL)
+            entry.resource.reset();
+    }
+    entries.clear();
+    lru.clear();
+}
+
+std::string ResourceManager::normalize_path(const std::string& path)
+{
+    std::string normalized = std::filesystem::path(path).lexically_normal().generic_string();
+#ifdef _WIN32
+    std::transform(normalized.begin(), normalized.end(), normalized.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+#endif
+    return normalized;
+}
+
+TextureHandle ResourceManager::load_texture_uncached(const std::string& path, bool flip_vertically)
+{
+    TextureHandle texture = std::make_shared<AsyncTexture>();
+    texture->path = path;
+    texture->id = load_texture_file(path, flip_vertically, &texture->width, &texture->height, &texture->channels);
+    texture->state = texture->width > 0 ? load_state::READY : load_state::FAILED;
+    return texture;
+}
+
+TextureHandle ResourceManager::load_texture(const std::string& path, bool flip_vertically)
+{
+    std::string key = normalize_path(path);
+    uint64_t hash = hash_key(key, flip_vertically ? 1 : 2);
+    if (Entry* entry = find(hash, resource_type::TEXTURE, key))
+        return std::static_pointer_cast<AsyncTexture>(entry->resource);
+
+    TextureHandle texture = loader ? loader->load_texture(key, flip_vertically) : load_texture_uncached(key, flip_vertically);
+    insert(hash, resource_type::TEXTURE, key, texture);
+    return texture;
+}
+
+ModelHandle ResourceManager::load_model(const std::string& path, const VertexFormat& format)
+{
+    std::string key = normalize_path(path);
+    uint64_t hash = hash_key(key, (uint64_t(format.key()) << 8) | 3);
+    if (Entry* entry = find(hash, resource_type::MODEL, key))
+        return std::static_pointer_cast<AsyncModel>(entry->resource);
+
+    ModelHandle model;
+    if (loader) {
+        model = loader->load_model(key, this, format);
+    }
+    else {
+        model = std::make_shared<AsyncModel>();
+        model->path = key;
+        model->model = std::make_shared<Model>(key, false, this, format);
+        model->state = model->model->meshes.empty() ? load_state::FAILED : load_state::READY;
+    }
+    insert(hash, resource_type::MODEL, key, model);
+    return model;
+}
+
+std::shared_ptr<Shader> ResourceManager::load_shader(const std::string& vertex_path, const std::string& fragment_path,
+                                                     const std::string& defines)
+{
+    std::string key = normalize_path(vertex_path) + '|' + normalize_path(fragment_path) + '|' + defines;
+    uint64_t hash = hash_key(key, 4);
+    if (Entry* entry = find(hash, resource_type::SHADER, key))
+        return std::static_pointer_cast<Shader>(entry->resource);
+
+    std::shared_ptr<Shader> shader = create_shader(vertex_path, fragment_path, defines, shader_cache);
+    if (shader_reloader)
+        shader_reloader->add(shader);
+    insert(hash, resource_type::SHADER, key, shader);
+    return shader;
+}
+
+ResourceManager::Entry* ResourceManager::find(uint64_t hash, resource_type type, const std::string& key)
+{
+    auto it = entries.find(hash);
+    if (it == entries.end() || it->second.type != type || it->second.key != key)
+        return nullptr;
+
+    stats.hits++;
+    lru.splice(lru.begin(), lru, it->second.lru_position);
+    return &it->second;
+}
+
+void ResourceManager::insert(uint64_t hash, resource_type type, const std::string& key, std::shared_ptr<void> resource)
+{
+    stats.misses++;
+
+    auto it = entries.find(hash);
+    if (it != entries.end()) {
+        // 两个不同路径哈希到同一个值 (极少见)：资源照常返回，只是不进缓存
+        std::cout << "ERROR::RESOURCE::HASH_COLLISION: " << key << " vs " << it->second.key << std::endl;
+        return;
+    }
+
+    lru.push_front(hash);
+    Entry& entry = entries[hash];
+    entry.type = type;
+    entry.key = key;
+    entry.resource = std::move(resource);
+    entry.lru_position = lru.begin();
+}
+
+void ResourceManager::evict(uint64_t hash)
+{
+    auto it = entries.find(hash);
+    lru.erase(it->second.lru_position);
+    entries.erase(it);
+    stats.evictions++;
+}
+
+std::size_t ResourceManager::estimate_bytes(const Entry& entry)
+{
+    switch (entry.type) {
+        case resource_type::TEXTURE: {
+            const AsyncTexture& texture = *std::static_pointer_cast<AsyncTexture>(entry.resource);
+            // 加上 Mipmap 链大约多出 1/3
+            return std::size_t(texture.width) * texture.height * texture.channels * 4 / 3;
+        }
+        case resource_type::MODEL: {
+            const AsyncModel& model = *std::static_pointer_cast<AsyncModel>(entry.resource);
+            if (!model.is_ready())
+                return 0;
+            // 只统计网格缓冲，模型的纹理作为独立的资源统计
+            std::size_t bytes = 0;
+            for (const Mesh& mesh : model.model->meshes)
+                bytes += mesh.getGpuBytes();
+            return bytes;
+        }
+        default:
+            // 程序对象由驱动管理，体积很小，不计入预算
+            return 0;
+    }
+}
+
+void ResourceManager::trim()
+{
+    // -> 重新统计 (异步资源的大小要等加载完成后才知道)
+    stats.textures = stats.models = stats.shaders = stats.unused = 0;
+    stats.memory_bytes = 0;
+    for (auto& [hash, entry] : entries) {
+        entry.bytes = estimate_bytes(entry);
+        stats.memory_bytes += entry.bytes;
+        if (entry.resource.use_count() == 1)
+            stats.unused++;
+        switch (entry.type) {
+            case resource_type::TEXTURE: stats.textures++; break;
+            case resource_type::MODEL:   stats.models++;   break;
+            case resource_type::SHADER:  stats.shaders++;  break;
+        }
+    }
+    stats.memory_budget = memory_budget;
+
+    // -> 超出预算：从 LRU 队尾开始淘汰只被缓存持有的资源
+    // 淘汰模型会释放它持有的纹理句柄，所以重复扫描直到不再超预算或者没有可淘汰的资源
+    bool evicted = true;
+    while (stats.memory_bytes > memory_budget && evicted) {
+        evicted = false;
+        for (auto it = lru.rbegin(); it != lru.rend() && stats.memory_bytes > memory_budget; ) {
+            Entry& entry = entries[*it];
+            if (entry.resource.use_count() > 1) {
+                ++it;
+                continue;
+            }
+            stats.memory_bytes -= entry.bytes;
+            stats.unused--;
+            switch (entry.type) {
+                case resource_type::TEXTURE: stats.textures--; break;
+                case resource_type::MODEL:   stats.models--;   break;
+                case resource_type::SHADER:  stats.shaders--;  break;
+            }
+            uint64_t hash = *it;
+            it = std::list<uint64_t>::reverse_iterator(lru.erase(std::next(it).base()));
+            entries.erase(hash);
+            stats.evictions++;
+            evicted = true;
+        }
+    }
+}
+
+void ResourceManager::release_unused()
+{
+    // 模型释放后它的纹理才变成没人使用，所以重复到没有变化为止
+    bool released = true;
+    while (released) {
+        released = false;
+        for (auto it = entries.begin(); it != entries.end(); ) {
+            if (it->second.resource.use_count() == 1) {
+                uint64_t hash = it->first;
+                ++it;
+                evict(hash);
+                released = true;
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+    trim();
+
+    // 一次释放了很多网格，几何池里留下的空洞在这里合并
+    if (geometry_arena)
+        geometry_arena->defragment();
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "async_loader.h"
+#include "shader.h"
+
+class GeometryArena;
+class ShaderCache;
+class ShaderReloader;
+
+// 资源统计
+struct ResourceStats {
+    unsigned int textures = 0;
+    unsigned int models = 0;
+    unsigned int shaders = 0;
+    unsigned int unused = 0;          // 只被缓存持有、可以被淘汰的资源
+    std::size_t memory_bytes = 0;     // 估算的显存占用 (纹理 + 网格缓冲)
+    std::size_t memory_budget = 0;
+    uint64_t hits = 0;                // 累计命中次数
+    uint64_t misses = 0;              // 累计未命中 (真正加载) 次数
+    uint64_t evictions = 0;           // 累计淘汰次数
+};
+
+// ResourceManager：引擎统一的资源缓存
+//
+// 纹理、模型 (网格) 和着色器按 "规范化路径的哈希" 去重，同一个文件无论被请求多少次都只加载一次。
+// 返回的句柄是引用计数的 shared_ptr；缓存自己也持有一份，所以暂时没人用的资源不会立刻释放，
+// 再次请求时直接命中。显存估算超过预算时，trim() 按最近最少使用 (LRU) 的顺序淘汰
+// 只被缓存持有的资源，正在使用的资源永远不会被淘汰。
+//
+// 只在 GL 线程上使用。构造时传入 AsyncLoader 则纹理和模型走异步加载，否则同步加载。
+class ResourceManager
+{
+public:
+    explicit ResourceManager(AsyncLoader* loader = nullptr, std::size_t memory_budget = 512u << 20);
+    ~ResourceManager();
+
+    ResourceManager(const ResourceManager&) = delete;
+    ResourceManager& operator=(const ResourceManager&) = delete;
+
+    // 加载纹理 (flip_vertically 参与缓存键：同一张图翻转/不翻转是两个纹理)
+    TextureHandle load_texture(const std::string& path, bool flip_vertically = true);
+
+    // 加载模型 (模型的纹理同样通过本管理器加载，多个模型共用同一张贴图)
+    // 顶点格式参与缓存键
+    ModelHandle load_model(const std::string& path, const VertexFormat& format = VertexFormat::standard());
+
+    // 加载着色器程序 (顶点 + 片段路径 + defines 一起作为缓存键)
+    // defines 不为空时是同一对源码的一个变体 (见 shader_permutations.h)
+    std::shared_ptr<Shader> load_shader(const std::string& vertex_path, const std::string& fragment_path,
+                                        const std::string& defines = "");
+
+    // 几何池：设置后新加载的模型从池里子分配顶点/索引 (池必须比资源管理器活得久)
+    void set_geometry_arena(GeometryArena* arena) { geometry_arena = arena; }
+    GeometryArena* get_geometry_arena() const { return geometry_arena; }
+
+    // 着色器的程序二进制缓存和热重载：设置后新加载的着色器先查缓存，并登记到重载器
+    // (两者都必须比资源管理器活得久，不设置时每次都编译、不热重载)
+    void set_shader_cache(ShaderCache* cache) { shader_cache = cache; }
+    void set_shader_reloader(ShaderReloader* reloader) { shader_reloader = reloader; }
+
+    // 显存预算 (字节)
+    void set_memory_budget(std::size_t bytes) { memory_budget = bytes; }
+
+    // 每帧调用一次：重新统计显存占用，超出预算时按 LRU 淘汰没人使用的资源
+    void trim();
+
+    // 立刻释放所有没人使用的资源 (切换场景时使用)，之后整理几何池的碎片
+    void release_unused();
+
+    const ResourceStats& get_stats() const { return stats; }
+
+    // 路径规范化：统一分隔符为 '/'，去掉 "./" 和 "xx/../" (Windows 下不区分大小写)
+    static std::string normalize_path(const std::string& path);
+
+    // 不经过缓存，直接同步加载一张纹理 (没有资源管理器时使用)
+    static TextureHandle load_texture_uncached(const std::string& path, bool flip_vertically = true);
+
+private:
+    enum class resource_type : uint8_t { TEXTURE, MODEL, SHADER };
+
+    struct Entry {
+        resource_type type;
+        std::string key;                  // 规范化后的路径 (哈希冲突时用来区分)
+        std::shared_ptr<void> resource;
+        std::size_t bytes = 0;
+        std::list<uint64_t>::iterator lru_position;
+    };
+
+    // 查找缓存，命中时移到 LRU 队首
+    Entry* find(uint64_t hash, resource_type type, const std::string& key);
+    void insert(uint64_t hash, resource_type type, const std::string& key, std::shared_ptr<void> resource);
+    void evict(uint64_t hash);
+
+    // 估算单个资源的显存占用
+    static std::size_t estimate_bytes(const Entry& entry);
+
+    AsyncLoader* loader;
+    std::size_t memory_budget;
+    GeometryArena* geometry_arena = nullptr;
+    ShaderCache* shader_cache = nullptr;
+    ShaderReloader* shader_reloader = nullptr;
+
+    std::unordered_map<uint64_t, Entry> entries;
+    std::list<uint64_t> lru; // 队首是最近使用的
+
+    ResourceStats stats;
+};
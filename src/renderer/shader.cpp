@@ -1,14 +1,57 @@
 ﻿#include "../renderer/shader.h"
+#include "../renderer/uniform_blocks.h"
+#include "../renderer/shader_cache.h"
 
 #include <fstream>
 #include <sstream>
 #include <iostream>
 
-Shader::Shader(const char* vertexPath, const char* fragmentPath)
+namespace {
+    // 驱动是否支持并行编译 (可以不阻塞地查询编译是否完成)
+    bool has_parallel_compile()
+    {
+        return GLAD_GL_KHR_parallel_shader_compile || GLAD_GL_ARB_parallel_shader_compile;
+    }
+
+    bool is_sampler_type(GLenum type)
+    {
+        switch (type) {
+            case GL_SAMPLER_1D: case GL_SAMPLER_2D: case GL_SAMPLER_3D: case GL_SAMPLER_CUBE:
+            case GL_SAMPLER_2D_SHADOW: case GL_SAMPLER_2D_ARRAY: case GL_SAMPLER_2D_ARRAY_SHADOW:
+            case GL_SAMPLER_CUBE_SHADOW: case GL_SAMPLER_BUFFER: case GL_SAMPLER_2D_MULTISAMPLE:
+            case GL_INT_SAMPLER_2D: case GL_INT_SAMPLER_BUFFER:
+            case GL_UNSIGNED_INT_SAMPLER_2D: case GL_UNSIGNED_INT_SAMPLER_BUFFER:
+                return true;
+            default:
+                return false;
+        }
+    }
+}
+
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+Shader::Shader(const char* vertexPath, const char* fragmentPath, ShaderCache* cache, const std::string &defines)
+    : vertexPath(vertexPath), fragmentPath(fragmentPath), defines(defines)
 {
     // 从文件路径中获取顶点/片段着色器
     std::string vertexCode;
     std::string fragmentCode;
+    readSources(this->vertexPath, this->fragmentPath, vertexCode, fragmentCode);
+
+    // 编译 (或者从缓存创建) 并链接，启动时直接等结果
+    ShaderBuild build = beginBuild(vertexCode, fragmentCode, defines, cache);
+    finishBuild(build, cache);
+    ID = build.program;
+
+    // 链接完成后，一次性把所有 Uniform 位置缓存下来
+    reflectUniforms();
+}
+
+bool Shader::readSources(const std::string &vertexPath, const std::string &fragmentPath,
+                         std::string &vertexCode, std::string &fragmentCode)
+{
     std::ifstream vShaderFile;
     std::ifstream fShaderFile;
 
@@ -38,36 +81,148 @@ Shader::Shader(const char* vertexPath, const char* fragmentPath)
     catch (std::ifstream::failure& e)
     {
         std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << e.what() << std::endl;
+        return false;
     }
+    return true;
+}
+
+std::string Shader::injectDefines(const std::string &code, const std::string &defines)
+{
+    if (defines.empty())
+        return code;
+
+    // #version 必须是第一条语句：插在它的下一行，没有 #version 时插在最前面
+    std::size_t versionLine = code.find("#version");
+    if (versionLine == std::string::npos)
+        return defines + "#line 1\n" + code;
+
+    std::size_t lineEnd = code.find('\n', versionLine);
+    if (lineEnd == std::string::npos)
+        return code + "\n" + defines;
+
+    // #version 之前的行数 (通常是 0) + #version 自己，决定下一行的行号
+    int nextLine = 2;
+    for (std::size_t i = 0; i < versionLine; i++)
+        nextLine += code[i] == '\n';
+    return code.substr(0, lineEnd + 1) + defines + "#line " + std::to_string(nextLine) + "\n" + code.substr(lineEnd + 1);
+}
 
-    const char* vShaderCode = vertexCode.c_str();
-    const char* fShaderCode = fragmentCode.c_str();
+ShaderBuild Shader::beginBuild(const std::string &vertexCode, const std::string &fragmentCode,
+                               const std::string &defines, ShaderCache* cache)
+{
+    ShaderBuild build;
+
+    // 先查程序二进制缓存：命中时不需要编译
+    if (cache) {
+        build.cacheKey = cache->make_key(vertexCode, fragmentCode, defines);
+        build.program = cache->load(build.cacheKey);
+        if (build.program != 0) {
+            build.cacheKey = 0; // 已经在缓存里了
+            return build;
+        }
+    }
 
-    // 编译着色器
-    unsigned int vertex, fragment;
+    std::string vertexSource = injectDefines(vertexCode, defines);
+    std::string fragmentSource = injectDefines(fragmentCode, defines);
+    const char* vShaderCode = vertexSource.c_str();
+    const char* fShaderCode = fragmentSource.c_str();
 
     // 顶点着色器
-    vertex = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertex, 1, &vShaderCode, NULL);
-    glCompileShader(vertex);
-    checkCompileErrors(vertex, "VERTEX");
+    build.vertex = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(build.vertex, 1, &vShaderCode, NULL);
+    glCompileShader(build.vertex);
 
     // 片段着色器
-    fragment = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragment, 1, &fShaderCode, NULL);
-    glCompileShader(fragment);
-    checkCompileErrors(fragment, "FRAGMENT");
-
-    // 着色器程序
-    ID = glCreateProgram();
-    glAttachShader(ID, vertex);
-    glAttachShader(ID, fragment);
-    glLinkProgram(ID);
-    checkCompileErrors(ID, "PROGRAM");
+    build.fragment = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(build.fragment, 1, &fShaderCode, NULL);
+    glCompileShader(build.fragment);
+
+    // 着色器程序 (不检查编译结果直接链接：编译失败时链接也会失败，错误在 finishBuild 里统一打印)
+    build.program = glCreateProgram();
+    if (cache)
+        cache->prepare(build.program);
+    glAttachShader(build.program, build.vertex);
+    glAttachShader(build.program, build.fragment);
+    glLinkProgram(build.program);
+    return build;
+}
+
+bool Shader::isBuildComplete(const ShaderBuild &build)
+{
+    if (build.vertex == 0 || !has_parallel_compile())
+        return true;
+
+    int complete = 0;
+    glGetProgramiv(build.program, GL_COMPLETION_STATUS_KHR, &complete);
+    return complete != 0;
+}
+
+bool Shader::finishBuild(ShaderBuild &build, ShaderCache* cache)
+{
+    // 从缓存创建的程序在加载时已经检查过链接状态
+    if (build.vertex == 0)
+        return true;
+
+    bool success = checkCompileErrors(build.vertex, "VERTEX");
+    success = checkCompileErrors(build.fragment, "FRAGMENT") && success;
+    success = checkCompileErrors(build.program, "PROGRAM") && success;
+
+    // 成功链接的程序写入缓存，下次启动直接使用
+    if (success && cache)
+        cache->store(build.cacheKey, build.program);
 
     // 删除着色器，它们已经链接到我们的程序中了，已经不再需要了
-    glDeleteShader(vertex);
-    glDeleteShader(fragment);
+    glDeleteShader(build.vertex);
+    glDeleteShader(build.fragment);
+    build.vertex = build.fragment = 0;
+    return success;
+}
+
+bool Shader::applyBuild(ShaderBuild &build, ShaderCache* cache)
+{
+    if (!finishBuild(build, cache)) {
+        glDeleteProgram(build.program);
+        build.program = 0;
+        return false;
+    }
+
+    // 采样器的纹理单元是程序的状态，一般只在初始化时设置一次 (setup_shader)：从旧程序沿用到新程序
+    int previous = 0;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &previous);
+    glUseProgram(build.program);
+
+    int count = 0;
+    int maxNameLength = 0;
+    glGetProgramiv(build.program, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(build.program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+    std::string name(maxNameLength > 0 ? maxNameLength : 1, '\0');
+    for (int i = 0; i < count; i++)
+    {
+        int length = 0;
+        int size = 0;
+        GLenum type;
+        glGetActiveUniform(build.program, i, maxNameLength, &length, &size, &type, &name[0]);
+        if (size != 1 || !is_sampler_type(type))
+            continue;
+
+        std::string uniformName = name.substr(0, length);
+        int oldLocation = getUniformLocation(uniformName);
+        if (oldLocation < 0)
+            continue;
+        int unit = 0;
+        glGetUniformiv(ID, oldLocation, &unit);
+        glUniform1i(glGetUniformLocation(build.program, uniformName.c_str()), unit);
+    }
+
+    // GL 线程上一次性替换程序和 Uniform 表，之后的绘制全部使用新程序
+    unsigned int oldProgram = ID;
+    ID = build.program;
+    build.program = 0;
+    reflectUniforms();
+
+    glUseProgram(previous == static_cast<int>(oldProgram) ? ID : static_cast<unsigned int>(previous));
+    glDeleteProgram(oldProgram);
+    return true;
 }
 
 void Shader::use()
@@ -75,67 +230,167 @@ void Shader::use()
     glUseProgram(ID);
 }
 
+int Shader::getUniformLocation(const std::string &name) const
+{
+    auto it = uniformLocations.find(name);
+    return it != uniformLocations.end() ? it->second : -1;
+}
+
 void Shader::setBool(const std::string &name, bool value) const
 {
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+    glUniform1i(getUniformLocation(name), (int)value);
 }
 
 void Shader::setInt(const std::string &name, int value) const
 {
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+    glUniform1i(getUniformLocation(name), value);
 }
 
 void Shader::setFloat(const std::string &name, float value) const
 {
-    glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+    glUniform1f(getUniformLocation(name), value);
 }
 
 void Shader::setVec2(const std::string &name, const glm::vec2 &value) const
 {
-    glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+    glUniform2fv(getUniformLocation(name), 1, &value[0]);
 }
 
 void Shader::setVec2(const std::string &name, float x, float y) const
 {
-    glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y);
+    glUniform2f(getUniformLocation(name), x, y);
 }
 
 void Shader::setVec3(const std::string &name, const glm::vec3 &value) const
 {
-    glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+    glUniform3fv(getUniformLocation(name), 1, &value[0]);
 }
 
 void Shader::setVec3(const std::string &name, float x, float y, float z) const
 {
-    glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z);
+    glUniform3f(getUniformLocation(name), x, y, z);
 }
 
 void Shader::setVec4(const std::string &name, const glm::vec4 &value) const
 {
-    glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+    glUniform4fv(getUniformLocation(name), 1, &value[0]);
 }
 
 void Shader::setVec4(const std::string &name, float x, float y, float z, float w) const
 {
-    glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w);
+    glUniform4f(getUniformLocation(name), x, y, z, w);
 }
 
 void Shader::setMat2(const std::string &name, const glm::mat2 &mat) const
 {
-    glUniformMatrix2fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    glUniformMatrix2fv(getUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
 }
 
 void Shader::setMat3(const std::string &name, const glm::mat3 &mat) const
 {
-    glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    glUniformMatrix3fv(getUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
 }
 
 void Shader::setMat4(const std::string &name, const glm::mat4 &mat) const
 {
-    glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    glUniformMatrix4fv(getUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
+}
+
+void Shader::setInt(int location, int value) const
+{
+    glUniform1i(location, value);
+}
+
+void Shader::setFloat(int location, float value) const
+{
+    glUniform1f(location, value);
+}
+
+void Shader::setVec3(int location, const glm::vec3 &value) const
+{
+    glUniform3fv(location, 1, &value[0]);
+}
+
+void Shader::setVec4(int location, const glm::vec4 &value) const
+{
+    glUniform4fv(location, 1, &value[0]);
+}
+
+void Shader::setMat4(int location, const glm::mat4 &mat) const
+{
+    glUniformMatrix4fv(location, 1, GL_FALSE, &mat[0][0]);
+}
+
+void Shader::bindUniformBlock(const std::string &blockName, unsigned int binding) const
+{
+    unsigned int index = glGetUniformBlockIndex(ID, blockName.c_str());
+    if (index != GL_INVALID_INDEX)
+        glUniformBlockBinding(ID, index, binding);
 }
 
-void Shader::checkCompileErrors(unsigned int shader, std::string type)
+void Shader::reflectUniforms()
+{
+    uniformLocations.clear();
+
+    // 普通 Uniform
+    int count = 0;
+    int maxNameLength = 0;
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+    uniformLocations.reserve(count);
+
+    std::string name(maxNameLength > 0 ? maxNameLength : 1, '\0');
+    for (int i = 0; i < count; i++)
+    {
+        int length = 0;
+        int size = 0;
+        GLenum type;
+        glGetActiveUniform(ID, i, maxNameLength, &length, &size, &type, &name[0]);
+        std::string uniformName = name.substr(0, length);
+
+        // Uniform Block 里的成员没有独立位置 (返回 -1)，跳过
+        int location = glGetUniformLocation(ID, uniformName.c_str());
+        if (location < 0)
+            continue;
+        uniformLocations[uniformName] = location;
+
+        // 数组 Uniform 只会报告第一个元素 "arr[0]"
+        // 这里把 "arr" 和 "arr[1]" ... "arr[n-1]" 也都补进表里
+        if (size > 1 && uniformName.size() > 3 && uniformName.compare(uniformName.size() - 3, 3, "[0]") == 0)
+        {
+            std::string base = uniformName.substr(0, uniformName.size() - 3);
+            uniformLocations[base] = location;
+            for (int j = 1; j < size; j++)
+            {
+                std::string element = base + "[" + std::to_string(j) + "]";
+                uniformLocations[element] = glGetUniformLocation(ID, element.c_str());
+            }
+        }
+    }
+
+    // Uniform Block：按名字自动绑定到引擎约定的绑定点
+    int blockCount = 0;
+    int maxBlockNameLength = 0;
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORM_BLOCKS, &blockCount);
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxBlockNameLength);
+
+    std::string blockName(maxBlockNameLength > 0 ? maxBlockNameLength : 1, '\0');
+    for (int i = 0; i < blockCount; i++)
+    {
+        int length = 0;
+        glGetActiveUniformBlockName(ID, i, maxBlockNameLength, &length, &blockName[0]);
+        int binding = UniformBlocks::binding_for(blockName.substr(0, length));
+        if (binding >= 0)
+            glUniformBlockBinding(ID, i, binding);
+    }
+
+    // 热路径上用到的固定名字，提前查好
+    vertexDecodeLocations.positionScale = getUniformLocation("positionScale");
+    vertexDecodeLocations.positionOffset = getUniformLocation("positionOffset");
+    vertexDecodeLocations.octahedralNormals = getUniformLocation("octahedralNormals");
+}
+
+bool Shader::checkCompileErrors(unsigned int shader, std::string type)
 {
     int success;
     char infoLog[1024];
@@ -157,4 +412,5 @@ void Shader::checkCompileErrors(unsigned int shader, std::string type)
             std::cout << "ERROR::PROGRAM_LINKING_ERROR of type: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
         }
     }
-}
\ No newline at end of file
+    return success != 0;
+}
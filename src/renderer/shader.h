@@ -3,7 +3,27 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
+#include <cstdint>
 #include <string>
+#include <unordered_map>
+
+class ShaderCache;
+
+// 一次提交给驱动、还没有检查结果的构建 (见 Shader::beginBuild)
+struct ShaderBuild {
+    unsigned int program = 0;
+    unsigned int vertex = 0;     // 从缓存创建的程序没有着色器对象 (0)
+    unsigned int fragment = 0;
+    uint64_t cacheKey = 0;       // 链接成功后写入缓存用的键，0 = 不写
+};
+
+// 顶点解码 Uniform 的位置 (压缩顶点格式，见 vertex_format.h)
+// 每次绘制都可能要设置，链接时和其它 Uniform 一起反射出来，-1 表示程序里没有
+struct VertexDecodeLocations {
+    int positionScale = -1;
+    int positionOffset = -1;
+    int octahedralNormals = -1;
+};
 
 class Shader
 {
@@ -11,12 +31,47 @@ public:
     unsigned int ID; // 着色器程序 ID
 
     // 构造函数：读取并构建着色器
-    Shader(const char* vertexPath, const char* fragmentPath);
+    // cache 不为空时先尝试程序二进制缓存，没有命中才编译，编译结果再写回缓存
+    // defines 是若干行 "#define ..."，插在两个源码的 #version 之后 (着色器变体，见 shader_permutations.h)
+    Shader(const char* vertexPath, const char* fragmentPath, ShaderCache* cache = nullptr, const std::string &defines = "");
 
     // 激活程序
     void use();
 
-    // Uniform 工具函数
+    const std::string& getVertexPath() const { return vertexPath; }
+    const std::string& getFragmentPath() const { return fragmentPath; }
+    const std::string& getDefines() const { return defines; }
+
+    // ---------------------------------------------------------------
+    // 重新构建 (热重载用，见 shader_reloader.h)
+    // ---------------------------------------------------------------
+    // 读取两个源码文件，可以在任意线程调用
+    static bool readSources(const std::string &vertexPath, const std::string &fragmentPath,
+                            std::string &vertexCode, std::string &fragmentCode);
+
+    // 提交编译和链接，但不查询结果 (查询会等驱动编译完)；缓存命中时直接得到链接好的程序
+    static ShaderBuild beginBuild(const std::string &vertexCode, const std::string &fragmentCode,
+                                  const std::string &defines, ShaderCache* cache);
+
+    // 把 defines 插到源码的 #version 行之后，再用 #line 恢复原来的行号 (编译错误里的行号和文件一致)
+    static std::string injectDefines(const std::string &code, const std::string &defines);
+
+    // 驱动是否已经完成编译和链接 (支持 KHR/ARB_parallel_shader_compile 时不会阻塞；
+    // 不支持时总是返回 true，之后查询结果可能要等驱动编译完)
+    static bool isBuildComplete(const ShaderBuild &build);
+
+    // 检查构建结果：成功时换成新的程序 (采样器的纹理单元从旧程序沿用)，删除旧的程序；
+    // 失败时打印错误、删除新的程序，继续使用旧的。返回是否成功
+    bool applyBuild(ShaderBuild &build, ShaderCache* cache);
+
+    // 查询 Uniform 位置 (查的是链接时反射出来的哈希表，不再调用 glGetUniformLocation)
+    // 不存在的名字返回 -1，传给 glUniform* 时会被 OpenGL 静默忽略
+    // 热路径上建议在初始化时取一次位置，之后使用下面的 "按位置" 重载
+    int getUniformLocation(const std::string &name) const;
+
+    const VertexDecodeLocations& getVertexDecodeLocations() const { return vertexDecodeLocations; }
+
+    // Uniform 工具函数 (按名字)
     void setBool(const std::string &name, bool value) const;
     void setInt(const std::string &name, int value) const;
     void setFloat(const std::string &name, float value) const;
@@ -34,7 +89,32 @@ public:
     void setMat3(const std::string &name, const glm::mat3 &mat) const;
     void setMat4(const std::string &name, const glm::mat4 &mat) const;
 
+    // Uniform 工具函数 (按预先解析好的位置)
+    void setInt(int location, int value) const;
+    void setFloat(int location, float value) const;
+    void setVec3(int location, const glm::vec3 &value) const;
+    void setVec4(int location, const glm::vec4 &value) const;
+    void setMat4(int location, const glm::mat4 &mat) const;
+
+    // 手动把 Uniform Block 绑定到指定的绑定点
+    // 引擎内置的 Block (见 uniform_blocks.h) 在链接时已经自动绑定，一般不需要调用
+    void bindUniformBlock(const std::string &blockName, unsigned int binding) const;
+
 private:
-    // 检查编译/链接错误的辅助函数
-    void checkCompileErrors(unsigned int shader, std::string type);
-};
\ No newline at end of file
+    std::string vertexPath;
+    std::string fragmentPath;
+    std::string defines;
+
+    // Uniform 名字 -> 位置 的哈希表，链接成功后一次性填充
+    std::unordered_map<std::string, int> uniformLocations;
+    VertexDecodeLocations vertexDecodeLocations;
+
+    // 检查结果、写入缓存、删除着色器对象，返回是否链接成功
+    static bool finishBuild(ShaderBuild &build, ShaderCache* cache);
+
+    // 检查编译/链接错误的辅助函数 (没有错误返回 true)
+    static bool checkCompileErrors(unsigned int shader, std::string type);
+
+    // 链接后反射所有活跃的 Uniform 和 Uniform Block
+    void reflectUniforms();
+};
@@ -0,0 +1,203 @@
+#include "shader_cache.h"
+
+#include "../core/mapped_file.h"
+
+#include <glad/glad.h>
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace {
+    const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+    const uint64_t FNV_PRIME = 1099511628211ull;
+
+    // 文件格式版本：头部改了之后旧文件自动失效
+    const uint32_t PROGRAM_CACHE_VERSION = 1;
+
+    struct ProgramCacheHeader {
+        char magic[4];      // "SPRG"
+        uint32_t version;
+        uint64_t key;       // 和文件名相同，防止文件被改名或者哈希截断后误用
+        uint32_t format;    // glGetProgramBinary 返回的二进制格式
+        uint32_t size;      // 后面紧跟的二进制长度
+    };
+
+    uint64_t fnv1a(const std::string& data, uint64_t hash)
+    {
+        for (unsigned char c : data) {
+            hash ^= c;
+            hash *= FNV_PRIME;
+        }
+        // 长度也参与哈希，避免 "ab" + "c" 和 "a" + "bc" 得到相同的键
+        uint64_t length = data.size();
+        for (int i = 0; i < 8; i++) {
+            hash ^= (length >> (i * 8)) & 0xFF;
+            hash *= FNV_PRIME;
+        }
+        return hash;
+    }
+
+    std::string gl_string(GLenum name)
+    {
+        const GLubyte* value = glGetString(name);
+        return value ? reinterpret_cast<const char*>(value) : "";
+    }
+}
+
+ShaderCache::ShaderCache(std::string directory)
+    : directory(std::move(directory))
+{
+}
+
+void ShaderCache::init()
+{
+    initialized = true;
+
+    // 驱动支持程序二进制，并且至少有一种格式 (有的驱动支持这个扩展但一种格式都不提供)
+    if (GLAD_GL_VERSION_4_1 || GLAD_GL_ARB_get_program_binary) {
+        int formats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        stats.supported = formats > 0;
+    }
+    if (!stats.supported)
+        return;
+
+    // 二进制只对生成它的驱动有效：驱动信息参与缓存键，换显卡或者升级驱动后自然不会命中
+    driver_hash = fnv1a(gl_string(GL_VENDOR), FNV_OFFSET_BASIS);
+    driver_hash = fnv1a(gl_string(GL_RENDERER), driver_hash);
+    driver_hash = fnv1a(gl_string(GL_VERSION), driver_hash);
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error) {
+        std::cout << "ERROR::SHADER_CACHE::CANNOT_CREATE_DIRECTORY: " << directory << " (" << error.message() << ")" << std::endl;
+        stats.supported = false;
+    }
+}
+
+bool ShaderCache::is_supported()
+{
+    if (!initialized)
+        init();
+    return stats.supported;
+}
+
+uint64_t ShaderCache::make_key(const std::string& vertex_code, const std::string& fragment_code, const std::string& defines)
+{
+    if (!is_supported())
+        return 0;
+
+    uint64_t key = fnv1a(vertex_code, driver_hash ^ PROGRAM_CACHE_VERSION);
+    key = fnv1a(fragment_code, key);
+    key = fnv1a(defines, key);
+    return key != 0 ? key : 1;
+}
+
+std::string ShaderCache::path_for(uint64_t key) const
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.sprog", static_cast<unsigned long long>(key));
+    return directory + '/' + name;
+}
+
+unsigned int ShaderCache::load(uint64_t key)
+{
+    if (key == 0 || !is_supported())
+        return 0;
+
+    std::string path = path_for(key);
+    MappedFile file;
+    if (!file.open(path)) {
+        stats.misses++;
+        return 0;
+    }
+
+    ProgramCacheHeader header;
+    bool valid = file.get_size() >= sizeof(header);
+    if (valid) {
+        std::memcpy(&header, file.get_data(), sizeof(header));
+        valid = std::memcmp(header.magic, "SPRG", 4) == 0 && header.version == PROGRAM_CACHE_VERSION &&
+                header.key == key && header.size == file.get_size() - sizeof(header);
+    }
+
+    unsigned int program = 0;
+    if (valid) {
+        program = glCreateProgram();
+        glProgramBinary(program, header.format, file.get_data() + sizeof(header), static_cast<GLsizei>(header.size));
+        int success = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        if (!success) {
+            glDeleteProgram(program);
+            program = 0;
+        }
+    }
+
+    if (program == 0) {
+        // 损坏或者被驱动拒绝：删掉，调用方重新编译后会写入新的
+        file.close();
+        std::error_code error;
+        std::filesystem::remove(path, error);
+        stats.rejected++;
+        return 0;
+    }
+
+    stats.hits++;
+    return program;
+}
+
+void ShaderCache::prepare(unsigned int program)
+{
+    if (is_supported())
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+}
+
+void ShaderCache::store(uint64_t key, unsigned int program)
+{
+    if (key == 0 || !is_supported())
+        return;
+
+    int length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &length, &format, binary.data());
+
+    ProgramCacheHeader header = {};
+    std::memcpy(header.magic, "SPRG", 4);
+    header.version = PROGRAM_CACHE_VERSION;
+    header.key = key;
+    header.format = format;
+    header.size = static_cast<uint32_t>(length);
+
+    // -> 先写临时文件再改名，写到一半失败不会留下损坏的缓存
+    std::string path = path_for(key);
+    std::string temp_path = path + ".tmp";
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(binary.data(), length);
+        if (!out) {
+            std::cout << "ERROR::SHADER_CACHE::WRITE_FAILED: " << temp_path << std::endl;
+            out.close();
+            std::error_code error;
+            std::filesystem::remove(temp_path, error);
+            return;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temp_path, path, error);
+    if (error) {
+        std::cout << "ERROR::SHADER_CACHE::RENAME_FAILED: " << path << " (" << error.message() << ")" << std::endl;
+        std::filesystem::remove(temp_path, error);
+        return;
+    }
+    stats.stored++;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// 程序二进制缓存统计 (累计值)
+struct ShaderCacheStats {
+    bool supported = false;     // 驱动是否支持读取程序二进制
+    unsigned int hits = 0;      // 直接从缓存创建的程序
+    unsigned int misses = 0;    // 没有缓存，需要编译的程序
+    unsigned int rejected = 0;  // 有缓存但驱动拒绝 (驱动升级、格式不再支持)，已删除并重新编译
+    unsigned int stored = 0;    // 写入缓存的程序
+};
+
+// ShaderCache：程序二进制缓存 (glGetProgramBinary / glProgramBinary)
+//
+// 链接好的程序以驱动的内部格式保存在 directory 下，文件名是
+// "顶点源码 + 片段源码 + defines + 驱动 (GL_VENDOR / GL_RENDERER / GL_VERSION)" 的哈希，
+// 任何一项变了都会得到新的键，旧文件不会被误用 (也不会被自动删除，清空目录即可)。
+// 下次启动时直接把二进制交给驱动，跳过编译和链接；驱动拒绝时删除这个文件，调用方照常编译。
+// 需要 GL 4.1 或 ARB_get_program_binary，并且驱动至少支持一种二进制格式，否则所有操作都直接返回。
+//
+// 只在 GL 线程上使用 (第一次使用时查询驱动信息)。
+class ShaderCache
+{
+public:
+    explicit ShaderCache(std::string directory = "cache/shaders");
+
+    bool is_supported();
+
+    // 缓存键 (不支持时返回 0，0 表示不使用缓存)
+    uint64_t make_key(const std::string& vertex_code, const std::string& fragment_code, const std::string& defines = "");
+
+    // 用缓存的二进制创建程序，成功时返回已经链接好的程序，没有缓存或者被驱动拒绝时返回 0
+    unsigned int load(uint64_t key);
+
+    // 链接之前调用：提示驱动保留二进制，之后才能取出来
+    void prepare(unsigned int program);
+
+    // 把链接成功的程序写入缓存 (先写临时文件再改名)
+    void store(uint64_t key, unsigned int program);
+
+    const ShaderCacheStats& get_stats() const { return stats; }
+
+private:
+    void init();
+    std::string path_for(uint64_t key) const;
+
+    std::string directory;
+    bool initialized = false;
+    uint64_t driver_hash = 0;
+
+    ShaderCacheStats stats;
+};
@@ -0,0 +1,71 @@
+#include "shader_permutations.h"
+
+#include "mesh.h"
+#include "resource_manager.h"
+
+uint32_t ShaderFeatures::for_material(const Mesh& mesh)
+{
+    uint32_t features = 0;
+    for (const TextureInfo& texture : mesh.textures) {
+        if (texture.type == "texture_diffuse")
+            features |= DIFFUSE_MAP;
+        else if (texture.type == "texture_specular")
+            features |= SPECULAR_MAP;
+    }
+    return features;
+}
+
+std::string ShaderFeatures::make_defines(uint32_t features)
+{
+    std::string defines = "#define SHADER_PERMUTATION\n";
+    defines += "#define POINT_LIGHT_COUNT " + std::to_string(point_lights(features & POINT_LIGHT_MASK)) + "\n";
+    if (features & DIR_LIGHT)
+        defines += "#define HAS_DIR_LIGHT\n";
+    if (features & SPOT_LIGHT)
+        defines += "#define HAS_SPOT_LIGHT\n";
+    if (features & SHADOWS)
+        defines += "#define HAS_SHADOWS\n";
+    if (features & DIFFUSE_MAP)
+        defines += "#define HAS_DIFFUSE_MAP\n";
+    if (features & SPECULAR_MAP)
+        defines += "#define HAS_SPECULAR_MAP\n";
+    return defines;
+}
+
+ShaderPermutations::ShaderPermutations(ResourceManager& resources, std::string vertex_path, std::string fragment_path,
+                                       uint32_t supported_features)
+    : resources(resources), vertex_path(std::move(vertex_path)), fragment_path(std::move(fragment_path)),
+      supported(supported_features),
+      generic(resources.load_shader(this->vertex_path, this->fragment_path))
+{
+}
+
+void ShaderPermutations::set_on_create(std::function<void(Shader&, uint32_t)> callback)
+{
+    on_create = std::move(callback);
+    if (!on_create)
+        return;
+
+    for (auto& [features, shader] : variants)
+        on_create(*shader, features);
+}
+
+Shader& ShaderPermutations::get(uint32_t features)
+{
+    features &= supported;
+    auto it = variants.find(features);
+    if (it != variants.end())
+        return *it->second;
+
+    std::shared_ptr<Shader> shader = resources.load_shader(vertex_path, fragment_path, ShaderFeatures::make_defines(features));
+    variants.emplace(features, shader);
+    if (on_create)
+        on_create(*shader, features);
+    return *shader;
+}
+
+Shader& ShaderPermutations::find(uint32_t features) const
+{
+    auto it = variants.find(features & supported);
+    return it != variants.end() ? *it->second : *generic;
+}
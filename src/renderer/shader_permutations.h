@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "shader.h"
+#include "uniform_blocks.h"
+
+class Mesh;
+class ResourceManager;
+
+// 着色器特性位：每一位对应一个注入的 #define，组合起来就是变体的键
+// 着色器里用 #ifdef SHADER_PERMUTATION 区分 "变体" 和 "没有注入任何特性的通用版本"，
+// 通用版本按全部开启编译，运行时再判断 (和引入变体之前的行为相同)
+struct ShaderFeatures {
+    static constexpr uint32_t POINT_LIGHT_MASK = 0x7;        // 低 3 位：点光源数量 (POINT_LIGHT_COUNT)
+    static constexpr uint32_t DIR_LIGHT        = 1u << 3;    // HAS_DIR_LIGHT
+    static constexpr uint32_t SPOT_LIGHT       = 1u << 4;    // HAS_SPOT_LIGHT
+    static constexpr uint32_t SHADOWS          = 1u << 5;    // HAS_SHADOWS
+    static constexpr uint32_t DIFFUSE_MAP      = 1u << 6;    // HAS_DIFFUSE_MAP
+    static constexpr uint32_t SPECULAR_MAP     = 1u << 7;    // HAS_SPECULAR_MAP
+
+    static constexpr uint32_t LIGHTING = POINT_LIGHT_MASK | DIR_LIGHT | SPOT_LIGHT | SHADOWS;
+    static constexpr uint32_t MATERIAL = DIFFUSE_MAP | SPECULAR_MAP;
+    static constexpr uint32_t ALL = LIGHTING | MATERIAL;
+    static constexpr int MATERIAL_SHIFT = 6;                  // 材质特性 >> MATERIAL_SHIFT = 0 ~ 3，用来记录用到了哪些贴图组合
+
+    // 点光源数量最多到 LightsBlock 里的数组长度 (着色器的 pointLights[NR_POINT_LIGHTS])，再多会读出数组
+    static uint32_t point_lights(unsigned int count)
+    {
+        return count < static_cast<unsigned int>(MAX_POINT_LIGHTS) ? count : static_cast<uint32_t>(MAX_POINT_LIGHTS);
+    }
+
+    // 网格带有的贴图 (按 TextureInfo::type)
+    static uint32_t for_material(const Mesh& mesh);
+
+    // 特性位 -> "#define ..." 行
+    static std::string make_defines(uint32_t features);
+};
+
+static_assert(MAX_POINT_LIGHTS <= static_cast<int>(ShaderFeatures::POINT_LIGHT_MASK), "POINT_LIGHT_MASK is too narrow for MAX_POINT_LIGHTS");
+
+// ShaderPermutations：同一对源码按特性位编译出的一组变体
+//
+// get() 第一次遇到某个特性组合时才通过 ResourceManager 加载 (所以变体同样走程序二进制缓存和热重载)，
+// 之后按特性位直接查表。不支持的特性位 (supported_features 之外) 在查表前就去掉，不会产生重复的变体。
+// 同时持有一个不注入特性的通用版本，find() 查不到变体时返回它，保证任何时候都有可用的 Shader。
+//
+// get() 会创建 GL 对象，只在 GL 线程上调用；find() 只读，可以在任务里调用 (同一时间不能有 get)。
+class ShaderPermutations
+{
+public:
+    ShaderPermutations(ResourceManager& resources, std::string vertex_path, std::string fragment_path,
+                       uint32_t supported_features = ShaderFeatures::ALL);
+
+    // 新变体创建后调用一次：设置采样器的纹理单元、登记合批版本等
+    // 设置时对已经存在的变体补调一次；通用版本在构造时就已经存在，由使用方自己设置 (get_generic)
+    void set_on_create(std::function<void(Shader&, uint32_t features)> callback);
+
+    // 取变体，没有时编译 (GL 线程)
+    Shader& get(uint32_t features);
+
+    // 只查表，没有编译过的组合返回通用版本
+    Shader& find(uint32_t features) const;
+
+    Shader& get_generic() const { return *generic; }
+    uint32_t get_supported_features() const { return supported; }
+    unsigned int get_variant_count() const { return static_cast<unsigned int>(variants.size()); }
+
+private:
+    ResourceManager& resources;
+    std::string vertex_path;
+    std::string fragment_path;
+    uint32_t supported;
+
+    std::shared_ptr<Shader> generic;
+    std::unordered_map<uint32_t, std::shared_ptr<Shader>> variants;
+    std::function<void(Shader&, uint32_t)> on_create;
+};
@@ -0,0 +1,170 @@
+#include "shader_reloader.h"
+
+#include "../core/jobs.h"
+
+#include <atomic>
+#include <filesystem>
+#include <iostream>
+#include <unordered_set>
+
+// 后台读取的源码 (后台任务写完之后设置 done，GL 线程看到 done 之后才读)
+struct ShaderReloader::Sources {
+    std::string vertex_path;
+    std::string fragment_path;
+    std::string vertex_code;
+    std::string fragment_code;
+    bool success = false;
+    std::atomic<bool> done{ false };
+};
+
+namespace {
+    std::string normalize(const std::string& path)
+    {
+        return std::filesystem::path(path).lexically_normal().generic_string();
+    }
+
+    // 放弃一次还没有应用的构建
+    void discard(ShaderBuild& build)
+    {
+        if (build.vertex != 0)
+            glDeleteShader(build.vertex);
+        if (build.fragment != 0)
+            glDeleteShader(build.fragment);
+        if (build.program != 0)
+            glDeleteProgram(build.program);
+        build = ShaderBuild();
+    }
+}
+
+ShaderReloader::ShaderReloader(ShaderCache* cache)
+    : cache(cache)
+{
+}
+
+ShaderReloader::~ShaderReloader()
+{
+    // 后台任务只持有 Sources 的引用，不访问重载器本身，不需要等它们
+    for (Reload& reload : reloads)
+        discard(reload.build);
+}
+
+bool ShaderReloader::watch(const std::string& directory)
+{
+    bool success = watcher.watch_directory(directory);
+    stats.watching = watcher.is_watching();
+    return success;
+}
+
+void ShaderReloader::add(const std::shared_ptr<Shader>& shader)
+{
+    watched.push_back({ shader, normalize(shader->getVertexPath()), normalize(shader->getFragmentPath()) });
+}
+
+void ShaderReloader::start(const std::shared_ptr<Shader>& shader, Reload& reload)
+{
+    reload.sources = std::make_shared<Sources>();
+    reload.sources->vertex_path = shader->getVertexPath();
+    reload.sources->fragment_path = shader->getFragmentPath();
+    reload.submitted = false;
+    reload.restart = false;
+
+    std::shared_ptr<Sources> sources = reload.sources;
+    JobSystem::dispatch_background([sources]() {
+        sources->success = Shader::readSources(sources->vertex_path, sources->fragment_path,
+                                               sources->vertex_code, sources->fragment_code);
+        sources->done = true;
+    });
+}
+
+void ShaderReloader::update()
+{
+    // -> 修改过的文件 -> 受影响的着色器
+    std::vector<std::string> changes = watcher.poll_changes();
+    if (!changes.empty()) {
+        std::unordered_set<std::string> changed(changes.begin(), changes.end());
+        for (std::size_t i = 0; i < watched.size(); ) {
+            std::shared_ptr<Shader> shader = watched[i].shader.lock();
+            if (!shader) {
+                watched[i] = std::move(watched.back());
+                watched.pop_back();
+                continue;
+            }
+            if (changed.count(watched[i].vertex_path) || changed.count(watched[i].fragment_path)) {
+                Reload* existing = nullptr;
+                for (Reload& reload : reloads) {
+                    if (reload.shader.lock() == shader)
+                        existing = &reload;
+                }
+                if (existing) {
+                    existing->restart = true;
+                }
+                else {
+                    reloads.push_back(Reload());
+                    reloads.back().shader = shader;
+                    start(shader, reloads.back());
+                }
+            }
+            i++;
+        }
+    }
+
+    // -> 推进进行中的重载
+    for (std::size_t i = 0; i < reloads.size(); ) {
+        Reload& reload = reloads[i];
+        std::shared_ptr<Shader> shader = reload.shader.lock();
+        bool finished = false;
+
+        if (!shader) {
+            // 着色器已经释放，结果没人要了
+            discard(reload.build);
+            finished = true;
+        }
+        else if (!reload.submitted) {
+            if (reload.sources->done.load()) {
+                if (reload.sources->success) {
+                    // 只提交，结果下一帧之后再检查
+                    reload.build = Shader::beginBuild(reload.sources->vertex_code, reload.sources->fragment_code,
+                                                      shader->getDefines(), cache);
+                    reload.submitted = true;
+                }
+                else {
+                    stats.failures++;
+                    finished = true;
+                }
+            }
+        }
+        else if (Shader::isBuildComplete(reload.build)) {
+            if (shader->applyBuild(reload.build, cache)) {
+                stats.reloads++;
+                std::cout << "SHADER::RELOADED: " << shader->getVertexPath() << " + " << shader->getFragmentPath() << std::endl;
+            }
+            else {
+                stats.failures++;
+            }
+            finished = true;
+        }
+
+        if (finished && shader && reload.restart) {
+            // 编译期间文件又被保存了：用最新的源码再来一遍
+            start(shader, reload);
+            finished = false;
+        }
+
+        if (finished) {
+            reloads[i] = std::move(reloads.back());
+            reloads.pop_back();
+        }
+        else {
+            i++;
+        }
+    }
+
+    // -> 统计
+    stats.watching = watcher.is_watching();
+    stats.shaders = 0;
+    for (const Watched& entry : watched) {
+        if (!entry.shader.expired())
+            stats.shaders++;
+    }
+    stats.pending = static_cast<unsigned int>(reloads.size());
+}
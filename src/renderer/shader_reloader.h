@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../core/file_watcher.h"
+#include "shader.h"
+
+class ShaderCache;
+
+// 热重载统计
+struct ShaderReloadStats {
+    bool watching = false;     // 监视线程是否在运行
+    unsigned int shaders = 0;  // 登记的着色器 (已经释放的不算)
+    unsigned int pending = 0;  // 正在读取或者编译的重载
+    uint64_t reloads = 0;      // 累计成功替换的次数
+    uint64_t failures = 0;     // 累计编译/链接失败 (失败时继续使用旧的程序)
+};
+
+// ShaderReloader：着色器热重载
+//
+// FileWatcher 在后台线程监视着色器目录，源码文件保存后，用到它的着色器会在几帧之内换成新版本，不需要重启：
+//   1. GL 线程每帧 update() 取走修改过的文件，找到受影响的着色器
+//   2. 源码在后台任务里读取 (JobSystem::dispatch_background)
+//   3. 读完后在 GL 线程上提交编译和链接，但不查询结果；之后每帧检查一次驱动是否编译完
+//      (KHR/ARB_parallel_shader_compile 下编译在驱动的线程里进行，检查不会阻塞；
+//      不支持时下一帧再查询结果，给多线程驱动留出一帧的时间)
+//   4. 完成后在帧开始时一次性替换程序 (Shader::applyBuild)，不会有一帧用到一半新一半旧的状态；
+//      编译失败时打印错误并保留旧的程序，修好再保存即可
+// 新程序同样写入程序二进制缓存，下次启动直接使用。
+//
+// 只在 GL 线程上使用。着色器以 weak_ptr 登记，释放之后自动忽略。
+class ShaderReloader
+{
+public:
+    explicit ShaderReloader(ShaderCache* cache = nullptr);
+    ~ShaderReloader();
+
+    ShaderReloader(const ShaderReloader&) = delete;
+    ShaderReloader& operator=(const ShaderReloader&) = delete;
+
+    // 监视一个着色器目录 (不递归)
+    bool watch(const std::string& directory);
+
+    // 登记一个着色器 (ResourceManager 加载着色器时自动调用)
+    void add(const std::shared_ptr<Shader>& shader);
+
+    // 每帧在渲染之前调用一次
+    void update();
+
+    const ShaderReloadStats& get_stats() const { return stats; }
+
+private:
+    struct Sources;
+
+    struct Watched {
+        std::weak_ptr<Shader> shader;
+        std::string vertex_path;     // 规范化后的路径，和 FileWatcher 报告的路径比较
+        std::string fragment_path;
+    };
+
+    struct Reload {
+        std::weak_ptr<Shader> shader;
+        std::shared_ptr<Sources> sources; // 后台任务写，读完之后 GL 线程读
+        ShaderBuild build;
+        bool submitted = false;
+        bool restart = false;             // 编译期间文件又被修改：这次完成后再来一遍
+    };
+
+    void start(const std::shared_ptr<Shader>& shader, Reload& reload);
+
+    ShaderCache* cache;
+    FileWatcher watcher;
+    std::vector<Watched> watched;
+    std::vector<Reload> reloads;
+
+    ShaderReloadStats stats;
+};
@@ -0,0 +1,284 @@
+#include "../renderer/shadow_cascades.h"
+#include "../renderer/stream_buffer.h"
+#include "../core/profiler.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace {
+    // 静态层缓存时投影中心对齐的网格 (texel 数)：投影范围比切片的外接球大 2 * CACHE_TEXELS 个 texel
+    const int CACHE_TEXELS_DIVISOR = 16; // 分辨率的 1/16，即投影范围放大约 14%
+
+    // 光栅化时的斜率深度偏移 (glPolygonOffset)，和着色器里的常量偏移、法线偏移一起消除自阴影
+    const float POLYGON_OFFSET_FACTOR = 2.0f;
+    const float POLYGON_OFFSET_UNITS = 2.0f;
+
+    unsigned int create_depth_array(int resolution, bool compare)
+    {
+        unsigned int texture = 0;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT32F, resolution, resolution, MAX_SHADOW_CASCADES, 0,
+                     GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+
+        if (compare) {
+            // 硬件比较 + 线性过滤：每次采样得到 2x2 个比较结果的插值
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+        } else {
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        }
+        // 贴图之外按 "不在阴影里" 处理
+        float border[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+        glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, border);
+
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+        return texture;
+    }
+}
+
+ShadowCascades::ShadowCascades(int resolution)
+    : resolution(resolution),
+      shadow_ubo(sizeof(ShadowBlock), SHADOW_BLOCK_BINDING)
+{
+    static_maps = create_depth_array(resolution, false);
+    shadow_maps = create_depth_array(resolution, true);
+
+    // 两个只有深度附件的帧缓冲：一个画，一个作为复制的来源
+    glGenFramebuffers(1, &draw_fbo);
+    glGenFramebuffers(1, &copy_fbo);
+    for (unsigned int fbo : { draw_fbo, copy_fbo }) {
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, draw_fbo);
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, shadow_maps, 0, 0);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "ERROR::SHADOW_CASCADES::INCOMPLETE_FRAMEBUFFER: 0x" << std::hex << status << std::dec << std::endl;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    for (int i = 0; i < MAX_SHADOW_CASCADES; i++) {
+        light_matrices[i] = glm::mat4(1.0f);
+        static_matrices[i] = glm::mat4(1.0f);
+    }
+    shadow_block = ShadowBlock();
+}
+
+ShadowCascades::~ShadowCascades()
+{
+    glDeleteFramebuffers(1, &draw_fbo);
+    glDeleteFramebuffers(1, &copy_fbo);
+    glDeleteTextures(1, &static_maps);
+    glDeleteTextures(1, &shadow_maps);
+}
+
+void ShadowCascades::fit(const Camera& camera, float width, float height, const glm::vec3& light_direction,
+                         const AABB& caster_bounds, const ShadowParams& params)
+{
+    cascade_count = params.enable ? std::clamp(params.cascade_count, 1, MAX_SHADOW_CASCADES) : 0;
+    depth_bias = params.depth_bias;
+    normal_bias = params.normal_bias;
+
+    // 关闭缓存期间静态层不再更新，重新开启时需要重画
+    cache_enabled = params.cache_static;
+    if (!cache_enabled)
+        std::fill(std::begin(static_valid), std::end(static_valid), false);
+
+    if (cascade_count == 0)
+        return;
+
+    // -> 切分：对数切分和均匀切分按 lambda 混合 (Practical Split Scheme)
+    float near_plane = camera.near_plane;
+    float far_plane = std::max(std::min(camera.far_plane, params.max_distance), near_plane * 2.0f);
+    float lambda = std::clamp(params.split_lambda, 0.0f, 1.0f);
+    float splits[MAX_SHADOW_CASCADES + 1];
+    splits[0] = near_plane;
+    for (int i = 1; i <= cascade_count; i++) {
+        float p = static_cast<float>(i) / cascade_count;
+        float log_split = near_plane * std::pow(far_plane / near_plane, p);
+        float uniform_split = near_plane + (far_plane - near_plane) * p;
+        splits[i] = uniform_split + (log_split - uniform_split) * lambda;
+    }
+
+    // -> 光源空间：原点在世界原点，只有旋转，所以 texel 网格在世界空间里是固定的
+    glm::vec3 direction = glm::length(light_direction) > 0.0f ? glm::normalize(light_direction) : glm::vec3(0.0f, -1.0f, 0.0f);
+    glm::vec3 up = std::abs(direction.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+    glm::mat4 light_view = glm::lookAt(glm::vec3(0.0f), direction, up);
+    AABB light_bounds = caster_bounds.is_valid() ? caster_bounds.transformed(light_view) : AABB();
+
+    // 视锥切片半对角线的斜率 (切片在距离 d 处的截面半对角线 = d * k)
+    float aspect = height > 0.0f ? width / height : 1.0f;
+    float k = std::sqrt(1.0f + aspect * aspect) * std::tan(glm::radians(camera.zoom) * 0.5f);
+    float k2 = k * k;
+
+    int cache_texels = cache_enabled ? std::max(resolution / CACHE_TEXELS_DIVISOR, 1) : 1;
+
+    for (int c = 0; c < cascade_count; c++) {
+        float n = splits[c];
+        float f = splits[c + 1];
+
+        // -> 切片的最小外接球，球心在视线上
+        float center_distance, radius;
+        if (k2 >= (f - n) / (f + n)) {
+            center_distance = f;
+            radius = f * k;
+        } else {
+            center_distance = 0.5f * (f + n) * (1.0f + k2);
+            radius = 0.5f * std::sqrt((f - n) * (f - n) + 2.0f * (f * f + n * n) * k2 + (f + n) * (f + n) * k2 * k2);
+        }
+        // 半径只取决于切片形状，取整后每帧完全相同
+        radius = std::ceil(radius * 16.0f) / 16.0f;
+
+        // -> 投影范围：中心对齐到 cache_texels 个 texel 的网格，范围放大一个网格，保证始终覆盖外接球
+        // half = radius + cell，cell = cache_texels * (2 * half / resolution)
+        float half = radius / (1.0f - 2.0f * cache_texels / static_cast<float>(resolution));
+        float texel = 2.0f * half / resolution;
+        float cell = texel * cache_texels;
+
+        glm::vec3 center = glm::vec3(light_view * glm::vec4(camera.position + camera.front * center_distance, 1.0f));
+        center.x = std::floor(center.x / cell) * cell;
+        center.y = std::floor(center.y / cell) * cell;
+
+        // -> 深度范围：光源看向 -z，取静态投影物的范围 (向外取整，避免浮点误差让缓存失效)
+        float z_near, z_far;
+        if (light_bounds.is_valid()) {
+            z_near = std::floor(-light_bounds.max.z) - 1.0f;
+            z_far = std::ceil(-light_bounds.min.z) + 1.0f;
+        } else {
+            z_near = -center.z - half;
+            z_far = -center.z + half;
+        }
+
+        glm::mat4 projection = glm::ortho(center.x - half, center.x + half, center.y - half, center.y + half, z_near, z_far);
+        light_matrices[c] = projection * light_view;
+
+        // 挑选投影物时去掉近平面 (平面方程恒为正)
+        caster_frustums[c] = Frustum::from_matrix(light_matrices[c]);
+        caster_frustums[c].planes[Frustum::NEAR_PLANE] = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+
+        split_far[c] = f;
+        texel_sizes[c] = texel;
+        dynamic_casters[c] = 0;
+    }
+}
+
+void ShadowCascades::invalidate_static()
+{
+    std::fill(std::begin(static_valid), std::end(static_valid), false);
+}
+
+void ShadowCascades::set_dynamic_casters(int cascade, unsigned int count)
+{
+    dynamic_casters[cascade] = count;
+}
+
+void ShadowCascades::attach_layer(GLenum target, unsigned int texture, int layer)
+{
+    glFramebufferTextureLayer(target, GL_DEPTH_ATTACHMENT, texture, 0, layer);
+}
+
+void ShadowCascades::render(const std::function<unsigned int(int, bool)>& draw)
+{
+    stats = ShadowStats();
+    stats.cascades = cascade_count;
+    if (cascade_count == 0)
+        return;
+
+    PROFILE_SCOPE("Shadow Maps");
+
+    // 记下调用方的帧缓冲和视口，画完恢复
+    GLint previous_fbo = 0;
+    GLint previous_viewport[4];
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previous_fbo);
+    glGetIntegerv(GL_VIEWPORT, previous_viewport);
+
+    glViewport(0, 0, resolution, resolution);
+    glEnable(GL_DEPTH_TEST);
+    glDepthMask(GL_TRUE);
+    glEnable(GL_DEPTH_CLAMP);
+    glEnable(GL_POLYGON_OFFSET_FILL);
+    glPolygonOffset(POLYGON_OFFSET_FACTOR, POLYGON_OFFSET_UNITS);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, draw_fbo);
+
+    for (int c = 0; c < cascade_count; c++) {
+        if (!cache_enabled) {
+            // 不缓存：静态和动态投影物直接画进最终的阴影贴图
+            attach_layer(GL_DRAW_FRAMEBUFFER, shadow_maps, c);
+            glClear(GL_DEPTH_BUFFER_BIT);
+            stats.static_casters += draw(c, true);
+            stats.dynamic_casters += draw(c, false);
+            continue;
+        }
+
+        // -> 静态层：投影矩阵变了或者被标记失效时才重画
+        bool static_rendered = false;
+        if (is_static_dirty(c)) {
+            attach_layer(GL_DRAW_FRAMEBUFFER, static_maps, c);
+            glClear(GL_DEPTH_BUFFER_BIT);
+            stats.static_casters += draw(c, true);
+            static_matrices[c] = light_matrices[c];
+            static_valid[c] = true;
+            static_rendered = true;
+            stats.static_layers_rendered++;
+        }
+
+        // -> 最终层 = 静态层 + 动态投影物；两边都没变化时沿用上一帧的结果
+        if (!static_rendered && dynamic_casters[c] == 0 && !had_dynamic[c])
+            continue;
+
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, copy_fbo);
+        attach_layer(GL_READ_FRAMEBUFFER, static_maps, c);
+        attach_layer(GL_DRAW_FRAMEBUFFER, shadow_maps, c);
+        glBlitFramebuffer(0, 0, resolution, resolution, 0, 0, resolution, resolution, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+        stats.layers_composited++;
+
+        if (dynamic_casters[c] > 0)
+            stats.dynamic_casters += draw(c, false);
+        had_dynamic[c] = dynamic_casters[c] > 0;
+    }
+
+    glDisable(GL_POLYGON_OFFSET_FILL);
+    glDisable(GL_DEPTH_CLAMP);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, previous_fbo);
+    glViewport(previous_viewport[0], previous_viewport[1], previous_viewport[2], previous_viewport[3]);
+}
+
+void ShadowCascades::bind()
+{
+    // 从 [-1, 1] 的裁剪空间映射到 [0, 1] 的纹理坐标和深度
+    const glm::mat4 bias = glm::translate(glm::mat4(1.0f), glm::vec3(0.5f)) * glm::scale(glm::mat4(1.0f), glm::vec3(0.5f));
+
+    for (int c = 0; c < MAX_SHADOW_CASCADES; c++) {
+        bool active = c < cascade_count;
+        shadow_block.light_space[c] = active ? bias * light_matrices[c] : glm::mat4(1.0f);
+        shadow_block.cascade_splits[c] = active ? split_far[c] : 0.0f;
+        shadow_block.texel_sizes[c] = active ? texel_sizes[c] : 0.0f;
+    }
+    shadow_block.params = glm::vec4(static_cast<float>(cascade_count), depth_bias, normal_bias, 1.0f / resolution);
+
+    if (stream)
+        shadow_ubo.stream(*stream, shadow_block);
+    else
+        shadow_ubo.update(shadow_block);
+
+    glActiveTexture(GL_TEXTURE0 + SHADOW_MAP_UNIT);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, shadow_maps);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void ShadowCascades::setup_shader(Shader& shader)
+{
+    shader.use();
+    shader.setInt("shadowMap", SHADOW_MAP_UNIT);
+}
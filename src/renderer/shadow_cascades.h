@@ -0,0 +1,117 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <functional>
+
+#include "../scene/bounds.h"
+#include "../scene/light_params.h"
+#include "../renderer/camera.h"
+#include "../renderer/shader.h"
+#include "../renderer/uniform_buffer.h"
+#include "../renderer/uniform_blocks.h"
+
+class StreamBuffer;
+
+// 每帧的阴影统计
+struct ShadowStats {
+    unsigned int cascades = 0;
+    unsigned int static_layers_rendered = 0; // 本帧重新渲染的静态层 (缓存命中时为 0)
+    unsigned int layers_composited = 0;      // 本帧从静态层复制并叠加动态投影物的层
+    unsigned int static_casters = 0;         // 本帧画进静态层的投影物
+    unsigned int dynamic_casters = 0;        // 本帧画进阴影贴图的动态投影物
+};
+
+// ShadowCascades：定向光的级联阴影贴图 (Cascaded Shadow Maps)
+//
+// 观察距离 [near, max_distance] 按对数/均匀混合切成最多 4 级，每一级一张正交投影的深度图 (纹理数组的一层)。
+// - 稳定拟合：每一级用视锥切片的外接球 (半径只取决于切片形状，摄像机转动时不变)，
+//   投影中心在光源空间里对齐到 texel 网格，摄像机移动时阴影边缘不会闪烁
+// - 缓存：静态投影物画在单独的深度数组里。投影中心按更粗的网格 (cache_texels 个 texel) 对齐，
+//   投影范围相应放大一圈保证仍然覆盖整个切片，于是摄像机小范围移动时投影矩阵不变，静态层可以直接复用；
+//   投影矩阵变化 (光源方向变了、摄像机走出网格) 或 invalidate_static() 之后才重画
+// - 每帧把静态层复制到最终的阴影贴图，再把动态投影物叠加上去；这一级没有动态投影物并且静态层没变时连复制也省掉
+// 光源方向的深度范围由静态投影物的包围盒决定，渲染时开启深度钳制 (GL_DEPTH_CLAMP)，
+// 范围之外朝向光源的投影物被压到近平面上，仍然能投下阴影。
+class ShadowCascades
+{
+public:
+    // 阴影贴图固定占用的纹理单元 (在分簇光照的纹理缓冲之后)
+    static const int SHADOW_MAP_UNIT = 11;
+
+    // resolution: 每一级阴影贴图的边长
+    explicit ShadowCascades(int resolution = 2048);
+    ~ShadowCascades();
+
+    // 禁止拷贝，防止重复删除 GL 对象
+    ShadowCascades(const ShadowCascades&) = delete;
+    ShadowCascades& operator=(const ShadowCascades&) = delete;
+
+    // 根据摄像机和光源方向拟合每一级的投影 (不调用 GL，可以在任务系统的任意线程上执行)
+    // light_direction: 光线的传播方向; caster_bounds: 静态投影物的总包围盒
+    void fit(const Camera& camera, float width, float height, const glm::vec3& light_direction,
+             const AABB& caster_bounds, const ShadowParams& params);
+
+    // 静态投影物变化了 (移动、加载完成、增删)，所有静态层在下次 render 时重画
+    void invalidate_static();
+
+    // 第 cascade 级本帧要叠加的动态投影物数量 (fit 之后、render 之前设置)
+    void set_dynamic_casters(int cascade, unsigned int count);
+
+    // 渲染阴影贴图 (GL 线程)，结束后恢复原来的帧缓冲和视口
+    // draw(cascade, is_static) 把这一级的静态 / 动态投影物画到当前绑定的层，返回画了多少个物体
+    // 不使用缓存时两次调用画进同一层
+    void render(const std::function<unsigned int(int, bool)>& draw);
+
+    // 上传 ShadowBlock 并把阴影贴图绑定到 SHADOW_MAP_UNIT (每帧在绘制场景之前调用)
+    void bind();
+
+    // 设置后 ShadowBlock 每帧写进环形缓冲 (见 stream_buffer.h)
+    void set_stream_buffer(StreamBuffer* ring) { stream = ring; }
+
+    // 设置 Shader 里的阴影贴图采样器 (shadowMap)，每个 Shader 链接后调用一次
+    static void setup_shader(Shader& shader);
+
+    int get_cascade_count() const { return cascade_count; }
+    int get_resolution() const { return resolution; }
+    // 第 cascade 级的 光源 Projection * View
+    const glm::mat4& get_light_matrix(int cascade) const { return light_matrices[cascade]; }
+    // 第 cascade 级挑选投影物用的视锥 (没有近平面：光源和切片之间的物体都可能投下阴影)
+    const Frustum& get_caster_frustum(int cascade) const { return caster_frustums[cascade]; }
+    // 第 cascade 级的静态层本帧是否需要重画
+    bool is_static_dirty(int cascade) const { return !cache_enabled || !static_valid[cascade] || light_matrices[cascade] != static_matrices[cascade]; }
+
+    const ShadowStats& get_stats() const { return stats; }
+
+private:
+    void attach_layer(GLenum target, unsigned int texture, int layer);
+
+    int resolution = 0;
+    int cascade_count = 0;
+    bool cache_enabled = true;
+
+    // 每一级的投影和切分
+    glm::mat4 light_matrices[MAX_SHADOW_CASCADES];
+    Frustum   caster_frustums[MAX_SHADOW_CASCADES];
+    float     split_far[MAX_SHADOW_CASCADES] = {};
+    float     texel_sizes[MAX_SHADOW_CASCADES] = {};
+    float     depth_bias = 0.0f;
+    float     normal_bias = 0.0f;
+
+    // 静态层的缓存状态：画静态层时使用的投影矩阵
+    glm::mat4 static_matrices[MAX_SHADOW_CASCADES];
+    bool      static_valid[MAX_SHADOW_CASCADES] = {};
+    unsigned int dynamic_casters[MAX_SHADOW_CASCADES] = {};
+    bool      had_dynamic[MAX_SHADOW_CASCADES] = {}; // 上一次 render 时叠加过动态投影物 (最终层和静态层不一致)
+
+    unsigned int static_maps = 0;   // 静态投影物的深度 (纹理数组)
+    unsigned int shadow_maps = 0;   // 最终的阴影贴图 (静态 + 动态，开启深度比较)
+    unsigned int draw_fbo = 0;
+    unsigned int copy_fbo = 0;
+
+    UniformBuffer shadow_ubo;
+    ShadowBlock shadow_block;
+    StreamBuffer* stream = nullptr;
+
+    ShadowStats stats;
+};
@@ -0,0 +1,211 @@
+#include "stream_buffer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+namespace {
+    // 等待栅栏时每次的超时 (纳秒)，超时后继续等，只是为了第一次等待之后带上 FLUSH 位
+    const GLuint64 FENCE_TIMEOUT_NS = 1000000;
+
+    std::size_t align_up(std::size_t value, std::size_t alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+}
+
+StreamBuffer::StreamBuffer(std::size_t frame_size)
+{
+    GLint alignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    if (alignment > 0)
+        uniform_alignment = static_cast<std::size_t>(alignment);
+
+    create(frame_size);
+}
+
+StreamBuffer::~StreamBuffer()
+{
+    destroy();
+}
+
+void StreamBuffer::create(std::size_t size)
+{
+    frame_size = align_up(size, uniform_alignment);
+    std::size_t total = frame_size * FRAME_COUNT;
+
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+
+    // -> 不可变存储 + 持久映射：整个生命周期只映射一次
+    persistent = false;
+#ifdef GL_VERSION_4_4
+    if (GLAD_GL_VERSION_4_4 || GLAD_GL_ARB_buffer_storage) {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_COPY_WRITE_BUFFER, total, nullptr, flags);
+        mapped = static_cast<uint8_t*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, total, flags));
+        persistent = mapped != nullptr;
+        if (!persistent) {
+            // 映射失败：不可变存储不能再 glBufferData，换一个缓冲对象走普通路径
+            glDeleteBuffers(1, &buffer);
+            glGenBuffers(1, &buffer);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        }
+    }
+#endif
+
+    // -> 普通存储：每次写入时再映射对应的一段
+    if (!persistent)
+        glBufferData(GL_COPY_WRITE_BUFFER, total, nullptr, GL_STREAM_DRAW);
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    frame = 0;
+    head = 0;
+    stats.frame_capacity = frame_size;
+    stats.persistent = persistent;
+}
+
+void StreamBuffer::destroy()
+{
+    for (GLsync& fence : fences) {
+        if (fence) {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+
+    if (buffer != 0) {
+        if (persistent) {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+            glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        }
+        glDeleteBuffers(1, &buffer);
+    }
+    buffer = 0;
+    mapped = nullptr;
+}
+
+void StreamBuffer::wait_for_frame(unsigned int index)
+{
+    GLsync& fence = fences[index];
+    if (!fence)
+        return;
+
+    GLbitfield flags = 0;
+    bool stalled = false;
+    auto start = std::chrono::steady_clock::now();
+    while (true) {
+        GLenum result = glClientWaitSync(fence, flags, flags ? FENCE_TIMEOUT_NS : 0);
+        if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED)
+            break;
+        if (result == GL_WAIT_FAILED) {
+            std::cout << "ERROR::STREAM_BUFFER::FENCE_WAIT_FAILED" << std::endl;
+            break;
+        }
+        // 第一次没等到：确实需要等 GPU，带上 FLUSH 位保证栅栏命令已经提交
+        flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+        stalled = true;
+    }
+    if (stalled) {
+        stats.stalls++;
+        stats.wait_ms += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+void StreamBuffer::begin_frame()
+{
+    stats.used_bytes = head;
+    stats.allocations = allocations;
+    stats.overflows = overflows;
+    stats.wait_ms = 0.0f;
+
+    // 上一帧有放不下的请求：等所有段都被 GPU 用完，重新分配一个更大的缓冲
+    if (grow_to > 0) {
+        for (unsigned int i = 0; i < FRAME_COUNT; i++)
+            wait_for_frame(i);
+        destroy();
+        create(grow_to);
+        grow_to = 0;
+    }
+    else {
+        frame = (frame + 1) % FRAME_COUNT;
+        wait_for_frame(frame);
+    }
+
+    head = 0;
+    allocations = 0;
+    overflows = 0;
+}
+
+void StreamBuffer::end_frame()
+{
+    if (fences[frame])
+        glDeleteSync(fences[frame]);
+    fences[frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+StreamRange StreamBuffer::allocate(std::size_t size, std::size_t alignment)
+{
+    StreamRange range;
+    if (size == 0)
+        return range;
+
+    std::size_t start = align_up(head, alignment);
+    if (start + size > frame_size) {
+        // 放不下：本次失败，下一帧开始前扩容
+        grow_to = std::max(grow_to, std::max(frame_size * 2, align_up(start + size, uniform_alignment)));
+        overflows++;
+        return range;
+    }
+
+    range.buffer = buffer;
+    range.offset = frame * frame_size + start;
+    range.size = size;
+
+    if (persistent) {
+        range.data = mapped + range.offset;
+    }
+    else {
+        // 这一段在栅栏之后才会再被写，不需要同步；旧内容也不需要保留
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        range.data = glMapBufferRange(GL_COPY_WRITE_BUFFER, range.offset, size,
+                                      GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+        if (!range.data) {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+            std::cout << "ERROR::STREAM_BUFFER::MAP_FAILED: " << size << " bytes" << std::endl;
+            return StreamRange();
+        }
+    }
+
+    head = start + size;
+    stats.peak_bytes = std::max(stats.peak_bytes, head);
+    allocations++;
+    return range;
+}
+
+void StreamBuffer::commit(const StreamRange& range)
+{
+    // 持久映射是 COHERENT 的，写入对 GPU 自动可见
+    if (persistent || !range.valid())
+        return;
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+StreamRange StreamBuffer::write(const void* data, std::size_t size, std::size_t alignment)
+{
+    StreamRange range = allocate(size, alignment);
+    if (range.valid()) {
+        std::memcpy(range.data, data, size);
+        commit(range);
+    }
+    return range;
+}
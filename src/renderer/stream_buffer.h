@@ -0,0 +1,95 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+
+// 从环形缓冲里分出的一段 (只在本帧有效)
+struct StreamRange {
+    unsigned int buffer = 0;   // GL 缓冲 ID (0 表示分配失败)
+    std::size_t offset = 0;    // 在缓冲里的字节偏移
+    std::size_t size = 0;
+    void* data = nullptr;      // 可写的 CPU 指针 (commit 之前有效)
+
+    bool valid() const { return buffer != 0; }
+};
+
+// 流式缓冲统计 (单帧的数字是上一个完整帧的，begin_frame 时更新)
+struct StreamBufferStats {
+    std::size_t frame_capacity = 0;   // 每帧可用的字节数
+    std::size_t used_bytes = 0;       // 上一帧分配的字节数
+    std::size_t peak_bytes = 0;       // 历史最大的单帧用量
+    unsigned int allocations = 0;     // 上一帧分配次数
+    unsigned int overflows = 0;       // 上一帧放不下的请求 (调用方退回普通上传)
+    uint64_t stalls = 0;              // 累计因为 GPU 还没读完而等待栅栏的次数
+    float wait_ms = 0.0f;             // 本帧开始时等待栅栏的时间
+    bool persistent = false;          // 是否为持久映射
+};
+
+// StreamBuffer：每帧动态数据 (实例数据、Uniform Block、间接绘制命令等) 的环形缓冲
+//
+// 一个大缓冲分成 FRAME_COUNT 段，每帧只写自己那一段，按顺序循环使用 (三重缓冲)。
+// 每帧结束时插入一个 glFenceSync，下次轮到同一段时先等它：GPU 读完之前 CPU 不会覆盖，
+// 正常情况下 GPU 落后不超过两帧，所以这个等待几乎总是立刻返回。
+//
+// GL 4.4 (ARB_buffer_storage) 可用时用 glBufferStorage 分配不可变存储并持久映射 (PERSISTENT | COHERENT)，
+// 分配直接返回映射内存里的指针，不需要任何 GL 调用；
+// 否则每次写入用 glMapBufferRange(UNSYNCHRONIZED | INVALIDATE_RANGE) 映射对应的一小段，
+// 有栅栏保护，不会等待 GPU，也没有 glBufferSubData 的驱动端拷贝。
+//
+// 某一帧放不下时分配失败 (调用方退回原来的上传方式)，下一帧开始时把缓冲扩大一倍。
+// 只在 GL 线程上使用。
+class StreamBuffer
+{
+public:
+    static const unsigned int FRAME_COUNT = 3;
+
+    explicit StreamBuffer(std::size_t frame_size = 4u << 20);
+    ~StreamBuffer();
+
+    StreamBuffer(const StreamBuffer&) = delete;
+    StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+    // 每帧开始时调用：切换到下一段，必要时等待 GPU 读完它
+    void begin_frame();
+
+    // 每帧所有绘制提交之后调用：插入栅栏
+    void end_frame();
+
+    // 分配一段并返回可写指针，写完后调用 commit() (对齐必须是 2 的幂)
+    // 非持久映射时这一段处于映射状态，commit 之前不能再分配，也不能发出读取它的绘制
+    StreamRange allocate(std::size_t size, std::size_t alignment = 16);
+    void commit(const StreamRange& range);
+
+    // 分配 + 拷贝 + 提交
+    StreamRange write(const void* data, std::size_t size, std::size_t alignment = 16);
+
+    // Uniform Block 的偏移必须是 GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT 的倍数
+    std::size_t get_uniform_alignment() const { return uniform_alignment; }
+
+    unsigned int get_buffer() const { return buffer; }
+    bool is_persistent() const { return persistent; }
+    const StreamBufferStats& get_stats() const { return stats; }
+
+private:
+    void create(std::size_t frame_size);
+    void destroy();
+
+    // 等待某一段的栅栏 (GPU 读完这一段之前不返回)
+    void wait_for_frame(unsigned int frame);
+
+    unsigned int buffer = 0;
+    std::size_t frame_size = 0;
+    std::size_t grow_to = 0;          // 非 0 时下一帧开始前扩容到这个大小
+    uint8_t* mapped = nullptr;        // 持久映射的起始地址
+    bool persistent = false;
+    std::size_t uniform_alignment = 256;
+
+    unsigned int frame = 0;           // 当前写入的段
+    std::size_t head = 0;             // 段内下一个空闲位置
+    unsigned int allocations = 0;     // 本帧的分配次数 (begin_frame 时转入 stats)
+    unsigned int overflows = 0;
+    GLsync fences[FRAME_COUNT] = {};
+
+    StreamBufferStats stats;
+};
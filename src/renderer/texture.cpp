@@ -6,37 +6,40 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
-Texture::Texture(const char* path)
+unsigned int load_texture_file(const std::string& path, bool flip_vertically, int* width, int* height, int* channels)
 {
     // 生成纹理 ID
-    glGenTextures(1, &ID);
-
-    // 加载图片数据
-    unsigned char *data = nullptr;
+    unsigned int textureID;
+    glGenTextures(1, &textureID);
 
     // 翻转 Y 轴：OpenGL 的纹理坐标原点在左下角，而大多数图片格式原点在左上角
-    // 这是一个全局设置，放在这里确保加载前生效
-    stbi_set_flip_vertically_on_load(true);
+    // 使用线程局部的设置，不会影响工作线程上同时进行的解码
+    stbi_set_flip_vertically_on_load_thread(flip_vertically ? 1 : 0);
 
     // 使用 stbi_load 加载图片
-    // &width, &height, &nrChannels 会被填充为图片的实际信息
-    data = stbi_load(path, &width, &height, &nrChannels, 0);
+    // w, h, n 会被填充为图片的实际信息
+    int w = 0, h = 0, n = 0;
+    unsigned char *data = stbi_load(path.c_str(), &w, &h, &n, 0);
 
     if (data)
     {
         GLenum format;
-        if (nrChannels == 1)
+        if (n == 1)
             format = GL_RED;
-        else if (nrChannels == 3)
+        else if (n == 2)
+            format = GL_RG;
+        else if (n == 3)
             format = GL_RGB;
-        else if (nrChannels == 4)
+        else
             format = GL_RGBA;
 
         // 绑定当前纹理 ID，后续的操作都会作用于它
-        glBindTexture(GL_TEXTURE_2D, ID);
+        glBindTexture(GL_TEXTURE_2D, textureID);
 
-        // 将图片数据上传到 GPU
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+        // 将图片数据上传到 GPU (stb_image 的行是紧密排列的)
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, format, w, h, 0, format, GL_UNSIGNED_BYTE, data);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 
         // 自动生成多级渐远纹理 (Mipmap)
         glGenerateMipmap(GL_TEXTURE_2D);
@@ -56,8 +59,18 @@ Texture::Texture(const char* path)
     else
     {
         std::cout << "Texture failed to load at path: " << path << std::endl;
-        stbi_image_free(data);
+        w = h = n = 0;
     }
+
+    if (width) *width = w;
+    if (height) *height = h;
+    if (channels) *channels = n;
+    return textureID;
+}
+
+Texture::Texture(const char* path)
+{
+    ID = load_texture_file(path, true, &width, &height, &nrChannels);
 }
 
 Texture::~Texture()
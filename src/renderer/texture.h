@@ -3,6 +3,11 @@
 #include <glad/glad.h> // 需要 OpenGL 函数来管理纹理 ID
 #include <string>
 
+// 同步加载图片文件并创建 OpenGL 纹理 (带 Mipmap)，返回纹理 ID
+// 失败时依然返回一个有效的 (空) 纹理 ID，width/height/channels 为 0
+// Texture 类、模型和资源管理器共用这一份实现
+unsigned int load_texture_file(const std::string& path, bool flip_vertically, int* width = nullptr, int* height = nullptr, int* channels = nullptr);
+
 class Texture
 {
 public:
@@ -10,7 +15,7 @@ public:
     int width, height;    // 纹理的像素宽高
     int nrChannels;       // 颜色通道数 (RGB/RGBA)
 
-    // 构造函数：传入文件路径，自动加载图片并生成纹理
+    // 构造函数：传入文件路径，自动加载图片并生成纹理 (上下翻转以匹配 OpenGL 的纹理原点)
     Texture(const char* path);
 
     // 析构函数：对象销毁时自动释放显存
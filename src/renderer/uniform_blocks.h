@@ -0,0 +1,97 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <string>
+
+// =========================================================================
+// 引擎内置的 Uniform Block (std140 布局)
+// =========================================================================
+// 这些结构体和 Shader 里的 "layout (std140) uniform XxxBlock" 一一对应
+// std140 规则下 vec3 会按 16 字节对齐，为了避免踩坑，这里统一使用 vec4
+// (多出来的 w 分量要么闲置，要么用来塞额外的标量参数)
+
+// 最多支持的点光源数量 (必须与 main_fragment.glsl 中的 NR_POINT_LIGHTS 一致)
+const int MAX_POINT_LIGHTS = 4;
+
+// 定向光阴影的最大级数 (必须与片段着色器中的 NR_SHADOW_CASCADES 一致)
+const int MAX_SHADOW_CASCADES = 4;
+
+// 绑定点约定：C++ 端的 UniformBuffer 和 Shader 端的 Block 都绑定到这里
+enum UniformBlockBinding : unsigned int {
+    CAMERA_BLOCK_BINDING   = 0,
+    LIGHTS_BLOCK_BINDING   = 1,
+    MATERIAL_BLOCK_BINDING = 2,
+    CLUSTER_BLOCK_BINDING  = 3,
+    SHADOW_BLOCK_BINDING   = 4
+};
+
+// 摄像机：每帧更新一次
+struct CameraBlock {
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::vec4 view_pos;     // xyz = 摄像机位置
+};
+
+struct DirLightStd140 {
+    glm::vec4 direction;
+    glm::vec4 ambient;
+    glm::vec4 diffuse;
+    glm::vec4 specular;
+};
+
+struct PointLightStd140 {
+    glm::vec4 position;
+    glm::vec4 ambient;
+    glm::vec4 diffuse;
+    glm::vec4 specular;
+    glm::vec4 attenuation;  // x = constant, y = linear, z = quadratic
+};
+
+struct SpotLightStd140 {
+    glm::vec4 position;
+    glm::vec4 direction;
+    glm::vec4 ambient;
+    glm::vec4 diffuse;
+    glm::vec4 specular;
+    glm::vec4 attenuation;  // x = constant, y = linear, z = quadratic
+    glm::vec4 cone;         // x = cos(内切角), y = cos(外切角), z = 是否启用 (0/1)
+};
+
+// 光照：每帧更新一次
+struct LightsBlock {
+    DirLightStd140   dir_light;
+    PointLightStd140 point_lights[MAX_POINT_LIGHTS];
+    SpotLightStd140  spot_light;
+};
+
+// 材质常量 (纹理采样器不能放进 Uniform Block，仍然走普通 Uniform)
+struct MaterialBlock {
+    glm::vec4 params;       // x = shininess
+};
+
+// 分簇光照的网格参数 (见 light_clusters.h)
+struct ClusterBlock {
+    glm::uvec4 grid_size;     // xyz = 网格尺寸, w = 光源总数
+    glm::vec4  screen_params; // x = 视口宽, y = 视口高, z = 深度切片 scale, w = 深度切片 bias
+    glm::vec4  ambient;       // rgb = 点光源的环境光颜色
+};
+
+// 级联阴影 (见 shadow_cascades.h)
+struct ShadowBlock {
+    glm::mat4 light_space[MAX_SHADOW_CASCADES]; // 世界空间 -> 各级阴影贴图 (xyz 都在 [0, 1])
+    glm::vec4 cascade_splits;  // 各级覆盖到的最远观察深度
+    glm::vec4 texel_sizes;     // 各级一个阴影贴图 texel 的世界尺寸
+    glm::vec4 params;          // x = 级数 (0 = 关闭), y = 深度偏移, z = 法线偏移 (texel), w = 1 / 分辨率
+};
+
+namespace UniformBlocks {
+    // 根据 Shader 中的 Block 名字查找约定的绑定点，未知名字返回 -1
+    inline int binding_for(const std::string& block_name) {
+        if (block_name == "CameraBlock")   return CAMERA_BLOCK_BINDING;
+        if (block_name == "LightsBlock")   return LIGHTS_BLOCK_BINDING;
+        if (block_name == "MaterialBlock") return MATERIAL_BLOCK_BINDING;
+        if (block_name == "ClusterBlock")  return CLUSTER_BLOCK_BINDING;
+        if (block_name == "ShadowBlock")   return SHADOW_BLOCK_BINDING;
+        return -1;
+    }
+}
@@ -0,0 +1,51 @@
+#include "../renderer/uniform_buffer.h"
+#include "../renderer/stream_buffer.h"
+
+#include <iostream>
+
+UniformBuffer::UniformBuffer(std::size_t size, unsigned int binding)
+    : binding(binding), size(size)
+{
+    glGenBuffers(1, &ID);
+    glBindBuffer(GL_UNIFORM_BUFFER, ID);
+    // 每帧都会整体重写，所以用 DYNAMIC_DRAW
+    glBufferData(GL_UNIFORM_BUFFER, size, NULL, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    // 绑定到绑定点，之后所有 Shader 里同名的 Block 都能直接读取
+    glBindBufferBase(GL_UNIFORM_BUFFER, binding, ID);
+}
+
+UniformBuffer::~UniformBuffer()
+{
+    glDeleteBuffers(1, &ID);
+}
+
+void UniformBuffer::update(const void* data, std::size_t data_size, std::size_t offset) const
+{
+    if (offset + data_size > size)
+    {
+        std::cout << "ERROR::UNIFORM_BUFFER::UPDATE_OUT_OF_RANGE: " << offset + data_size << " > " << size << std::endl;
+        return;
+    }
+
+    glBindBuffer(GL_UNIFORM_BUFFER, ID);
+    glBufferSubData(GL_UNIFORM_BUFFER, offset, data_size, data);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void UniformBuffer::stream(StreamBuffer& ring, const void* data, std::size_t data_size)
+{
+    StreamRange range = ring.write(data, data_size, ring.get_uniform_alignment());
+    if (!range.valid()) {
+        if (streamed) {
+            glBindBufferBase(GL_UNIFORM_BUFFER, binding, ID);
+            streamed = false;
+        }
+        update(data, data_size);
+        return;
+    }
+
+    glBindBufferRange(GL_UNIFORM_BUFFER, binding, range.buffer, range.offset, data_size);
+    streamed = true;
+}
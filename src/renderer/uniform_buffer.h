@@ -0,0 +1,45 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+
+class StreamBuffer;
+
+// Uniform Buffer Object 的简单封装
+// 一个 UBO 对应 Shader 里的一个 Uniform Block，整块数据一次 glBufferSubData 上传，
+// 取代逐个调用 glUniform* 的方式
+class UniformBuffer
+{
+public:
+    unsigned int ID;        // OpenGL 缓冲 ID
+    unsigned int binding;   // 绑定点 (见 uniform_blocks.h)
+    std::size_t size;       // 缓冲大小 (字节)
+
+    // 构造函数：分配显存并绑定到指定的绑定点
+    UniformBuffer(std::size_t size, unsigned int binding);
+
+    // 析构函数：释放显存
+    ~UniformBuffer();
+
+    // 禁止拷贝，防止两个对象重复删除同一个缓冲
+    UniformBuffer(const UniformBuffer&) = delete;
+    UniformBuffer& operator=(const UniformBuffer&) = delete;
+
+    // 上传数据 (offset + data_size 不能超过 size)
+    void update(const void* data, std::size_t data_size, std::size_t offset = 0) const;
+
+    // 便捷版本：直接上传整个结构体
+    template <typename T>
+    void update(const T& block) const { update(&block, sizeof(T)); }
+
+    // 每帧数据走环形缓冲：写进本帧的一段，再用 glBindBufferRange 把绑定点指过去
+    // 不会等待 GPU 读完上一帧的内容；环形缓冲放不下时退回 update()
+    void stream(StreamBuffer& ring, const void* data, std::size_t data_size);
+
+    template <typename T>
+    void stream(StreamBuffer& ring, const T& block) { stream(ring, &block, sizeof(T)); }
+
+private:
+    // 绑定点当前是否指向环形缓冲 (退回 update() 时需要重新指回自己的缓冲)
+    bool streamed = false;
+};
@@ -0,0 +1,258 @@
+#include "vertex_format.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+    void append(std::vector<uint8_t>& out, const void* data, std::size_t size)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        out.insert(out.end(), bytes, bytes + size);
+    }
+
+    int16_t to_snorm16(float value)
+    {
+        return static_cast<int16_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+    }
+
+    uint16_t to_unorm16(float value)
+    {
+        return static_cast<uint16_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 65535.0f));
+    }
+
+    // float -> IEEE 754 half (就近舍入，溢出变为无穷，过小变为 0)
+    uint16_t to_half(float value)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+
+        uint32_t sign = (bits >> 16) & 0x8000u;
+        int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xFFu) - 127 + 15;
+        uint32_t mantissa = bits & 0x7FFFFFu;
+
+        if (((bits >> 23) & 0xFFu) == 0xFFu) // Inf / NaN
+            return static_cast<uint16_t>(sign | 0x7C00u | (mantissa ? 0x200u : 0u));
+        if (exponent >= 31)
+            return static_cast<uint16_t>(sign | 0x7C00u);
+        if (exponent <= 0) {
+            // 非规格化数
+            if (exponent < -10)
+                return static_cast<uint16_t>(sign);
+            mantissa |= 0x800000u;
+            uint32_t shift = static_cast<uint32_t>(14 - exponent);
+            uint32_t half_mantissa = mantissa >> shift;
+            if ((mantissa >> (shift - 1)) & 1u)
+                half_mantissa++;
+            return static_cast<uint16_t>(sign | half_mantissa);
+        }
+
+        uint32_t half = sign | (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+        if (mantissa & 0x1000u) // 舍入 (进位可能溢出到指数位，结果依然正确)
+            half++;
+        return static_cast<uint16_t>(half);
+    }
+
+    // 单位向量 -> 八面体映射 [-1, 1]^2
+    glm::vec2 encode_octahedral(glm::vec3 n)
+    {
+        float length = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+        if (length <= 0.0f)
+            return glm::vec2(0.0f);
+        n /= length;
+
+        glm::vec2 result(n.x, n.y);
+        if (n.z < 0.0f) {
+            // 下半球折叠到四个角上
+            result.x = (1.0f - std::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f);
+            result.y = (1.0f - std::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f);
+        }
+        return result;
+    }
+
+    // GL_INT_2_10_10_10_REV：x 在低 10 位，w 在最高 2 位
+    uint32_t pack_snorm10(const glm::vec3& n)
+    {
+        auto component = [](float value) {
+            int32_t q = static_cast<int32_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 511.0f));
+            return static_cast<uint32_t>(q) & 0x3FFu;
+        };
+        return component(n.x) | (component(n.y) << 10) | (component(n.z) << 20);
+    }
+
+    unsigned int position_size(position_format format)
+    {
+        return format == position_format::UNORM16 ? 8 : 12;
+    }
+
+    unsigned int normal_size(normal_format format)
+    {
+        return format == normal_format::FLOAT3 ? 12 : 4;
+    }
+
+    unsigned int texcoord_size(texcoord_format format)
+    {
+        return format == texcoord_format::HALF2 ? 4 : 8;
+    }
+}
+
+VertexFormat VertexFormat::compact()
+{
+    VertexFormat format;
+    format.position = position_format::UNORM16;
+    format.normal = normal_format::OCTAHEDRAL;
+    format.texcoord = texcoord_format::HALF2;
+    format.index16 = true;
+    return format;
+}
+
+unsigned int VertexFormat::stride() const
+{
+    return position_size(position) + normal_size(normal) + texcoord_size(texcoord);
+}
+
+unsigned int VertexFormat::normal_offset() const
+{
+    return position_size(position);
+}
+
+unsigned int VertexFormat::texcoord_offset() const
+{
+    return position_size(position) + normal_size(normal);
+}
+
+bool VertexFormat::is_standard() const
+{
+    return position == position_format::FLOAT3 && normal == normal_format::FLOAT3 && texcoord == texcoord_format::FLOAT2;
+}
+
+uint32_t VertexFormat::key() const
+{
+    return static_cast<uint32_t>(position) | (static_cast<uint32_t>(normal) << 4) |
+           (static_cast<uint32_t>(texcoord) << 8) | (index16 ? 1u << 12 : 0u);
+}
+
+bool VertexFormat::from_key(uint32_t key, VertexFormat& format)
+{
+    uint32_t position = key & 0xF, normal = (key >> 4) & 0xF, texcoord = (key >> 8) & 0xF;
+    if (position > 1 || normal > 2 || texcoord > 1 || (key >> 13) != 0)
+        return false;
+
+    format.position = static_cast<position_format>(position);
+    format.normal = static_cast<normal_format>(normal);
+    format.texcoord = static_cast<texcoord_format>(texcoord);
+    format.index16 = (key >> 12) & 1u;
+    return true;
+}
+
+VertexDecode make_vertex_decode(const VertexFormat& format, const AABB& bounds)
+{
+    VertexDecode decode;
+    if (format.position == position_format::UNORM16 && bounds.is_valid()) {
+        decode.position_scale = bounds.max - bounds.min;
+        decode.position_offset = bounds.min;
+    }
+    decode.octahedral_normals = format.normal == normal_format::OCTAHEDRAL;
+    return decode;
+}
+
+void pack_vertices(const Vertex* vertices, unsigned int count, const VertexFormat& format, const AABB& bounds,
+                   std::vector<uint8_t>& out)
+{
+    if (format.is_standard()) {
+        append(out, vertices, std::size_t(count) * sizeof(Vertex));
+        return;
+    }
+
+    // 量化位置：映射到包围盒内的 [0, 1]，某个轴没有厚度时该轴全部为 0
+    glm::vec3 extent = bounds.is_valid() ? bounds.max - bounds.min : glm::vec3(0.0f);
+    glm::vec3 inverse_extent;
+    for (int axis = 0; axis < 3; axis++)
+        inverse_extent[axis] = extent[axis] > 0.0f ? 1.0f / extent[axis] : 0.0f;
+
+    out.reserve(out.size() + std::size_t(count) * format.stride());
+    for (unsigned int i = 0; i < count; i++) {
+        const Vertex& vertex = vertices[i];
+
+        if (format.position == position_format::UNORM16) {
+            glm::vec3 t = (vertex.Position - bounds.min) * inverse_extent;
+            uint16_t packed[4] = { to_unorm16(t.x), to_unorm16(t.y), to_unorm16(t.z), 0 };
+            append(out, packed, sizeof(packed));
+        }
+        else {
+            append(out, &vertex.Position, sizeof(glm::vec3));
+        }
+
+        if (format.normal == normal_format::OCTAHEDRAL) {
+            glm::vec2 oct = encode_octahedral(vertex.Normal);
+            int16_t packed[2] = { to_snorm16(oct.x), to_snorm16(oct.y) };
+            append(out, packed, sizeof(packed));
+        }
+        else if (format.normal == normal_format::SNORM10) {
+            uint32_t packed = pack_snorm10(vertex.Normal);
+            append(out, &packed, sizeof(packed));
+        }
+        else {
+            append(out, &vertex.Normal, sizeof(glm::vec3));
+        }
+
+        if (format.texcoord == texcoord_format::HALF2) {
+            uint16_t packed[2] = { to_half(vertex.TexCoords.x), to_half(vertex.TexCoords.y) };
+            append(out, packed, sizeof(packed));
+        }
+        else {
+            append(out, &vertex.TexCoords, sizeof(glm::vec2));
+        }
+    }
+}
+
+unsigned int index_size_for(const VertexFormat& format, unsigned int vertex_count)
+{
+    return format.index16 && vertex_count <= 65536 ? 2 : 4;
+}
+
+void pack_indices(const unsigned int* indices, unsigned int count, unsigned int index_size, std::vector<uint8_t>& out)
+{
+    if (index_size == 4) {
+        append(out, indices, std::size_t(count) * sizeof(unsigned int));
+        return;
+    }
+
+    std::size_t start = out.size();
+    out.resize(start + std::size_t(count) * sizeof(uint16_t));
+    uint16_t* packed = reinterpret_cast<uint16_t*>(out.data() + start);
+    for (unsigned int i = 0; i < count; i++)
+        packed[i] = static_cast<uint16_t>(indices[i]);
+}
+
+void setup_vertex_attributes(const VertexFormat& format)
+{
+    GLsizei stride = static_cast<GLsizei>(format.stride());
+    const void* normal_offset = reinterpret_cast<const void*>(static_cast<uintptr_t>(format.normal_offset()));
+    const void* texcoord_offset = reinterpret_cast<const void*>(static_cast<uintptr_t>(format.texcoord_offset()));
+
+    // 位置 Position (Location = 0)
+    // UNORM16 归一化到 [0, 1]，着色器里再用包围盒反量化
+    glEnableVertexAttribArray(0);
+    if (format.position == position_format::UNORM16)
+        glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, stride, (void*)0);
+    else
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
+
+    // 法线 Normal (Location = 1)
+    // 八面体编码只有两个分量 (z 自动补 0)，着色器根据 octahedralNormals 解码
+    glEnableVertexAttribArray(1);
+    if (format.normal == normal_format::OCTAHEDRAL)
+        glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, stride, normal_offset);
+    else if (format.normal == normal_format::SNORM10)
+        glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, normal_offset);
+    else
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, normal_offset);
+
+    // 纹理坐标 TexCoords (Location = 2)
+    glEnableVertexAttribArray(2);
+    if (format.texcoord == texcoord_format::HALF2)
+        glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, stride, texcoord_offset);
+    else
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, texcoord_offset);
+}
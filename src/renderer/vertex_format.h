@@ -0,0 +1,103 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+#include "../scene/bounds.h"
+
+// 定义顶点的标准格式
+// 这种结构体在内存中是紧凑排列的：PX,PY,PZ, NX,NY,NZ, U,V
+// 这与 OpenGL 的缓冲布局完美对应
+// 导入和处理阶段统一使用它，上传前再按 VertexFormat 打包成压缩格式
+struct Vertex {
+    glm::vec3 Position;
+    glm::vec3 Normal;
+    glm::vec2 TexCoords;
+};
+
+// 位置编码
+enum class position_format : uint8_t {
+    FLOAT3 = 0,      // 3 x float                                            12 字节
+    UNORM16 = 1      // 3 x uint16，相对于网格包围盒量化 (补齐到 4 字节对齐)      8 字节
+};
+
+// 法线编码
+enum class normal_format : uint8_t {
+    FLOAT3 = 0,      // 3 x float                                            12 字节
+    OCTAHEDRAL = 1,  // 八面体映射到 2 x snorm16                              4 字节
+    SNORM10 = 2      // GL_INT_2_10_10_10_REV (xyz 各 10 位)                  4 字节
+};
+
+// 纹理坐标编码
+enum class texcoord_format : uint8_t {
+    FLOAT2 = 0,      // 2 x float                                            8 字节
+    HALF2 = 1        // 2 x half float                                       4 字节
+};
+
+// 顶点格式：导入时选定，决定 GPU 缓冲里每个顶点的布局
+// 属性位置固定：0 = 位置, 1 = 法线, 2 = 纹理坐标 (与所有顶点着色器的约定一致)
+struct VertexFormat {
+    position_format position = position_format::FLOAT3;
+    normal_format   normal   = normal_format::FLOAT3;
+    texcoord_format texcoord = texcoord_format::FLOAT2;
+    bool index16 = false; // 顶点数不超过 65536 时使用 16 位索引
+
+    // 与 Vertex 结构体完全相同的布局 (32 字节，32 位索引)
+    static VertexFormat standard() { return VertexFormat(); }
+
+    // 压缩布局：量化位置 + 八面体法线 + half UV + 16 位索引 (16 字节)
+    static VertexFormat compact();
+
+    unsigned int stride() const;
+    unsigned int normal_offset() const;
+    unsigned int texcoord_offset() const;
+
+    // 是否与 Vertex 的内存布局相同 (可以原样上传)
+    bool is_standard() const;
+
+    // 打包成 32 位的键 (写进 .smesh 头部、参与缓存哈希)
+    uint32_t key() const;
+    static bool from_key(uint32_t key, VertexFormat& format);
+
+    bool operator==(const VertexFormat& other) const { return key() == other.key(); }
+    bool operator!=(const VertexFormat& other) const { return key() != other.key(); }
+};
+
+// 顶点着色器里的解码参数 (每个网格一组)
+// 解码后的位置 = 存储值 * position_scale + position_offset
+struct VertexDecode {
+    glm::vec3 position_scale = glm::vec3(1.0f);
+    glm::vec3 position_offset = glm::vec3(0.0f);
+    bool octahedral_normals = false;
+
+    bool operator==(const VertexDecode& other) const
+    {
+        return position_scale == other.position_scale && position_offset == other.position_offset &&
+               octahedral_normals == other.octahedral_normals;
+    }
+    bool operator!=(const VertexDecode& other) const { return !(*this == other); }
+};
+
+// 量化位置使用的包围盒 (与打包时一致)，由它得到解码参数
+VertexDecode make_vertex_decode(const VertexFormat& format, const AABB& bounds);
+
+// 按格式打包顶点，结果追加到 out 末尾
+// bounds 是这些顶点的包围盒 (量化位置时使用)
+void pack_vertices(const Vertex* vertices, unsigned int count, const VertexFormat& format, const AABB& bounds,
+                   std::vector<uint8_t>& out);
+
+// 实际使用的索引宽度 (字节)：格式允许且顶点数放得下时为 2，否则为 4
+unsigned int index_size_for(const VertexFormat& format, unsigned int vertex_count);
+
+// 按宽度打包索引，结果追加到 out 末尾
+void pack_indices(const unsigned int* indices, unsigned int count, unsigned int index_size, std::vector<uint8_t>& out);
+
+// 为当前绑定的 GL_ARRAY_BUFFER 设置顶点属性指针 (记录到当前绑定的 VAO 中)
+void setup_vertex_attributes(const VertexFormat& format);
+
+// 索引宽度 -> GL_UNSIGNED_SHORT / GL_UNSIGNED_INT
+inline GLenum index_type_for(unsigned int index_size)
+{
+    return index_size == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+}
@@ -0,0 +1,137 @@
+#include "../scene/bounds.h"
+
+#include <algorithm>
+
+float AABB::surface_area() const
+{
+    if (!is_valid())
+        return 0.0f;
+    glm::vec3 size = max - min;
+    return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+void AABB::expand(const glm::vec3& point)
+{
+    min = glm::min(min, point);
+    max = glm::max(max, point);
+}
+
+void AABB::expand(const AABB& other)
+{
+    if (!other.is_valid())
+        return;
+    min = glm::min(min, other.min);
+    max = glm::max(max, other.max);
+}
+
+AABB AABB::transformed(const glm::mat4& matrix) const
+{
+    if (!is_valid())
+        return *this;
+
+    // 中心点正常变换；半长用矩阵各元素的绝对值变换 (Arvo 方法)
+    // 比变换 8 个角点再求包围盒快得多，结果完全相同
+    glm::vec3 c = glm::vec3(matrix * glm::vec4(center(), 1.0f));
+    glm::vec3 e = extents();
+
+    glm::vec3 new_extents;
+    for (int i = 0; i < 3; i++) {
+        new_extents[i] = std::abs(matrix[0][i]) * e.x
+                       + std::abs(matrix[1][i]) * e.y
+                       + std::abs(matrix[2][i]) * e.z;
+    }
+
+    AABB result;
+    result.min = c - new_extents;
+    result.max = c + new_extents;
+    return result;
+}
+
+BoundingSphere BoundingSphere::transformed(const glm::mat4& matrix) const
+{
+    BoundingSphere result;
+    result.center = glm::vec3(matrix * glm::vec4(center, 1.0f));
+
+    float sx = glm::length(glm::vec3(matrix[0]));
+    float sy = glm::length(glm::vec3(matrix[1]));
+    float sz = glm::length(glm::vec3(matrix[2]));
+    result.radius = radius * std::max(sx, std::max(sy, sz));
+    return result;
+}
+
+Frustum Frustum::from_matrix(const glm::mat4& m)
+{
+    // glm 是列主序：m[col][row]
+    // 第 i 行 = (m[0][i], m[1][i], m[2][i], m[3][i])
+    glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+    glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+    glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+    glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+    Frustum frustum;
+    frustum.planes[LEFT]       = row3 + row0;
+    frustum.planes[RIGHT]      = row3 - row0;
+    frustum.planes[BOTTOM]     = row3 + row1;
+    frustum.planes[TOP]        = row3 - row1;
+    frustum.planes[NEAR_PLANE] = row3 + row2;
+    frustum.planes[FAR_PLANE]  = row3 - row2;
+
+    // 归一化，让 dot(normal, p) + w 等于真实的有向距离 (球体测试需要)
+    for (glm::vec4& plane : frustum.planes) {
+        float length = glm::length(glm::vec3(plane));
+        if (length > 0.0f)
+            plane /= length;
+    }
+    return frustum;
+}
+
+bool Frustum::intersects(const AABB& box) const
+{
+    glm::vec3 c = box.center();
+    glm::vec3 e = box.extents();
+    for (const glm::vec4& plane : planes) {
+        // 包围盒在平面法线方向上的投影半径
+        float r = e.x * std::abs(plane.x) + e.y * std::abs(plane.y) + e.z * std::abs(plane.z);
+        float d = plane.x * c.x + plane.y * c.y + plane.z * c.z + plane.w;
+        if (d + r < 0.0f)
+            return false;
+    }
+    return true;
+}
+
+bool Frustum::intersects(const BoundingSphere& sphere) const
+{
+    for (const glm::vec4& plane : planes) {
+        float d = glm::dot(glm::vec3(plane), sphere.center) + plane.w;
+        if (d < -sphere.radius)
+            return false;
+    }
+    return true;
+}
+
+AABB compute_aabb(const void* points, unsigned int count, unsigned int stride)
+{
+    AABB box;
+    const unsigned char* bytes = static_cast<const unsigned char*>(points);
+    for (unsigned int i = 0; i < count; i++)
+        box.expand(*reinterpret_cast<const glm::vec3*>(bytes + i * stride));
+    return box;
+}
+
+BoundingSphere compute_bounding_sphere(const void* points, unsigned int count, unsigned int stride, const AABB& box)
+{
+    BoundingSphere sphere;
+    if (!box.is_valid())
+        return sphere;
+
+    sphere.center = box.center();
+
+    float max_distance2 = 0.0f;
+    const unsigned char* bytes = static_cast<const unsigned char*>(points);
+    for (unsigned int i = 0; i < count; i++) {
+        glm::vec3 d = *reinterpret_cast<const glm::vec3*>(bytes + i * stride) - sphere.center;
+        max_distance2 = std::max(max_distance2, glm::dot(d, d));
+    }
+    sphere.radius = std::sqrt(max_distance2);
+    return sphere;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cfloat>
+
+// 轴对齐包围盒 (Axis-Aligned Bounding Box)
+// 默认构造出来的是 "空盒" (min > max)，expand 之后才有效
+struct AABB {
+    glm::vec3 min = glm::vec3( FLT_MAX);
+    glm::vec3 max = glm::vec3(-FLT_MAX);
+
+    // 是否包含至少一个点
+    bool is_valid() const { return min.x <= max.x && min.y <= max.y && min.z <= max.z; }
+
+    glm::vec3 center() const  { return (min + max) * 0.5f; }
+    glm::vec3 extents() const { return (max - min) * 0.5f; } // 半长
+    float surface_area() const;
+
+    // 扩展包围盒，使其包含一个点 / 另一个包围盒
+    void expand(const glm::vec3& point);
+    void expand(const AABB& other);
+
+    // 把包围盒变换到另一个空间 (通常是 局部 -> 世界)
+    // 结果依然是轴对齐的，会比原盒子略大
+    AABB transformed(const glm::mat4& matrix) const;
+};
+
+// 包围球
+struct BoundingSphere {
+    glm::vec3 center = glm::vec3(0.0f);
+    float radius = 0.0f;
+
+    // 变换包围球 (半径按最大缩放轴放大)
+    BoundingSphere transformed(const glm::mat4& matrix) const;
+};
+
+// 视锥体：6 个平面，法线指向视锥体内部
+// 平面方程为 dot(normal, p) + w = 0，点在平面内侧时结果 >= 0
+struct Frustum {
+    enum { LEFT = 0, RIGHT, BOTTOM, TOP, NEAR_PLANE, FAR_PLANE, PLANE_COUNT };
+    glm::vec4 planes[PLANE_COUNT];
+
+    // 从 Projection * View 矩阵中提取平面 (Gribb/Hartmann 方法)
+    static Frustum from_matrix(const glm::mat4& view_projection);
+
+    // 单个物体的测试 (大批量请使用 FrustumCuller)
+    bool intersects(const AABB& box) const;
+    bool intersects(const BoundingSphere& sphere) const;
+};
+
+// 根据一组点计算包围盒和包围球 (Ritter 算法的简化版：以包围盒中心为球心)
+// stride 是相邻两个点之间的字节距离，方便直接传入 Vertex 数组
+AABB compute_aabb(const void* points, unsigned int count, unsigned int stride);
+BoundingSphere compute_bounding_sphere(const void* points, unsigned int count, unsigned int stride, const AABB& box);
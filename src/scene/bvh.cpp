@@ -0,0 +1,457 @@
+#include "../scene/bvh.h"
+#include "../renderer/frustum_culler.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace {
+    // 分桶 SAH 的桶数：12 个桶在构建速度和树质量之间比较平衡
+    const int SAH_BINS = 12;
+
+    // 遍历一个内部节点相对于测试一个物体的代价
+    const float TRAVERSAL_COST = 1.0f;
+
+    // 遍历栈：SAH 不保证树的深度，栈必须能增长
+    // 每个线程复用一个 (查询可能在多个任务里同时进行)，容量留到下次，稳定后不再分配内存
+    template <typename T>
+    std::vector<T>& traversal_stack()
+    {
+        thread_local std::vector<T> stack;
+        stack.clear();
+        return stack;
+    }
+
+    // 视锥查询中和视锥部分相交的叶子：里面的物体先收集起来，最后用 FrustumCuller 一次批量 (SIMD) 测试
+    struct PartialLeafBatch {
+        FrustumCuller culler;
+        std::vector<uint32_t> objects; // 批次下标 -> 物体 ID
+    };
+
+    PartialLeafBatch& partial_leaf_batch()
+    {
+        thread_local PartialLeafBatch batch;
+        batch.culler.clear();
+        batch.objects.clear();
+        return batch;
+    }
+
+    float half_area(const glm::vec3& min, const glm::vec3& max)
+    {
+        glm::vec3 e = max - min;
+        return e.x * e.y + e.y * e.z + e.z * e.x;
+    }
+
+    // 射线与包围盒的 Slab 测试，命中时返回进入距离，否则返回 FLT_MAX
+    float intersect_ray_aabb(const glm::vec3& origin, const glm::vec3& inv_dir, float max_t,
+                             const glm::vec3& box_min, const glm::vec3& box_max)
+    {
+        glm::vec3 t0 = (box_min - origin) * inv_dir;
+        glm::vec3 t1 = (box_max - origin) * inv_dir;
+        glm::vec3 t_small = glm::min(t0, t1);
+        glm::vec3 t_big = glm::max(t0, t1);
+
+        float t_enter = std::max(std::max(t_small.x, t_small.y), std::max(t_small.z, 0.0f));
+        float t_exit  = std::min(std::min(t_big.x, t_big.y), std::min(t_big.z, max_t));
+        return t_enter <= t_exit ? t_enter : FLT_MAX;
+    }
+
+    bool overlaps_sphere(const glm::vec3& box_min, const glm::vec3& box_max, const glm::vec3& center, float radius)
+    {
+        glm::vec3 closest = glm::clamp(center, box_min, box_max);
+        glm::vec3 d = closest - center;
+        return glm::dot(d, d) <= radius * radius;
+    }
+}
+
+void BVH::build(const std::vector<AABB>& bounds)
+{
+    object_bounds = bounds;
+    const uint32_t count = static_cast<uint32_t>(object_bounds.size());
+
+    nodes.clear();
+    parents.clear();
+    dirty_objects.clear();
+    object_indices.resize(count);
+    object_leaf.assign(count, 0);
+    build_cost = current_cost = 0.0f;
+
+    if (count == 0)
+        return;
+
+    // 最多 2N-1 个节点，预留好避免构建中途扩容
+    nodes.reserve(count * 2);
+    parents.reserve(count * 2);
+
+    std::vector<glm::vec3> centroids(count);
+    for (uint32_t i = 0; i < count; i++) {
+        object_indices[i] = i;
+        centroids[i] = object_bounds[i].center();
+    }
+
+    BVHNode root;
+    root.left_first = 0;
+    root.count = count;
+    nodes.push_back(root);
+    parents.push_back(UINT32_MAX);
+
+    update_node_bounds(0);
+    subdivide(0, centroids);
+
+    // 记录每个物体所在的叶子，refit 时直接从叶子开始向上更新
+    for (uint32_t n = 0; n < nodes.size(); n++) {
+        const BVHNode& node = nodes[n];
+        if (!node.is_leaf())
+            continue;
+        for (uint32_t i = 0; i < node.count; i++)
+            object_leaf[object_indices[node.left_first + i]] = n;
+    }
+
+    build_cost = current_cost = compute_sah_cost();
+}
+
+void BVH::update_node_bounds(uint32_t node_index)
+{
+    BVHNode& node = nodes[node_index];
+    AABB box;
+    if (node.is_leaf()) {
+        for (uint32_t i = 0; i < node.count; i++)
+            box.expand(object_bounds[object_indices[node.left_first + i]]);
+    } else {
+        const BVHNode& left = nodes[node.left_first];
+        const BVHNode& right = nodes[node.left_first + 1];
+        box.min = glm::min(left.min, right.min);
+        box.max = glm::max(left.max, right.max);
+    }
+    node.min = box.min;
+    node.max = box.max;
+}
+
+void BVH::subdivide(uint32_t node_index, std::vector<glm::vec3>& centroids)
+{
+    const uint32_t first = nodes[node_index].left_first;
+    const uint32_t count = nodes[node_index].count;
+    if (count <= MAX_LEAF_SIZE)
+        return;
+
+    // 用物体中心点的包围盒来划分桶 (比用节点包围盒更均匀)
+    glm::vec3 centroid_min(FLT_MAX), centroid_max(-FLT_MAX);
+    for (uint32_t i = 0; i < count; i++) {
+        const glm::vec3& c = centroids[object_indices[first + i]];
+        centroid_min = glm::min(centroid_min, c);
+        centroid_max = glm::max(centroid_max, c);
+    }
+
+    int best_axis = -1;
+    float best_position = 0.0f;
+    float best_cost = FLT_MAX;
+
+    for (int axis = 0; axis < 3; axis++) {
+        float extent = centroid_max[axis] - centroid_min[axis];
+        if (extent <= 0.0f)
+            continue;
+
+        // 把物体分到各个桶里
+        AABB bin_bounds[SAH_BINS];
+        uint32_t bin_count[SAH_BINS] = {};
+        float scale = SAH_BINS / extent;
+        for (uint32_t i = 0; i < count; i++) {
+            uint32_t object = object_indices[first + i];
+            int bin = std::min(SAH_BINS - 1, static_cast<int>((centroids[object][axis] - centroid_min[axis]) * scale));
+            bin_count[bin]++;
+            bin_bounds[bin].expand(object_bounds[object]);
+        }
+
+        // 从左往右、从右往左各扫一遍，得到每个切分位置两侧的面积和数量
+        float left_area[SAH_BINS - 1], right_area[SAH_BINS - 1];
+        uint32_t left_count[SAH_BINS - 1], right_count[SAH_BINS - 1];
+        AABB left_box, right_box;
+        uint32_t left_sum = 0, right_sum = 0;
+        for (int i = 0; i < SAH_BINS - 1; i++) {
+            left_sum += bin_count[i];
+            left_box.expand(bin_bounds[i]);
+            left_count[i] = left_sum;
+            left_area[i] = left_box.is_valid() ? half_area(left_box.min, left_box.max) : 0.0f;
+
+            right_sum += bin_count[SAH_BINS - 1 - i];
+            right_box.expand(bin_bounds[SAH_BINS - 1 - i]);
+            right_count[SAH_BINS - 2 - i] = right_sum;
+            right_area[SAH_BINS - 2 - i] = right_box.is_valid() ? half_area(right_box.min, right_box.max) : 0.0f;
+        }
+
+        for (int i = 0; i < SAH_BINS - 1; i++) {
+            float cost = left_count[i] * left_area[i] + right_count[i] * right_area[i];
+            if (cost < best_cost) {
+                best_cost = cost;
+                best_axis = axis;
+                best_position = centroid_min[axis] + (i + 1) / scale;
+            }
+        }
+    }
+
+    // 划分不比直接做叶子更便宜时就停止
+    float leaf_cost = count * half_area(nodes[node_index].min, nodes[node_index].max);
+    float split_cost = TRAVERSAL_COST * half_area(nodes[node_index].min, nodes[node_index].max) + best_cost;
+    if (best_axis < 0 || split_cost >= leaf_cost)
+        return;
+
+    // 原地分区：左边是中心点在切分位置左侧的物体
+    uint32_t i = first;
+    uint32_t j = first + count;
+    while (i < j) {
+        if (centroids[object_indices[i]][best_axis] < best_position)
+            i++;
+        else
+            std::swap(object_indices[i], object_indices[--j]);
+    }
+
+    uint32_t left_count = i - first;
+    if (left_count == 0 || left_count == count)
+        return;
+
+    // 两个孩子相邻存放
+    uint32_t left_index = static_cast<uint32_t>(nodes.size());
+    BVHNode left, right;
+    left.left_first = first;
+    left.count = left_count;
+    right.left_first = i;
+    right.count = count - left_count;
+    nodes.push_back(left);
+    nodes.push_back(right);
+    parents.push_back(node_index);
+    parents.push_back(node_index);
+
+    nodes[node_index].left_first = left_index;
+    nodes[node_index].count = 0;
+
+    update_node_bounds(left_index);
+    update_node_bounds(left_index + 1);
+    subdivide(left_index, centroids);
+    subdivide(left_index + 1, centroids);
+}
+
+void BVH::update_object(uint32_t object_id, const AABB& bounds)
+{
+    if (object_id >= object_bounds.size())
+        return;
+    object_bounds[object_id] = bounds;
+    dirty_objects.push_back(object_id);
+}
+
+void BVH::refit()
+{
+    if (dirty_objects.empty() || nodes.empty())
+        return;
+
+    if (dirty_objects.size() * 8 < object_bounds.size()) {
+        // 改动少：从每个脏叶子沿父节点链向上更新
+        for (uint32_t object : dirty_objects) {
+            uint32_t node = object_leaf[object];
+            while (node != UINT32_MAX) {
+                update_node_bounds(node);
+                node = parents[node];
+            }
+        }
+    } else {
+        // 改动多：孩子的下标总是大于父节点，倒序遍历一遍就是自底向上
+        for (uint32_t n = static_cast<uint32_t>(nodes.size()); n-- > 0;)
+            update_node_bounds(n);
+    }
+
+    dirty_objects.clear();
+    current_cost = compute_sah_cost();
+}
+
+bool BVH::rebuild_if_needed()
+{
+    refit();
+    if (build_cost <= 0.0f || current_cost <= build_cost * rebuild_threshold)
+        return false;
+
+    std::vector<AABB> bounds = object_bounds;
+    build(bounds);
+    return true;
+}
+
+float BVH::compute_sah_cost() const
+{
+    if (nodes.empty())
+        return 0.0f;
+
+    float root_area = half_area(nodes[0].min, nodes[0].max);
+    if (root_area <= 0.0f)
+        return 0.0f;
+
+    float cost = 0.0f;
+    for (const BVHNode& node : nodes) {
+        float area = half_area(node.min, node.max);
+        cost += node.is_leaf() ? node.count * area : TRAVERSAL_COST * area;
+    }
+    return cost / root_area;
+}
+
+void BVH::query_frustum(const Frustum& frustum, std::vector<uint32_t>& out) const
+{
+    if (nodes.empty())
+        return;
+
+    // 栈里同时记录平面掩码：父节点已经完全在某个平面内侧时，子节点不必再测这个平面
+    struct Entry { uint32_t node; uint32_t plane_mask; };
+    std::vector<Entry>& stack = traversal_stack<Entry>();
+    PartialLeafBatch& batch = partial_leaf_batch();
+    stack.push_back({ 0, (1u << Frustum::PLANE_COUNT) - 1 });
+
+    while (!stack.empty()) {
+        Entry entry = stack.back();
+        stack.pop_back();
+        const BVHNode& node = nodes[entry.node];
+
+        uint32_t mask = entry.plane_mask;
+        bool outside = false;
+        if (mask != 0) {
+            glm::vec3 c = (node.min + node.max) * 0.5f;
+            glm::vec3 e = (node.max - node.min) * 0.5f;
+            for (int p = 0; p < Frustum::PLANE_COUNT; p++) {
+                if (!(mask & (1u << p)))
+                    continue;
+                const glm::vec4& plane = frustum.planes[p];
+                float d = plane.x * c.x + plane.y * c.y + plane.z * c.z + plane.w;
+                float r = e.x * std::abs(plane.x) + e.y * std::abs(plane.y) + e.z * std::abs(plane.z);
+                if (d + r < 0.0f) { outside = true; break; }
+                if (d - r >= 0.0f) mask &= ~(1u << p); // 完全在内侧
+            }
+        }
+        if (outside)
+            continue;
+
+        if (node.is_leaf()) {
+            for (uint32_t i = 0; i < node.count; i++) {
+                uint32_t object = object_indices[node.left_first + i];
+                // 叶子完全在视锥内时直接可见；否则叶子里的物体还要再测，先放进批次
+                if (mask == 0) {
+                    out.push_back(object);
+                } else {
+                    batch.objects.push_back(object);
+                    batch.culler.add(object_bounds[object]);
+                }
+            }
+        } else {
+            stack.push_back({ node.left_first + 1, mask });
+            stack.push_back({ node.left_first, mask });
+        }
+    }
+
+    if (batch.objects.empty())
+        return;
+    batch.culler.cull(frustum);
+    for (uint32_t index : batch.culler.get_visible_indices())
+        out.push_back(batch.objects[index]);
+}
+
+void BVH::query_sphere(const glm::vec3& center, float radius, std::vector<uint32_t>& out) const
+{
+    if (nodes.empty())
+        return;
+
+    std::vector<uint32_t>& stack = traversal_stack<uint32_t>();
+    stack.push_back(0);
+
+    while (!stack.empty()) {
+        const BVHNode& node = nodes[stack.back()];
+        stack.pop_back();
+        if (!overlaps_sphere(node.min, node.max, center, radius))
+            continue;
+
+        if (node.is_leaf()) {
+            for (uint32_t i = 0; i < node.count; i++) {
+                uint32_t object = object_indices[node.left_first + i];
+                if (overlaps_sphere(object_bounds[object].min, object_bounds[object].max, center, radius))
+                    out.push_back(object);
+            }
+        } else {
+            stack.push_back(node.left_first + 1);
+            stack.push_back(node.left_first);
+        }
+    }
+}
+
+bool BVH::raycast(const glm::vec3& origin, const glm::vec3& direction, float max_distance, RayHit& hit) const
+{
+    hit = RayHit();
+    if (nodes.empty())
+        return false;
+
+    glm::vec3 inv_dir = 1.0f / direction;
+    float best_t = max_distance;
+
+    if (intersect_ray_aabb(origin, inv_dir, best_t, nodes[0].min, nodes[0].max) == FLT_MAX)
+        return false;
+    std::vector<uint32_t>& stack = traversal_stack<uint32_t>();
+    stack.push_back(0);
+
+    while (!stack.empty()) {
+        const BVHNode& node = nodes[stack.back()];
+        stack.pop_back();
+
+        if (node.is_leaf()) {
+            for (uint32_t i = 0; i < node.count; i++) {
+                uint32_t object = object_indices[node.left_first + i];
+                const AABB& box = object_bounds[object];
+                float t = intersect_ray_aabb(origin, inv_dir, best_t, box.min, box.max);
+                // intersect_ray_aabb 保证命中时 t <= best_t
+                if (t != FLT_MAX && (t < best_t || hit.object == UINT32_MAX)) {
+                    best_t = t;
+                    hit.object = object;
+                    hit.t = t;
+                }
+            }
+            continue;
+        }
+
+        // 先走近的孩子，远的孩子在当前最近命中更远时直接剪掉
+        uint32_t near_child = node.left_first;
+        uint32_t far_child = node.left_first + 1;
+        float t_near = intersect_ray_aabb(origin, inv_dir, best_t, nodes[near_child].min, nodes[near_child].max);
+        float t_far  = intersect_ray_aabb(origin, inv_dir, best_t, nodes[far_child].min, nodes[far_child].max);
+        if (t_far < t_near) {
+            std::swap(near_child, far_child);
+            std::swap(t_near, t_far);
+        }
+        if (t_far != FLT_MAX)
+            stack.push_back(far_child);
+        if (t_near != FLT_MAX)
+            stack.push_back(near_child);
+    }
+
+    return hit.object != UINT32_MAX;
+}
+
+void BVH::query_ray(const glm::vec3& origin, const glm::vec3& direction, float max_distance, std::vector<uint32_t>& out) const
+{
+    if (nodes.empty())
+        return;
+
+    glm::vec3 inv_dir = 1.0f / direction;
+
+    std::vector<uint32_t>& stack = traversal_stack<uint32_t>();
+    stack.push_back(0);
+
+    while (!stack.empty()) {
+        const BVHNode& node = nodes[stack.back()];
+        stack.pop_back();
+        if (intersect_ray_aabb(origin, inv_dir, max_distance, node.min, node.max) == FLT_MAX)
+            continue;
+
+        if (node.is_leaf()) {
+            for (uint32_t i = 0; i < node.count; i++) {
+                uint32_t object = object_indices[node.left_first + i];
+                const AABB& box = object_bounds[object];
+                if (intersect_ray_aabb(origin, inv_dir, max_distance, box.min, box.max) != FLT_MAX)
+                    out.push_back(object);
+            }
+        } else {
+            stack.push_back(node.left_first + 1);
+            stack.push_back(node.left_first);
+        }
+    }
+}
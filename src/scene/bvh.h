@@ -0,0 +1,90 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+#include "bounds.h"
+
+// BVH 节点：32 字节，两个节点正好占一条 64 字节缓存行
+// 左右子节点总是相邻存放 (right = left + 1)，遍历时一次取到两个孩子
+struct BVHNode {
+    glm::vec3 min;
+    uint32_t  left_first;  // 内部节点：左孩子下标；叶子：第一个物体在 object_indices 中的位置
+    glm::vec3 max;
+    uint32_t  count;       // 0 表示内部节点，否则为叶子包含的物体数
+
+    bool is_leaf() const { return count > 0; }
+};
+
+// 射线检测结果
+struct RayHit {
+    uint32_t object = UINT32_MAX; // 命中的物体 ID (UINT32_MAX 表示未命中)
+    float    t = 0.0f;            // 命中点到射线起点的距离 (以包围盒为准)
+};
+
+// BVH：场景级的空间加速结构 (层次包围盒)
+//
+// 视锥剔除、拾取 (射线) 和邻近查询 (球体) 共用同一棵树。
+// - build()：用分桶 SAH (Surface Area Heuristic) 从头构建
+// - update_object() + refit()：物体移动后只更新包围盒，不改变树的拓扑
+// - refit 会让树的质量逐渐变差，rebuild_if_needed() 在 SAH 代价劣化到阈值时重建
+class BVH
+{
+public:
+    // 叶子最多容纳的物体数
+    static const uint32_t MAX_LEAF_SIZE = 4;
+
+    // 用一组物体的世界空间包围盒构建 BVH，物体 ID 就是数组下标
+    void build(const std::vector<AABB>& object_bounds);
+
+    // 更新某个物体的包围盒 (比如它的 Transform 变了)，需要之后调用 refit()
+    void update_object(uint32_t object_id, const AABB& bounds);
+
+    // 把 update_object 的修改传播到整棵树
+    // 改动少时沿父节点链向上更新，改动多时整棵树自底向上重算一遍
+    void refit();
+
+    // 如果 refit 后的 SAH 代价比构建时差太多，就用当前包围盒重建
+    // 返回是否发生了重建
+    bool rebuild_if_needed();
+
+    // 允许的 SAH 代价劣化比例 (默认 1.3 倍)
+    void set_rebuild_threshold(float ratio) { rebuild_threshold = ratio; }
+
+    // --- 查询 ---
+
+    // 视锥体查询：所有与视锥相交的物体 ID 追加到 out
+    // 树只负责粗筛，部分相交的叶子里的物体最后交给 FrustumCuller 批量测试
+    void query_frustum(const Frustum& frustum, std::vector<uint32_t>& out) const;
+
+    // 球体查询：所有包围盒与球相交的物体 ID 追加到 out
+    void query_sphere(const glm::vec3& center, float radius, std::vector<uint32_t>& out) const;
+
+    // 射线查询：返回包围盒最近被命中的物体
+    bool raycast(const glm::vec3& origin, const glm::vec3& direction, float max_distance, RayHit& hit) const;
+
+    // 射线查询：所有包围盒被命中的物体 ID 追加到 out (用于再做精确的三角形测试)
+    void query_ray(const glm::vec3& origin, const glm::vec3& direction, float max_distance, std::vector<uint32_t>& out) const;
+
+    // --- 统计 ---
+    uint32_t get_object_count() const { return static_cast<uint32_t>(object_bounds.size()); }
+    uint32_t get_node_count() const { return static_cast<uint32_t>(nodes.size()); }
+    float    get_sah_cost() const { return current_cost; }
+    const AABB& get_object_bounds(uint32_t object_id) const { return object_bounds[object_id]; }
+
+private:
+    std::vector<BVHNode>  nodes;
+    std::vector<uint32_t> object_indices;  // 叶子引用的物体 ID (按叶子连续排列)
+    std::vector<AABB>     object_bounds;   // 每个物体当前的包围盒
+    std::vector<uint32_t> object_leaf;     // 物体 ID -> 所在叶子节点
+    std::vector<uint32_t> parents;         // 节点 -> 父节点 (根节点为 UINT32_MAX)
+    std::vector<uint32_t> dirty_objects;   // 等待 refit 的物体
+
+    float build_cost = 0.0f;
+    float current_cost = 0.0f;
+    float rebuild_threshold = 1.3f;
+
+    void subdivide(uint32_t node_index, std::vector<glm::vec3>& centroids);
+    void update_node_bounds(uint32_t node_index);
+    float compute_sah_cost() const;
+};
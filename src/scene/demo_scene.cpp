@@ -0,0 +1,582 @@
+#include "demo_scene.h"
+#include "primitives.h"
+#include "transform_kernels.h"
+#include "../core/profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace {
+    // DemoScene::object_casters 的取值
+    const uint8_t CASTER_DYNAMIC = 1;
+    const uint8_t CASTER_STATIC = 2;
+
+    // 箱子的纹理列表
+    // Mesh 类会根据 type (texture_diffuse/specular) 自动绑定到 Shader 中对应的采样器
+    std::vector<TextureInfo> make_box_textures(const TextureHandle& diffuse, const TextureHandle& specular)
+    {
+        std::vector<TextureInfo> textures;
+        textures.push_back({ diffuse->id, "texture_diffuse", "" });
+        textures.push_back({ specular->id, "texture_specular", "" });
+        return textures;
+    }
+}
+
+DemoScene::DemoScene(ResourceManager& resources, StreamBuffer& frame_stream)
+    : frame_stream(frame_stream),
+      // 主场景 Shader 和它的实例化版本 (模型矩阵来自实例属性)，变体按需编译
+      forward_shaders(resources, "assets/shaders/main_vertex.glsl", "assets/shaders/main_fragment.glsl"),
+      forward_instanced_shaders(resources, "assets/shaders/main_vertex_instanced.glsl", "assets/shaders/main_fragment.glsl"),
+      // 分簇光照版本 (点光源和聚光灯来自纹理缓冲里的光源列表，变体只区分定向光、阴影和贴图)
+      clustered_shaders(resources, "assets/shaders/main_vertex.glsl", "assets/shaders/main_fragment_clustered.glsl",
+                        ShaderFeatures::DIR_LIGHT | ShaderFeatures::SHADOWS | ShaderFeatures::MATERIAL),
+      clustered_instanced_shaders(resources, "assets/shaders/main_vertex_instanced.glsl", "assets/shaders/main_fragment_clustered.glsl",
+                                  ShaderFeatures::DIR_LIGHT | ShaderFeatures::SHADOWS | ShaderFeatures::MATERIAL),
+      // 光源 Shader (纯色，用于显示灯泡位置；颜色来自实例属性)
+      lamp_shader(resources.load_shader("assets/shaders/LightVS_instanced.glsl", "assets/shaders/LightFS_instanced.glsl")),
+      // 阴影贴图的深度渲染 (只写深度) 和它的合批版本
+      shadow_shader(resources.load_shader("assets/shaders/shadow_depth_vertex.glsl", "assets/shaders/shadow_depth_fragment.glsl")),
+      shadow_instanced_shader(resources.load_shader("assets/shaders/shadow_depth_vertex_instanced.glsl", "assets/shaders/shadow_depth_fragment.glsl")),
+      // 延迟渲染：几何阶段 (顶点着色器与前向渲染相同，只写 G-buffer) 和全屏的光照阶段 (固定光源 / 分簇两个版本)
+      gbuffer_shader(resources.load_shader("assets/shaders/main_vertex.glsl", "assets/shaders/gbuffer_fragment.glsl")),
+      gbuffer_instanced_shader(resources.load_shader("assets/shaders/main_vertex_instanced.glsl", "assets/shaders/gbuffer_fragment.glsl")),
+      deferred_shader(resources.load_shader("assets/shaders/deferred_vertex.glsl", "assets/shaders/deferred_fragment.glsl")),
+      deferred_clustered_shader(resources.load_shader("assets/shaders/deferred_vertex.glsl", "assets/shaders/deferred_fragment_clustered.glsl")),
+      // Shader 链接时已经按名字把 Block 绑定到了相同的绑定点，这里只需要每帧整块上传
+      camera_ubo(sizeof(CameraBlock), CAMERA_BLOCK_BINDING),
+      lights_ubo(sizeof(LightsBlock), LIGHTS_BLOCK_BINDING),
+      material_ubo(sizeof(MaterialBlock), MATERIAL_BLOCK_BINDING),
+      // 纹理先拿到占位图的 ID，解码完成后内容自动替换
+      diffuse_map(resources.load_texture("assets/textures/container2.png")),
+      specular_map(resources.load_texture("assets/textures/container2_specular.png")),
+      // 手写的立方体没有索引；灯泡复用顶点数据，但不需要纹理
+      cube_mesh(Primitives::get_cube_vertices(), {}, make_box_textures(diffuse_map, specular_map)),
+      light_mesh(Primitives::get_cube_vertices(), {}, {}),
+      // 压缩顶点格式：量化位置 + 八面体法线 + half UV + 16 位索引，每个顶点 16 字节 (标准格式 32 字节)
+      backpack_model(resources.load_model("assets/models/teapot.fbx", VertexFormat::compact())),
+      // 相同网格的多个物体合并成一次实例化绘制
+      box_instances(cube_mesh),
+      light_instances(light_mesh),
+      box_occluder(OccluderMesh::from_mesh(cube_mesh))
+{
+    ClusteredLighting::setup_shader(clustered_shaders.get_generic());
+    ClusteredLighting::setup_shader(clustered_instanced_shaders.get_generic());
+    ClusteredLighting::setup_shader(*deferred_clustered_shader);
+    for(Shader* shader : { &forward_shaders.get_generic(), &forward_instanced_shaders.get_generic(), &clustered_shaders.get_generic(),
+                           &clustered_instanced_shaders.get_generic(), deferred_shader.get(), deferred_clustered_shader.get() })
+        ShadowCascades::setup_shader(*shader);
+    DeferredShading::setup_shader(*deferred_shader);
+    DeferredShading::setup_shader(*deferred_clustered_shader);
+
+    // 几何池中的网格可以合批成 MDI：合批时模型矩阵来自实例属性，所以使用实例化版本的 Shader
+    render_queue.set_batch_shader(forward_shaders.get_generic(), forward_instanced_shaders.get_generic());
+    render_queue.set_batch_shader(clustered_shaders.get_generic(), clustered_instanced_shaders.get_generic());
+    render_queue.set_batch_shader(*gbuffer_shader, *gbuffer_instanced_shader);
+
+    // 新编译的变体同样设置采样器，并和同一组特性的实例化变体配成合批对
+    forward_instanced_shaders.set_on_create([](Shader& shader, uint32_t) { ShadowCascades::setup_shader(shader); });
+    forward_shaders.set_on_create([this](Shader& shader, uint32_t features) {
+        ShadowCascades::setup_shader(shader);
+        render_queue.set_batch_shader(shader, forward_instanced_shaders.get(features));
+    });
+    clustered_instanced_shaders.set_on_create([](Shader& shader, uint32_t) {
+        ClusteredLighting::setup_shader(shader);
+        ShadowCascades::setup_shader(shader);
+    });
+    clustered_shaders.set_on_create([this](Shader& shader, uint32_t features) {
+        ClusteredLighting::setup_shader(shader);
+        ShadowCascades::setup_shader(shader);
+        render_queue.set_batch_shader(shader, clustered_instanced_shaders.get(features));
+    });
+    material_variants = 1u << (ShaderFeatures::for_material(cube_mesh) >> ShaderFeatures::MATERIAL_SHIFT);
+
+    clustered_lighting.set_stream_buffer(&frame_stream);
+    shadow_queue.set_batch_shader(*shadow_shader, *shadow_instanced_shader);
+    shadows.set_stream_buffer(&frame_stream);
+
+    // -> 10 个木箱子，设置不同的旋转角度，让场景看起来自然些
+    glm::vec3 cube_positions[] = {
+        glm::vec3( 0.0f,  0.0f,  0.0f), glm::vec3( 2.0f,  5.0f, -15.0f),
+        glm::vec3(-1.5f, -2.2f, -2.5f), glm::vec3(-3.8f, -2.0f, -12.3f),
+        glm::vec3( 2.4f, -0.4f, -3.5f), glm::vec3(-1.7f,  3.0f, -7.5f),
+        glm::vec3( 1.3f, -2.0f, -2.5f), glm::vec3( 1.5f,  2.0f, -2.5f),
+        glm::vec3( 1.5f,  0.2f, -1.5f), glm::vec3(-1.3f,  1.0f, -1.5f)
+    };
+    model_node = scene_transforms.create();
+    for(int i = 0; i < 10; i++) {
+        Transform box;
+        box.position = cube_positions[i];
+        box.set_euler_degrees(glm::vec3(20.0f * i, 15.0f * i, 5.0f * i));
+        entities.create(SceneNode{ scene_transforms.create(box) },
+                        CullProxy{ next_object_id++, cube_mesh.bounds },
+                        InstanceDraw{ &box_instances, glm::vec4(1.0f) },
+                        ShadowCaster{ &cube_mesh, true },
+                        Occluder{ &box_occluder });
+    }
+
+    // -> 4 个点光源 (可视化灯泡)
+    glm::vec3 point_light_positions[] = {
+        glm::vec3( 0.7f,  0.2f,  2.0f), glm::vec3( 2.3f, -3.3f, -4.0f),
+        glm::vec3(-4.0f,  2.0f, -12.0f), glm::vec3( 0.0f,  0.0f, -3.0f)
+    };
+    light_rig_node = scene_transforms.create();
+    for(int i = 0; i < 4; i++) {
+        Transform light;
+        light.position = point_light_positions[i];
+        light.scale = glm::vec3(0.2f); // 灯泡缩小一点
+        entities.create(SceneNode{ scene_transforms.create(light, light_rig_node) },
+                        CullProxy{ next_object_id++, light_mesh.bounds },
+                        InstanceDraw{ &light_instances, glm::vec4(1.0f) },
+                        PointLamp{});
+    }
+    scene_transforms.update();
+
+    // -> 额外散布在场景里的彩色点光源 (演示分簇光照)，固定种子保证每次运行一致
+    // 衰减取得比较陡，让每个光源只影响附近几个簇
+    extra_lights.resize(MAX_EXTRA_LIGHTS);
+    std::mt19937 light_rng(1337);
+    std::uniform_real_distribution<float> unit_dist(0.0f, 1.0f);
+    for(LightSource& light : extra_lights) {
+        light.position = glm::vec3(-8.0f + 16.0f * unit_dist(light_rng),
+                                   -4.0f +  9.0f * unit_dist(light_rng),
+                                   -18.0f + 21.0f * unit_dist(light_rng));
+        // 随机色相，饱和度拉满
+        float hue = unit_dist(light_rng) * 6.0f;
+        light.color = glm::clamp(glm::vec3(std::abs(hue - 3.0f) - 1.0f,
+                                           2.0f - std::abs(hue - 2.0f),
+                                           2.0f - std::abs(hue - 4.0f)), 0.0f, 1.0f);
+        light.linear = 0.7f;
+        light.quadratic = 1.8f;
+    }
+
+    // -> BVH
+    object_bounds.resize(next_object_id);
+    bounds_changed.resize(next_object_id, 0);
+    // 模型还没加载完：先用它的位置处的一个空盒子占位，加载完成后再更新
+    object_bounds[model_object_id] = AABB();
+    object_bounds[model_object_id].expand(scene_transforms.get_world_position(model_node));
+    entities.for_each<SceneNode, CullProxy>([&](Entity, const SceneNode& node, const CullProxy& proxy) {
+        object_bounds[proxy.object_id] = proxy.local_bounds.transformed(scene_transforms.get_world_matrix(node.node));
+    });
+
+    // -> 阴影投影物 (模型是静态的；灯泡自己发光，不投阴影)
+    object_casters.resize(object_bounds.size(), 0);
+    object_cascades.resize(object_bounds.size(), 0);
+    object_casters[model_object_id] = CASTER_STATIC;
+    entities.for_each<CullProxy, ShadowCaster>([&](Entity, const CullProxy& proxy, const ShadowCaster& caster) {
+        object_casters[proxy.object_id] = caster.is_static ? CASTER_STATIC : CASTER_DYNAMIC;
+        if (caster.is_static)
+            static_caster_bounds.expand(object_bounds[proxy.object_id]);
+    });
+
+    scene_bvh.build(object_bounds);
+    object_visible.resize(object_bounds.size());
+
+    // -> 每帧的任务图
+    JobGraph::Node cull = frame_graph.add([this]() { sync_and_cull(); });
+    JobGraph::Node occlusion_node = frame_graph.add([this]() { occlusion_cull(); });
+    JobGraph::Node commands = frame_graph.add([this]() { build_commands(); });
+    JobGraph::Node shadow_casters = frame_graph.add([this]() { cull_shadow_casters(); });
+    frame_graph.add([this]() { bin_lights(); });
+    frame_graph.depend(occlusion_node, cull);
+    frame_graph.depend(commands, occlusion_node);
+    frame_graph.depend(shadow_casters, cull);
+}
+
+void DemoScene::render(const Camera& camera, float width, float height)
+{
+    // 清除颜色缓冲和深度缓冲
+    glClearColor(clear_color.r, clear_color.g, clear_color.b, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    frame_camera = &camera;
+    frame_width = width;
+    frame_height = height;
+    frame_view = camera.get_view_matrix();
+    frame_projection = camera.get_projection_matrix(width, height);
+
+    // 层级变换：只重算修改过的子树 (灯泡位置、剔除和实例矩阵都读这里的结果)
+    {
+        PROFILE_CPU_SCOPE("Transforms");
+        scene_transforms.update();
+    }
+
+    // 每个 Block 每帧只上传一次，所有使用它的 Shader 共享
+    camera_block.view = frame_view;
+    camera_block.projection = frame_projection;
+    camera_block.view_pos = glm::vec4(camera.position, 1.0f);
+    fill_blocks(camera);
+    prepare_shader_variants();
+    camera_ubo.stream(frame_stream, camera_block);
+    lights_ubo.stream(frame_stream, lights_block);
+    material_ubo.stream(frame_stream, material_block);
+
+    render_queue.clear();
+    render_queue.set_depth_range(camera.near_plane, camera.far_plane);
+
+    // -> CPU 阶段并行执行 (主线程也参与)
+    {
+        PROFILE_CPU_SCOPE("Frame Jobs");
+        frame_graph.run();
+    }
+
+    // -> GL 阶段
+    // 阴影贴图画在自己的帧缓冲里，画完恢复当前的帧缓冲和视口
+    shadows.render([this](int cascade, bool is_static) { return draw_shadow_casters(cascade, is_static); });
+    shadows.bind();
+    if (cluster_params.enable) {
+        clustered_lighting.upload();
+        clustered_lighting.bind();
+    }
+    submit_instances();
+
+    if (shading == shading_path::DEFERRED) {
+        // 几何阶段：不透明物体只写 G-buffer
+        {
+            PROFILE_SCOPE("G-Buffer");
+            deferred.begin_geometry(static_cast<int>(width), static_cast<int>(height));
+            render_queue.execute(render_pass::SOLID, render_pass::SOLID);
+            deferred.end_geometry();
+        }
+        // 光照阶段：每个像素计算一次光照，同时写回深度
+        deferred.draw_lighting(cluster_params.enable ? *deferred_clustered_shader : *deferred_shader, frame_projection * frame_view);
+        // 半透明物体和叠加层仍然前向绘制，和 G-buffer 的深度做测试
+        render_queue.execute(render_pass::TRANSLUCENT, render_pass::OVERLAY);
+        return;
+    }
+
+    // 排序并执行本帧所有绘制
+    deferred.mark_inactive();
+    render_queue.execute();
+}
+
+void DemoScene::fill_blocks(const Camera& camera)
+{
+    glm::vec4 bg_vec = glm::vec4(clear_color, 0.0f);
+    glm::vec4 zero(0.0f);
+
+    // -> 定向光
+    lights_block.dir_light.direction = glm::vec4(dir_params.direction, 0.0f);
+    lights_block.dir_light.ambient   = dir_params.enable ? bg_vec : zero;
+    lights_block.dir_light.diffuse   = dir_params.enable ? glm::vec4(dir_params.color, 0.0f) : zero;
+    lights_block.dir_light.specular  = dir_params.enable ? glm::vec4(dir_params.color, 0.0f) : zero;
+
+    // -> 点光源 (循环设置 4 个)
+    glm::vec4 pt_col = glm::vec4(point_params.color, 0.0f);
+    glm::vec4 pt_attenuation = glm::vec4(point_params.constant, point_params.linear, point_params.quadratic, 0.0f);
+    int lamp_count = 0;
+    entities.for_each<SceneNode, PointLamp>([&](Entity, const SceneNode& node, const PointLamp&) {
+        if (lamp_count >= MAX_POINT_LIGHTS)
+            return;
+        PointLightStd140& light = lights_block.point_lights[lamp_count++];
+        light.position    = glm::vec4(scene_transforms.get_world_position(node.node), 1.0f);
+        light.ambient     = point_params.enable ? bg_vec : zero;
+        light.diffuse     = point_params.enable ? pt_col : zero;
+        light.specular    = point_params.enable ? pt_col : zero;
+        light.attenuation = pt_attenuation;
+    });
+    // 灯泡不足 MAX_POINT_LIGHTS 个时，剩下的槽位不发光
+    for(int i = lamp_count; i < MAX_POINT_LIGHTS; i++) {
+        lights_block.point_lights[i].ambient  = zero;
+        lights_block.point_lights[i].diffuse  = zero;
+        lights_block.point_lights[i].specular = zero;
+    }
+
+    // -> 聚光灯 (跟随摄像机)
+    glm::vec4 spot_col = glm::vec4(spot_params.color, 0.0f);
+    SpotLightStd140& spot = lights_block.spot_light;
+    spot.position    = glm::vec4(camera.position, 1.0f);
+    spot.direction   = glm::vec4(camera.front, 0.0f);
+    spot.ambient     = bg_vec;
+    spot.diffuse     = spot_col;
+    spot.specular    = spot_col;
+    spot.attenuation = glm::vec4(spot_params.constant, spot_params.linear, spot_params.quadratic, 0.0f);
+    spot.cone        = glm::vec4(glm::cos(glm::radians(spot_params.cut_off)),
+                                 glm::cos(glm::radians(spot_params.outer_cut_off)),
+                                 spot_params.enable ? 1.0f : 0.0f, 0.0f);
+
+    // 材质属性 (纹理由绘制队列按 Mesh 的约定绑定)
+    material_block.params = glm::vec4(32.0f, 0.0f, 0.0f, 0.0f);
+
+    // -> 着色器变体的光源特性：关闭的光源和没有灯泡的点光源槽位在编译时就去掉
+    frame_features = ShaderFeatures::point_lights(point_params.enable ? lamp_count : 0);
+    if (dir_params.enable)
+        frame_features |= ShaderFeatures::DIR_LIGHT;
+    if (dir_params.enable && shadow_params.enable)
+        frame_features |= ShaderFeatures::SHADOWS;
+    if (spot_params.enable)
+        frame_features |= ShaderFeatures::SPOT_LIGHT;
+}
+
+void DemoScene::prepare_shader_variants()
+{
+    if (shading == shading_path::DEFERRED)
+        return;
+
+    // 模型加载完成后补上它的贴图组合
+    if (backpack_model->is_ready())
+        material_variants |= backpack_model->model->getMaterialVariants();
+
+    // 每种用到的贴图组合一个变体 (实例化版本在创建回调里一起编译)
+    // 光源状态不变时全部命中，切换开关时才编译新的组合 (有程序二进制缓存时下次启动不再编译)
+    ShaderPermutations& permutations = cluster_params.enable ? clustered_shaders : forward_shaders;
+    for(uint32_t material = 0; material <= (ShaderFeatures::MATERIAL >> ShaderFeatures::MATERIAL_SHIFT); material++) {
+        if (material_variants & (1u << material))
+            permutations.get(frame_features | (material << ShaderFeatures::MATERIAL_SHIFT));
+    }
+}
+
+void DemoScene::bin_lights()
+{
+    if (!cluster_params.enable)
+        return;
+    const Camera& camera = *frame_camera;
+
+    // 收集所有点光源和聚光灯，分簇 (上传在任务图之后的 GL 阶段)
+    scene_lights.clear();
+    if (point_params.enable) {
+        entities.for_each<SceneNode, PointLamp>([&](Entity, const SceneNode& node, const PointLamp&) {
+            LightSource light;
+            light.position  = scene_transforms.get_world_position(node.node);
+            light.color     = point_params.color;
+            light.constant  = point_params.constant;
+            light.linear    = point_params.linear;
+            light.quadratic = point_params.quadratic;
+            scene_lights.push_back(light);
+        });
+    }
+    if (spot_params.enable) {
+        LightSource light;
+        light.position  = camera.position;
+        light.color     = spot_params.color;
+        light.constant  = spot_params.constant;
+        light.linear    = spot_params.linear;
+        light.quadratic = spot_params.quadratic;
+        light.is_spot   = true;
+        light.direction = camera.front;
+        light.cos_inner = glm::cos(glm::radians(spot_params.cut_off));
+        light.cos_outer = glm::cos(glm::radians(spot_params.outer_cut_off));
+        scene_lights.push_back(light);
+    }
+    int extra_count = std::clamp(cluster_params.extra_point_lights, 0, MAX_EXTRA_LIGHTS);
+    scene_lights.insert(scene_lights.end(), extra_lights.begin(), extra_lights.begin() + extra_count);
+
+    clustered_lighting.bin(scene_lights, frame_view, frame_projection, camera.near_plane, camera.far_plane,
+                           frame_width, frame_height, clear_color);
+}
+
+void DemoScene::sync_and_cull()
+{
+    PROFILE_CPU_SCOPE("Scene Sync & Culling");
+
+    // -> 同步 BVH：世界矩阵在本帧变化过的物体才更新包围盒 (refit)，树质量变差太多时才重建
+    // 包围盒按块并行计算 (每个物体只写自己的槽位)，BVH 的修改在之后串行进行
+    // 块内变化过的物体每攒满一批就交给批量内核一起变换
+    entities.parallel_for_each_chunk<SceneNode, CullProxy>([this](uint32_t count, const Entity*, const SceneNode* nodes, const CullProxy* proxies) {
+        constexpr uint32_t BATCH = 64;
+        AABB local_bounds[BATCH], world_bounds[BATCH];
+        glm::mat4 matrices[BATCH];
+        uint32_t ids[BATCH];
+        uint32_t batched = 0;
+
+        auto flush = [&]() {
+            transform_aabb_batch(local_bounds, matrices, batched, world_bounds);
+            for(uint32_t j = 0; j < batched; j++) {
+                object_bounds[ids[j]] = world_bounds[j];
+                bounds_changed[ids[j]] = 1;
+            }
+            batched = 0;
+        };
+
+        for(uint32_t i = 0; i < count; i++) {
+            if (!scene_transforms.is_changed(nodes[i].node))
+                continue;
+            local_bounds[batched] = proxies[i].local_bounds;
+            matrices[batched] = scene_transforms.get_world_matrix(nodes[i].node);
+            ids[batched] = proxies[i].object_id;
+            if (++batched == BATCH)
+                flush();
+        }
+        if (batched > 0)
+            flush();
+    });
+    bool static_changed = false;
+    for(uint32_t id = 0; id < bounds_changed.size(); id++) {
+        if (bounds_changed[id]) {
+            scene_bvh.update_object(id, object_bounds[id]);
+            static_changed = static_changed || object_casters[id] == CASTER_STATIC;
+            bounds_changed[id] = 0;
+        }
+    }
+    if (backpack_model->is_ready() && (!model_in_bvh || scene_transforms.is_changed(model_node))) {
+        object_bounds[model_object_id] = backpack_model->model->bounds.transformed(scene_transforms.get_world_matrix(model_node));
+        scene_bvh.update_object(model_object_id, object_bounds[model_object_id]);
+        model_in_bvh = true;
+        static_changed = true;
+    }
+    scene_bvh.rebuild_if_needed();
+
+    // 静态投影物变了：重新计算它们的总包围盒，阴影的静态层全部重画
+    if (static_changed) {
+        static_caster_bounds = AABB();
+        for(uint32_t id = 0; id < object_casters.size(); id++) {
+            if (object_casters[id] == CASTER_STATIC && (id != model_object_id || model_in_bvh))
+                static_caster_bounds.expand(object_bounds[id]);
+        }
+        shadows.invalidate_static();
+    }
+
+    // -> 视锥剔除：遍历 BVH，整棵子树在视锥外时一次跳过
+    visible_objects.clear();
+    scene_bvh.query_frustum(frame_camera->get_frustum(frame_width, frame_height), visible_objects);
+    std::fill(object_visible.begin(), object_visible.end(), 0);
+    for(uint32_t id : visible_objects)
+        object_visible[id] = 1;
+    culling_stats.tested = scene_bvh.get_object_count();
+    culling_stats.visible = static_cast<unsigned int>(visible_objects.size());
+}
+
+void DemoScene::occlusion_cull()
+{
+    // 关闭时也要清空上一帧的遮挡物和统计
+    occlusion.begin(frame_projection * frame_view);
+    if (!occlusion_params.enable)
+        return;
+
+    PROFILE_CPU_SCOPE("Occlusion Culling");
+
+    // -> 可见并且在屏幕上足够大的遮挡物画进深度缓冲 (条带并行光栅化)
+    const glm::vec3 eye = frame_camera->position;
+    entities.for_each<SceneNode, CullProxy, Occluder>([&](Entity, const SceneNode& node, const CullProxy& proxy, const Occluder& occluder) {
+        if (!object_visible[proxy.object_id])
+            return;
+        const AABB& bounds = object_bounds[proxy.object_id];
+        float radius = glm::length(bounds.extents());
+        float distance = glm::length(bounds.center() - eye);
+        if (distance > radius && radius < occlusion_params.min_occluder_size * distance)
+            return;
+        occlusion.add_occluder(*occluder.mesh, scene_transforms.get_world_matrix(node.node));
+    });
+    occlusion.rasterize();
+
+    // -> 视锥剔除留下的物体逐个和深度缓冲比较，被挡住的不再提交绘制
+    if (occlusion.cull(object_bounds.data(), visible_objects) > 0) {
+        std::fill(object_visible.begin(), object_visible.end(), 0);
+        for(uint32_t id : visible_objects)
+            object_visible[id] = 1;
+    }
+    culling_stats.visible = static_cast<unsigned int>(visible_objects.size());
+}
+
+void DemoScene::build_commands()
+{
+    const Camera& camera = *frame_camera;
+    const ShaderPermutations& scene_shaders = cluster_params.enable ? clustered_shaders : forward_shaders;
+
+    // -> 模型：按摄像机 FOV 和距离选 LOD，投影到屏幕上的几何误差不超过 1 像素
+    if (model_in_bvh && object_visible[model_object_id]) {
+        const glm::mat4& model = scene_transforms.get_world_matrix(model_node);
+        float model_depth = glm::length(glm::vec3(model[3]) - camera.position);
+        backpack_model->model->selectLods(model, LodView::fromCamera(camera, frame_height), backpack_lods);
+        if (shading == shading_path::DEFERRED)
+            backpack_model->model->Submit(render_queue, *gbuffer_shader, model, model_depth, &backpack_lods);
+        else
+            backpack_model->model->Submit(render_queue, scene_shaders, frame_features, model, model_depth, &backpack_lods);
+    }
+
+    // -> 灯泡：点光源开启时显示对应颜色，否则显示暗灰色 (颜色作为实例属性传入)
+    glm::vec4 lamp_color = glm::vec4(point_params.enable ? point_params.color : glm::vec3(0.1f), 1.0f);
+    entities.for_each<InstanceDraw, PointLamp>([&](Entity, InstanceDraw& draw, const PointLamp&) {
+        draw.color = lamp_color;
+    });
+
+    // -> 箱子和灯泡：收集可见实体的世界矩阵，每个批次一次 Draw Call 画完
+    box_instances.clear();
+    light_instances.clear();
+    entities.for_each_chunk<SceneNode, CullProxy, InstanceDraw>([&](uint32_t count, const Entity*, const SceneNode* nodes,
+                                                                    const CullProxy* proxies, const InstanceDraw* draws) {
+        for(uint32_t i = 0; i < count; i++) {
+            if (object_visible[proxies[i].object_id])
+                draws[i].batch->add_instance(scene_transforms.get_world_matrix(nodes[i].node), draws[i].color);
+        }
+    });
+}
+
+void DemoScene::cull_shadow_casters()
+{
+    PROFILE_CPU_SCOPE("Shadow Casters");
+
+    // 定向光关闭时没有阴影
+    ShadowParams params = shadow_params;
+    params.enable = shadow_params.enable && dir_params.enable;
+    shadows.fit(*frame_camera, frame_width, frame_height, dir_params.direction, static_caster_bounds, params);
+
+    // -> 每一级用自己的视锥查询 BVH，记下每个投影物要画进哪几级
+    // 静态层可以复用的级只需要动态投影物
+    std::fill(object_cascades.begin(), object_cascades.end(), 0);
+    for(int cascade = 0; cascade < shadows.get_cascade_count(); cascade++) {
+        shadow_candidates.clear();
+        scene_bvh.query_frustum(shadows.get_caster_frustum(cascade), shadow_candidates);
+
+        bool need_static = shadows.is_static_dirty(cascade);
+        unsigned int dynamic_count = 0;
+        for(uint32_t id : shadow_candidates) {
+            uint8_t caster = object_casters[id];
+            if (caster == 0 || (caster == CASTER_STATIC && !need_static))
+                continue;
+            object_cascades[id] |= static_cast<uint8_t>(1u << cascade);
+            if (caster == CASTER_DYNAMIC)
+                dynamic_count++;
+        }
+        shadows.set_dynamic_casters(cascade, dynamic_count);
+    }
+}
+
+unsigned int DemoScene::draw_shadow_casters(int cascade, bool is_static)
+{
+    // 光源矩阵是普通 Uniform (属于 Program 状态)，每一级设置一次
+    const glm::mat4& light_space = shadows.get_light_matrix(cascade);
+    shadow_shader->use();
+    shadow_shader->setMat4("lightSpace", light_space);
+    shadow_instanced_shader->use();
+    shadow_instanced_shader->setMat4("lightSpace", light_space);
+
+    uint8_t cascade_bit = static_cast<uint8_t>(1u << cascade);
+    unsigned int drawn = 0;
+    shadow_queue.clear();
+
+    // -> 模型 (静态，阴影里使用第 0 级 LOD，缓存之后不随摄像机距离变化)
+    if (is_static && model_in_bvh && (object_cascades[model_object_id] & cascade_bit)) {
+        backpack_model->model->Submit(shadow_queue, *shadow_shader, scene_transforms.get_world_matrix(model_node));
+        drawn++;
+    }
+
+    // -> 实体
+    entities.for_each_chunk<SceneNode, CullProxy, ShadowCaster>([&](uint32_t count, const Entity*, const SceneNode* nodes,
+                                                                    const CullProxy* proxies, const ShadowCaster* casters) {
+        for(uint32_t i = 0; i < count; i++) {
+            if (casters[i].is_static != is_static || !(object_cascades[proxies[i].object_id] & cascade_bit))
+                continue;
+            shadow_queue.submit(render_pass::SOLID, *shadow_shader, *casters[i].mesh, scene_transforms.get_world_matrix(nodes[i].node));
+            drawn++;
+        }
+    });
+
+    shadow_queue.execute();
+    return drawn;
+}
+
+void DemoScene::submit_instances()
+{
+    // 变体已经在 prepare_shader_variants 里编译好，这里只查表
+    const ShaderPermutations& instanced_shaders = cluster_params.enable ? clustered_instanced_shaders : forward_instanced_shaders;
+    Shader& scene_instanced_shader = shading == shading_path::DEFERRED ? *gbuffer_instanced_shader
+                                   : instanced_shaders.find(frame_features | ShaderFeatures::for_material(cube_mesh));
+
+    box_instances.upload(&frame_stream);
+    render_queue.submit(render_pass::SOLID, scene_instanced_shader, box_instances);
+
+    light_instances.upload(&frame_stream);
+    render_queue.submit(render_pass::OVERLAY, *lamp_shader, light_instances);
+}
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+
+#include "../renderer/camera.h"
+#include "../renderer/shader.h"
+#include "../renderer/shader_permutations.h"
+#include "../renderer/mesh.h"
+#include "../renderer/model.h"
+#include "../renderer/instanced_mesh.h"
+#include "../renderer/render_queue.h"
+#include "../renderer/frustum_culler.h"
+#include "../renderer/occlusion_culler.h"
+#include "../renderer/uniform_buffer.h"
+#include "../renderer/uniform_blocks.h"
+#include "../renderer/light_clusters.h"
+#include "../renderer/shadow_cascades.h"
+#include "../renderer/deferred_shading.h"
+#include "../renderer/resource_manager.h"
+#include "../renderer/stream_buffer.h"
+#include "../core/jobs.h"
+#include "transform_hierarchy.h"
+#include "entity_world.h"
+#include "scene_components.h"
+#include "light_params.h"
+#include "bvh.h"
+
+// DemoScene：示例场景 (模型 + 10 个箱子 + 4 个灯泡 + 可选的大量彩色点光源)
+//
+// 场景内容的创建和每帧的渲染 (填充 Uniform Block、分簇光照、BVH 同步与剔除、提交并执行绘制队列)
+// 都在这里，编辑器 (shadow-engine) 和基准测试 (shadow-bench) 共用同一份，
+// 这样基准测到的就是编辑器里实际画的东西。
+// 每帧的 CPU 阶段是一个任务图 (core/jobs.h)：
+//   场景同步与视锥剔除 -> 遮挡剔除 -> 构建绘制命令
+//                      -> 拟合阴影级联、挑选每一级的投影物
+//   光源分簇 (与上面几个并行)
+// 任务图执行完之后，GL 线程先画阴影贴图，再上传实例数据/光源数据并执行绘制队列。
+// 延迟渲染时绘制队列分两次执行：不透明物体写进 G-buffer，屏幕空间光照之后再前向绘制其余阶段。
+// 箱子和灯泡是 EntityWorld 里的实体 (SceneNode + CullProxy + InstanceDraw，灯泡另有 PointLamp)，
+// 各阶段按块遍历组件数组，不再针对每类物体单独写循环。
+// 光照参数是公开成员，编辑器的 UI 直接修改它们。
+class DemoScene
+{
+public:
+    static const int MAX_EXTRA_LIGHTS = 2048;
+
+    // 需要 GL 上下文；资源通过 resources 加载 (模型在后台导入，完成之前不参与绘制)
+    DemoScene(ResourceManager& resources, StreamBuffer& frame_stream);
+
+    DemoScene(const DemoScene&) = delete;
+    DemoScene& operator=(const DemoScene&) = delete;
+
+    // 渲染一帧到当前绑定的帧缓冲 (包括清屏)，width/height 是视口大小
+    void render(const Camera& camera, float width, float height);
+
+    // --- 光照参数 (UI 修改) ---
+    glm::vec3 clear_color = glm::vec3(0.05f, 0.05f, 0.05f); // 背景色 (也是环境光的基础颜色)
+    DirLightParams dir_params;
+    PointLightParams point_params;
+    SpotLightParams spot_params;
+    ClusteredLightingParams cluster_params;
+    ShadowParams shadow_params;
+    OcclusionParams occlusion_params;
+    shading_path shading = shading_path::FORWARD;
+
+    // --- 统计 (上一次 render 的结果) ---
+    const RenderQueueStats& get_render_stats() const { return render_queue.get_stats(); }
+    const CullingStats& get_culling_stats() const { return culling_stats; }
+    const ClusterStats& get_cluster_stats() const { return clustered_lighting.get_stats(); }
+    const ShadowStats& get_shadow_stats() const { return shadows.get_stats(); }
+    const DeferredStats& get_deferred_stats() const { return deferred.get_stats(); }
+    const OcclusionStats& get_occlusion_stats() const { return occlusion.get_stats(); }
+
+private:
+    void fill_blocks(const Camera& camera);
+    // GL 线程：编译本帧光源状态下用得到的着色器变体 (已经编译过的直接跳过)
+    void prepare_shader_variants();
+
+    // 任务图的节点 (可能在工作线程上执行，不能调用 GL)
+    void bin_lights();
+    void sync_and_cull();
+    void occlusion_cull();
+    void build_commands();
+    void cull_shadow_casters();
+
+    // GL 线程：上传实例数据并提交实例化绘制
+    void submit_instances();
+    // GL 线程：把第 cascade 级的静态 / 动态投影物画进当前的阴影贴图层，返回画了多少个物体
+    unsigned int draw_shadow_casters(int cascade, bool is_static);
+
+    StreamBuffer& frame_stream;
+
+    // 每帧的任务图和它的输入 (render 开始时设置)
+    JobGraph frame_graph;
+    const Camera* frame_camera = nullptr;
+    float frame_width = 0.0f;
+    float frame_height = 0.0f;
+    glm::mat4 frame_view = glm::mat4(1.0f);
+    glm::mat4 frame_projection = glm::mat4(1.0f);
+
+    // 着色器 (与资源管理器共享)
+    // 前向渲染的主着色器按光源和贴图的特性编译成变体 (见 shader_permutations.h)，每个都有对应的实例化版本
+    ShaderPermutations forward_shaders;
+    ShaderPermutations forward_instanced_shaders;
+    ShaderPermutations clustered_shaders;
+    ShaderPermutations clustered_instanced_shaders;
+    uint32_t frame_features = 0;     // 本帧的光源特性 (fill_blocks 里确定，和网格无关的部分)
+    uint32_t material_variants = 0;  // 场景里用到的贴图组合 (见 Model::getMaterialVariants)
+    std::shared_ptr<Shader> lamp_shader;
+    std::shared_ptr<Shader> shadow_shader;
+    std::shared_ptr<Shader> shadow_instanced_shader;
+    std::shared_ptr<Shader> gbuffer_shader;
+    std::shared_ptr<Shader> gbuffer_instanced_shader;
+    std::shared_ptr<Shader> deferred_shader;
+    std::shared_ptr<Shader> deferred_clustered_shader;
+
+    // Uniform Buffer (摄像机 / 光照 / 材质)
+    UniformBuffer camera_ubo;
+    UniformBuffer lights_ubo;
+    UniformBuffer material_ubo;
+    CameraBlock camera_block;
+    LightsBlock lights_block;
+    MaterialBlock material_block;
+
+    // 网格与模型
+    TextureHandle diffuse_map;
+    TextureHandle specular_map;
+    Mesh cube_mesh;
+    Mesh light_mesh;
+    ModelHandle backpack_model;
+    LodState backpack_lods;           // 模型每个子网格当前的 LOD 级别 (跨帧保留，用于滞后切换)
+    InstancedMesh box_instances;
+    InstancedMesh light_instances;
+
+    RenderQueue render_queue;
+    ClusteredLighting clustered_lighting;
+    std::vector<LightSource> scene_lights;
+    std::vector<LightSource> extra_lights;
+
+    // 定向光的级联阴影：每一级的投影物单独排序绘制
+    ShadowCascades shadows;
+    RenderQueue shadow_queue;
+
+    // 延迟渲染的 G-buffer (只在选择延迟渲染时才创建)
+    DeferredShading deferred;
+
+    // 场景物体：所有变换放在同一个层级里 (4 个灯泡挂在一个灯架节点下)，每帧只重算修改过的子树
+    TransformHierarchy scene_transforms;
+    TransformHierarchy::Node model_node = TransformHierarchy::INVALID;
+    TransformHierarchy::Node light_rig_node = TransformHierarchy::INVALID;
+    EntityWorld entities;
+
+    // 场景里的物体统一编号后放进 BVH：[0] 模型，之后按创建顺序是各实体的 CullProxy
+    uint32_t model_object_id = 0;
+    uint32_t next_object_id = 1;
+    std::vector<AABB> object_bounds;
+    std::vector<uint8_t> bounds_changed; // 本帧世界包围盒变化了、需要 refit 的物体
+    std::vector<uint8_t> object_casters; // 物体是否投下阴影 (见 demo_scene.cpp 的 CASTER_*)
+    std::vector<uint8_t> object_cascades;// 本帧要画进哪几级阴影 (bit c = 第 c 级)
+    std::vector<uint32_t> shadow_candidates;
+    AABB static_caster_bounds;           // 所有静态投影物的包围盒 (决定阴影的深度范围)
+    bool model_in_bvh = false;
+
+    BVH scene_bvh;
+    std::vector<uint32_t> visible_objects;
+    std::vector<uint8_t> object_visible;
+    CullingStats culling_stats;
+
+    // 软件遮挡剔除：箱子作为遮挡物 (立方体本身就是它的遮挡几何)
+    OcclusionCuller occlusion;
+    OccluderMesh box_occluder;
+};
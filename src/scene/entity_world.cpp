@@ -0,0 +1,238 @@
+#include "entity_world.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+
+namespace {
+    // 块内每一段按 16 字节对齐 (glm 类型、SIMD 读取都够用)
+    const std::size_t COLUMN_ALIGNMENT = 16;
+
+    std::size_t align_up(std::size_t value)
+    {
+        return (value + COLUMN_ALIGNMENT - 1) & ~(COLUMN_ALIGNMENT - 1);
+    }
+
+    std::mutex registry_mutex;
+    std::vector<std::size_t> component_sizes;
+}
+
+ComponentId ComponentRegistry::register_component(std::size_t size)
+{
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    if (component_sizes.size() >= MAX_COMPONENTS) {
+        std::cout << "ERROR::ENTITY_WORLD::TOO_MANY_COMPONENT_TYPES: " << MAX_COMPONENTS << std::endl;
+        std::abort();
+    }
+    component_sizes.push_back(size);
+    return static_cast<ComponentId>(component_sizes.size() - 1);
+}
+
+std::size_t ComponentRegistry::get_size(ComponentId component)
+{
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    return component_sizes[component];
+}
+
+EntityWorld::EntityWorld() = default;
+EntityWorld::~EntityWorld() = default;
+
+// ------------------------------------------------------------------------
+// 实体
+// ------------------------------------------------------------------------
+Entity EntityWorld::create_entity(ComponentMask mask)
+{
+    Entity entity;
+    if (!free_indices.empty()) {
+        entity.index = free_indices.back();
+        free_indices.pop_back();
+    } else {
+        entity.index = static_cast<uint32_t>(records.size());
+        records.emplace_back();
+    }
+    entity.generation = records[entity.index].generation;
+
+    uint32_t archetype = find_archetype(mask);
+    records[entity.index].archetype = archetype;
+    records[entity.index].row = allocate_row(*archetypes[archetype], entity);
+    alive_count++;
+    return entity;
+}
+
+void EntityWorld::destroy(Entity entity)
+{
+    if (!is_alive(entity))
+        return;
+
+    EntityRecord& record = records[entity.index];
+    free_row(*archetypes[record.archetype], record.row);
+    record.archetype = UINT32_MAX;
+    record.generation++;
+    free_indices.push_back(entity.index);
+    alive_count--;
+}
+
+bool EntityWorld::is_alive(Entity entity) const
+{
+    return entity.index < records.size() && records[entity.index].generation == entity.generation &&
+           records[entity.index].archetype != UINT32_MAX;
+}
+
+// 把实体搬到组件组合为 mask 的原型：两边都有的组件按值复制，新增的组件内容未定义 (由调用方写入)
+void EntityWorld::move_entity(Entity entity, ComponentMask mask)
+{
+    if (!is_alive(entity))
+        return;
+
+    EntityRecord& record = records[entity.index];
+    uint32_t target_index = find_archetype(mask);
+    Archetype& source = *archetypes[record.archetype];
+    Archetype& target = *archetypes[target_index];
+
+    uint32_t row = allocate_row(target, entity);
+    Chunk& from = *source.chunks[record.row / source.capacity];
+    Chunk& to = *target.chunks[row / target.capacity];
+    uint32_t from_row = record.row % source.capacity;
+    uint32_t to_row = row % target.capacity;
+    for (ComponentId id : target.components) {
+        if (source.offsets[id] == UINT32_MAX)
+            continue;
+        std::size_t size = target.sizes[id];
+        std::memcpy(to.data + target.offsets[id] + to_row * size, from.data + source.offsets[id] + from_row * size, size);
+    }
+
+    free_row(source, record.row);
+    record.archetype = target_index;
+    record.row = row;
+}
+
+void EntityWorld::write(Entity entity, ComponentId id, const void* data)
+{
+    void* destination = get_component(entity, id);
+    if (destination)
+        std::memcpy(destination, data, archetypes[records[entity.index].archetype]->sizes[id]);
+}
+
+ComponentMask EntityWorld::get_mask(Entity entity) const
+{
+    return is_alive(entity) ? archetypes[records[entity.index].archetype]->mask : 0;
+}
+
+bool EntityWorld::has_component(Entity entity, ComponentId id) const
+{
+    return (get_mask(entity) & bit(id)) != 0;
+}
+
+void* EntityWorld::get_component(Entity entity, ComponentId id) const
+{
+    if (!has_component(entity, id))
+        return nullptr;
+
+    const EntityRecord& record = records[entity.index];
+    Archetype& archetype = *archetypes[record.archetype];
+    Chunk& chunk = *archetype.chunks[record.row / archetype.capacity];
+    return chunk.data + archetype.offsets[id] + (record.row % archetype.capacity) * archetype.sizes[id];
+}
+
+// ------------------------------------------------------------------------
+// 原型与块
+// ------------------------------------------------------------------------
+uint32_t EntityWorld::find_archetype(ComponentMask mask)
+{
+    for (uint32_t i = 0; i < archetypes.size(); i++) {
+        if (archetypes[i]->mask == mask)
+            return i;
+    }
+
+    // -> 新原型：按组件大小算出每块能放多少行，再依次排布各段
+    auto archetype = std::make_unique<Archetype>();
+    archetype->mask = mask;
+    std::fill(std::begin(archetype->offsets), std::end(archetype->offsets), UINT32_MAX);
+    std::fill(std::begin(archetype->sizes), std::end(archetype->sizes), 0u);
+
+    std::size_t row_size = sizeof(Entity);
+    for (ComponentId id = 0; id < ComponentRegistry::MAX_COMPONENTS; id++) {
+        if (mask & bit(id)) {
+            archetype->components.push_back(id);
+            archetype->sizes[id] = static_cast<uint32_t>(ComponentRegistry::get_size(id));
+            row_size += archetype->sizes[id];
+        }
+    }
+
+    // 每一段的对齐最多浪费 COLUMN_ALIGNMENT 字节
+    // 一行加上对齐都放不进一个块时不能建这个原型 (强行放 1 行会写出块的末尾)
+    std::size_t padding = (archetype->components.size() + 1) * COLUMN_ALIGNMENT;
+    std::size_t capacity = (CHUNK_SIZE - padding) / row_size;
+    if (capacity == 0) {
+        std::cout << "ERROR::ENTITY_WORLD::ROW_TOO_LARGE: " << row_size << " bytes per entity, chunk is " << CHUNK_SIZE << " bytes" << std::endl;
+        std::abort();
+    }
+    archetype->capacity = static_cast<uint32_t>(capacity);
+
+    std::size_t offset = align_up(sizeof(Entity) * archetype->capacity);
+    for (ComponentId id : archetype->components) {
+        archetype->offsets[id] = static_cast<uint32_t>(offset);
+        offset = align_up(offset + archetype->sizes[id] * archetype->capacity);
+    }
+
+    archetypes.push_back(std::move(archetype));
+    return static_cast<uint32_t>(archetypes.size() - 1);
+}
+
+uint32_t EntityWorld::allocate_row(Archetype& archetype, Entity entity)
+{
+    uint32_t row = archetype.count++;
+    if (row / archetype.capacity >= archetype.chunks.size())
+        archetype.chunks.push_back(std::make_unique<Chunk>());
+
+    Chunk& chunk = *archetype.chunks[row / archetype.capacity];
+    entity_column(archetype, chunk)[row % archetype.capacity] = entity;
+    chunk.count++;
+    return row;
+}
+
+// 用原型的最后一行填补 row，保持所有块紧密排列
+void EntityWorld::free_row(Archetype& archetype, uint32_t row)
+{
+    uint32_t last = --archetype.count;
+    Chunk& last_chunk = *archetype.chunks[last / archetype.capacity];
+    uint32_t last_in_chunk = last % archetype.capacity;
+
+    if (row != last) {
+        Chunk& chunk = *archetype.chunks[row / archetype.capacity];
+        uint32_t row_in_chunk = row % archetype.capacity;
+        for (ComponentId id : archetype.components) {
+            std::size_t size = archetype.sizes[id];
+            std::memcpy(chunk.data + archetype.offsets[id] + row_in_chunk * size,
+                        last_chunk.data + archetype.offsets[id] + last_in_chunk * size, size);
+        }
+        Entity moved = entity_column(archetype, last_chunk)[last_in_chunk];
+        entity_column(archetype, chunk)[row_in_chunk] = moved;
+        records[moved.index].row = row;
+    }
+
+    last_chunk.count--;
+    if (last_chunk.count == 0)
+        archetype.chunks.pop_back();
+}
+
+void EntityWorld::collect_chunks(ComponentMask mask, std::vector<ChunkRef>& out) const
+{
+    for (const std::unique_ptr<Archetype>& archetype : archetypes) {
+        if ((archetype->mask & mask) != mask)
+            continue;
+        for (const std::unique_ptr<Chunk>& chunk : archetype->chunks)
+            out.push_back({ archetype.get(), chunk.get() });
+    }
+}
+
+EntityWorldStats EntityWorld::get_stats() const
+{
+    EntityWorldStats stats;
+    stats.entities = alive_count;
+    stats.archetypes = static_cast<unsigned int>(archetypes.size());
+    for (const std::unique_ptr<Archetype>& archetype : archetypes)
+        stats.chunks += static_cast<unsigned int>(archetype->chunks.size());
+    return stats;
+}
@@ -0,0 +1,216 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <vector>
+#include "../core/jobs.h"
+
+// 实体句柄：index 指向实体表，generation 在实体销毁后递增，旧句柄因此失效 (不会误指向复用了槽位的新实体)
+struct Entity {
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0;
+
+    bool is_valid() const { return index != UINT32_MAX; }
+    bool operator==(const Entity& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const Entity& other) const { return !(*this == other); }
+};
+
+using ComponentId = uint32_t;
+using ComponentMask = uint64_t;
+
+// 组件类型编号：每个类型第一次使用时分配 (线程安全)
+class ComponentRegistry
+{
+public:
+    static const ComponentId MAX_COMPONENTS = 64;
+
+    template<typename T>
+    static ComponentId id()
+    {
+        // 组件在块之间搬移时直接 memcpy，所以只能是平凡可复制的数据 (glm 类型、句柄、指针等)
+        static_assert(std::is_trivially_copyable_v<T>, "components must be trivially copyable");
+        static_assert(alignof(T) <= 16, "components must not need more than 16-byte alignment");
+        static const ComponentId component = register_component(sizeof(T));
+        return component;
+    }
+
+    static std::size_t get_size(ComponentId component);
+
+private:
+    static ComponentId register_component(std::size_t size);
+};
+
+// 实体统计
+struct EntityWorldStats {
+    unsigned int entities = 0;
+    unsigned int archetypes = 0;
+    unsigned int chunks = 0;
+};
+
+// EntityWorld：按原型 (archetype) 存放的实体/组件
+//
+// 组件组合完全相同的实体属于同一个原型，原型的数据切成固定大小 (16 KB) 的块 (chunk)，
+// 块内每种组件一段连续数组 (SoA)，外加一段实体句柄：
+//   [Entity x capacity][组件 A x capacity][组件 B x capacity]...
+// 系统按块遍历 "拥有某几种组件" 的所有原型，每次拿到的是几段紧密排列的数组，可以直接顺序扫描，
+// 也可以把块分给任务系统并行处理 (parallel_for_each_chunk)。
+//
+// 删除实体时用原型最后一行填补空位，所以除了最后一块之外的块总是满的；
+// 添加/删除组件会把实体搬到另一个原型 (组件按值复制)。
+// 组件指针只在下一次结构修改 (创建/删除实体、添加/删除组件) 之前有效，实体句柄一直有效。
+//
+// 结构修改只能在一个线程上进行；并行遍历期间只能读写已有的组件。
+class EntityWorld
+{
+public:
+    static const std::size_t CHUNK_SIZE = 16 * 1024;
+
+    EntityWorld();
+    ~EntityWorld();
+    EntityWorld(const EntityWorld&) = delete;
+    EntityWorld& operator=(const EntityWorld&) = delete;
+
+    // 创建实体，同时设置它的全部初始组件
+    template<typename... Ts>
+    Entity create(const Ts&... components)
+    {
+        ComponentMask mask = (ComponentMask(0) | ... | bit(ComponentRegistry::id<Ts>()));
+        Entity entity = create_entity(mask);
+        (write(entity, ComponentRegistry::id<Ts>(), &components), ...);
+        return entity;
+    }
+
+    // 销毁实体 (句柄失效)
+    void destroy(Entity entity);
+    bool is_alive(Entity entity) const;
+
+    // 添加组件 (已经有时直接覆盖)
+    template<typename T>
+    void add(Entity entity, const T& component)
+    {
+        ComponentId id = ComponentRegistry::id<T>();
+        if (!has_component(entity, id))
+            move_entity(entity, get_mask(entity) | bit(id));
+        write(entity, id, &component);
+    }
+
+    template<typename T>
+    void remove(Entity entity)
+    {
+        ComponentId id = ComponentRegistry::id<T>();
+        if (has_component(entity, id))
+            move_entity(entity, get_mask(entity) & ~bit(id));
+    }
+
+    template<typename T>
+    bool has(Entity entity) const { return has_component(entity, ComponentRegistry::id<T>()); }
+
+    // 实体没有这个组件 (或者实体已销毁) 时返回 nullptr
+    template<typename T>
+    T* get(Entity entity) { return static_cast<T*>(get_component(entity, ComponentRegistry::id<T>())); }
+    template<typename T>
+    const T* get(Entity entity) const { return static_cast<const T*>(get_component(entity, ComponentRegistry::id<T>())); }
+
+    // 遍历所有拥有 Ts 组件 (可以还有其他组件) 的块：function(count, entities, Ts* columns...)
+    template<typename... Ts, typename F>
+    void for_each_chunk(F&& function)
+    {
+        ComponentMask mask = (ComponentMask(0) | ... | bit(ComponentRegistry::id<Ts>()));
+        for (std::size_t a = 0; a < archetypes.size(); a++) {
+            Archetype& archetype = *archetypes[a];
+            if ((archetype.mask & mask) != mask)
+                continue;
+            for (uint32_t c = 0; c < archetype.chunks.size(); c++) {
+                Chunk& chunk = *archetype.chunks[c];
+                function(chunk.count, entity_column(archetype, chunk),
+                         static_cast<Ts*>(column(archetype, chunk, ComponentRegistry::id<Ts>()))...);
+            }
+        }
+    }
+
+    // 逐个实体遍历：function(entity, Ts&...)
+    template<typename... Ts, typename F>
+    void for_each(F&& function)
+    {
+        for_each_chunk<Ts...>([&](uint32_t count, const Entity* entities, Ts*... columns) {
+            for (uint32_t i = 0; i < count; i++)
+                function(entities[i], columns[i]...);
+        });
+    }
+
+    // 与 for_each_chunk 相同，但每个块是一个任务 (调用线程也参与)，全部完成后返回
+    // function 会在多个线程上同时执行，只能访问自己这个块里的数据
+    template<typename... Ts, typename F>
+    void parallel_for_each_chunk(F&& function)
+    {
+        ComponentMask mask = (ComponentMask(0) | ... | bit(ComponentRegistry::id<Ts>()));
+        std::vector<ChunkRef> refs;
+        collect_chunks(mask, refs);
+        JobSystem::parallel_for(static_cast<unsigned int>(refs.size()), 1, [&](unsigned int begin, unsigned int end) {
+            for (unsigned int i = begin; i < end; i++) {
+                Archetype& archetype = *refs[i].archetype;
+                Chunk& chunk = *refs[i].chunk;
+                function(chunk.count, entity_column(archetype, chunk),
+                         static_cast<Ts*>(column(archetype, chunk, ComponentRegistry::id<Ts>()))...);
+            }
+        });
+    }
+
+    unsigned int get_entity_count() const { return alive_count; }
+    EntityWorldStats get_stats() const;
+
+private:
+    struct Chunk {
+        alignas(64) uint8_t data[CHUNK_SIZE];
+        uint32_t count = 0;
+    };
+
+    struct Archetype {
+        ComponentMask mask = 0;
+        std::vector<ComponentId> components;
+        uint32_t offsets[ComponentRegistry::MAX_COMPONENTS]; // 组件 -> 块内的字节偏移 (没有的组件为 UINT32_MAX)
+        uint32_t sizes[ComponentRegistry::MAX_COMPONENTS];   // 组件 -> 大小 (避免访问组件时查全局注册表)
+        uint32_t capacity = 0;                               // 每块的行数
+        uint32_t count = 0;                                  // 总行数
+        std::vector<std::unique_ptr<Chunk>> chunks;
+    };
+
+    struct ChunkRef {
+        Archetype* archetype;
+        Chunk* chunk;
+    };
+
+    // 实体表：实体当前所在的原型和行
+    struct EntityRecord {
+        uint32_t archetype = UINT32_MAX;
+        uint32_t row = 0;         // 在原型内的行号 (chunk = row / capacity)
+        uint32_t generation = 0;
+    };
+
+    static ComponentMask bit(ComponentId id) { return ComponentMask(1) << id; }
+
+    Entity create_entity(ComponentMask mask);
+    void move_entity(Entity entity, ComponentMask mask);
+    void write(Entity entity, ComponentId id, const void* data);
+
+    ComponentMask get_mask(Entity entity) const;
+    bool has_component(Entity entity, ComponentId id) const;
+    void* get_component(Entity entity, ComponentId id) const;
+
+    uint32_t find_archetype(ComponentMask mask);
+    uint32_t allocate_row(Archetype& archetype, Entity entity);
+    void free_row(Archetype& archetype, uint32_t row);
+    void collect_chunks(ComponentMask mask, std::vector<ChunkRef>& out) const;
+
+    // 块的第一段是实体句柄
+    static Entity* entity_column(Archetype&, Chunk& chunk) { return reinterpret_cast<Entity*>(chunk.data); }
+    static void* column(Archetype& archetype, Chunk& chunk, ComponentId id) { return chunk.data + archetype.offsets[id]; }
+
+    std::vector<std::unique_ptr<Archetype>> archetypes;
+    std::vector<EntityRecord> records;
+    std::vector<uint32_t> free_indices;
+    unsigned int alive_count = 0;
+};
@@ -1,5 +1,6 @@
 ﻿#pragma once
 #include <glm/glm.hpp> // 需要 GLM 类型
+#include <cmath>
 
 // 定向光参数
 struct DirLightParams {
@@ -8,6 +9,17 @@ struct DirLightParams {
     glm::vec3 color     = glm::vec3(1.0f, 1.0f, 1.0f);
 };
 
+// 定向光的级联阴影设置
+struct ShadowParams {
+    bool enable = true;
+    int cascade_count = 4;          // 1 ~ MAX_SHADOW_CASCADES
+    float max_distance = 40.0f;     // 阴影覆盖的最远观察距离
+    float split_lambda = 0.75f;     // 级联的切分方式：0 = 均匀，1 = 对数
+    float depth_bias = 0.0005f;     // 比较时的深度偏移 (阴影贴图的深度单位)
+    float normal_bias = 1.5f;       // 沿法线把采样点推出表面的距离 (以 texel 为单位)
+    bool cache_static = true;       // 静态投影物缓存在单独的深度层里，只在光源或静态物体变化时重画
+};
+
 // 点光源参数
 struct PointLightParams {
     bool enable = true;
@@ -17,6 +29,53 @@ struct PointLightParams {
     float quadratic = 0.032f;
 };
 
+// 分簇光照设置
+struct ClusteredLightingParams {
+    bool enable = true;          // 关闭时退回到固定 4 个点光源的逐像素循环
+    int extra_point_lights = 256; // 场景中额外散布的点光源数量 (演示用)
+};
+
+// 软件遮挡剔除设置
+struct OcclusionParams {
+    bool enable = true;
+    float min_occluder_size = 0.1f; // 遮挡物在屏幕上的最小尺寸 (包围球半径 / 距离)，更小的不画进深度缓冲
+};
+
+// 着色路径 (每个场景单独选择)
+enum class shading_path {
+    FORWARD,    // 前向渲染：光栅化时直接计算光照
+    DEFERRED    // 延迟渲染：先写 G-buffer，再在屏幕空间对每个像素计算一次光照 (见 deferred_shading.h)
+};
+
+// 场景中的一个光源实例 (点光源或聚光灯)
+// 分簇光照把它们分到视锥体的三维网格里，每个像素只计算影响它所在簇的光源
+struct LightSource {
+    glm::vec3 position  = glm::vec3(0.0f);
+    glm::vec3 color     = glm::vec3(1.0f);
+    float constant  = 1.0f;
+    float linear    = 0.09f;
+    float quadratic = 0.032f;
+
+    // 聚光灯专用
+    bool is_spot = false;
+    glm::vec3 direction = glm::vec3(0.0f, 0.0f, -1.0f);
+    float cos_inner = 1.0f;
+    float cos_outer = 1.0f;
+};
+
+// 根据衰减常数计算光源的影响半径
+// 衰减公式 1 / (c + l*d + q*d^2)，求亮度 (最大通道 * 衰减) 降到 threshold 时的距离 d
+inline float compute_light_range(float constant, float linear, float quadratic, float max_intensity, float threshold = 5.0f / 256.0f)
+{
+    // 解 q*d^2 + l*d + (c - max_intensity / threshold) = 0 的正根
+    float c = constant - max_intensity / threshold;
+    if (c >= 0.0f)
+        return 0.0f; // 光源本身就暗于阈值
+    if (quadratic <= 0.0f)
+        return linear > 0.0f ? -c / linear : 1e30f;
+    return (-linear + std::sqrt(linear * linear - 4.0f * quadratic * c)) / (2.0f * quadratic);
+}
+
 // 聚光灯参数
 struct SpotLightParams {
     bool enable = true;
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include "bounds.h"
+#include "transform_hierarchy.h"
+
+class InstancedMesh;
+class Mesh;
+struct OccluderMesh;
+
+// 场景实体的组件 (见 entity_world.h)：都是平凡可复制的小结构，系统按块顺序遍历
+
+// 实体在变换层级里的节点 (世界矩阵从 TransformHierarchy 读取)
+struct SceneNode {
+    TransformHierarchy::Node node = TransformHierarchy::INVALID;
+};
+
+// 参与 BVH 剔除：物体在 BVH 里的编号 + 局部空间的包围盒
+struct CullProxy {
+    uint32_t object_id = 0;
+    AABB     local_bounds;
+};
+
+// 以实例化方式绘制：可见时把世界矩阵和颜色追加到 batch
+struct InstanceDraw {
+    InstancedMesh* batch = nullptr;
+    glm::vec4      color = glm::vec4(1.0f);
+};
+
+// 向定向光投下阴影：每一级阴影贴图里单独绘制 mesh
+// 静态投影物缓存在阴影的静态层里，移动后整层重画；经常移动的物体应设为动态
+struct ShadowCaster {
+    const Mesh* mesh = nullptr;
+    bool        is_static = true;
+};
+
+// 遮挡其他物体：可见并且在屏幕上足够大时，mesh 被光栅化进软件遮挡剔除的深度缓冲 (见 occlusion_culler.h)
+// mesh 必须完全在物体内部
+struct Occluder {
+    const OccluderMesh* mesh = nullptr;
+};
+
+// 场景里的点光源 (位置取自 SceneNode，颜色和衰减由面板统一设置)
+struct PointLamp {
+};
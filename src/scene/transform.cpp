@@ -8,26 +8,30 @@ Transform::Transform()
 void Transform::reset()
 {
     position = glm::vec3(0.0f, 0.0f, 0.0f);
-    rotation = glm::vec3(0.0f, 0.0f, 0.0f);
+    rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
     scale    = glm::vec3(1.0f, 1.0f, 1.0f);
 }
 
-glm::mat4 Transform::get_model_matrix() const
+void Transform::set_euler_degrees(const glm::vec3& degrees)
 {
-    glm::mat4 model = glm::mat4(1.0f);
+    // 与 glm::rotate 依次绕 X、Y、Z 轴旋转的结果相同 (注意：glm::angleAxis 接收弧度)
+    rotation = glm::angleAxis(glm::radians(degrees.x), glm::vec3(1.0f, 0.0f, 0.0f))
+             * glm::angleAxis(glm::radians(degrees.y), glm::vec3(0.0f, 1.0f, 0.0f))
+             * glm::angleAxis(glm::radians(degrees.z), glm::vec3(0.0f, 0.0f, 1.0f));
+}
 
-    // 位移 (Translation)
-    model = glm::translate(model, position);
+glm::mat4 Transform::get_model_matrix() const
+{
+    // 旋转 (Rotation)
+    glm::mat4 model = glm::mat4_cast(rotation);
 
-    // 旋转 (Rotation) - 欧拉角 (Z-Y-X 顺序或其他顺序，这里简单起见按 X->Y->Z 累乘)
-    // 注意：glm::rotate 接收弧度
-    // 为了防止万向节死锁，成熟引擎会用四元数 (Quaternion)，但目前欧拉角足够了
-    model = glm::rotate(model, glm::radians(rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
-    model = glm::rotate(model, glm::radians(rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
-    model = glm::rotate(model, glm::radians(rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
+    // 缩放 (Scale)：T * R * S 中 S 只作用在 R 的每一列上
+    model[0] *= scale.x;
+    model[1] *= scale.y;
+    model[2] *= scale.z;
 
-    // 缩放 (Scale)
-    model = glm::scale(model, scale);
+    // 位移 (Translation)
+    model[3] = glm::vec4(position, 1.0f);
 
     return model;
 }
\ No newline at end of file
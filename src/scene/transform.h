@@ -3,20 +3,25 @@
 #include "glm/glm.hpp"
 #include "glm/gtc/matrix_transform.hpp"
 #include "glm/gtc/type_ptr.hpp"
+#include "glm/gtc/quaternion.hpp"
 
 class Transform
 {
 public:
     // 位置、旋转、缩放
     glm::vec3 position;
-    glm::vec3 rotation; // 存储欧拉角（角度制，Degrees），分别对应 Pitch, Yaw, Roll
+    glm::quat rotation; // 四元数 (单位长度)，没有万向节死锁，插值也方便
     glm::vec3 scale;
 
     // 构造函数
     Transform();
 
+    // 用欧拉角 (角度制，Degrees) 设置旋转，按 X -> Y -> Z 的顺序累乘 (Pitch, Yaw, Roll)
+    void set_euler_degrees(const glm::vec3& degrees);
+
     // 核心功能：获取模型矩阵
     // 矩阵乘法顺序通常是：Translate * Rotate * Scale (T * R * S)
+    // 直接由四元数写出旋转部分，再按列乘缩放、填入位移，不做完整的矩阵乘法
     glm::mat4 get_model_matrix() const;
 
     // 辅助函数：重置状态
@@ -0,0 +1,245 @@
+#include "transform_hierarchy.h"
+#include "transform_kernels.h"
+
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+
+TransformHierarchy::Node TransformHierarchy::create(const Transform& local, Node parent)
+{
+    // 父节点已经存在，追加到末尾就满足拓扑顺序
+    Node node = static_cast<Node>(slots.size());
+    uint32_t slot = static_cast<uint32_t>(parents.size());
+    slots.push_back(slot);
+    nodes.push_back(node);
+
+    parents.push_back(parent != INVALID ? slots[parent] : INVALID);
+    for (auto& values : channels)
+        values.push_back(0.0f);
+    write_local(slot, local);
+    local_matrices.push_back(glm::mat4(1.0f));
+    world_matrices.push_back(glm::mat4(1.0f));
+    dirty.push_back(1);
+    changed.push_back(0);
+    any_dirty = true;
+    return node;
+}
+
+void TransformHierarchy::set_parent(Node node, Node parent)
+{
+    uint32_t slot = slots[node];
+    uint32_t parent_slot = parent != INVALID ? slots[parent] : INVALID;
+
+    // 沿新父节点向上走，遇到自己说明会形成环
+    for (uint32_t ancestor = parent_slot; ancestor != INVALID; ancestor = parents[ancestor]) {
+        if (ancestor == slot) {
+            std::cout << "ERROR::TRANSFORM_HIERARCHY::CYCLIC_PARENT: " << node << " -> " << parent << std::endl;
+            return;
+        }
+    }
+
+    parents[slot] = parent_slot;
+    if (parent_slot != INVALID && parent_slot > slot)
+        needs_sort = true;
+    mark_dirty(slot);
+}
+
+TransformHierarchy::Node TransformHierarchy::get_parent(Node node) const
+{
+    uint32_t parent_slot = parents[slots[node]];
+    return parent_slot != INVALID ? nodes[parent_slot] : INVALID;
+}
+
+Transform TransformHierarchy::get_local(Node node) const
+{
+    uint32_t slot = slots[node];
+    Transform local;
+    local.position = glm::vec3(channels[POSITION_X][slot], channels[POSITION_Y][slot], channels[POSITION_Z][slot]);
+    local.rotation = glm::quat(channels[ROTATION_W][slot], channels[ROTATION_X][slot], channels[ROTATION_Y][slot], channels[ROTATION_Z][slot]);
+    local.scale = glm::vec3(channels[SCALE_X][slot], channels[SCALE_Y][slot], channels[SCALE_Z][slot]);
+    return local;
+}
+
+void TransformHierarchy::set_local(Node node, const Transform& local)
+{
+    uint32_t slot = slots[node];
+    write_local(slot, local);
+    mark_dirty(slot);
+}
+
+void TransformHierarchy::set_position(Node node, const glm::vec3& position)
+{
+    uint32_t slot = slots[node];
+    channels[POSITION_X][slot] = position.x;
+    channels[POSITION_Y][slot] = position.y;
+    channels[POSITION_Z][slot] = position.z;
+    mark_dirty(slot);
+}
+
+void TransformHierarchy::set_rotation(Node node, const glm::quat& rotation)
+{
+    uint32_t slot = slots[node];
+    channels[ROTATION_X][slot] = rotation.x;
+    channels[ROTATION_Y][slot] = rotation.y;
+    channels[ROTATION_Z][slot] = rotation.z;
+    channels[ROTATION_W][slot] = rotation.w;
+    mark_dirty(slot);
+}
+
+void TransformHierarchy::set_scale(Node node, const glm::vec3& scale)
+{
+    uint32_t slot = slots[node];
+    channels[SCALE_X][slot] = scale.x;
+    channels[SCALE_Y][slot] = scale.y;
+    channels[SCALE_Z][slot] = scale.z;
+    mark_dirty(slot);
+}
+
+void TransformHierarchy::write_local(uint32_t slot, const Transform& local)
+{
+    channels[POSITION_X][slot] = local.position.x;
+    channels[POSITION_Y][slot] = local.position.y;
+    channels[POSITION_Z][slot] = local.position.z;
+    channels[ROTATION_X][slot] = local.rotation.x;
+    channels[ROTATION_Y][slot] = local.rotation.y;
+    channels[ROTATION_Z][slot] = local.rotation.z;
+    channels[ROTATION_W][slot] = local.rotation.w;
+    channels[SCALE_X][slot] = local.scale.x;
+    channels[SCALE_Y][slot] = local.scale.y;
+    channels[SCALE_Z][slot] = local.scale.z;
+}
+
+void TransformHierarchy::mark_dirty(uint32_t slot)
+{
+    dirty[slot] = 1;
+    any_dirty = true;
+}
+
+unsigned int TransformHierarchy::update()
+{
+    if (needs_sort)
+        sort();
+
+    // 没有修改：只清掉上一次的变化标记
+    if (!any_dirty) {
+        if (changed_count > 0) {
+            std::fill(changed.begin(), changed.end(), 0);
+            changed_count = 0;
+        }
+        return 0;
+    }
+
+    const uint32_t count = static_cast<uint32_t>(parents.size());
+
+    // -> 局部矩阵：每一段连续的脏节点批量合成
+    TransformSoA soa = {
+        { channels[POSITION_X].data(), channels[POSITION_Y].data(), channels[POSITION_Z].data() },
+        { channels[ROTATION_X].data(), channels[ROTATION_Y].data(), channels[ROTATION_Z].data(), channels[ROTATION_W].data() },
+        { channels[SCALE_X].data(), channels[SCALE_Y].data(), channels[SCALE_Z].data() }
+    };
+    for (uint32_t i = 0; i < count; i++) {
+        if (!dirty[i])
+            continue;
+        uint32_t end = i + 1;
+        while (end < count && dirty[end])
+            end++;
+        compose_trs_batch(soa, i, end - i, local_matrices.data());
+        i = end;
+    }
+
+    // -> 世界矩阵：父节点总在前面，需要重算的节点攒成一批；
+    //    父节点还在当前这一批里 (世界矩阵还没算出来) 时先把这一批算完
+    unsigned int updated = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t parent = parents[i];
+        bool parent_changed = parent != INVALID && changed[parent];
+
+        if (dirty[i] || parent_changed) {
+            if (parent_changed && !batch_slots.empty() && parent >= batch_slots.front())
+                flush_world_batch();
+            batch_slots.push_back(i);
+            batch_parents.push_back(parent);
+            changed[i] = 1;
+            updated++;
+        } else {
+            changed[i] = 0;
+        }
+        dirty[i] = 0;
+    }
+    flush_world_batch();
+
+    any_dirty = false;
+    changed_count = updated;
+    return updated;
+}
+
+void TransformHierarchy::flush_world_batch()
+{
+    if (batch_slots.empty())
+        return;
+    multiply_parent_batch(batch_slots.data(), batch_parents.data(), batch_slots.size(),
+                          local_matrices.data(), world_matrices.data());
+    batch_slots.clear();
+    batch_parents.clear();
+}
+
+void TransformHierarchy::sort()
+{
+    const uint32_t count = static_cast<uint32_t>(parents.size());
+
+    // -> 每个槽位的深度 (根为 0)，沿父节点链向上走到第一个已知深度的祖先
+    std::vector<uint32_t> depth(count, INVALID);
+    std::vector<uint32_t> chain;
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t slot = i;
+        while (slot != INVALID && depth[slot] == INVALID) {
+            chain.push_back(slot);
+            slot = parents[slot];
+        }
+        uint32_t d = slot != INVALID ? depth[slot] + 1 : 0;
+        for (auto it = chain.rbegin(); it != chain.rend(); ++it)
+            depth[*it] = d++;
+        chain.clear();
+    }
+
+    // -> 按深度稳定排序：同一深度内保持原来的相对顺序
+    std::vector<uint32_t> order(count);
+    std::iota(order.begin(), order.end(), 0u);
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return depth[a] < depth[b]; });
+
+    std::vector<uint32_t> new_slot(count);
+    for (uint32_t i = 0; i < count; i++)
+        new_slot[order[i]] = i;
+
+    // -> 按新顺序重排所有数组
+    std::vector<uint32_t>  sorted_parents(count);
+    std::vector<glm::mat4> sorted_local_matrices(count);
+    std::vector<glm::mat4> sorted_world_matrices(count);
+    std::vector<uint8_t>   sorted_dirty(count);
+    std::vector<uint8_t>   sorted_changed(count);
+    std::vector<Node>      sorted_nodes(count);
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t old = order[i];
+        sorted_parents[i] = parents[old] != INVALID ? new_slot[parents[old]] : INVALID;
+        sorted_local_matrices[i] = local_matrices[old];
+        sorted_world_matrices[i] = world_matrices[old];
+        sorted_dirty[i] = dirty[old];
+        sorted_changed[i] = changed[old];
+        sorted_nodes[i] = nodes[old];
+        slots[nodes[old]] = i;
+    }
+
+    parents.swap(sorted_parents);
+    for (auto& values : channels) {
+        std::vector<float> sorted_values(count);
+        for (uint32_t i = 0; i < count; i++)
+            sorted_values[i] = values[order[i]];
+        values.swap(sorted_values);
+    }
+    local_matrices.swap(sorted_local_matrices);
+    world_matrices.swap(sorted_world_matrices);
+    dirty.swap(sorted_dirty);
+    changed.swap(sorted_changed);
+    nodes.swap(sorted_nodes);
+    needs_sort = false;
+}
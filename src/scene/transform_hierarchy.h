@@ -0,0 +1,79 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+#include "transform.h"
+
+// TransformHierarchy：父子层级的变换，缓存局部矩阵和世界矩阵
+//
+// 所有节点的数据按拓扑顺序 (父节点一定排在子节点前面) 平铺在几个连续数组里，
+// 局部变换按分量分开存放 (SoA)，update() 用批量内核 (transform_kernels.h) 处理：
+// - 局部变换被修改过的节点 (脏节点) 重算局部矩阵，连续的一段脏节点一次批量合成
+// - 从前往后扫一遍，自己是脏节点或父节点的世界矩阵刚变化过的节点重算世界矩阵 (world = parent_world * local)，
+//   攒成一批一起乘，遇到父节点还在这一批里的节点时先把这一批算完
+// - 其他节点直接跳过；没有任何修改时 update() 立即返回
+//
+// 节点句柄在整个生命周期内不变，内部的存放位置 (槽位) 可能因为重新挂接父节点而调整。
+class TransformHierarchy
+{
+public:
+    using Node = uint32_t;
+    static constexpr Node INVALID = UINT32_MAX;
+
+    // 创建节点 (新节点总是脏的，下次 update 时计算世界矩阵)
+    Node create(const Transform& local = Transform(), Node parent = INVALID);
+
+    // 重新挂接父节点 (保持局部变换不变)，parent 为 INVALID 时变成根节点
+    // parent 不能是 node 自己或它的子孙
+    void set_parent(Node node, Node parent);
+    Node get_parent(Node node) const;
+
+    // 局部变换 (相对于父节点)，修改后标记为脏
+    Transform get_local(Node node) const;
+    void set_local(Node node, const Transform& local);
+    void set_position(Node node, const glm::vec3& position);
+    void set_rotation(Node node, const glm::quat& rotation);
+    void set_scale(Node node, const glm::vec3& scale);
+
+    // 重算所有脏子树的世界矩阵，返回本次重算的节点数
+    unsigned int update();
+
+    // --- 最近一次 update() 的结果 ---
+    const glm::mat4& get_world_matrix(Node node) const { return world_matrices[slots[node]]; }
+    glm::vec3 get_world_position(Node node) const { return glm::vec3(world_matrices[slots[node]][3]); }
+    // 世界矩阵在最近一次 update() 里是否变化了 (比如只刷新移动过的物体的包围盒)
+    bool is_changed(Node node) const { return changed[slots[node]] != 0; }
+
+    std::size_t size() const { return slots.size(); }
+
+private:
+    // 局部变换的分量
+    enum channel { POSITION_X, POSITION_Y, POSITION_Z, ROTATION_X, ROTATION_Y, ROTATION_Z, ROTATION_W,
+                   SCALE_X, SCALE_Y, SCALE_Z, CHANNEL_COUNT };
+
+    void write_local(uint32_t slot, const Transform& local);
+    void mark_dirty(uint32_t slot);
+    void flush_world_batch();
+    // 按深度重新排列所有数组，恢复拓扑顺序
+    void sort();
+
+    // 按槽位存放 (拓扑顺序)
+    std::vector<uint32_t>  parents;        // 父节点的槽位，根节点为 INVALID
+    std::vector<float>     channels[CHANNEL_COUNT];
+    std::vector<glm::mat4> local_matrices;
+    std::vector<glm::mat4> world_matrices;
+    std::vector<uint8_t>   dirty;          // 局部变换被修改过
+    std::vector<uint8_t>   changed;        // 最近一次 update 里世界矩阵变化了
+    std::vector<Node>      nodes;          // 槽位 -> 句柄
+
+    std::vector<uint32_t>  slots;          // 句柄 -> 槽位
+
+    // update 期间等待相乘的一批节点 (复用内存)
+    std::vector<uint32_t>  batch_slots;
+    std::vector<uint32_t>  batch_parents;
+
+    bool any_dirty = false;
+    bool needs_sort = false;               // 重新挂接后父节点可能排到了子节点后面
+    unsigned int changed_count = 0;
+};
@@ -0,0 +1,217 @@
+#include "transform_kernels.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstring>
+
+#if SHADOW_SIMD_X86
+#include <emmintrin.h>
+
+// AVX2 版本在 transform_kernels_avx2.cpp 里 (单独用 AVX2 编译选项编译)
+namespace transform_kernels_avx2 {
+    void compose_trs(const TransformSoA& transforms, std::size_t first, std::size_t count, glm::mat4* out);
+    void multiply_parent(const uint32_t* slots, const uint32_t* parents, std::size_t count, const glm::mat4* local, glm::mat4* world);
+    void transform_aabb(const AABB* local, const glm::mat4* matrices, std::size_t count, AABB* out);
+}
+#endif
+
+namespace {
+    // -1 表示还没有检测
+    std::atomic<int> kernel_level{ -1 };
+
+    // ------------------------------------------------------------------------
+    // 标量版本 (也用来处理 SIMD 版本凑不满一组的尾部)
+    // ------------------------------------------------------------------------
+    void compose_trs_scalar(const TransformSoA& t, std::size_t first, std::size_t count, glm::mat4* out)
+    {
+        for (std::size_t i = first; i < first + count; i++) {
+            float x = t.rotation[0][i], y = t.rotation[1][i], z = t.rotation[2][i], w = t.rotation[3][i];
+            float sx = t.scale[0][i], sy = t.scale[1][i], sz = t.scale[2][i];
+            float xx = x * x, yy = y * y, zz = z * z;
+            float xy = x * y, xz = x * z, yz = y * z;
+            float wx = w * x, wy = w * y, wz = w * z;
+
+            glm::mat4& m = out[i];
+            m[0] = glm::vec4((1.0f - 2.0f * (yy + zz)) * sx, 2.0f * (xy + wz) * sx, 2.0f * (xz - wy) * sx, 0.0f);
+            m[1] = glm::vec4(2.0f * (xy - wz) * sy, (1.0f - 2.0f * (xx + zz)) * sy, 2.0f * (yz + wx) * sy, 0.0f);
+            m[2] = glm::vec4(2.0f * (xz + wy) * sz, 2.0f * (yz - wx) * sz, (1.0f - 2.0f * (xx + yy)) * sz, 0.0f);
+            m[3] = glm::vec4(t.position[0][i], t.position[1][i], t.position[2][i], 1.0f);
+        }
+    }
+
+    void multiply_parent_scalar(const uint32_t* slots, const uint32_t* parents, std::size_t count,
+                                const glm::mat4* local, glm::mat4* world)
+    {
+        for (std::size_t i = 0; i < count; i++) {
+            uint32_t slot = slots[i];
+            world[slot] = parents[i] != UINT32_MAX ? world[parents[i]] * local[slot] : local[slot];
+        }
+    }
+
+    void transform_aabb_scalar(const AABB* local, const glm::mat4* matrices, std::size_t count, AABB* out)
+    {
+        for (std::size_t i = 0; i < count; i++)
+            out[i] = local[i].transformed(matrices[i]);
+    }
+
+#if SHADOW_SIMD_X86
+    // ------------------------------------------------------------------------
+    // SSE2 版本
+    // ------------------------------------------------------------------------
+
+    // 4 个物体并行：每个 __m128 是 4 个物体的同一个分量，算完之后按列转置写回
+    void compose_trs_sse(const TransformSoA& t, std::size_t first, std::size_t count, glm::mat4* out)
+    {
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 two = _mm_set1_ps(2.0f);
+        const __m128 zero = _mm_setzero_ps();
+
+        std::size_t i = first;
+        for (; i + 4 <= first + count; i += 4) {
+            __m128 x = _mm_loadu_ps(t.rotation[0] + i), y = _mm_loadu_ps(t.rotation[1] + i);
+            __m128 z = _mm_loadu_ps(t.rotation[2] + i), w = _mm_loadu_ps(t.rotation[3] + i);
+            __m128 sx = _mm_loadu_ps(t.scale[0] + i), sy = _mm_loadu_ps(t.scale[1] + i), sz = _mm_loadu_ps(t.scale[2] + i);
+
+            __m128 xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+            __m128 xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+            __m128 wx = _mm_mul_ps(w, x), wy = _mm_mul_ps(w, y), wz = _mm_mul_ps(w, z);
+
+            __m128 columns[4][4] = {
+                { _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), sx),
+                  _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), sx),
+                  _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), sx), zero },
+                { _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), sy),
+                  _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), sy),
+                  _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), sy), zero },
+                { _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), sz),
+                  _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), sz),
+                  _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), sz), zero },
+                { _mm_loadu_ps(t.position[0] + i), _mm_loadu_ps(t.position[1] + i), _mm_loadu_ps(t.position[2] + i), one }
+            };
+
+            for (int c = 0; c < 4; c++) {
+                __m128 r0 = columns[c][0], r1 = columns[c][1], r2 = columns[c][2], r3 = columns[c][3];
+                _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+                _mm_storeu_ps(&out[i + 0][c][0], r0);
+                _mm_storeu_ps(&out[i + 1][c][0], r1);
+                _mm_storeu_ps(&out[i + 2][c][0], r2);
+                _mm_storeu_ps(&out[i + 3][c][0], r3);
+            }
+        }
+        compose_trs_scalar(t, i, first + count - i, out);
+    }
+
+    // 一个矩阵一次：结果的每一列 = 父矩阵四列的线性组合
+    void multiply_parent_sse(const uint32_t* slots, const uint32_t* parents, std::size_t count,
+                             const glm::mat4* local, glm::mat4* world)
+    {
+        for (std::size_t i = 0; i < count; i++) {
+            uint32_t slot = slots[i];
+            if (parents[i] == UINT32_MAX) {
+                world[slot] = local[slot];
+                continue;
+            }
+
+            const float* p = &world[parents[i]][0][0];
+            const float* l = &local[slot][0][0];
+            __m128 p0 = _mm_loadu_ps(p), p1 = _mm_loadu_ps(p + 4), p2 = _mm_loadu_ps(p + 8), p3 = _mm_loadu_ps(p + 12);
+            float* w = &world[slot][0][0];
+            for (int c = 0; c < 4; c++) {
+                __m128 column = _mm_mul_ps(p0, _mm_set1_ps(l[c * 4 + 0]));
+                column = _mm_add_ps(column, _mm_mul_ps(p1, _mm_set1_ps(l[c * 4 + 1])));
+                column = _mm_add_ps(column, _mm_mul_ps(p2, _mm_set1_ps(l[c * 4 + 2])));
+                column = _mm_add_ps(column, _mm_mul_ps(p3, _mm_set1_ps(l[c * 4 + 3])));
+                _mm_storeu_ps(w + c * 4, column);
+            }
+        }
+    }
+
+    // 一个包围盒一次：中心点正常变换，半长用矩阵列的绝对值变换
+    void transform_aabb_sse(const AABB* local, const glm::mat4* matrices, std::size_t count, AABB* out)
+    {
+        const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+
+        for (std::size_t i = 0; i < count; i++) {
+            if (!local[i].is_valid()) {
+                out[i] = local[i];
+                continue;
+            }
+
+            const float* m = &matrices[i][0][0];
+            __m128 m0 = _mm_loadu_ps(m), m1 = _mm_loadu_ps(m + 4), m2 = _mm_loadu_ps(m + 8), m3 = _mm_loadu_ps(m + 12);
+
+            glm::vec3 c = (local[i].min + local[i].max) * 0.5f;
+            glm::vec3 e = (local[i].max - local[i].min) * 0.5f;
+
+            __m128 center = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m0, _mm_set1_ps(c.x)), _mm_mul_ps(m1, _mm_set1_ps(c.y))),
+                                       _mm_add_ps(_mm_mul_ps(m2, _mm_set1_ps(c.z)), m3));
+            __m128 extent = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_and_ps(m0, abs_mask), _mm_set1_ps(e.x)),
+                                                  _mm_mul_ps(_mm_and_ps(m1, abs_mask), _mm_set1_ps(e.y))),
+                                       _mm_mul_ps(_mm_and_ps(m2, abs_mask), _mm_set1_ps(e.z)));
+
+            float lower[4], upper[4];
+            _mm_storeu_ps(lower, _mm_sub_ps(center, extent));
+            _mm_storeu_ps(upper, _mm_add_ps(center, extent));
+            out[i].min = glm::vec3(lower[0], lower[1], lower[2]);
+            out[i].max = glm::vec3(upper[0], upper[1], upper[2]);
+        }
+    }
+#endif
+
+    simd_level current_level()
+    {
+        int level = kernel_level.load(std::memory_order_relaxed);
+        if (level < 0) {
+            level = static_cast<int>(detect_simd_level());
+            kernel_level.store(level, std::memory_order_relaxed);
+        }
+        return static_cast<simd_level>(level);
+    }
+}
+
+void compose_trs_batch(const TransformSoA& transforms, std::size_t first, std::size_t count, glm::mat4* out)
+{
+    switch (current_level()) {
+#if SHADOW_SIMD_X86
+        case simd_level::AVX2: transform_kernels_avx2::compose_trs(transforms, first, count, out); return;
+        case simd_level::SSE:  compose_trs_sse(transforms, first, count, out); return;
+#endif
+        default: compose_trs_scalar(transforms, first, count, out); return;
+    }
+}
+
+void multiply_parent_batch(const uint32_t* slots, const uint32_t* parents, std::size_t count,
+                           const glm::mat4* local, glm::mat4* world)
+{
+    switch (current_level()) {
+#if SHADOW_SIMD_X86
+        case simd_level::AVX2: transform_kernels_avx2::multiply_parent(slots, parents, count, local, world); return;
+        case simd_level::SSE:  multiply_parent_sse(slots, parents, count, local, world); return;
+#endif
+        default: multiply_parent_scalar(slots, parents, count, local, world); return;
+    }
+}
+
+void transform_aabb_batch(const AABB* local, const glm::mat4* matrices, std::size_t count, AABB* out)
+{
+    switch (current_level()) {
+#if SHADOW_SIMD_X86
+        case simd_level::AVX2: transform_kernels_avx2::transform_aabb(local, matrices, count, out); return;
+        case simd_level::SSE:  transform_aabb_sse(local, matrices, count, out); return;
+#endif
+        default: transform_aabb_scalar(local, matrices, count, out); return;
+    }
+}
+
+simd_level get_transform_kernel_level()
+{
+    return current_level();
+}
+
+void set_transform_kernel_level(simd_level level)
+{
+    simd_level supported = detect_simd_level();
+    if (static_cast<int>(level) > static_cast<int>(supported))
+        level = supported;
+    kernel_level.store(static_cast<int>(level), std::memory_order_relaxed);
+}
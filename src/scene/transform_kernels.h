@@ -0,0 +1,38 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include "../core/cpu_features.h"
+#include "bounds.h"
+
+// 批量变换内核：一次处理 N 个物体的 TRS 合成、父子矩阵相乘和包围盒变换
+//
+// 每个函数有标量、SSE2 和 AVX2 (+FMA) 三个版本，第一次调用时按 CPU 支持的最高档选择 (core/cpu_features.h)，
+// 也可以用 set_transform_kernel_level 强制使用较低的档位 (基准测试对比、排查精度问题)。
+// - TRS 合成：输入按分量分开存放 (SoA)，SIMD 每条指令处理 4 / 8 个物体，最后转置写回矩阵
+// - 矩阵相乘 / 包围盒变换：输入是矩阵数组，SIMD 在矩阵的列上展开 (AVX2 一次处理两列)
+// 各版本的结果与 Transform::get_model_matrix / AABB::transformed 只有浮点舍入上的差别。
+
+// 局部变换的 SoA 视图：每个分量一段连续的 float，下标相同的元素属于同一个物体
+struct TransformSoA {
+    const float* position[3]; // x, y, z
+    const float* rotation[4]; // 四元数 x, y, z, w (单位长度)
+    const float* scale[3];    // x, y, z
+};
+
+// out[i] = T * R * S，i 属于 [first, first + count)
+void compose_trs_batch(const TransformSoA& transforms, std::size_t first, std::size_t count, glm::mat4* out);
+
+// world[slots[i]] = world[parents[i]] * local[slots[i]] (parents[i] 为 UINT32_MAX 时直接复制 local)
+// 同一批里的节点互不依赖：父节点的世界矩阵必须在这一批之前算好
+void multiply_parent_batch(const uint32_t* slots, const uint32_t* parents, std::size_t count,
+                           const glm::mat4* local, glm::mat4* world);
+
+// out[i] = local[i] 经 matrices[i] 变换后的世界包围盒 (Arvo 方法，无效包围盒原样输出)
+void transform_aabb_batch(const AABB* local, const glm::mat4* matrices, std::size_t count, AABB* out);
+
+// 当前使用的档位
+simd_level get_transform_kernel_level();
+// 强制使用某一档 (超过 CPU 支持的档位时取支持的最高档)
+void set_transform_kernel_level(simd_level level);
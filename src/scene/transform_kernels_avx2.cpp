@@ -0,0 +1,153 @@
+// 变换内核的 AVX2 + FMA 版本
+// 这个文件单独用 AVX2 编译选项编译 (见 CMakeLists.txt)，只有运行时检测到 CPU 支持时才会被调用。
+// 头文件里的 inline 函数 (glm 运算符、AABB 成员函数等) 在这里也会被编译成 AVX2 指令，
+// 链接器可能让其他文件共用这一份，所以这里只直接读写 float 数组，不调用它们。
+#include "transform_kernels.h"
+
+#if SHADOW_SIMD_X86
+#include <immintrin.h>
+#include <cstring>
+
+namespace transform_kernels_avx2 {
+    namespace {
+        // 标量尾部 (与 transform_kernels.cpp 的标量版本公式相同)
+        void compose_trs_tail(const TransformSoA& t, std::size_t first, std::size_t end, glm::mat4* out)
+        {
+            for (std::size_t i = first; i < end; i++) {
+                float x = t.rotation[0][i], y = t.rotation[1][i], z = t.rotation[2][i], w = t.rotation[3][i];
+                float sx = t.scale[0][i], sy = t.scale[1][i], sz = t.scale[2][i];
+                float xx = x * x, yy = y * y, zz = z * z;
+                float xy = x * y, xz = x * z, yz = y * z;
+                float wx = w * x, wy = w * y, wz = w * z;
+
+                float* m = reinterpret_cast<float*>(out + i);
+                m[0]  = (1.0f - 2.0f * (yy + zz)) * sx; m[1]  = 2.0f * (xy + wz) * sx; m[2]  = 2.0f * (xz - wy) * sx; m[3]  = 0.0f;
+                m[4]  = 2.0f * (xy - wz) * sy; m[5]  = (1.0f - 2.0f * (xx + zz)) * sy; m[6]  = 2.0f * (yz + wx) * sy; m[7]  = 0.0f;
+                m[8]  = 2.0f * (xz + wy) * sz; m[9]  = 2.0f * (yz - wx) * sz; m[10] = (1.0f - 2.0f * (xx + yy)) * sz; m[11] = 0.0f;
+                m[12] = t.position[0][i]; m[13] = t.position[1][i]; m[14] = t.position[2][i]; m[15] = 1.0f;
+            }
+        }
+    }
+
+    // 8 个物体并行，每一列的 4 个分量 (各含 8 个物体) 转置成 8 个物体各自的一列
+    void compose_trs(const TransformSoA& t, std::size_t first, std::size_t count, glm::mat4* out)
+    {
+        const __m256 one = _mm256_set1_ps(1.0f);
+        const __m256 two = _mm256_set1_ps(2.0f);
+        const __m256 zero = _mm256_setzero_ps();
+
+        std::size_t i = first;
+        for (; i + 8 <= first + count; i += 8) {
+            __m256 x = _mm256_loadu_ps(t.rotation[0] + i), y = _mm256_loadu_ps(t.rotation[1] + i);
+            __m256 z = _mm256_loadu_ps(t.rotation[2] + i), w = _mm256_loadu_ps(t.rotation[3] + i);
+            __m256 sx = _mm256_loadu_ps(t.scale[0] + i), sy = _mm256_loadu_ps(t.scale[1] + i), sz = _mm256_loadu_ps(t.scale[2] + i);
+
+            __m256 xx = _mm256_mul_ps(x, x), yy = _mm256_mul_ps(y, y), zz = _mm256_mul_ps(z, z);
+            __m256 xy = _mm256_mul_ps(x, y), xz = _mm256_mul_ps(x, z), yz = _mm256_mul_ps(y, z);
+            __m256 wx = _mm256_mul_ps(w, x), wy = _mm256_mul_ps(w, y), wz = _mm256_mul_ps(w, z);
+
+            __m256 columns[4][4] = {
+                { _mm256_mul_ps(_mm256_fnmadd_ps(two, _mm256_add_ps(yy, zz), one), sx),
+                  _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(xy, wz)), sx),
+                  _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(xz, wy)), sx), zero },
+                { _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(xy, wz)), sy),
+                  _mm256_mul_ps(_mm256_fnmadd_ps(two, _mm256_add_ps(xx, zz), one), sy),
+                  _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(yz, wx)), sy), zero },
+                { _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(xz, wy)), sz),
+                  _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(yz, wx)), sz),
+                  _mm256_mul_ps(_mm256_fnmadd_ps(two, _mm256_add_ps(xx, yy), one), sz), zero },
+                { _mm256_loadu_ps(t.position[0] + i), _mm256_loadu_ps(t.position[1] + i), _mm256_loadu_ps(t.position[2] + i), one }
+            };
+
+            for (int c = 0; c < 4; c++) {
+                // 4x8 转置：低 128 位是物体 0..3，高 128 位是物体 4..7
+                __m256 t0 = _mm256_unpacklo_ps(columns[c][0], columns[c][1]);
+                __m256 t1 = _mm256_unpackhi_ps(columns[c][0], columns[c][1]);
+                __m256 t2 = _mm256_unpacklo_ps(columns[c][2], columns[c][3]);
+                __m256 t3 = _mm256_unpackhi_ps(columns[c][2], columns[c][3]);
+                __m256 o0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+                __m256 o1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+                __m256 o2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+                __m256 o3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+
+                _mm_storeu_ps(reinterpret_cast<float*>(out + i + 0) + c * 4, _mm256_castps256_ps128(o0));
+                _mm_storeu_ps(reinterpret_cast<float*>(out + i + 1) + c * 4, _mm256_castps256_ps128(o1));
+                _mm_storeu_ps(reinterpret_cast<float*>(out + i + 2) + c * 4, _mm256_castps256_ps128(o2));
+                _mm_storeu_ps(reinterpret_cast<float*>(out + i + 3) + c * 4, _mm256_castps256_ps128(o3));
+                _mm_storeu_ps(reinterpret_cast<float*>(out + i + 4) + c * 4, _mm256_extractf128_ps(o0, 1));
+                _mm_storeu_ps(reinterpret_cast<float*>(out + i + 5) + c * 4, _mm256_extractf128_ps(o1, 1));
+                _mm_storeu_ps(reinterpret_cast<float*>(out + i + 6) + c * 4, _mm256_extractf128_ps(o2, 1));
+                _mm_storeu_ps(reinterpret_cast<float*>(out + i + 7) + c * 4, _mm256_extractf128_ps(o3, 1));
+            }
+        }
+        compose_trs_tail(t, i, first + count, out);
+    }
+
+    // 一个矩阵两次迭代：每次算两列 (低 128 位是第 c 列，高 128 位是第 c + 1 列)
+    void multiply_parent(const uint32_t* slots, const uint32_t* parents, std::size_t count, const glm::mat4* local, glm::mat4* world)
+    {
+        for (std::size_t i = 0; i < count; i++) {
+            uint32_t slot = slots[i];
+            if (parents[i] == UINT32_MAX) {
+                std::memcpy(world + slot, local + slot, sizeof(glm::mat4));
+                continue;
+            }
+
+            const float* p = reinterpret_cast<const float*>(world + parents[i]);
+            const float* l = reinterpret_cast<const float*>(local + slot);
+            // 父矩阵的每一列复制到高低两半
+            __m256 p0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(p));
+            __m256 p1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(p + 4));
+            __m256 p2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(p + 8));
+            __m256 p3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(p + 12));
+
+            float* w = reinterpret_cast<float*>(world + slot);
+            for (int c = 0; c < 4; c += 2) {
+                __m256 pair = _mm256_loadu_ps(l + c * 4); // 第 c 列和第 c + 1 列
+                __m256 column = _mm256_mul_ps(p0, _mm256_permute_ps(pair, _MM_SHUFFLE(0, 0, 0, 0)));
+                column = _mm256_fmadd_ps(p1, _mm256_permute_ps(pair, _MM_SHUFFLE(1, 1, 1, 1)), column);
+                column = _mm256_fmadd_ps(p2, _mm256_permute_ps(pair, _MM_SHUFFLE(2, 2, 2, 2)), column);
+                column = _mm256_fmadd_ps(p3, _mm256_permute_ps(pair, _MM_SHUFFLE(3, 3, 3, 3)), column);
+                _mm256_storeu_ps(w + c * 4, column);
+            }
+        }
+    }
+
+    // 一个包围盒一次，中心点和半长分别放在低、高 128 位，共用同一组 FMA
+    void transform_aabb(const AABB* local, const glm::mat4* matrices, std::size_t count, AABB* out)
+    {
+        const __m256 abs_high = _mm256_castsi256_ps(_mm256_setr_epi32(-1, -1, -1, -1, 0x7FFFFFFF, 0x7FFFFFFF, 0x7FFFFFFF, 0x7FFFFFFF));
+
+        for (std::size_t i = 0; i < count; i++) {
+            const AABB& box = local[i];
+            if (!(box.min.x <= box.max.x && box.min.y <= box.max.y && box.min.z <= box.max.z)) {
+                std::memcpy(out + i, local + i, sizeof(AABB));
+                continue;
+            }
+
+            const float* m = reinterpret_cast<const float*>(matrices + i);
+            // 低半：矩阵列 (给中心点用)，高半：矩阵列的绝对值 (给半长用)
+            __m256 m0 = _mm256_and_ps(_mm256_broadcast_ps(reinterpret_cast<const __m128*>(m)), abs_high);
+            __m256 m1 = _mm256_and_ps(_mm256_broadcast_ps(reinterpret_cast<const __m128*>(m + 4)), abs_high);
+            __m256 m2 = _mm256_and_ps(_mm256_broadcast_ps(reinterpret_cast<const __m128*>(m + 8)), abs_high);
+            __m256 m3 = _mm256_setr_m128(_mm_loadu_ps(m + 12), _mm_setzero_ps());
+
+            float cx = (box.min.x + box.max.x) * 0.5f, ex = (box.max.x - box.min.x) * 0.5f;
+            float cy = (box.min.y + box.max.y) * 0.5f, ey = (box.max.y - box.min.y) * 0.5f;
+            float cz = (box.min.z + box.max.z) * 0.5f, ez = (box.max.z - box.min.z) * 0.5f;
+
+            __m256 result = _mm256_fmadd_ps(m0, _mm256_setr_ps(cx, cx, cx, cx, ex, ex, ex, ex), m3);
+            result = _mm256_fmadd_ps(m1, _mm256_setr_ps(cy, cy, cy, cy, ey, ey, ey, ey), result);
+            result = _mm256_fmadd_ps(m2, _mm256_setr_ps(cz, cz, cz, cz, ez, ez, ez, ez), result);
+
+            __m128 center = _mm256_castps256_ps128(result);
+            __m128 extent = _mm256_extractf128_ps(result, 1);
+            float lower[4], upper[4];
+            _mm_storeu_ps(lower, _mm_sub_ps(center, extent));
+            _mm_storeu_ps(upper, _mm_add_ps(center, extent));
+            out[i].min.x = lower[0]; out[i].min.y = lower[1]; out[i].min.z = lower[2];
+            out[i].max.x = upper[0]; out[i].max.y = upper[1]; out[i].max.z = upper[2];
+        }
+    }
+}
+#endif
@@ -0,0 +1,236 @@
+// shadow-occlusion-test：OcclusionCuller 的单元测试
+//
+// 软件光栅化和遮挡测试只用 CPU，不需要窗口和 GL 上下文：
+// - 前面的墙挡住后面的箱子，没挡住的箱子可见
+// - 穿过近平面的遮挡物被裁剪后仍然正确写入深度，穿过近平面的物体按可见处理
+// - 遮挡物就是物体自己时 (DEPTH_EPSILON) 不会把自己剔除
+// - 标量 / SSE2 / AVX2 三档光栅化得到逐位相同的深度缓冲 (CPU 不支持的档位退回到支持的最高档)
+// 失败时打印检查的位置，返回非 0。
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "core/cpu_features.h"
+#include "core/jobs.h"
+#include "renderer/occlusion_culler.h"
+#include "scene/bounds.h"
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            std::printf("FAILED %s:%d: %s\n", __FILE__, __LINE__, #condition); \
+            failures++; \
+        } \
+    } while (0)
+
+namespace {
+    int failures = 0;
+
+    const float NEAR_PLANE = 0.1f;
+    const simd_level LEVELS[] = { simd_level::SCALAR, simd_level::SSE, simd_level::AVX2 };
+
+    // 摄像机在原点看向 -Z
+    glm::mat4 make_view_projection()
+    {
+        glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, NEAR_PLANE, 100.0f);
+        glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        return projection * view;
+    }
+
+    // XY 平面上的矩形 (两个三角形)
+    OccluderMesh make_quad(float half_width, float half_height)
+    {
+        OccluderMesh mesh;
+        mesh.positions = { { -half_width, -half_height, 0.0f }, { half_width, -half_height, 0.0f },
+                           { half_width, half_height, 0.0f }, { -half_width, half_height, 0.0f } };
+        mesh.indices = { 0, 1, 2, 0, 2, 3 };
+        return mesh;
+    }
+
+    // 边长为 1 的立方体
+    OccluderMesh make_cube()
+    {
+        OccluderMesh mesh;
+        for (int i = 0; i < 8; i++)
+            mesh.positions.push_back(glm::vec3((i & 1) ? 0.5f : -0.5f, (i & 2) ? 0.5f : -0.5f, (i & 4) ? 0.5f : -0.5f));
+        const uint32_t faces[6][4] = { { 0, 1, 3, 2 }, { 4, 6, 7, 5 }, { 0, 4, 5, 1 }, { 2, 3, 7, 6 }, { 0, 2, 6, 4 }, { 1, 5, 7, 3 } };
+        for (const auto& face : faces)
+            mesh.indices.insert(mesh.indices.end(), { face[0], face[1], face[2], face[0], face[2], face[3] });
+        return mesh;
+    }
+
+    AABB make_box(const glm::vec3& min, const glm::vec3& max)
+    {
+        AABB box;
+        box.min = min;
+        box.max = max;
+        return box;
+    }
+
+    AABB make_box(const glm::vec3& center, float half_size)
+    {
+        return make_box(center - glm::vec3(half_size), center + glm::vec3(half_size));
+    }
+
+    void test_wall_occludes_box(simd_level level)
+    {
+        OcclusionCuller culler;
+        culler.set_simd_level(level);
+        culler.begin(make_view_projection());
+        culler.add_occluder(make_quad(4.0f, 4.0f), glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -5.0f)));
+        culler.rasterize();
+
+        CHECK(culler.get_stats().triangles == 2);
+        CHECK(!culler.is_visible(make_box(glm::vec3(0.0f, 0.0f, -10.0f), 0.5f)));   // 墙后面
+        CHECK(culler.is_visible(make_box(glm::vec3(0.0f, 0.0f, -3.0f), 0.5f)));     // 墙前面
+        CHECK(culler.is_visible(make_box(glm::vec3(20.0f, 0.0f, -10.0f), 0.5f)));   // 墙旁边
+        CHECK(culler.is_visible(make_box(glm::vec3(0.0f, 0.0f, -5.0f), 0.5f)));     // 穿过墙
+    }
+
+    void test_near_plane(simd_level level)
+    {
+        glm::mat4 view_projection = make_view_projection();
+
+        // 物体穿过近平面：投影不可靠，即使后面整屏都是遮挡物也按可见处理
+        OcclusionCuller culler;
+        culler.set_simd_level(level);
+        culler.begin(view_projection);
+        culler.add_occluder(make_quad(50.0f, 50.0f), glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -1.0f)));
+        culler.rasterize();
+        CHECK(!culler.is_visible(make_box(glm::vec3(0.0f, 0.0f, -10.0f), 0.5f)));
+        CHECK(culler.is_visible(make_box(glm::vec3(-0.5f, -0.5f, -3.0f), glm::vec3(0.5f, 0.5f, -0.05f))));
+        CHECK(culler.is_visible(make_box(glm::vec3(-0.5f, -0.5f, -3.0f), glm::vec3(0.5f, 0.5f, 1.0f))));
+
+        // 遮挡物穿过近平面：裁剪掉摄像机后面的部分，剩下的部分照常写入深度
+        // 斜着的墙经过 (0, 0, -2)，屏幕中心被它挡住
+        culler.begin(view_projection);
+        glm::mat4 model = glm::rotate(glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -2.0f)), 1.2f, glm::vec3(0.0f, 1.0f, 0.0f));
+        culler.add_occluder(make_quad(50.0f, 50.0f), model);
+        culler.rasterize();
+        CHECK(culler.get_stats().triangles > 2);
+        CHECK(!culler.is_visible(make_box(glm::vec3(0.0f, 0.0f, -10.0f), 0.3f)));
+
+        // 裁剪之后 w 不小于近平面距离，深度 1 / w 不会超过 1 / near
+        float max_depth = 0.0f;
+        for (int y = 0; y < culler.get_height(); y++) {
+            for (int x = 0; x < culler.get_width(); x++)
+                max_depth = std::max(max_depth, culler.get_depth(x, y));
+        }
+        CHECK(max_depth > 0.0f);
+        CHECK(max_depth <= 1.0f / NEAR_PLANE * 1.001f);
+    }
+
+    void test_self_occlusion(simd_level level)
+    {
+        OccluderMesh cube = make_cube();
+        glm::mat4 model = glm::rotate(glm::translate(glm::mat4(1.0f), glm::vec3(0.3f, 0.2f, -4.0f)), 0.7f, glm::vec3(1.0f, 1.0f, 0.0f));
+
+        OcclusionCuller culler;
+        culler.set_simd_level(level);
+        culler.begin(make_view_projection());
+        culler.add_occluder(cube, model);
+        culler.rasterize();
+
+        // 遮挡物的包围盒最近的角和遮挡物自己的深度几乎相同，DEPTH_EPSILON 让它保持可见
+        AABB self;
+        for (const glm::vec3& position : cube.positions)
+            self.expand(glm::vec3(model * glm::vec4(position, 1.0f)));
+        CHECK(culler.is_visible(self));
+        CHECK(!culler.is_visible(make_box(glm::vec3(0.3f, 0.2f, -30.0f), 0.3f)));
+    }
+
+    // 随机三角形 (其中一部分穿过近平面) 在三档下的深度缓冲必须逐位相同
+    void test_levels_match()
+    {
+        std::mt19937 random(7);
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        std::vector<OccluderMesh> triangles;
+        for (int i = 0; i < 300; i++) {
+            OccluderMesh triangle;
+            for (int k = 0; k < 3; k++)
+                triangle.positions.push_back(glm::vec3(unit(random) * 20.0f, unit(random) * 12.0f, -1.0f - (unit(random) + 1.0f) * 15.0f));
+            if (i % 10 == 0)
+                triangle.positions[0].z = 2.0f;
+            triangle.indices = { 0, 1, 2 };
+            triangles.push_back(triangle);
+        }
+
+        std::vector<AABB> boxes;
+        for (int i = 0; i < 2000; i++)
+            boxes.push_back(make_box(glm::vec3(unit(random) * 15.0f, unit(random) * 9.0f, -2.0f - (unit(random) + 1.0f) * 20.0f),
+                                     0.2f + 0.5f * (unit(random) + 1.0f)));
+
+        OcclusionCuller reference;
+        reference.set_simd_level(simd_level::SCALAR);
+        reference.begin(make_view_projection());
+        for (const OccluderMesh& triangle : triangles)
+            reference.add_occluder(triangle, glm::mat4(1.0f));
+        reference.rasterize();
+
+        int covered = 0;
+        for (int y = 0; y < reference.get_height(); y++) {
+            for (int x = 0; x < reference.get_width(); x++)
+                covered += reference.get_depth(x, y) > 0.0f ? 1 : 0;
+        }
+        CHECK(covered > 0);
+
+        for (simd_level level : LEVELS) {
+            OcclusionCuller culler;
+            culler.set_simd_level(level);
+            culler.begin(make_view_projection());
+            for (const OccluderMesh& triangle : triangles)
+                culler.add_occluder(triangle, glm::mat4(1.0f));
+            culler.rasterize();
+
+            int mismatched = 0;
+            for (int y = 0; y < culler.get_height(); y++) {
+                for (int x = 0; x < culler.get_width(); x++) {
+                    float expected = reference.get_depth(x, y);
+                    float actual = culler.get_depth(x, y);
+                    mismatched += std::memcmp(&expected, &actual, sizeof(float)) != 0 ? 1 : 0;
+                }
+            }
+            int disagreements = 0;
+            for (const AABB& box : boxes)
+                disagreements += culler.is_visible(box) != reference.is_visible(box) ? 1 : 0;
+
+            std::printf("  %s: %d / %d pixels differ, %d / %zu visibility results differ\n", simd_level_name(culler.get_simd_level()),
+                        mismatched, culler.get_width() * culler.get_height(), disagreements, boxes.size());
+            CHECK(mismatched == 0);
+            CHECK(disagreements == 0);
+        }
+    }
+}
+
+int main()
+{
+    // 多个工作线程：光栅化按条带并行
+    JobSystem::init(3);
+    std::printf("cpu simd level: %s\n", simd_level_name(detect_simd_level()));
+
+    for (simd_level level : LEVELS) {
+        std::printf("level %s\n", simd_level_name(level));
+        test_wall_occludes_box(level);
+        test_near_plane(level);
+        test_self_occlusion(level);
+    }
+    std::printf("levels match\n");
+    test_levels_match();
+
+    JobSystem::shutdown();
+
+    if (failures > 0) {
+        std::printf("%d check(s) failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    std::printf("all checks passed\n");
+    return EXIT_SUCCESS;
+}